@@ -59,6 +59,7 @@ MODULE_OBJS := \
 	saves/savefile.o \
 	saves/default/default-saves.o \
 	saves/posix/posix-saves.o \
+	saves/sdl/sdl-saves.o \
 	timer/default/default-timer.o \
 	timer/sdl/sdl-timer.o \
 	vkeybd/image-map.o \
@@ -29,6 +29,7 @@
 
 #include "backends/platform/sdl/posix/posix.h"
 #include "backends/saves/posix/posix-saves.h"
+#include "backends/saves/sdl/sdl-saves.h"
 #include "backends/fs/posix/posix-fs-factory.h"
 
 #include <errno.h>
@@ -49,8 +50,11 @@ void OSystem_POSIX::init() {
 
 void OSystem_POSIX::initBackend() {
 	// Create the savefile manager
-	if (_savefileManager == 0)
-		_savefileManager = new POSIXSaveFileManager();
+	if (_savefileManager == 0) {
+		POSIXSaveFileManager *saveFileMan = new POSIXSaveFileManager();
+		saveFileMan->setBackgroundWriter(new SdlSaveWriter(saveFileMan));
+		_savefileManager = saveFileMan;
+	}
 
 	// Invoke parent implementation of this method
 	OSystem_SDL::initBackend();
@@ -34,6 +34,7 @@
 #include "common/EventRecorder.h"
 
 #include "backends/saves/default/default-saves.h"
+#include "backends/saves/sdl/sdl-saves.h"
 #include "backends/audiocd/sdl/sdl-audiocd.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
@@ -184,8 +185,11 @@ void OSystem_SDL::initBackend() {
 		((OpenGLSdlGraphicsManager *)_graphicsManager)->initEventObserver();
 #endif
 
-	if (_savefileManager == 0)
-		_savefileManager = new DefaultSaveFileManager();
+	if (_savefileManager == 0) {
+		DefaultSaveFileManager *saveFileMan = new DefaultSaveFileManager();
+		saveFileMan->setBackgroundWriter(new SdlSaveWriter(saveFileMan));
+		_savefileManager = saveFileMan;
+	}
 
 	if (_mixerManager == 0) {
 		_mixerManager = new SdlMixerManager();
@@ -29,24 +29,87 @@
 
 #include "backends/saves/default/default-saves.h"
 
+#include "common/algorithm.h"
 #include "common/savefile.h"
 #include "common/util.h"
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/mutex.h"
 #include "common/zlib.h"
 
+#include <stdio.h>	// for rename()
+
 #ifndef _WIN32_WCE
 #include <errno.h>	// for removeSavefile()
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+/**
+ * Savefile returned by openForSavingInBackground. It collects the data in
+ * memory, and queues it for writing when it is finalized.
+ */
+class BackgroundSaveFile : public Common::OutSaveFile {
+public:
+	BackgroundSaveFile(DefaultSaveFileManager *manager, const Common::String &name, const Common::String &path)
+		: _manager(manager), _name(name), _path(path), _stream(DisposeAfterUse::NO) {
+	}
+
+	~BackgroundSaveFile() {
+		finalize();
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (!_manager)
+			return 0;
+		return _stream.write(dataPtr, dataSize);
+	}
+
+	void finalize() {
+		if (_manager) {
+			// The manager takes over the data
+			_manager->queueSave(_name, _path, _stream.getData(), _stream.size());
+			_manager = 0;
+		}
+	}
+
+private:
+	DefaultSaveFileManager *_manager; ///< 0 once the savefile has been finalized
+	Common::String _name;
+	Common::String _path;
+	Common::MemoryWriteStreamDynamic _stream;
+};
+
+DefaultSaveFileManager::DefaultSaveFileManager()
+	: _backgroundWriter(0), _pendingMutex(0), _writingSave(false) {
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) {
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath)
+	: _backgroundWriter(0), _pendingMutex(0), _writingSave(false) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	// Stop the writer thread, and write whatever is still pending
+	delete _backgroundWriter;
+	_backgroundWriter = 0;
+
+	while (writePendingSave())
+		;
+
+	if (_pendingMutex)
+		g_system->deleteMutex(_pendingMutex);
+}
+
+void DefaultSaveFileManager::setBackgroundWriter(BackgroundWriter *writer) {
+	if (!_pendingMutex)
+		_pendingMutex = g_system->createMutex();
+
+	waitForSaves();
+	delete _backgroundWriter;
+	_backgroundWriter = writer;
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -77,10 +140,32 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 		}
 	}
 
+	// Savefiles which haven't been written yet
+	if (_pendingMutex) {
+		Common::StackLock lock(_pendingMutex);
+		for (PendingSaveList::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+			if (i->name.matchString(search, true) && Common::find(results.begin(), results.end(), i->name) == results.end())
+				results.push_back(i->name);
+		}
+	}
+
 	return results;
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	// A savefile which is still being written is read from memory
+	if (_pendingMutex) {
+		Common::StackLock lock(_pendingMutex);
+		for (PendingSaveList::const_iterator i = _pendingSaves.reverse_begin(); i != _pendingSaves.end(); --i) {
+			if (i->name == filename) {
+				byte *data = (byte *)malloc(i->size);
+				assert(data || !i->size);
+				memcpy(data, i->data, i->size);
+				return new Common::MemoryReadStream(data, i->size, DisposeAfterUse::YES);
+			}
+		}
+	}
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -101,6 +186,10 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 }
 
 Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String &filename) {
+	// Don't let an older version which is written in the background
+	// overwrite this one
+	waitForSave(filename);
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -118,7 +207,137 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 	return Common::wrapCompressedWriteStream(sf);
 }
 
+Common::OutSaveFile *DefaultSaveFileManager::openForSavingInBackground(const Common::String &filename) {
+	if (!_backgroundWriter)
+		return openForSaving(filename);
+
+	// Ensure that the savepath is valid. If not, generate an appropriate error.
+	Common::String savePathName = getSavePath();
+	checkPath(Common::FSNode(savePathName));
+	if (getError() != Common::kNoError)
+		return 0;
+
+	// recreate FSNode since checkPath may have changed/created the directory
+	Common::FSNode savePath(savePathName);
+
+	// The path is resolved here, since the writer thread must not access
+	// the config manager
+	return new BackgroundSaveFile(this, filename, savePath.getChild(filename).getPath());
+}
+
+void DefaultSaveFileManager::queueSave(const Common::String &name, const Common::String &path, byte *data, uint32 size) {
+	{
+		Common::StackLock lock(_pendingMutex);
+
+		// Drop older versions of the savefile, unless they are already
+		// being written
+		PendingSaveList::iterator i = _pendingSaves.begin();
+		if (_writingSave && i != _pendingSaves.end())
+			++i;
+		while (i != _pendingSaves.end()) {
+			if (i->name == name) {
+				free(i->data);
+				i = _pendingSaves.erase(i);
+			} else {
+				++i;
+			}
+		}
+
+		PendingSave save;
+		save.name = name;
+		save.path = path;
+		save.data = data;
+		save.size = size;
+		_pendingSaves.push_back(save);
+	}
+
+	_backgroundWriter->wakeUp();
+}
+
+bool DefaultSaveFileManager::writePendingSave() {
+	if (!_pendingMutex)
+		return false;
+
+	PendingSave save;
+	{
+		Common::StackLock lock(_pendingMutex);
+		if (_pendingSaves.empty())
+			return false;
+		save = _pendingSaves.front();
+		_writingSave = true;
+	}
+
+	// Write to a hidden file next to the savefile, which the savefile
+	// patterns of the engines don't match
+	Common::FSNode file(save.path);
+	Common::FSNode tempFile = file.getParent().getChild("." + save.name + ".tmp");
+
+	bool success = false;
+	Common::WriteStream *out = Common::wrapCompressedWriteStream(tempFile.createWriteStream());
+	if (out) {
+		out->write(save.data, save.size);
+		out->finalize();
+		success = !out->err();
+		delete out;
+	}
+
+	if (success) {
+#if defined(WIN32)
+		// rename() doesn't replace existing files on Windows
+		remove(file.getPath().c_str());
+#endif
+		success = (rename(tempFile.getPath().c_str(), file.getPath().c_str()) == 0);
+	}
+
+	if (!success) {
+		warning("Writing the savefile '%s' in the background failed", save.name.c_str());
+		remove(tempFile.getPath().c_str());
+	}
+
+	{
+		Common::StackLock lock(_pendingMutex);
+		free(_pendingSaves.front().data);
+		_pendingSaves.pop_front();
+		_writingSave = false;
+	}
+
+	return true;
+}
+
+bool DefaultSaveFileManager::isSaving(const Common::String &filename) {
+	if (!_pendingMutex)
+		return false;
+
+	Common::StackLock lock(_pendingMutex);
+	for (PendingSaveList::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+		if (i->name == filename)
+			return true;
+	}
+	return false;
+}
+
+void DefaultSaveFileManager::waitForSave(const Common::String &filename) {
+	while (isSaving(filename))
+		g_system->delayMillis(1);
+}
+
+void DefaultSaveFileManager::waitForSaves() {
+	if (!_pendingMutex)
+		return;
+
+	while (true) {
+		{
+			Common::StackLock lock(_pendingMutex);
+			if (_pendingSaves.empty())
+				return;
+		}
+		g_system->delayMillis(1);
+	}
+}
+
 bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
+	waitForSave(filename);
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError() != Common::kNoError)
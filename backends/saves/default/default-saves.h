@@ -30,21 +30,86 @@
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
+#include "common/list.h"
+#include "common/system.h"
 
 /**
  * Provides a default savefile manager implementation for common platforms.
+ *
+ * Savefiles opened with openForSavingInBackground are only written in the
+ * background if the backend sets a BackgroundWriter. Otherwise they are
+ * written like any other savefile.
  */
 class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
+	/**
+	 * Thread which writes the savefiles queued by openForSavingInBackground.
+	 * It is implemented by the backend, and calls writePendingSave() until
+	 * it returns false whenever it is woken up.
+	 */
+	class BackgroundWriter {
+	public:
+		virtual ~BackgroundWriter() {}
+
+		/** Called when a savefile has been queued for writing. */
+		virtual void wakeUp() = 0;
+	};
+
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::String &defaultSavepath);
+	virtual ~DefaultSaveFileManager();
 
 	virtual Common::StringArray listSavefiles(const Common::String &pattern);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename);
+	virtual Common::OutSaveFile *openForSavingInBackground(const Common::String &filename);
 	virtual bool removeSavefile(const Common::String &filename);
+	virtual bool isSaving(const Common::String &filename);
+	virtual void waitForSaves();
+
+	/**
+	 * Enables writing savefiles in the background. The savefile manager
+	 * takes ownership of the writer.
+	 */
+	void setBackgroundWriter(BackgroundWriter *writer);
+
+	/**
+	 * Writes the oldest savefile queued by openForSavingInBackground.
+	 * This is called by the BackgroundWriter thread.
+	 *
+	 * The data is written to a temporary file first, which is then renamed,
+	 * so that an interrupted write doesn't destroy an older savefile.
+	 *
+	 * @return false if no savefile was queued.
+	 */
+	bool writePendingSave();
 
 protected:
+	friend class BackgroundSaveFile;
+
+	/** A savefile which was finalized, but hasn't been written yet. */
+	struct PendingSave {
+		Common::String name;
+		Common::String path; ///< Full path of the file, resolved when it was opened
+		byte *data;          ///< Uncompressed data, allocated with malloc()
+		uint32 size;
+	};
+	typedef Common::List<PendingSave> PendingSaveList;
+
+	BackgroundWriter *_backgroundWriter;
+	/** Guards _pendingSaves and _writingSave */
+	OSystem::MutexRef _pendingMutex;
+	/** Pending savefiles, oldest first */
+	PendingSaveList _pendingSaves;
+	/** Whether the first pending savefile is being written right now */
+	bool _writingSave;
+
+	/** Queues the data of a finalized savefile for writing. */
+	void queueSave(const Common::String &name, const Common::String &path, byte *data, uint32 size);
+
+	/** Waits until a savefile opened with openForSavingInBackground has been written. */
+	void waitForSave(const Common::String &filename);
+
 	/**
 	 * Get the path to the savegame directory.
 	 * Should only be used internally since some platforms
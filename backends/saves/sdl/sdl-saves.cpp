@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+
+#include "backends/saves/sdl/sdl-saves.h"
+
+SdlSaveWriter::SdlSaveWriter(DefaultSaveFileManager *manager) :
+	_manager(manager), _writerThread(0), _wakeUpMutex(0), _wakeUpCond(0),
+	_threadShouldQuit(false), _wakeUpPending(false) {
+
+	_wakeUpMutex = SDL_CreateMutex();
+	_wakeUpCond = SDL_CreateCond();
+
+	// Creates the writer thread
+	_writerThread = SDL_CreateThread(writerThreadEntry, this);
+	if (!_writerThread)
+		error("Could not create the savefile writer thread: %s", SDL_GetError());
+}
+
+SdlSaveWriter::~SdlSaveWriter() {
+	// Signal the writer thread to end, and wait for it to actually finish.
+	// The manager writes whatever is still pending itself.
+	SDL_LockMutex(_wakeUpMutex);
+	_threadShouldQuit = true;
+	SDL_CondSignal(_wakeUpCond);
+	SDL_UnlockMutex(_wakeUpMutex);
+	SDL_WaitThread(_writerThread, NULL);
+
+	SDL_DestroyCond(_wakeUpCond);
+	SDL_DestroyMutex(_wakeUpMutex);
+}
+
+void SdlSaveWriter::wakeUp() {
+	SDL_LockMutex(_wakeUpMutex);
+	_wakeUpPending = true;
+	SDL_CondSignal(_wakeUpCond);
+	SDL_UnlockMutex(_wakeUpMutex);
+}
+
+void SdlSaveWriter::writerThread() {
+	SDL_LockMutex(_wakeUpMutex);
+	while (!_threadShouldQuit) {
+		// Write without holding the lock, so that savefiles can be queued
+		// in the meantime
+		_wakeUpPending = false;
+		SDL_UnlockMutex(_wakeUpMutex);
+
+		while (_manager->writePendingSave())
+			;
+
+		SDL_LockMutex(_wakeUpMutex);
+		if (!_threadShouldQuit && !_wakeUpPending)
+			SDL_CondWait(_wakeUpCond, _wakeUpMutex);
+	}
+	SDL_UnlockMutex(_wakeUpMutex);
+}
+
+int SDLCALL SdlSaveWriter::writerThreadEntry(void *arg) {
+	SdlSaveWriter *writer = (SdlSaveWriter *)arg;
+	assert(writer);
+	writer->writerThread();
+	return 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#if !defined(BACKEND_SDL_SAVES_H) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+#define BACKEND_SDL_SAVES_H
+
+#include "backends/saves/default/default-saves.h"
+
+#include "backends/platform/sdl/sdl-sys.h"
+
+/**
+ * Writes the savefiles of a DefaultSaveFileManager, which were opened with
+ * openForSavingInBackground, in its own thread.
+ */
+class SdlSaveWriter : public DefaultSaveFileManager::BackgroundWriter {
+public:
+	SdlSaveWriter(DefaultSaveFileManager *manager);
+	virtual ~SdlSaveWriter();
+
+	virtual void wakeUp();
+
+protected:
+	DefaultSaveFileManager *_manager;
+
+	SDL_Thread *_writerThread;
+	/** Guards _threadShouldQuit and _wakeUpPending */
+	SDL_mutex *_wakeUpMutex;
+	SDL_cond *_wakeUpCond;
+	bool _threadShouldQuit;
+	/** Set when a savefile was queued while the thread was writing */
+	bool _wakeUpPending;
+
+	/**
+	 * Writes the pending savefiles whenever it is woken up
+	 */
+	void writerThread();
+
+	/**
+	 * Entry point for the writer thread
+	 */
+	static int SDLCALL writerThreadEntry(void *arg);
+};
+
+#endif
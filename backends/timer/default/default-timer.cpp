@@ -25,90 +25,104 @@
 #include "common/scummsys.h"
 #include "backends/timer/default/default-timer.h"
 #include "common/util.h"
+#include "common/debug.h"
 #include "common/system.h"
 
+enum {
+	// A timer which fell behind by more than this (e.g. because the process
+	// was suspended) is rescheduled from the current time, instead of firing
+	// all the missed calls at once. In microseconds.
+	kMaxCatchUp = 1000000
+};
 
 struct TimerSlot {
 	Common::TimerManager::TimerProc callback;
 	void *refCon;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// mircoseconds part of nextFire
+	uint32 nextFireTime;	// in microseconds, wraps around
+	uint32 sequence;	// order of insertion, for timers due at the same time
 
-	TimerSlot *next;
+	// Statistics
+	uint32 calls;
+	uint32 resyncs;	// times the timer was rescheduled from the current time
+	uint32 totalLateness;	// in milliseconds
+	uint32 maxLateness;	// in microseconds
+	uint32 totalRunTime;	// in milliseconds
+	uint32 maxRunTime;	// in milliseconds
 };
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
-
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = 0;
+static uint32 getMicros() {
+	// Only the millisecond clock is available, but keeping the fire times
+	// in microseconds makes intervals which are no multiples of a
+	// millisecond accurate on average.
+	return g_system->getMillis() * 1000;
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == 0 || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
-	}
+static bool firesBefore(const TimerSlot *a, const TimerSlot *b) {
+	const int32 diff = (int32)(a->nextFireTime - b->nextFireTime);
+	if (diff)
+		return diff < 0;
+	return (int32)(a->sequence - b->sequence) < 0;
 }
 
 
 DefaultTimerManager::DefaultTimerManager() :
 	_timerHandler(0),
-	_head(0) {
-
-	_head = new TimerSlot();
-	memset(_head, 0, sizeof(TimerSlot));
+	_nextSequence(0),
+	_currentSlot(0) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	for (uint i = 0; i < _queue.size(); ++i) {
+		printStatistics(_queue[i]);
+		delete _queue[i];
 	}
-	_head = 0;
+	_queue.clear();
 }
 
 void DefaultTimerManager::handler() {
 	Common::StackLock lock(_mutex);
 
-	const uint32 curTime = g_system->getMillis();
+	const uint32 curTime = getMicros();
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
+	while (!_queue.empty() && (int32)(_queue[0]->nextFireTime - curTime) <= 0) {
+		TimerSlot *slot = _queue[0];
 
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
+		const uint32 lateness = curTime - slot->nextFireTime;
+		slot->calls++;
+		slot->totalLateness += (lateness + 500) / 1000;
+		slot->maxLateness = MAX(slot->maxLateness, lateness);
+
+		// Update the fire time and move the TimerSlot to its new place in
+		// the priority queue. Counting from the time the timer was due
+		// rather than from the current time keeps it from drifting.
 		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
+		if (lateness > kMaxCatchUp) {
+			slot->nextFireTime = curTime + slot->interval;
+			slot->resyncs++;
+		} else {
+			slot->nextFireTime += slot->interval;
 		}
-		insertPrioQueue(_head, slot);
+		slot->sequence = _nextSequence++;
+		siftDown(0);
 
 		// Invoke the timer callback
 		assert(slot->callback);
+		_currentSlot = slot;
+		const uint32 startTime = g_system->getMillis();
 		slot->callback(slot->refCon);
 
-		// Look at the next scheduled timer
-		slot = _head->next;
+		// The callback may have removed its own timer
+		if (_currentSlot) {
+			const uint32 runTime = g_system->getMillis() - startTime;
+			slot->totalRunTime += runTime;
+			slot->maxRunTime = MAX(slot->maxRunTime, runTime);
+		}
+		_currentSlot = 0;
 	}
 }
 
@@ -117,36 +131,103 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	Common::StackLock lock(_mutex);
 
 	TimerSlot *slot = new TimerSlot;
+	memset(slot, 0, sizeof(TimerSlot));
 	slot->callback = callback;
 	slot->refCon = refCon;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = 0;
-
-	// FIXME: It seems we do allow the client to add one callback multiple times over here,
-	// but "removeTimerProc" will remove *all* added instances. We should either prevent
-	// multiple additions of a timer proc OR we should change removeTimerProc to only remove
-	// a specific timer proc entry.
-	// Probably we can safely just allow a single addition of a specific function once
-	// and just update our Timer documentation accordingly.
-	insertPrioQueue(_head, slot);
+	slot->nextFireTime = getMicros() + interval;
+
+	// One callback may be added multiple times. "removeTimerProc(proc)" removes
+	// *all* added instances, "removeTimerProc(proc, refCon)" only those with
+	// the given refCon.
+	schedule(slot);
 
 	return true;
 }
 
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
-	Common::StackLock lock(_mutex);
+	removeSlots(callback, 0, false);
+}
 
-	TimerSlot *slot = _head;
+void DefaultTimerManager::removeTimerProc(TimerProc callback, void *refCon) {
+	removeSlots(callback, refCon, true);
+}
 
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
+void DefaultTimerManager::removeSlots(TimerProc callback, void *refCon, bool matchRefCon) {
+	Common::StackLock lock(_mutex);
+
+	uint kept = 0;
+	for (uint i = 0; i < _queue.size(); ++i) {
+		TimerSlot *slot = _queue[i];
+		if (slot->callback == callback && (!matchRefCon || slot->refCon == refCon)) {
+			if (slot == _currentSlot)
+				_currentSlot = 0;
+			printStatistics(slot);
+			delete slot;
 		} else {
-			slot = slot->next;
+			_queue[kept++] = slot;
 		}
 	}
+
+	if (kept == _queue.size())
+		return;
+
+	_queue.resize(kept);
+	for (uint i = kept / 2; i-- > 0; )
+		siftDown(i);
+}
+
+int32 DefaultTimerManager::getTimeUntilNextFire() {
+	Common::StackLock lock(_mutex);
+
+	if (_queue.empty())
+		return -1;
+
+	const int32 delay = (int32)(_queue[0]->nextFireTime - getMicros());
+	return MAX<int32>(delay, 0);
+}
+
+void DefaultTimerManager::schedule(TimerSlot *slot) {
+	slot->sequence = _nextSequence++;
+	_queue.push_back(slot);
+	siftUp(_queue.size() - 1);
+}
+
+void DefaultTimerManager::siftUp(uint index) {
+	TimerSlot *slot = _queue[index];
+	while (index > 0) {
+		const uint parent = (index - 1) / 2;
+		if (!firesBefore(slot, _queue[parent]))
+			break;
+		_queue[index] = _queue[parent];
+		index = parent;
+	}
+	_queue[index] = slot;
+}
+
+void DefaultTimerManager::siftDown(uint index) {
+	TimerSlot *slot = _queue[index];
+	const uint size = _queue.size();
+	while (true) {
+		uint child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && firesBefore(_queue[child + 1], _queue[child]))
+			child++;
+		if (!firesBefore(_queue[child], slot))
+			break;
+		_queue[index] = _queue[child];
+		index = child;
+	}
+	_queue[index] = slot;
+}
+
+void DefaultTimerManager::printStatistics(const TimerSlot *slot) const {
+	if (!slot->calls)
+		return;
+
+	debug(2, "Timer (refCon %p, every %d us): %d calls, %d resyncs, lateness %d us average, %d us max, run time %d ms total, %d ms max",
+		slot->refCon, slot->interval, slot->calls, slot->resyncs,
+		slot->totalLateness / slot->calls * 1000 + slot->totalLateness % slot->calls * 1000 / slot->calls, slot->maxLateness,
+		slot->totalRunTime, slot->maxRunTime);
 }
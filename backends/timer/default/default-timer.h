@@ -26,6 +26,7 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/timer.h"
+#include "common/array.h"
 #include "common/mutex.h"
 
 class OSystem;
@@ -36,18 +37,40 @@ class DefaultTimerManager : public Common::TimerManager {
 private:
 	Common::Mutex _mutex;
 	void *_timerHandler;
-	TimerSlot *_head;
+	/** Binary min-heap of the installed timers, ordered by their next fire time */
+	Common::Array<TimerSlot *> _queue;
+	/** Counts insertions, so that timers due at the same time fire in FIFO order */
+	uint32 _nextSequence;
+	/** The slot whose callback is running, reset if the callback removes it */
+	TimerSlot *_currentSlot;
+
+	void schedule(TimerSlot *slot);
+	void siftUp(uint index);
+	void siftDown(uint index);
+	void printStatistics(const TimerSlot *slot) const;
+	void removeSlots(TimerProc proc, void *refCon, bool matchRefCon);
 
 public:
 	DefaultTimerManager();
 	~DefaultTimerManager();
 	bool installTimerProc(TimerProc proc, int32 interval, void *refCon);
 	void removeTimerProc(TimerProc proc);
+	void removeTimerProc(TimerProc proc, void *refCon);
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
 	 */
 	void handler();
+
+protected:
+	/**
+	 * Returns the time until the next timer is due, so that backends running
+	 * handler() in their own thread can sleep exactly that long.
+	 *
+	 * @return the time in microseconds, 0 if a timer is due already, or -1 if
+	 *         no timer is installed
+	 */
+	int32 getTimeUntilNextFire();
 };
 
 #endif
@@ -30,24 +30,82 @@
 
 #include "backends/timer/sdl/sdl-timer.h"
 
-static Uint32 timer_handler(Uint32 interval, void *param) {
-	((DefaultTimerManager *)param)->handler();
-	return interval;
-}
+enum {
+	// How long the timer thread sleeps when no timer is installed, in
+	// milliseconds. Installing a timer wakes it up earlier.
+	kIdleWait = 100
+};
+
+SdlTimerManager::SdlTimerManager() :
+	_timerThread(0), _wakeUpMutex(0), _wakeUpCond(0),
+	_threadShouldQuit(false), _wakeUpPending(false) {
 
-SdlTimerManager::SdlTimerManager() {
 	// Initializes the SDL timer subsystem
 	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
 		error("Could not initialize SDL: %s", SDL_GetError());
 	}
 
-	// Creates the timer callback
-	_timerID = SDL_AddTimer(10, &timer_handler, this);
+	_wakeUpMutex = SDL_CreateMutex();
+	_wakeUpCond = SDL_CreateCond();
+
+	// Creates the timer thread
+	_timerThread = SDL_CreateThread(timerThreadEntry, this);
+	if (!_timerThread)
+		error("Could not create the timer thread: %s", SDL_GetError());
 }
 
 SdlTimerManager::~SdlTimerManager() {
-	// Removes the timer callback
-	SDL_RemoveTimer(_timerID);
+	// Signal the timer thread to end, and wait for it to actually finish
+	SDL_LockMutex(_wakeUpMutex);
+	_threadShouldQuit = true;
+	SDL_CondSignal(_wakeUpCond);
+	SDL_UnlockMutex(_wakeUpMutex);
+	SDL_WaitThread(_timerThread, NULL);
+
+	SDL_DestroyCond(_wakeUpCond);
+	SDL_DestroyMutex(_wakeUpMutex);
+}
+
+bool SdlTimerManager::installTimerProc(TimerProc proc, int32 interval, void *refCon) {
+	if (!DefaultTimerManager::installTimerProc(proc, interval, refCon))
+		return false;
+
+	// The new timer may be due before the timer thread wakes up
+	SDL_LockMutex(_wakeUpMutex);
+	_wakeUpPending = true;
+	SDL_CondSignal(_wakeUpCond);
+	SDL_UnlockMutex(_wakeUpMutex);
+
+	return true;
+}
+
+void SdlTimerManager::timerThread() {
+	SDL_LockMutex(_wakeUpMutex);
+	while (!_threadShouldQuit) {
+		// Run the timers without holding the lock, since they may install
+		// further timers
+		_wakeUpPending = false;
+		SDL_UnlockMutex(_wakeUpMutex);
+
+		handler();
+
+		// Sleep until the next timer is due, rounding up since handler()
+		// only fires the timers due at the current millisecond
+		const int32 delay = getTimeUntilNextFire();
+		const Uint32 wait = (delay < 0) ? (Uint32)kIdleWait : (Uint32)(delay + 999) / 1000;
+
+		SDL_LockMutex(_wakeUpMutex);
+		if (wait && !_threadShouldQuit && !_wakeUpPending)
+			SDL_CondWaitTimeout(_wakeUpCond, _wakeUpMutex, wait);
+	}
+	SDL_UnlockMutex(_wakeUpMutex);
+}
+
+int SDLCALL SdlTimerManager::timerThreadEntry(void *arg) {
+	SdlTimerManager *timerManager = (SdlTimerManager *)arg;
+	assert(timerManager);
+	timerManager->timerThread();
+	return 0;
 }
 
 #endif
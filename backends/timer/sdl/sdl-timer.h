@@ -31,16 +31,35 @@
 #include "backends/platform/sdl/sdl-sys.h"
 
 /**
- * SDL timer manager. Setups the timer callback for
- * DefaultTimerManager.
+ * SDL timer manager. Runs the DefaultTimerManager handler in its own
+ * thread, which sleeps until the next timer is due instead of polling
+ * at the 10ms resolution of SDL timers.
  */
 class SdlTimerManager : public DefaultTimerManager {
 public:
 	SdlTimerManager();
 	virtual ~SdlTimerManager();
 
+	bool installTimerProc(TimerProc proc, int32 interval, void *refCon);
+
 protected:
-	SDL_TimerID _timerID;
+	SDL_Thread *_timerThread;
+	/** Guards _threadShouldQuit and _wakeUpPending */
+	SDL_mutex *_wakeUpMutex;
+	SDL_cond *_wakeUpCond;
+	bool _threadShouldQuit;
+	/** Set when a timer was installed, which may be due before the current wait ends */
+	bool _wakeUpPending;
+
+	/**
+	 * Calls the timer handler whenever a timer is due
+	 */
+	void timerThread();
+
+	/**
+	 * Entry point for the timer thread
+	 */
+	static int SDLCALL timerThreadEntry(void *arg);
 };
 
 
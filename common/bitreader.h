@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef COMMON_BITREADER_H
+#define COMMON_BITREADER_H
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+
+namespace Common {
+
+/**
+ * Reads a stream of bits from a buffer in memory.
+ *
+ * Decompressors should read their packed data into memory and decode it
+ * with this class, instead of pulling every byte through
+ * ReadStream::readByte().
+ *
+ * The reader keeps up to 32 bits in a cache. While at least four bytes of
+ * the buffer are left, the cache is refilled with a single 32-bit read,
+ * which tops it up to more than 24 bits. Near the end of the buffer it is
+ * refilled byte by byte, and reading past the end returns zero bits.
+ *
+ * @tparam MSB If true, the bits of each byte are read starting with the
+ *             most significant bit, and values of several bits have the
+ *             first bit read as their most significant bit. If false, both
+ *             start with the least significant bit.
+ */
+template<bool MSB>
+class BitReader {
+public:
+	enum {
+		kMSBFirst = MSB,
+
+		/** The maximum number of bits that can be read or peeked at once. */
+		kMaxBits = 24
+	};
+
+	BitReader() {
+		reset(0, 0);
+	}
+
+	BitReader(const byte *data, uint32 size) {
+		reset(data, size);
+	}
+
+	/** Starts reading from the beginning of a new buffer. */
+	void reset(const byte *data, uint32 size) {
+		_data = data;
+		_size = size;
+		_pos = 0;
+		_cache = 0;
+		_cacheBits = 0;
+	}
+
+	/**
+	 * Returns the next bits of the stream, without consuming them.
+	 * @param n	number of bits, at most kMaxBits
+	 */
+	uint32 peekBits(uint n) {
+		if (_cacheBits < n)
+			refill();
+		if (MSB)
+			return (_cache >> 1) >> (31 - n);
+		else
+			return _cache & ((1 << n) - 1);
+	}
+
+	/**
+	 * Consumes bits of the stream.
+	 * @param n	number of bits, at most kMaxBits
+	 */
+	void skipBits(uint n) {
+		if (_cacheBits < n)
+			refill();
+		if (MSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+		_cacheBits -= n;
+	}
+
+	/**
+	 * Reads bits from the stream.
+	 * @param n	number of bits, at most kMaxBits
+	 */
+	uint32 getBits(uint n) {
+		uint32 value = peekBits(n);
+		if (MSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+		_cacheBits -= n;
+		return value;
+	}
+
+	uint32 getBit() {
+		return getBits(1);
+	}
+
+	byte getByte() {
+		return getBits(8);
+	}
+
+	/** Skips the rest of the current byte. */
+	void alignToByte() {
+		skipBits(_cacheBits & 7);
+	}
+
+	/** Returns the number of bits read so far. */
+	uint32 pos() const {
+		return _pos * 8 - _cacheBits;
+	}
+
+	/**
+	 * Returns the number of bytes moved into the cache so far. This can be
+	 * up to four bytes more than have actually been read.
+	 */
+	uint32 bytesFetched() const {
+		return _pos;
+	}
+
+	uint32 size() const {
+		return _size;
+	}
+
+	/** Returns true if more bits than the buffer holds have been read. */
+	bool eos() const {
+		return pos() > _size * 8;
+	}
+
+private:
+	void refill() {
+		if (_pos + 4 <= _size) {
+			// The bits beyond the ones counted in _cacheBits are filled
+			// in as well. They are exactly the bits the next refill puts
+			// there again.
+			if (MSB)
+				_cache |= READ_BE_UINT32(_data + _pos) >> _cacheBits;
+			else
+				_cache |= READ_LE_UINT32(_data + _pos) << _cacheBits;
+			const uint bytes = (32 - _cacheBits) >> 3;
+			_pos += bytes;
+			_cacheBits += bytes * 8;
+		} else {
+			while (_cacheBits <= 24) {
+				uint32 b = (_pos < _size) ? _data[_pos] : 0;
+				if (MSB)
+					_cache |= b << (24 - _cacheBits);
+				else
+					_cache |= b << _cacheBits;
+				_pos++;
+				_cacheBits += 8;
+			}
+		}
+	}
+
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;       ///< Offset of the next byte to move into the cache
+	uint32 _cache;
+	uint _cacheBits;   ///< Number of unread bits in _cache, up to 32
+};
+
+typedef BitReader<true> BitReaderMSB;
+typedef BitReader<false> BitReaderLSB;
+
+} // End of namespace Common
+
+#endif
@@ -23,11 +23,11 @@
  *
  */
 
+#include "common/bitreader.h"
 #include "common/dcl.h"
-#include "common/debug.h"
-#include "common/debug-channels.h"
-#include "common/endian.h"
+#include "common/huffman.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
 #include "common/stream.h"
 #include "common/util.h"
 
@@ -35,90 +35,29 @@ namespace Common {
 
 class DecompressorDCL {
 public:
-	bool unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	bool unpack(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
-	/**
-	 * Initialize decompressor.
-	 * @param src		source stream to read from
-	 * @param dest		destination stream to write to
-	 * @param nPacked	size of packed data
-	 * @param nUnpacket	size of unpacked data
-	 * @return 0 on success, non-zero on error
-	 */
-	void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	enum {
+		kLengthTree,
+		kDistanceTree,
+		kAsciiTree,
+		kTreeCount
+	};
 
-	/**
-	 * Get a number of bits from _src stream, starting with the least
-	 * significant unread bit of the current four byte block.
-	 * @param n		number of bits to get
-	 * @return n-bits number
-	 */
-	uint32 getBitsLSB(int n);
+	/** Builds the lookup table of one of the Huffman trees below. */
+	static Huffman *createHuffman(const int *tree, uint tableBits);
 
 	/**
-	 * Get one byte from _src stream.
-	 * @return byte
+	 * Returns the lookup table of one of the Huffman trees below. The trees
+	 * are constant, so each table is only built once and then shared by all
+	 * decompressions.
 	 */
-	byte getByteLSB();
-
-	void fetchBitsLSB();
+	static const Huffman &getHuffman(int tree);
 
-	/**
-	 * Write one byte into _dest stream
-	 * @param b byte to put
-	 */
-	void putByte(byte b);
-
-	int huffman_lookup(const int *tree);
-
-	uint32 _dwBits;		///< bits buffer
-	byte _nBits;		///< number of unread bits in _dwBits
-	uint32 _szPacked;	///< size of the compressed data
-	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
-	uint32 _dwWrote;	///< number of bytes written to _dest
-	Common::ReadStream *_src;
-	byte *_dest;
+	BitReaderLSB _bits;
 };
 
-void DecompressorDCL::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
-                        uint32 nUnpacked) {
-	_src = src;
-	_dest = dest;
-	_szPacked = nPacked;
-	_szUnpacked = nUnpacked;
-	_nBits = 0;
-	_dwRead = _dwWrote = 0;
-	_dwBits = 0;
-}
-
-void DecompressorDCL::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
-		_nBits += 8;
-		_dwRead++;
-	}
-}
-
-uint32 DecompressorDCL::getBitsLSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~((~0) << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte DecompressorDCL::getByteLSB() {
-	return getBitsLSB(8);
-}
-
-void DecompressorDCL::putByte(byte b) {
-	_dest[_dwWrote++] = b;
-}
-
 #define HUFFMAN_LEAF 0x40000000
 // Branch node
 #define BN(pos, left, right)  ((left << 12) | (right)),
@@ -322,96 +261,119 @@ static const int ascii_tree[] = {
 	LN(509, 128)      LN(510, 26)
 };
 
-int DecompressorDCL::huffman_lookup(const int *tree) {
-	int pos = 0;
+struct DCLCodes {
+	uint32 count;
+	uint32 codes[256];
+	uint8 lengths[256];
+	uint32 symbols[256];
+};
 
-	while (!(tree[pos] & HUFFMAN_LEAF)) {
-		int bit = getBitsLSB(1);
-		debug(8, "[%d]:%d->", pos, bit);
-		pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
+static void getCodes(const int *tree, int pos, uint32 code, uint8 length, DCLCodes &codes) {
+	if (tree[pos] & HUFFMAN_LEAF) {
+		codes.codes[codes.count] = code;
+		codes.lengths[codes.count] = length;
+		codes.symbols[codes.count] = tree[pos] & 0xFFFF;
+		codes.count++;
+	} else {
+		getCodes(tree, tree[pos] >> 12, code << 1, length + 1, codes);
+		getCodes(tree, tree[pos] & 0xFFF, (code << 1) | 1, length + 1, codes);
 	}
+}
 
-	debug(8, "=%02x\n", tree[pos] & 0xffff);
-	return tree[pos] & 0xFFFF;
+Huffman *DecompressorDCL::createHuffman(const int *tree, uint tableBits) {
+	DCLCodes codes;
+	codes.count = 0;
+	getCodes(tree, 0, 0, 0, codes);
+
+	return new Huffman(tableBits, codes.count, codes.codes, codes.lengths, codes.symbols, false);
+}
+
+const Huffman &DecompressorDCL::getHuffman(int tree) {
+	static const int *const trees[kTreeCount] = { length_tree, distance_tree, ascii_tree };
+	static ScopedPtr<Huffman> tables[kTreeCount];
+
+	if (!tables[tree])
+		tables[tree].reset(createHuffman(trees[tree], 8));
+	return *tables[tree];
 }
 
 #define DCL_BINARY_MODE 0
 #define DCL_ASCII_MODE 1
 
-bool DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
-	init(src, dest, nPacked, nUnpacked);
+bool DecompressorDCL::unpack(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+	_bits.reset(src, nPacked);
 
-	int value;
+	uint32 value;
 	uint32 val_distance, val_length;
+	uint32 dwWrote = 0;
 
-	int mode = getByteLSB();
-	int length_param = getByteLSB();
+	int mode = _bits.getByte();
+	int length_param = _bits.getByte();
 
 	if (mode != DCL_BINARY_MODE && mode != DCL_ASCII_MODE) {
 		warning("DCL-INFLATE: Error: Encountered mode %02x, expected 00 or 01", mode);
 		return false;
 	}
 
-	if (length_param < 3 || length_param > 6)
+	if (length_param < 3 || length_param > 6) {
 		warning("Unexpected length_param value %d (expected in [3,6])", length_param);
+		if (length_param > BitReaderLSB::kMaxBits)
+			return false;
+	}
 
-	while (_dwWrote < _szUnpacked) {
-		if (getBitsLSB(1)) { // (length,distance) pair
-			value = huffman_lookup(length_tree);
+	const Huffman &lengthCodes = getHuffman(kLengthTree);
+	const Huffman &distanceCodes = getHuffman(kDistanceTree);
+	const Huffman *asciiCodes = (mode == DCL_ASCII_MODE) ? &getHuffman(kAsciiTree) : 0;
+
+	while (dwWrote < nUnpacked) {
+		if (_bits.getBit()) { // (length,distance) pair
+			value = lengthCodes.getSymbol(_bits);
 
 			if (value < 8)
 				val_length = value + 2;
 			else
-				val_length = 8 + (1 << (value - 7)) + getBitsLSB(value - 7);
-
-			debug(8, " | ");
+				val_length = 8 + (1 << (value - 7)) + _bits.getBits(value - 7);
 
-			value = huffman_lookup(distance_tree);
+			value = distanceCodes.getSymbol(_bits);
 
 			if (val_length == 2)
-				val_distance = (value << 2) | getBitsLSB(2);
+				val_distance = (value << 2) | _bits.getBits(2);
 			else
-				val_distance = (value << length_param) | getBitsLSB(length_param);
+				val_distance = (value << length_param) | _bits.getBits(length_param);
 			val_distance ++;
 
-			debug(8, "\nCOPY(%d from %d)\n", val_length, val_distance);
-
-			if (val_length + _dwWrote > _szUnpacked) {
+			if (val_length + dwWrote > nUnpacked) {
 				warning("DCL-INFLATE Error: Write out of bounds while copying %d bytes", val_length);
 				return false;
 			}
 
-			if (_dwWrote < val_distance) {
+			if (dwWrote < val_distance) {
 				warning("DCL-INFLATE Error: Attempt to copy from before beginning of input stream");
 				return false;
 			}
 
-			while (val_length) {
-				uint32 copy_length = (val_length > val_distance) ? val_distance : val_length;
-				assert(val_distance >= copy_length);
-				uint32 pos = _dwWrote - val_distance;
-				for (uint32 i = 0; i < copy_length; i++)
-					putByte(dest[pos + i]);
-
-				for (uint32 i = 0; i < copy_length; i++)
-					debug(9, "\33[32;31m%02x\33[37;37m ", dest[pos + i]);
-				debug(9, "\n");
-
-				val_length -= copy_length;
-				val_distance += copy_length;
+			byte *copyDest = dest + dwWrote;
+			const byte *copySrc = copyDest - val_distance;
+			if (val_distance >= val_length) {
+				memcpy(copyDest, copySrc, val_length);
+			} else {
+				// The copy overlaps its source, which repeats the last
+				// val_distance bytes.
+				for (uint32 i = 0; i < val_length; i++)
+					copyDest[i] = copySrc[i];
 			}
+			dwWrote += val_length;
 
 		} else { // Copy byte verbatim
-			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree) : getByteLSB();
-			putByte(value);
-			debug(9, "\33[32;31m%02x \33[37;37m", value);
+			value = (mode == DCL_ASCII_MODE) ? asciiCodes->getSymbol(_bits) : _bits.getByte();
+			dest[dwWrote++] = value;
 		}
 	}
 
-	return _dwWrote == _szUnpacked;
+	return dwWrote == nUnpacked;
 }
 
-bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpackedSize) {
+bool decompressDCL(const byte *src, byte *dest, uint32 packedSize, uint32 unpackedSize) {
 	if (!src || !dest)
 		return false;
 
@@ -419,6 +381,22 @@ bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpack
 	return dcl.unpack(src, dest, packedSize, unpackedSize);
 }
 
+bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpackedSize) {
+	if (!src || !dest)
+		return false;
+
+	byte *packed = (byte *)malloc(packedSize);
+	if (!packed)
+		return false;
+
+	// Reading past the end of the stream returns zero bits, like before
+	uint32 size = src->read(packed, packedSize);
+	bool success = decompressDCL(packed, dest, size, unpackedSize);
+
+	free(packed);
+	return success;
+}
+
 SeekableReadStream *decompressDCL(ReadStream *src, uint32 packedSize, uint32 unpackedSize) {
 	byte *data = (byte *)malloc(unpackedSize);
 
@@ -40,6 +40,12 @@ namespace Common {
 class ReadStream;
 class SeekableReadStream;
 
+/**
+ * Try to decompress PKWARE DCL compressed data in memory. Returns true if
+ * successful.
+ */
+bool decompressDCL(const byte *src, byte *dest, uint32 packedSize, uint32 unpackedSize);
+
 /**
  * Try to decompress a PKWARE DCL compressed stream. Returns true if
  * successful.
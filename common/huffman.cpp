@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/huffman.h"
+#include "common/util.h"
+
+namespace Common {
+
+static uint32 reverseBits(uint32 value, uint bits) {
+	uint32 result = 0;
+	for (uint i = 0; i < bits; i++, value >>= 1)
+		result = (result << 1) | (value & 1);
+	return result;
+}
+
+Huffman::Huffman(uint tableBits, uint32 count, const uint32 *codes, const uint8 *lengths, const uint32 *symbols, bool msbFirst)
+	: _msbFirst(msbFirst) {
+
+	uint maxLength = 0;
+	for (uint32 i = 0; i < count; i++)
+		maxLength = MAX<uint>(maxLength, lengths[i]);
+
+	assert(maxLength <= BitReaderMSB::kMaxBits);
+	_tableBits = MIN(tableBits, maxLength);
+
+	// Find out how many more bits the longest code with each prefix needs
+	Array<uint8> subBits;
+	subBits.resize(1 << _tableBits);
+	for (uint32 i = 0; i < count; i++) {
+		if (lengths[i] > _tableBits) {
+			uint32 prefix = codes[i] >> (lengths[i] - _tableBits);
+			subBits[prefix] = MAX<uint8>(subBits[prefix], lengths[i] - _tableBits);
+		}
+	}
+
+	// Place the second level tables behind the first level one
+	uint32 size = 1 << _tableBits;
+	_table.resize(size);
+	for (uint32 prefix = 0; prefix < subBits.size(); prefix++) {
+		if (subBits[prefix]) {
+			Entry entry = { size, 0, subBits[prefix] };
+			fill(0, _tableBits, prefix, _tableBits, entry);
+			size += 1 << subBits[prefix];
+		}
+	}
+	_table.resize(size);
+
+	for (uint32 i = 0; i < count; i++) {
+		uint length = lengths[i];
+		if (length == 0)
+			continue;
+
+		Entry entry = { symbols ? symbols[i] : i, (uint8)length, 0 };
+
+		if (length <= _tableBits) {
+			fill(0, _tableBits, codes[i], length, entry);
+		} else {
+			uint32 prefix = codes[i] >> (length - _tableBits);
+			const Entry &sub = _table[msbFirst ? prefix : reverseBits(prefix, _tableBits)];
+			if (sub.subBits == 0)
+				continue; // A shorter code is a prefix of this one
+
+			length -= _tableBits;
+			fill(sub.symbol, sub.subBits, codes[i] & ((1 << length) - 1), length, entry);
+		}
+	}
+}
+
+void Huffman::fill(uint32 offset, uint bits, uint32 code, uint length, const Entry &entry) {
+	// Store the entry at all indices starting with the code
+	const uint32 count = 1 << (bits - length);
+
+	if (_msbFirst) {
+		const uint32 first = offset + (code << (bits - length));
+		for (uint32 i = 0; i < count; i++)
+			_table[first + i] = entry;
+	} else {
+		const uint32 first = offset + reverseBits(code, length);
+		for (uint32 i = 0; i < count; i++)
+			_table[first + (i << length)] = entry;
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef COMMON_HUFFMAN_H
+#define COMMON_HUFFMAN_H
+
+#include "common/array.h"
+#include "common/bitreader.h"
+
+namespace Common {
+
+/**
+ * Table driven Huffman decoder.
+ *
+ * The next tableBits bits of the stream index a lookup table, which
+ * directly yields the symbol and the length of all codes that aren't
+ * longer than that. Each prefix of a longer code points to a second level
+ * table, indexed with just as many further bits as the longest code with
+ * that prefix needs.
+ */
+class Huffman {
+public:
+	enum {
+		/** Returned by getSymbol() for bits that don't start any code. */
+		kInvalidSymbol = 0xFFFFFFFF
+	};
+
+	/**
+	 * Builds the lookup tables.
+	 *
+	 * @param tableBits Number of bits the first level table is indexed with.
+	 *                  It is reduced to the length of the longest code.
+	 * @param count     Number of codes.
+	 * @param codes     The codes. The first bit of a code in the stream is
+	 *                  its most significant bit, whatever the bit order of
+	 *                  the stream is.
+	 * @param lengths   Lengths of the codes in bits, at most
+	 *                  BitReader::kMaxBits. Codes of length 0 are ignored.
+	 * @param symbols   Symbols of the codes. If 0, the symbol of a code is
+	 *                  its index.
+	 * @param msbFirst  Whether the codes are read with a BitReaderMSB or a
+	 *                  BitReaderLSB.
+	 */
+	Huffman(uint tableBits, uint32 count, const uint32 *codes, const uint8 *lengths, const uint32 *symbols, bool msbFirst);
+
+	/**
+	 * Reads the next code from the stream and returns its symbol. Nothing
+	 * is read if the bits don't match any code.
+	 */
+	template<class BITREADER>
+	uint32 getSymbol(BITREADER &bits) const {
+		assert(bool(BITREADER::kMSBFirst) == _msbFirst);
+
+		const Entry *table = _table.begin();
+		const Entry *entry = &table[bits.peekBits(_tableBits)];
+		if (entry->length == 0) {
+			if (entry->subBits == 0)
+				return kInvalidSymbol;
+
+			// The code is longer than the first level table
+			uint32 index = bits.peekBits(_tableBits + entry->subBits);
+			if (BITREADER::kMSBFirst)
+				index &= (1 << entry->subBits) - 1;
+			else
+				index >>= _tableBits;
+
+			entry = &table[entry->symbol + index];
+			if (entry->length == 0)
+				return kInvalidSymbol;
+		}
+
+		bits.skipBits(entry->length);
+		return entry->symbol;
+	}
+
+private:
+	struct Entry {
+		uint32 symbol;  ///< Symbol, or offset of the second level table
+		uint8 length;   ///< Length of the code, or 0
+		uint8 subBits;  ///< Index bits of the second level table, or 0
+	};
+
+	void fill(uint32 offset, uint bits, uint32 code, uint length, const Entry &entry);
+
+	Array<Entry> _table;
+	uint _tableBits;
+	bool _msbFirst;
+};
+
+} // End of namespace Common
+
+#endif
@@ -27,6 +27,7 @@
 #define COMMON_MEMSTREAM_H
 
 #include "common/stream.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -130,7 +131,9 @@ private:
 
 		byte *old_data = _data;
 
-		_capacity = new_len + 32;
+		// Grow geometrically, so that many small writes don't copy the
+		// data over and over again
+		_capacity = MAX(new_len + 32, _capacity * 2);
 		_data = (byte *)malloc(_capacity);
 		_ptr = _data + _pos;
 
@@ -113,6 +113,37 @@ public:
 	 */
 	virtual OutSaveFile *openForSaving(const String &name) = 0;
 
+	/**
+	 * Open the savefile with the specified name in the given directory for
+	 * saving in the background. The data is collected in memory, and when the
+	 * savefile is finalized, it is compressed and written without blocking the
+	 * caller. Backends that can't do that open the savefile normally.
+	 *
+	 * Errors which occur while writing in the background can't be reported
+	 * through the returned savefile; they are only logged. Hence this should
+	 * only be used where a failed save is not fatal, e.g. for autosaves.
+	 *
+	 * The savefile can be loaded, listed, removed or saved again while it is
+	 * being written. All of these see the new contents.
+	 *
+	 * @param name	the name of the savefile
+	 * @return pointer to an OutSaveFile, or NULL if an error occurred.
+	 */
+	virtual OutSaveFile *openForSavingInBackground(const String &name) { return openForSaving(name); }
+
+	/**
+	 * Checks whether a savefile opened with openForSavingInBackground is
+	 * still being written.
+	 * @param name the name of the savefile
+	 */
+	virtual bool isSaving(const String &name) { return false; }
+
+	/**
+	 * Waits until all savefiles opened with openForSavingInBackground have
+	 * been written.
+	 */
+	virtual void waitForSaves() {}
+
 	/**
 	 * Open the file with the specified name in the given directory for loading.
 	 * @param name	the name of the savefile
@@ -42,7 +42,9 @@ public:
 	 * written following the same safety guidelines as any other threaded code.
 	 *
 	 * @note Although the interval is specified in microseconds, the actual timer resolution
-	 *       may be lower. In particular, with the SDL backend the timer resolution is 10ms.
+	 *       may be lower. In particular, with the SDL backend the timer resolution is 1ms.
+	 *       Timers are scheduled relative to when they were due rather than when they
+	 *       actually fired, so they keep their rate on average.
 	 * @param proc		the callback
 	 * @param interval	the interval in which the timer shall be invoked (in microseconds)
 	 * @param refCon	an arbitrary void pointer; will be passed to the timer callback
@@ -55,6 +57,13 @@ public:
 	 * and no instance of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Remove the given timer callback, but only where it was installed with
+	 * the given refCon. This allows removing one of several timers sharing
+	 * a callback, e.g. one per object.
+	 */
+	virtual void removeTimerProc(TimerProc proc, void *refCon) = 0;
 };
 
 } // End of namespace Common
@@ -54,6 +54,7 @@ CineEngine::CineEngine(OSystem *syst, const CINEGameDescription *gameDesc) : Eng
 	DebugMan.addDebugChannel(kCineDebugPart,      "Part",      "Part debug level");
 	DebugMan.addDebugChannel(kCineDebugSound,     "Sound",     "Sound debug level");
 	DebugMan.addDebugChannel(kCineDebugCollision, "Collision", "Collision debug level");
+	DebugMan.addDebugChannel(kCineDebugScreen,    "Screen",    "Screen debug level");
 	_console = new CineConsole(this);
 
 	// Setup mixer
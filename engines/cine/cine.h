@@ -220,7 +220,8 @@ enum {
 	kCineDebugScript    = 1 << 0,
 	kCineDebugPart      = 1 << 1,
 	kCineDebugSound     = 1 << 2,
-	kCineDebugCollision = 1 << 3
+	kCineDebugCollision = 1 << 3,
+	kCineDebugScreen    = 1 << 4
 };
 
 enum {
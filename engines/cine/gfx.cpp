@@ -110,7 +110,7 @@ static const byte cursorPalette[] = {
  */
 FWRenderer::FWRenderer() : _background(NULL), _backupPal(), _cmd(""),
 	_cmdY(0), _messageBg(0), _backBuffer(new byte[_screenSize]),
-	_activePal(), _changePal(0), _showCollisionPage(false) {
+	_shadowScreen(_screenWidth, _screenHeight), _activePal(), _changePal(0), _showCollisionPage(false) {
 
 	assert(_backBuffer);
 
@@ -649,7 +649,9 @@ void FWRenderer::blit() {
 	// Show the back buffer or the collision page. Normally the back
 	// buffer but showing the collision page is useful for debugging.
 	byte *source = (_showCollisionPage ? collisionPage : _backBuffer);
-	g_system->copyRectToScreen(source, 320, 0, 0, 320, 200);
+	_shadowScreen.resetStats();
+	_shadowScreen.copyRectToScreen(source, 320, 0, 0, 320, 200);
+	debugC(1, kCineDebugScreen, "blit() %d pixels copied, %d skipped", _shadowScreen.getPixelsCopied(), _shadowScreen.getPixelsSkipped());
 }
 
 /**
@@ -29,6 +29,7 @@
 #include "common/noncopyable.h"
 #include "common/rect.h"
 #include "common/stack.h"
+#include "graphics/shadowscreen.h"
 #include "cine/object.h"
 
 namespace Cine {
@@ -137,6 +138,7 @@ protected:
 	static const int _screenHeight = 200; ///< Screen height
 
 	byte *_backBuffer; ///< Screen backbuffer
+	Graphics::ShadowScreen _shadowScreen; ///< Copies the changed parts of the backbuffer to the screen
 	Cine::Palette _backupPal; ///< The backup color palette
 	Cine::Palette _activePal; ///< The active color palette
 	Common::Stack<Menu *> _menuStack; ///< All displayed menus
@@ -42,7 +42,7 @@ DataIO::File::File(const Common::String &n, uint32 s, uint32 o, bool p, Archive
 }
 
 
-DataIO::DataIO() {
+DataIO::DataIO() : _cacheSize(0) {
 	// Reserve memory for the standard max amount of archives
 	_archives.reserve(kMaxArchives);
 	for (int i = 0; i < kMaxArchives; i++)
@@ -78,70 +78,89 @@ byte *DataIO::unpack(const byte *src, uint32 srcSize, int32 &size) {
 
 	byte *data = new byte[size];
 
-	Common::MemoryReadStream srcStream(src + 4, srcSize - 4);
-	unpack(srcStream, data, size);
+	unpack(src + 4, srcSize - 4, data, size);
 	return data;
 }
 
 Common::SeekableReadStream *DataIO::unpack(Common::SeekableReadStream &src) {
 	uint32 size = src.readUint32LE();
 
+	uint32 srcSize = src.size() - src.pos();
+	byte *srcData = new byte[srcSize];
+	srcSize = src.read(srcData, srcSize);
+
 	byte *data = (byte *) malloc(size);
 
-	unpack(src, data, size);
+	unpack(srcData, srcSize, data, size);
+
+	delete[] srcData;
 	return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
 }
 
-void DataIO::unpack(Common::SeekableReadStream &src, byte *dest, uint32 size) {
-	byte *tmpBuf = new byte[4114];
-	assert(tmpBuf);
+void DataIO::unpack(const byte *src, uint32 srcSize, byte *dest, uint32 size) {
+	// LZSS with a 4096 byte window. The window starts out filled with
+	// spaces, and the first byte unpacked is written to position 4078.
+	// Since everything unpacked stays in dest, copies are done from there
+	// directly instead of through a separate window buffer.
 
-	uint32 counter = size;
-
-	for (int i = 0; i < 4078; i++)
-		tmpBuf[i] = 0x20;
-	uint16 tmpIndex = 4078;
+	const byte *srcEnd = src + srcSize;
+	byte *destStart = dest;
+	byte *destEnd = dest + size;
 
 	uint16 cmd = 0;
-	while (1) {
+	while (dest < destEnd) {
 		cmd >>= 1;
-		if ((cmd & 0x0100) == 0)
-			cmd = src.readByte() | 0xFF00;
-
-		if ((cmd & 1) != 0) { /* copy */
-			byte tmp = src.readByte();
+		if ((cmd & 0x0100) == 0) {
+			if (src >= srcEnd)
+				break;
 
-			*dest++ = tmp;
-			tmpBuf[tmpIndex] = tmp;
+			cmd = *src++ | 0xFF00;
+		}
 
-			tmpIndex++;
-			tmpIndex %= 4096;
-			counter--;
-			if (counter == 0)
+		if ((cmd & 1) != 0) { /* copy */
+			if (src >= srcEnd)
 				break;
+
+			*dest++ = *src++;
 		} else { /* copy string */
-			byte tmp1 = src.readByte();
-			byte tmp2 = src.readByte();
-
-			int16 off = tmp1 | ((tmp2 & 0xF0) << 4);
-			byte  len =         (tmp2 & 0x0F) + 3;
-
-			for (int i = 0; i < len; i++) {
-				*dest++ = tmpBuf[(off + i) % 4096];
-				counter--;
-				if (counter == 0) {
-					delete[] tmpBuf;
-					return;
+			if ((srcEnd - src) < 2)
+				break;
+
+			uint16 off = src[0] | ((src[1] & 0xF0) << 4);
+			uint32 len =          (src[1] & 0x0F) + 3;
+			src += 2;
+
+			// Distance from the current window position, 1 to 4096
+			const uint32 pos = (dest - destStart + 4078) & 0xFFF;
+			const uint32 dist = ((pos - off - 1) & 0xFFF) + 1;
+
+			len = MIN<uint32>(len, destEnd - dest);
+
+			if (dist > (uint32)(dest - destStart)) {
+				// Reaching back in front of the unpacked data, which is the
+				// initial window content
+				while (len > 0 && dist > (uint32)(dest - destStart)) {
+					*dest++ = 0x20;
+					len--;
 				}
-				tmpBuf[tmpIndex] = tmpBuf[(off + i) % 4096];
-				tmpIndex++;
-				tmpIndex %= 4096;
 			}
 
+			const byte *from = dest - dist;
+			if (dist >= len) {
+				memcpy(dest, from, len);
+				dest += len;
+			} else {
+				// The string overlaps the bytes it repeats
+				while (len-- > 0)
+					*dest++ = *from++;
+			}
 		}
 	}
 
-	delete[] tmpBuf;
+	if (dest < destEnd) {
+		warning("DataIO::unpack(): Packed data ended after %d of %d bytes", (int)(dest - destStart), size);
+		memset(dest, 0, destEnd - dest);
+	}
 }
 
 bool DataIO::openArchive(Common::String name, bool base) {
@@ -238,6 +257,7 @@ bool DataIO::closeArchive(bool base) {
 }
 
 bool DataIO::closeArchive(Archive &archive) {
+	dropCached(archive);
 	archive.file.close();
 
 	return true;
@@ -259,6 +279,10 @@ int32 DataIO::fileSize(const Common::String &name) {
 		if (!file->packed)
 			return file->size;
 
+		uint32 size;
+		if (findCached(*file, size))
+			return size;
+
 		// Sanity checks
 		assert(file->size >= 4);
 		assert(file->archive);
@@ -342,21 +366,35 @@ Common::SeekableReadStream *DataIO::getFile(File &file) {
 	if (!file.archive->file.isOpen())
 		return 0;
 
-	if (!file.archive->file.seek(file.offset))
-		return 0;
+	if (!file.packed) {
+		if (!file.archive->file.seek(file.offset))
+			return 0;
 
-	Common::SeekableReadStream *rawData = file.archive->file.readStream(file.size);
-	if (!rawData)
-		return 0;
+		return file.archive->file.readStream(file.size);
+	}
 
-	if (!file.packed)
-		return rawData;
+	uint32 size;
+	byte *data;
 
-	Common::SeekableReadStream *unpackedData = unpack(*rawData);
+	const byte *cachedData = findCached(file, size);
+	if (cachedData) {
+		data = (byte *) malloc(size);
+		memcpy(data, cachedData, size);
+	} else {
+		byte *packedData = readPacked(file);
+		if (!packedData)
+			return 0;
 
-	delete rawData;
+		size = READ_LE_UINT32(packedData);
+		data = (byte *) malloc(size);
+		unpack(packedData + 4, file.size - 4, data, size);
 
-	return unpackedData;
+		delete[] packedData;
+
+		addCached(file, data, size);
+	}
+
+	return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
 }
 
 byte *DataIO::getFile(File &file, int32 &size) {
@@ -366,25 +404,110 @@ byte *DataIO::getFile(File &file, int32 &size) {
 	if (!file.archive->file.isOpen())
 		return 0;
 
-	if (!file.archive->file.seek(file.offset))
+	if (!file.packed) {
+		if (!file.archive->file.seek(file.offset))
+			return 0;
+
+		size = file.size;
+
+		byte *rawData = new byte[file.size];
+		if (file.archive->file.read(rawData, file.size) != file.size) {
+			delete[] rawData;
+			return 0;
+		}
+
+		return rawData;
+	}
+
+	uint32 unpackedSize;
+	byte *data;
+
+	const byte *cachedData = findCached(file, unpackedSize);
+	if (cachedData) {
+		data = new byte[unpackedSize];
+		memcpy(data, cachedData, unpackedSize);
+	} else {
+		byte *packedData = readPacked(file);
+		if (!packedData)
+			return 0;
+
+		unpackedSize = READ_LE_UINT32(packedData);
+		data = new byte[unpackedSize];
+		unpack(packedData + 4, file.size - 4, data, unpackedSize);
+
+		delete[] packedData;
+
+		addCached(file, data, unpackedSize);
+	}
+
+	size = unpackedSize;
+	return data;
+}
+
+byte *DataIO::readPacked(File &file) {
+	if (file.size < 4)
 		return 0;
 
-	size = file.size;
+	if (!file.archive->file.seek(file.offset))
+		return 0;
 
-	byte *rawData = new byte[file.size];
-	if (file.archive->file.read(rawData, file.size) != file.size) {
-		delete[] rawData;
+	byte *packedData = new byte[file.size];
+	if (file.archive->file.read(packedData, file.size) != file.size) {
+		delete[] packedData;
 		return 0;
 	}
 
-	if (!file.packed)
-		return rawData;
+	return packedData;
+}
+
+const byte *DataIO::findCached(const File &file, uint32 &size) {
+	for (CacheList::iterator it = _cache.begin(); it != _cache.end(); ++it) {
+		if (it->file != &file)
+			continue;
+
+		// Move the file to the front of the list
+		if (it != _cache.begin()) {
+			_cache.push_front(*it);
+			_cache.erase(it);
+		}
 
-	byte *unpackedData = unpack(rawData, file.size, size);
+		size = _cache.front().size;
+		return _cache.front().data;
+	}
 
-	delete[] rawData;
+	return 0;
+}
 
-	return unpackedData;
+void DataIO::addCached(const File &file, const byte *data, uint32 size) {
+	// Big files would push out everything else
+	if (size > kCacheBudget / 4)
+		return;
+
+	while (!_cache.empty() && (_cacheSize + size > kCacheBudget)) {
+		_cacheSize -= _cache.back().size;
+		delete[] _cache.back().data;
+		_cache.pop_back();
+	}
+
+	CachedFile cached;
+	cached.file = &file;
+	cached.data = new byte[size];
+	cached.size = size;
+	memcpy(cached.data, data, size);
+
+	_cache.push_front(cached);
+	_cacheSize += size;
+}
+
+void DataIO::dropCached(const Archive &archive) {
+	for (CacheList::iterator it = _cache.begin(); it != _cache.end(); ) {
+		if (it->file->archive == &archive) {
+			_cacheSize -= it->size;
+			delete[] it->data;
+			it = _cache.erase(it);
+		} else
+			++it;
+	}
 }
 
 } // End of namespace Gob
@@ -30,6 +30,7 @@
 #include "common/str.h"
 #include "common/hashmap.h"
 #include "common/array.h"
+#include "common/list.h"
 #include "common/file.h"
 
 namespace Common {
@@ -67,6 +68,9 @@ public:
 private:
 	static const int kMaxArchives = 8;
 
+	/** Number of bytes of unpacked archive files kept in memory. */
+	static const uint32 kCacheBudget = 512 * 1024;
+
 	struct Archive;
 
 	struct File {
@@ -92,8 +96,20 @@ private:
 		bool base;
 	};
 
+	/** An unpacked archive file. */
+	struct CachedFile {
+		const File *file;
+		byte *data;
+		uint32 size;
+	};
+
+	typedef Common::List<CachedFile> CacheList;
+
 	Common::Array<Archive *> _archives;
 
+	CacheList _cache;   ///< Unpacked archive files, most recently used first
+	uint32 _cacheSize;  ///< Number of bytes in _cache
+
 	Archive *openArchive(const Common::String &name);
 	bool closeArchive(Archive &archive);
 
@@ -102,7 +118,13 @@ private:
 	Common::SeekableReadStream *getFile(File &file);
 	byte *getFile(File &file, int32 &size);
 
-	static void unpack(Common::SeekableReadStream &src, byte *dest, uint32 size);
+	byte *readPacked(File &file);
+
+	const byte *findCached(const File &file, uint32 &size);
+	void addCached(const File &file, const byte *data, uint32 size);
+	void dropCached(const Archive &archive);
+
+	static void unpack(const byte *src, uint32 srcSize, byte *dest, uint32 size);
 };
 
 } // End of namespace Gob
@@ -26,7 +26,7 @@
 #include "common/endian.h"
 #include "common/savefile.h"
 
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 
 #include "gob/gob.h"
 #include "gob/video.h"
@@ -114,7 +114,7 @@ void Video_v6::drawYUV(Surface &destDesc, int16 x, int16 y,
 		int16 dataWidth, int16 dataHeight, int16 width, int16 height,
 		const byte *dataY, const byte *dataU, const byte *dataV) {
 
-	const Graphics::PixelFormat &pixelFormat = _vm->getPixelFormat();
+	const Graphics::YUVToRGBLookup *yuvLookup = YUVToRGBMan.getLookup(_vm->getPixelFormat());
 
 	if ((x + width - 1) >= destDesc.getWidth())
 		width = destDesc.getWidth() - x;
@@ -162,12 +162,9 @@ void Video_v6::drawYUV(Surface &destDesc, int16 x, int16 y,
 			int16 dVY2 = dV2 * invtX + dV3 * tX;
 			byte dV = (dVY1 * invtY + dVY2 * tY) >> 3;
 
-			byte r, g, b;
-			Graphics::YUV2RGB(dY, dU, dV, r, g, b);
-
 			if (dY != 0) {
 				// Solid pixel
-				uint32 c = pixelFormat.RGBToColor(r, g, b);
+				uint32 c = yuvLookup->convert(dY, dU, dV);
 
 				// If the solid pixel's value is 0, we'll fudge it to 1
 				dstRow.set((c == 0) ? 1 : c);
@@ -34,7 +34,7 @@
 
 #ifdef USE_RGB_COLOR
 // Required for the YUV to RGB conversion
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 #endif
 #include "sound/mixer.h"
 #include "sound/decoders/raw.h"
@@ -160,6 +160,12 @@ void ROQPlayer::buildShowBuf() {
 	_dither->newFrame();
 #endif
 
+#ifdef USE_RGB_COLOR
+	const Graphics::YUVToRGBLookup *yuvLookup = 0;
+	if (!_vm->_mode8bit)
+		yuvLookup = YUVToRGBMan.getLookup(_vm->_pixelFormat);
+#endif
+
 	for (int line = 0; line < _bg->h; line++) {
 		byte *out = (byte *)_bg->getBasePtr(0, line);
 		byte *in = (byte *)_currBuf->getBasePtr(0, line / _scaleY);
@@ -173,11 +179,9 @@ void ROQPlayer::buildShowBuf() {
 #endif // DITHER
 #ifdef USE_RGB_COLOR
 			} else {
-				// Do the format conversion (YUV -> RGB -> Screen format)
-				byte r, g, b;
-				Graphics::YUV2RGB(*in, *(in + 1), *(in + 2), r, g, b);
+				// Do the format conversion (YUV -> Screen format)
 				// FIXME: this is fixed to 16bit
-				*(uint16 *)out = (uint16)_vm->_pixelFormat.RGBToColor(r, g, b);
+				*(uint16 *)out = (uint16)yuvLookup->convert(*in, *(in + 1), *(in + 2));
 #endif // USE_RGB_COLOR
 			}
 
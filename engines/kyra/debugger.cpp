@@ -51,6 +51,7 @@ Debugger::Debugger(KyraEngine_v1 *vm)
 	DCmd_Register("queryflag",			WRAP_METHOD(Debugger, cmd_queryFlag));
 	DCmd_Register("timers",				WRAP_METHOD(Debugger, cmd_listTimers));
 	DCmd_Register("settimercountdown",	WRAP_METHOD(Debugger, cmd_setTimerCountdown));
+	DCmd_Register("shape_check",		WRAP_METHOD(Debugger, cmd_checkShapes));
 }
 
 bool Debugger::cmd_setScreenDebug(int argc, const char **argv) {
@@ -191,6 +192,21 @@ bool Debugger::cmd_setTimerCountdown(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_checkShapes(int argc, const char **argv) {
+	int iterations = (argc > 1) ? MAX(1, atoi(argv[1])) : 10;
+
+	int draws = 0;
+	uint32 plotTime = 0, lineTime = 0;
+	int mismatches = _vm->screen()->checkShapeLineFuncs(iterations, draws, plotTime, lineTime);
+
+	DebugPrintf("%d of %d shapes captured from the screen are drawn differently by the line loops\n", mismatches, draws);
+	DebugPrintf("Drawing them %d times took %d ms plotting each pixel, %d ms with the line loops\n", iterations, plotTime, lineTime);
+	if (argc <= 1)
+		DebugPrintf("Use shape_check <iterations> to change the number of times\n");
+
+	return true;
+}
+
 #pragma mark -
 
 Debugger_LoK::Debugger_LoK(KyraEngine_LoK *vm)
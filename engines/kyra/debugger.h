@@ -52,6 +52,7 @@ protected:
 	bool cmd_queryFlag(int argc, const char **argv);
 	bool cmd_listTimers(int argc, const char **argv);
 	bool cmd_setTimerCountdown(int argc, const char **argv);
+	bool cmd_checkShapes(int argc, const char **argv);
 };
 
 class Debugger_LoK : public Debugger {
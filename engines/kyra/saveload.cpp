@@ -183,8 +183,14 @@ Common::WriteStream *KyraEngine_v1::openSaveForWriting(const char *filename, con
 	if (shouldQuit())
 		return 0;
 
+	// The autosave is written in the background, so that it doesn't stall the game
 	Common::WriteStream *out = 0;
-	if (!(out = _saveFileMan->openForSaving(filename))) {
+	if (filename == getSavegameFilename(_targetName, 999))
+		out = _saveFileMan->openForSavingInBackground(filename);
+	else
+		out = _saveFileMan->openForSaving(filename);
+
+	if (!out) {
 		warning("Can't create file '%s', game not saved", filename);
 		return 0;
 	}
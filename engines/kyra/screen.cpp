@@ -114,6 +114,7 @@ bool Screen::init() {
 	memset(pagePtr, 0, SCREEN_PAGE_SIZE * 8);
 
 	memset(_shapePages, 0, sizeof(_shapePages));
+	_dsPlotOnly = false;
 
 	const int paletteCount = _isAmiga ? 13 : 4;
 	const int numColors = _use16ColorMode ? 16 : (_isAmiga ? 32 : 256);
@@ -1326,17 +1327,6 @@ void Screen::drawShape(uint8 pageNum, const uint8 *shapeData, int x, int y, int
 		&Screen::drawShapeSkipScaleDownwind
 	};
 
-	static const DsLineFunc dsLineFunc[] = {
-		&Screen::drawShapeProcessLineNoScaleUpwind,
-		&Screen::drawShapeProcessLineNoScaleDownwind,
-		&Screen::drawShapeProcessLineNoScaleUpwind,
-		&Screen::drawShapeProcessLineNoScaleDownwind,
-		&Screen::drawShapeProcessLineScaleUpwind,
-		&Screen::drawShapeProcessLineScaleDownwind,
-		&Screen::drawShapeProcessLineScaleUpwind,
-		&Screen::drawShapeProcessLineScaleDownwind
-	};
-
 	static const DsPlotFunc dsPlotFunc[] = {
 		&Screen::drawShapePlotType0,		// used by Kyra 1 + 2
 		&Screen::drawShapePlotType1,		// used by Kyra 3
@@ -1376,7 +1366,6 @@ void Screen::drawShape(uint8 pageNum, const uint8 *shapeData, int x, int y, int
 	const int drawFunc = flags & 0x0f;
 	_dsProcessMargin = dsMarginFunc[drawFunc];
 	_dsScaleSkip = dsSkipFunc[drawFunc];
-	_dsProcessLine = dsLineFunc[drawFunc];
 
 	const int ppc = (flags >> 8) & 0x3F;
 	_dsPlot = dsPlotFunc[ppc];
@@ -1393,6 +1382,10 @@ void Screen::drawShape(uint8 pageNum, const uint8 *shapeData, int x, int y, int
 		return;
 	}
 
+	const DsLineFunc dsLine2 = getShapeLineFunc(drawFunc, dsPlot2);
+	const DsLineFunc dsLine3 = (dsPlot3 == dsPlot2) ? dsLine2 : getShapeLineFunc(drawFunc, dsPlot3);
+	_dsProcessLine = dsLine2;
+
 	int curY = y;
 	const uint8 *src = shapeData;
 	uint8 *dst = _dsDstPage = getPagePtr(pageNum);
@@ -1581,6 +1574,7 @@ void Screen::drawShape(uint8 pageNum, const uint8 *shapeData, int x, int y, int
 					if (flags & 0x800)
 						normalPlot = (curY > _maskMinY && curY < _maskMaxY);
 					_dsPlot = normalPlot ? dsPlot2 : dsPlot3;
+					_dsProcessLine = normalPlot ? dsLine2 : dsLine3;
 					(this->*_dsProcessLine)(d, src, cnt, scaleState);
 				}
 				cnt += _dsOffscreenRight;
@@ -1797,6 +1791,257 @@ void Screen::drawShapeProcessLineScaleDownwind(uint8 *&dst, const uint8 *&src, i
 	cnt = -1;
 }
 
+template<bool downwind, Screen::DsPlotFunc plot>
+void Screen::drawShapeProcessLineNoScale(uint8 *&dst, const uint8 *&src, int &cnt, int16) {
+	do {
+		uint8 c = *src++;
+		if (c) {
+			// Plot the whole run of opaque pixels
+			do {
+				(this->*plot)(dst, c);
+				if (downwind)
+					dst--;
+				else
+					dst++;
+			} while (--cnt > 0 && (c = *src++) != 0);
+
+			if (c || cnt <= 0)
+				continue;
+		}
+
+		c = *src++;
+		if (downwind)
+			dst -= c;
+		else
+			dst += c;
+		cnt -= c;
+	} while (cnt > 0);
+}
+
+template<bool downwind, Screen::DsPlotFunc plot>
+void Screen::drawShapeProcessLineScale(uint8 *&dst, const uint8 *&src, int &cnt, int16 scaleState) {
+	int c = 0;
+
+	do {
+		if ((scaleState & 0x8000) || !(scaleState & 0xFF00)) {
+			c = *src++;
+			_dsTmpWidth--;
+			if (c) {
+				scaleState += _dsScaleW;
+			} else {
+				_dsTmpWidth++;
+				c = *src++;
+				_dsTmpWidth -= c;
+				int r = c * _dsScaleW + scaleState;
+				if (downwind)
+					dst -= (r >> 8);
+				else
+					dst += (r >> 8);
+				cnt -= (r >> 8);
+				scaleState = r & 0xff;
+			}
+		} else if (downwind || scaleState) {
+			(this->*plot)(dst, c);
+			if (downwind)
+				dst--;
+			else
+				dst++;
+			scaleState -= 0x100;
+			cnt--;
+		}
+	} while (cnt > 0);
+
+	cnt = -1;
+}
+
+Screen::DsLineFunc Screen::getShapeLineFunc(int drawFunc, DsPlotFunc plot) const {
+	static const DsLineFunc dsLineFunc[] = {
+		&Screen::drawShapeProcessLineNoScaleUpwind,
+		&Screen::drawShapeProcessLineNoScaleDownwind,
+		&Screen::drawShapeProcessLineNoScaleUpwind,
+		&Screen::drawShapeProcessLineNoScaleDownwind,
+		&Screen::drawShapeProcessLineScaleUpwind,
+		&Screen::drawShapeProcessLineScaleDownwind,
+		&Screen::drawShapeProcessLineScaleUpwind,
+		&Screen::drawShapeProcessLineScaleDownwind
+	};
+
+#define DS_LINE_FUNCS(type) \
+	{ &Screen::drawShapePlotType##type, { \
+		&Screen::drawShapeProcessLineNoScale<false, &Screen::drawShapePlotType##type>, \
+		&Screen::drawShapeProcessLineNoScale<true, &Screen::drawShapePlotType##type>, \
+		&Screen::drawShapeProcessLineScale<false, &Screen::drawShapePlotType##type>, \
+		&Screen::drawShapeProcessLineScale<true, &Screen::drawShapePlotType##type> } }
+
+	// Plotting methods used for most shapes of Kyra 1-3 and LoL. The others
+	// go through _dsPlot for every pixel.
+	static const struct {
+		DsPlotFunc plot;
+		DsLineFunc line[4];
+	} dsPlotLineFunc[] = {
+		DS_LINE_FUNCS(0),
+		DS_LINE_FUNCS(1),
+		DS_LINE_FUNCS(4),
+		DS_LINE_FUNCS(5),
+		DS_LINE_FUNCS(8),
+		DS_LINE_FUNCS(9),
+		DS_LINE_FUNCS(12),
+		DS_LINE_FUNCS(13),
+		DS_LINE_FUNCS(37)
+	};
+
+#undef DS_LINE_FUNCS
+
+	for (int i = 0; i < ARRAYSIZE(dsPlotLineFunc) && !_dsPlotOnly; ++i) {
+		if (dsPlotLineFunc[i].plot == plot)
+			return dsPlotLineFunc[i].line[((drawFunc & DSF_SCALE) ? 2 : 0) + (drawFunc & DSF_X_FLIPPED)];
+	}
+
+	return dsLineFunc[drawFunc];
+}
+
+namespace {
+
+struct ShapeCheckDraw {
+	const uint8 *shape;
+	int x, y;
+	int flags;
+	int layer;
+	int scale;
+};
+
+void drawCheckShape(Screen *screen, int page, const ShapeCheckDraw &draw, const uint8 *table2, const uint8 *table, const uint8 *table5) {
+	// drawShape() takes the arguments of the flags in this order. Table 5
+	// comes last, so it can always be passed.
+	const bool t = (draw.flags & 0x100) != 0;
+	const bool l = (draw.flags & 0x800) != 0;
+	const bool s = (draw.flags & Screen::DSF_SCALE) != 0;
+	const int sc = draw.scale;
+
+	if (t && l && s)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, table, 1, draw.layer, sc, sc, table5);
+	else if (t && l)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, table, 1, draw.layer, table5);
+	else if (t && s)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, table, 1, sc, sc, table5);
+	else if (l && s)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, draw.layer, sc, sc, table5);
+	else if (t)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, table, 1, table5);
+	else if (l)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, draw.layer, table5);
+	else if (s)
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, sc, sc, table5);
+	else
+		screen->drawShape(page, draw.shape, draw.x, draw.y, 0, draw.flags, table2, table5);
+}
+
+} // End of anonymous namespace
+
+int Screen::checkShapeLineFuncs(int iterations, int &draws, uint32 &plotTime, uint32 &lineTime) {
+	// Plotting methods with their own line loops, see getShapeLineFunc()
+	static const int plotFlags[] = { 0x000, 0x100, 0x400, 0x500, 0x800, 0x900, 0xC00, 0xD00, 0x2500 };
+	const int numShapes = 16;
+	const int page = 2;
+
+	Common::RandomSource rnd;
+	rnd.setSeed(0x4b595241);
+
+	uint8 table2[256], table[256], table5[256];
+	for (int i = 0; i < 256; ++i) {
+		table2[i] = rnd.getRandomNumber(255);
+		table[i] = rnd.getRandomNumber(255);
+		table5[i] = rnd.getRandomNumber(255);
+	}
+
+	// Capture shapes of random parts of the screen, half of them with
+	// color tables
+	uint8 *shapes[numShapes];
+	const int oldPage = setCurPage(0);
+	for (int i = 0; i < numShapes; ++i) {
+		const int w = rnd.getRandomNumberRng(8, 96);
+		const int h = rnd.getRandomNumberRng(8, 96);
+		shapes[i] = encodeShape(rnd.getRandomNumber(SCREEN_W - w), rnd.getRandomNumber(SCREEN_H - h), w, h, (i & 1) ? 3 : 2);
+	}
+	setCurPage(oldPage);
+
+	Common::Array<ShapeCheckDraw> drawList;
+	for (int i = 0; i < numShapes; ++i) {
+		const int w = READ_LE_UINT16(shapes[i] + (_vm->gameFlags().useAltShapeHeader ? 5 : 3));
+		const int h = shapes[i][_vm->gameFlags().useAltShapeHeader ? 4 : 2];
+
+		for (int p = 0; p < ARRAYSIZE(plotFlags); ++p) {
+			// Flag 0x400 skips the color table of a shape, so it is only used
+			// with shapes that have one. Layered plotting needs the shape
+			// pages, and Kyra 1 has no table 5.
+			if ((plotFlags[p] & 0x400) && !(i & 1))
+				continue;
+			if ((plotFlags[p] & 0x800) && (!_shapePages[0] || !_shapePages[1]))
+				continue;
+			if ((plotFlags[p] & 0x2000) && _vm->game() == GI_KYRA1)
+				continue;
+
+			for (int drawFunc = 0; drawFunc < 8; ++drawFunc) {
+				ShapeCheckDraw draw;
+				draw.shape = shapes[i];
+				// Partly off screen now and then, to check the clipping
+				draw.x = rnd.getRandomNumberRng(0, SCREEN_W + w) - w / 2;
+				draw.y = rnd.getRandomNumberRng(0, SCREEN_H + h) - h / 2;
+				draw.flags = 0x8000 | plotFlags[p] | drawFunc;
+				draw.layer = rnd.getRandomNumber(7);
+				draw.scale = rnd.getRandomNumberRng(0x40, 0x200);
+				drawList.push_back(draw);
+			}
+		}
+	}
+
+	uint8 *savedPage = _pagePtrs[page];
+	uint8 *plotPage = new uint8[SCREEN_PAGE_SIZE];
+	uint8 *linePage = new uint8[SCREEN_PAGE_SIZE];
+
+	int mismatches = 0;
+	for (uint i = 0; i < drawList.size(); ++i) {
+		memcpy(plotPage, _pagePtrs[0], SCREEN_PAGE_SIZE);
+		memcpy(linePage, _pagePtrs[0], SCREEN_PAGE_SIZE);
+
+		_dsPlotOnly = true;
+		_pagePtrs[page] = plotPage;
+		drawCheckShape(this, page, drawList[i], table2, table, table5);
+
+		_dsPlotOnly = false;
+		_pagePtrs[page] = linePage;
+		drawCheckShape(this, page, drawList[i], table2, table, table5);
+
+		if (memcmp(plotPage, linePage, SCREEN_PAGE_SIZE)) {
+			debugC(1, kDebugLevelScreen, "Screen::checkShapeLineFuncs(): flags 0x%.04X give different results", drawList[i].flags);
+			++mismatches;
+		}
+	}
+
+	for (int pass = 0; pass < 2; ++pass) {
+		_dsPlotOnly = (pass == 0);
+		_pagePtrs[page] = _dsPlotOnly ? plotPage : linePage;
+
+		const uint32 start = _system->getMillis();
+		for (int i = 0; i < iterations; ++i) {
+			for (uint j = 0; j < drawList.size(); ++j)
+				drawCheckShape(this, page, drawList[j], table2, table, table5);
+		}
+		(_dsPlotOnly ? plotTime : lineTime) = _system->getMillis() - start;
+	}
+
+	_dsPlotOnly = false;
+	_pagePtrs[page] = savedPage;
+	delete[] plotPage;
+	delete[] linePage;
+
+	for (int i = 0; i < numShapes; ++i)
+		delete[] shapes[i];
+
+	draws = drawList.size();
+	return mismatches;
+}
+
 void Screen::drawShapePlotType0(uint8 *dst, uint8 cmd) {
 	*dst = cmd;
 }
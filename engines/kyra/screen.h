@@ -435,6 +435,17 @@ public:
 
 	void drawShape(uint8 pageNum, const uint8 *shapeData, int x, int y, int sd, int flags, ...);
 
+	/**
+	 * Draws shapes captured from page 0 with every plotting method that has
+	 * its own line loops, flipped, scaled and clipped, once with those loops
+	 * and once plotting each pixel through _dsPlot, and compares the pages.
+	 * Then draws all of them the given number of times in both ways to time
+	 * them. Used by the "shape_check" debugger command.
+	 *
+	 * @return the number of draws whose results differ
+	 */
+	int checkShapeLineFuncs(int iterations, int &draws, uint32 &plotTime, uint32 &lineTime);
+
 	// mouse handling
 	void hideMouse();
 	void showMouse();
@@ -584,6 +595,16 @@ protected:
 	typedef void (Screen::*DsLineFunc)(uint8 *&dst, const uint8 *&src, int &cnt, int16 scaleState);
 	typedef void (Screen::*DsPlotFunc)(uint8 *dst, uint8 cmd);
 
+	// Line processing with the plotting method compiled in, for the
+	// commonly used ones
+	template<bool downwind, DsPlotFunc plot>
+	void drawShapeProcessLineNoScale(uint8 *&dst, const uint8 *&src, int &cnt, int16 scaleState);
+	template<bool downwind, DsPlotFunc plot>
+	void drawShapeProcessLineScale(uint8 *&dst, const uint8 *&src, int &cnt, int16 scaleState);
+
+	DsLineFunc getShapeLineFunc(int drawFunc, DsPlotFunc plot) const;
+	bool _dsPlotOnly; ///< Draw all shapes through _dsPlot, for checkShapeLineFuncs()
+
 	DsMarginSkipFunc _dsProcessMargin;
 	DsMarginSkipFunc _dsScaleSkip;
 	DsLineFunc _dsProcessLine;
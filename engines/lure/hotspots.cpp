@@ -486,12 +486,6 @@ void Hotspot::setTickProc(uint16 newVal) {
 }
 
 void Hotspot::walkTo(int16 endPosX, int16 endPosY, uint16 destHotspot) {
-	if ((hotspotId() == PLAYER_ID) && (PATHFIND_COUNTDOWN != 0)) {
-		// Show the clock cursor whilst pathfinding will be calculated
-		Mouse &mouse = Mouse::getReference();
-		mouse.setCursorNum(CURSOR_TIME_START, 0, 0);
-	}
-
 	_destX = endPosX;
 	_destY = endPosY;
 	_destHotspotId = destHotspot;
@@ -4136,8 +4130,6 @@ PathFinder::PathFinder(Hotspot *h) {
 void PathFinder::clear() {
 	_stepCtr = 0;
 	_list.clear();
-	_inProgress = false;
-	_countdownCtr = PATHFIND_COUNTDOWN;
 }
 
 void PathFinder::reset(RoomPathsData &src) {
@@ -4146,124 +4138,82 @@ void PathFinder::reset(RoomPathsData &src) {
 	_inUse = true;
 }
 
-// Does the next stage of processing to figure out a path to take to a given
-// destination. Returns true if the path finding has been completed
+// Figures out a path to take to a given destination
 
 PathFinderResult PathFinder::process() {
-	bool returnFlag = _inProgress;
-	// Check whether the pathfinding can be broken by the countdown counter
-	bool breakFlag = (PATHFIND_COUNTDOWN != 0);
-	_countdownCtr = PATHFIND_COUNTDOWN;
 	int v;
 	uint16 *pTemp;
-	bool scanFlag = false;
+	bool scanFlag;
 	Direction currDirection = NO_DIRECTION;
 	Direction newDirection;
 	uint16 numSteps = 0, savedSteps = 0;
 	bool altFlag;
 	uint16 *pCurrent;
-	PathFinderResult result = PF_UNFINISHED;
-
-	if (!_inProgress) {
-		// Following code only done during first call to method
-		_inProgress = true;
-		initVars();
-
-		Common::Point diff(_destX - _xCurrent, _destY - _yCurrent);
-		_xCurrent >>= 3; _yCurrent >>= 3;
-		_xDestCurrent >>= 3; _yDestCurrent >>= 3;
-		if ((_xCurrent == _xDestCurrent) && (_yCurrent == _yDestCurrent)) {
-			// Very close move
-			if (_xDestPos > 0)
-				add(RIGHT, _xDestPos);
-			else if (_xDestPos < 0)
-				add(LEFT, -_xDestPos);
-			else if (diff.y > 0)
-				add(DOWN, diff.y);
-			else
-				add(UP, -diff.y);
+	PathFinderResult result;
+	bool destOccupied;
+
+	initVars();
+
+	Common::Point diff(_destX - _xCurrent, _destY - _yCurrent);
+	_xCurrent >>= 3; _yCurrent >>= 3;
+	_xDestCurrent >>= 3; _yDestCurrent >>= 3;
+	if ((_xCurrent == _xDestCurrent) && (_yCurrent == _yDestCurrent)) {
+		// Very close move
+		if (_xDestPos > 0)
+			add(RIGHT, _xDestPos);
+		else if (_xDestPos < 0)
+			add(LEFT, -_xDestPos);
+		else if (diff.y > 0)
+			add(DOWN, diff.y);
+		else
+			add(UP, -diff.y);
 
-			_inProgress = false;
-			result = PF_OK;
-			goto final_step;
-		}
+		result = PF_OK;
+		goto final_step;
+	}
 
-		// Path finding
+	// Path finding
 
-		_destX >>= 3;
-		_destY >>= 3;
-		_pSrc = &_layer[(_yCurrent + 1) * DECODED_PATHS_WIDTH + 1 + _xCurrent];
-		_pDest = &_layer[(_yDestCurrent + 1) * DECODED_PATHS_WIDTH + 1 + _xDestCurrent];
+	_destX >>= 3;
+	_destY >>= 3;
+	_pSrc = &_layer[(_yCurrent + 1) * DECODED_PATHS_WIDTH + 1 + _xCurrent];
+	_pDest = &_layer[(_yDestCurrent + 1) * DECODED_PATHS_WIDTH + 1 + _xDestCurrent];
 
-		// Flag starting/ending cells
-		*_pSrc = 1;
-		_destOccupied = *_pDest != 0;
-		result = _destOccupied ? PF_DEST_OCCUPIED : PF_OK;
-		*_pDest = 0;
+	// Flag starting/ending cells
+	*_pSrc = 1;
+	destOccupied = *_pDest != 0;
+	result = destOccupied ? PF_DEST_OCCUPIED : PF_OK;
+	*_pDest = 0;
 
-		// Set up the current pointer, adjusting away from edges if necessary
+	// Set up the sweep direction, adjusting away from edges if necessary
 
-		if (_xCurrent >= _xDestCurrent) {
-			_xChangeInc = -1;
-			_xChangeStart = ROOM_PATHS_WIDTH;
-		} else {
-			_xChangeInc = 1;
-			_xChangeStart = 1;
-		}
-
-		if (_yCurrent >= _yDestCurrent) {
-			_yChangeInc = -1;
-			_yChangeStart = ROOM_PATHS_HEIGHT;
-		} else {
-			_yChangeInc = 1;
-			_yChangeStart = 1;
-		}
+	if (_xCurrent >= _xDestCurrent) {
+		_xChangeInc = -1;
+		_xChangeStart = ROOM_PATHS_WIDTH;
+	} else {
+		_xChangeInc = 1;
+		_xChangeStart = 1;
 	}
 
-	// Major loop to populate data
-	_cellPopulated = false;
-
-	while (1) {
-		// Loop through to process cells in the given area
-		if (!returnFlag) _yCtr = 0;
-		while (returnFlag || (_yCtr < ROOM_PATHS_HEIGHT)) {
-			if (!returnFlag) _xCtr = 0;
-
-			while (returnFlag || (_xCtr < ROOM_PATHS_WIDTH)) {
-				if (!returnFlag) {
-					processCell(&_layer[(_yChangeStart + _yCtr * _yChangeInc) * DECODED_PATHS_WIDTH +
-						(_xChangeStart + _xCtr * _xChangeInc)]);
-					if (breakFlag && (_countdownCtr <= 0)) return PF_UNFINISHED;
-				} else {
-					returnFlag = false;
-				}
-				++_xCtr;
-			}
-			++_yCtr;
-		}
-
-		// If the destination cell has been filled in, then break out of loop
-		if (*_pDest != 0) break;
-
-		if (_cellPopulated) {
-			// At least one cell populated, so go repeat loop
-			_cellPopulated = false;
-		} else {
-			result = PF_PART_PATH;
-			scanFlag = true;
-			break;
-		}
+	if (_yCurrent >= _yDestCurrent) {
+		_yChangeInc = -1;
+		_yChangeStart = ROOM_PATHS_HEIGHT;
+	} else {
+		_yChangeInc = 1;
+		_yChangeStart = 1;
 	}
-	_inProgress = false;
 
-	if (scanFlag || _destOccupied) {
+	// Populate the cells, stopping once the destination cell has been filled in
+	scanFlag = !fill();
+	if (scanFlag)
+		result = PF_PART_PATH;
+
+	if (scanFlag || destOccupied) {
 		// Adjust the end point if necessary to stop character walking into occupied area
 
 		// Restore destination's occupied state if necessary
-		if (_destOccupied) {
+		if (destOccupied)
 			*_pDest = 0xffff;
-			_destOccupied = false;
-		}
 
 		// Scan through lines
 		v = 0xff;
@@ -4386,40 +4336,126 @@ Common::String PathFinder::getDebugInfo() const {
 	return buffer;
 }
 
-void PathFinder::processCell(uint16 *p) {
-	// Only process cells that are still empty
-	if (*p == 0) {
-		uint16 vMax = 0xffff;
-		uint16 vTemp;
-
-		// Check the surrounding cells (up,down,left,right) for values
-		// Up
-		vTemp = *(p - DECODED_PATHS_WIDTH);
-		if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
-		// Down
-		vTemp = *(p + DECODED_PATHS_WIDTH);
-		if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
-		// Left
-		vTemp = *(p - 1);
-		if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
-		// Right
-		vTemp = *(p + 1);
-		if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
-
-		if (vMax != 0xffff) {
-			// A surrounding cell with a value was found
-			++vMax;
-			*p = vMax;
-			_cellPopulated = true;
+#define SWEEP_SIZE (ROOM_PATHS_WIDTH * ROOM_PATHS_HEIGHT)
+#define SWEEP_FLAG_WORDS ((SWEEP_SIZE + 31) / 32)
+
+// Populates the walkable cells with their distance from the source cell.
+//
+// The original game did this by repeatedly sweeping over the whole room, in a
+// direction depending on where the destination lies, giving each empty cell
+// one more than the lowest value of its neighbours. Since a sweep can only
+// fill in cells next to ones filled in after they were last visited, those
+// cells are flagged instead, and each sweep just visits the flagged cells in
+// the same order. This results in exactly the same values, and hence routes,
+// as the full sweeps, while only touching each cell a few times.
+//
+// Returns true if the destination cell was reached.
+
+bool PathFinder::fill() {
+	// Cells to visit in the current and the next sweep, flagged by their
+	// position in the sweep order
+	uint32 flags[2][SWEEP_FLAG_WORDS];
+	uint32 *current = flags[0];
+	uint32 *next = flags[1];
+	int sweepPos;
+
+	// The first sweep has to visit all the empty cells that already have a
+	// neighbour with a value. Usually that's just the source cell, which can
+	// also lie in the padding below the room.
+	memset(current, 0, sizeof(flags[0]));
+	for (int y = 0; y < DECODED_PATHS_HEIGHT; ++y) {
+		for (int x = 0; x < DECODED_PATHS_WIDTH; ++x) {
+			uint16 v = _layer[y * DECODED_PATHS_WIDTH + x];
+			if ((v != 0) && (v != 0xffff)) {
+				flagNeighbour(x, y - 1, -1, current, next);
+				flagNeighbour(x, y + 1, -1, current, next);
+				flagNeighbour(x - 1, y, -1, current, next);
+				flagNeighbour(x + 1, y, -1, current, next);
+			}
 		}
+	}
 
-		_countdownCtr -= 3;
+	while (1) {
+		bool cellPopulated = false;
+		memset(next, 0, sizeof(flags[0]));
+
+		for (int wordCtr = 0; wordCtr < SWEEP_FLAG_WORDS; ++wordCtr) {
+			// Cells flagged while going through the word are visited as well
+			while (current[wordCtr] != 0) {
+				int bitCtr = 0;
+				while (!(current[wordCtr] & (1U << bitCtr)))
+					++bitCtr;
+				current[wordCtr] &= ~(1U << bitCtr);
+				sweepPos = (wordCtr << 5) + bitCtr;
+
+				int x = _xChangeStart + (sweepPos % ROOM_PATHS_WIDTH) * _xChangeInc;
+				int y = _yChangeStart + (sweepPos / ROOM_PATHS_WIDTH) * _yChangeInc;
+				uint16 *p = &_layer[y * DECODED_PATHS_WIDTH + x];
+
+				// Only process cells that are still empty
+				if (*p != 0)
+					continue;
+				*p = lowestNeighbour(p) + 1;
+				cellPopulated = true;
+
+				flagNeighbour(x, y - 1, sweepPos, current, next);
+				flagNeighbour(x, y + 1, sweepPos, current, next);
+				flagNeighbour(x - 1, y, sweepPos, current, next);
+				flagNeighbour(x + 1, y, sweepPos, current, next);
+			}
+		}
 
-	} else {
-		--_countdownCtr;
+		// If the destination cell has been filled in, then break out of loop
+		if (*_pDest != 0)
+			return true;
+
+		// Stop if no cell was populated during the sweep
+		if (!cellPopulated)
+			return false;
+
+		SWAP(current, next);
 	}
 }
 
+// Returns the lowest value of the surrounding cells (up, down, left, right),
+// or 0xffff if none of them has a value
+
+uint16 PathFinder::lowestNeighbour(const uint16 *p) const {
+	uint16 vMax = 0xffff;
+	uint16 vTemp;
+
+	// Up
+	vTemp = *(p - DECODED_PATHS_WIDTH);
+	if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
+	// Down
+	vTemp = *(p + DECODED_PATHS_WIDTH);
+	if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
+	// Left
+	vTemp = *(p - 1);
+	if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
+	// Right
+	vTemp = *(p + 1);
+	if ((vTemp != 0) && (vTemp < vMax)) vMax = vTemp;
+
+	return vMax;
+}
+
+// Flags an empty cell next to the one at the given sweep position as needing
+// a visit. Cells later on in the sweep order are visited during the current
+// sweep, and earlier ones during the next sweep
+
+void PathFinder::flagNeighbour(int x, int y, int sweepPos, uint32 *current, uint32 *next) const {
+	// The padding around the edges is never filled in
+	if ((x < 1) || (x > ROOM_PATHS_WIDTH) || (y < 1) || (y > ROOM_PATHS_HEIGHT))
+		return;
+	if (_layer[y * DECODED_PATHS_WIDTH + x] != 0)
+		return;
+
+	int pos = ((y - _yChangeStart) * _yChangeInc) * ROOM_PATHS_WIDTH + (x - _xChangeStart) * _xChangeInc;
+	uint32 *flags = (pos > sweepPos) ? current : next;
+	flags[pos >> 5] |= 1U << (pos & 31);
+}
+
 void PathFinder::scanLine(int numScans, int changeAmount, uint16 *&pEnd, int &v) {
 	uint16 *pTemp = _pDest;
 
@@ -4484,10 +4520,6 @@ void PathFinder::initVars() {
 		_yDestCurrent = 0;
 	if (_yDestCurrent >= (FULL_SCREEN_HEIGHT - MENUBAR_Y_SIZE))
 		_yDestCurrent = FULL_SCREEN_HEIGHT - MENUBAR_Y_SIZE - 1;
-
-	// Subtract an amount from the countdown counter to compensate for
-	// the time spent decompressing the walkable areas set for the room
-	_countdownCtr -= 700;
 }
 
 void PathFinder::saveToStream(Common::WriteStream *stream) {
@@ -4510,7 +4542,6 @@ void PathFinder::saveToStream(Common::WriteStream *stream) {
 }
 
 void PathFinder::loadFromStream(Common::ReadStream *stream) {
-	_inProgress = false;
 	_inUse = stream->readByte() != 0;
 
 	if (_inUse) {
@@ -129,22 +129,19 @@ private:
 	WalkingActionList _list;
 	RoomPathsDecompressedData _layer;
 	int _stepCtr;
-	bool _inProgress;
-	int _countdownCtr;
 	int16 _destX, _destY;
 	int16 _xPos, _yPos;
 	int16 _xCurrent, _yCurrent;
 	int16 _xDestPos, _yDestPos;
 	int16 _xDestCurrent, _yDestCurrent;
-	bool _destOccupied;
-	bool _cellPopulated;
 	uint16 *_pSrc, *_pDest;
 	int _xChangeInc, _xChangeStart;
 	int _yChangeInc, _yChangeStart;
-	int _xCtr, _yCtr;
 
 	void initVars();
-	void processCell(uint16 *p);
+	bool fill();
+	uint16 lowestNeighbour(const uint16 *p) const;
+	void flagNeighbour(int x, int y, int sweepPos, uint32 *current, uint32 *next) const;
 	void scanLine(int numScans, int changeAmount, uint16 *&pEnd, int &v);
 
 	void add(Direction dir, int steps) {
@@ -327,11 +327,6 @@ enum CursorType {CURSOR_ARROW = 0, CURSOR_DISK = 1, CURSOR_TIME_START = 2,
 #define ROOMNUM_CELLAR 42
 #define ROOMNUM_DINING_HALL 45
 
-// Countdown for # operations in path finder before breaking until next
-// tick - set it to 0 if you'd like all pathfinding to be done at once
-//#define PATHFIND_COUNTDOWN 4000
-#define PATHFIND_COUNTDOWN 0
-
 // Pixel record flags
 #define PIXELFLAG_HAS_TABLE 4
 
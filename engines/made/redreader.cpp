@@ -89,13 +89,23 @@ int LzhDecompressor::decompress(Common::SeekableReadStream &source, byte *dest,
 
 	buffer = (byte *) malloc(DICSIZ);
 
-	_source = &source;
-	_compSize = sourceLen;
+	// Read the compressed data into memory. Every 0xFFE bytes, it is
+	// interrupted by an unknown 16-bit value.
+	byte *packed = (byte *)malloc(sourceLen);
+	uint32 packedSize = 0;
+	while (packedSize < sourceLen) {
+		if (packedSize > 0)
+			source.skip(2); // skip unknown value
+		uint32 chunk = MIN<uint32>(sourceLen - packedSize, 0xFFE);
+		uint32 read = source.read(packed + packedSize, chunk);
+		packedSize += read;
+		if (read < chunk)
+			break;
+	}
+	_bits.reset(packed, packedSize);
 
 	count_len_depth = 0;
 
-	_blockPos = 0;
-
 	decode_start();
 	while (destLen > 0) {
 		bufsize = ((destLen > DICSIZ) ? DICSIZ : destLen);
@@ -105,48 +115,12 @@ int LzhDecompressor::decompress(Common::SeekableReadStream &source, byte *dest,
 		destLen -= bufsize;
 	}
 
+	free(packed);
 	free(buffer);
 
 	return 0;
 }
 
-byte LzhDecompressor::readByte() {
-	if (_blockPos == 0xFFE) {
-		_blockPos = 0;
-		_source->skip(2); // skip unknown value
-	}
-	byte temp = _source->readByte();
-	_blockPos++;
-	return temp;
-}
-
-void LzhDecompressor::fillbuf(int count) {
-	_bitbuf <<= count;
-	while (count > _bitcount) {
-		_bitbuf |= _subbitbuf << (count -= _bitcount);
-		if (_compSize != 0) {
-			_compSize--;
-			_subbitbuf = readByte();
-		} else _subbitbuf = 0;
-		_bitcount = 8;
-	}
-	_bitbuf |= _subbitbuf >> (_bitcount -= count);
-}
-
-uint LzhDecompressor::getbits(int count) {
-	uint x;
-	x = _bitbuf >> (BITBUFSIZ - count);
-	fillbuf(count);
-	return x;
-}
-
-void LzhDecompressor::init_getbits() {
-	_bitbuf = 0;
-	_subbitbuf = 0;
-	_bitcount = 0;
-	fillbuf(BITBUFSIZ);
-}
-
 void LzhDecompressor::decode_start() {
 	huf_decode_start();
 	decode_j = 0;
@@ -179,24 +153,25 @@ void LzhDecompressor::decode(uint count, byte buffer[]) {
 
 void LzhDecompressor::read_pt_len(int nn, int nbit, int i_special) {
 	int i, c, v;
-	unsigned int mask;
-	v = getbits(nbit);
+	unsigned int mask, bitbuf;
+	v = _bits.getBits(nbit);
 	if (v == 0) {
-		c = getbits(nbit);
+		c = _bits.getBits(nbit);
 		for (i = 0; i < nn; i++) _pt_len[i] = 0;
 		for (i = 0; i < 256; i++) _pt_table[i] = c;
 	} else {
 		i = 0;
 		while (i < v) {
-			c = _bitbuf >> (BITBUFSIZ - 3);
+			bitbuf = _bits.peekBits(BITBUFSIZ);
+			c = bitbuf >> (BITBUFSIZ - 3);
 			if (c == 7) {
 				mask = 1U << (BITBUFSIZ - 1 - 3);
-				while (mask & _bitbuf) {  mask >>= 1;  c++;  }
+				while (mask & bitbuf) {  mask >>= 1;  c++;  }
 			}
-			fillbuf((c < 7) ? 3 : c - 3);
+			_bits.skipBits((c < 7) ? 3 : c - 3);
 			_pt_len[i++] = c;
 			if (i == i_special) {
-				c = getbits(2);
+				c = _bits.getBits(2);
 				while (--c >= 0) _pt_len[i++] = 0;
 			}
 		}
@@ -206,31 +181,32 @@ void LzhDecompressor::read_pt_len(int nn, int nbit, int i_special) {
 }
 
 void LzhDecompressor::read_c_len() {
-	uint i, v;
+	uint i, v, bitbuf;
 	int c;
 	unsigned int mask;
-	v = getbits(CBIT);
+	v = _bits.getBits(CBIT);
 	if (v == 0) {
-		c = getbits(CBIT);
+		c = _bits.getBits(CBIT);
 		for (i = 0; i < NC; i++) _c_len[i] = 0;
 		for (i = 0; i < 4096; i++) _c_table[i] = c;
 	} else {
 		i = 0;
 		while (i < v) {
-			c = _pt_table[_bitbuf >> (BITBUFSIZ - 8)];
+			bitbuf = _bits.peekBits(BITBUFSIZ);
+			c = _pt_table[bitbuf >> (BITBUFSIZ - 8)];
 			if (c >= NT) {
 				mask = 1U << (BITBUFSIZ - 1 - 8);
 				do {
-					if (_bitbuf & mask) c = _right[c];
+					if (bitbuf & mask) c = _right[c];
 					else			   c = _left [c];
 					mask >>= 1;
 				} while (c >= NT);
 			}
-			fillbuf(_pt_len[c]);
+			_bits.skipBits(_pt_len[c]);
 			if (c <= 2) {
 				if	  (c == 0) c = 1;
-				else if (c == 1) c = getbits(4) + 3;
-				else			 c = getbits(CBIT) + 20;
+				else if (c == 1) c = _bits.getBits(4) + 3;
+				else			 c = _bits.getBits(CBIT) + 20;
 				while (--c >= 0) _c_len[i++] = 0;
 			} else _c_len[i++] = c - 2;
 		}
@@ -240,45 +216,46 @@ void LzhDecompressor::read_c_len() {
 }
 
 unsigned int LzhDecompressor::decode_c() {
-	uint j, mask;
+	uint j, mask, bitbuf;
 	if (_blocksize == 0) {
-		_blocksize = getbits(16);
+		_blocksize = _bits.getBits(16);
 		read_pt_len(NT, TBIT, 3);
 		read_c_len();
 		read_pt_len(NP, PBIT, -1);
 	}
 	_blocksize--;
-	j = _c_table[_bitbuf >> (BITBUFSIZ - 12)];
+	bitbuf = _bits.peekBits(BITBUFSIZ);
+	j = _c_table[bitbuf >> (BITBUFSIZ - 12)];
 	if (j >= NC) {
 		mask = 1U << (BITBUFSIZ - 1 - 12);
 		do {
-			if (_bitbuf & mask) j = _right[j];
+			if (bitbuf & mask) j = _right[j];
 			else			   j = _left [j];
 			mask >>= 1;
 		} while (j >= NC);
 	}
-	fillbuf(_c_len[j]);
+	_bits.skipBits(_c_len[j]);
 	return j;
 }
 
 unsigned int LzhDecompressor::decode_p() {
-	unsigned int j, mask;
-	j = _pt_table[_bitbuf >> (BITBUFSIZ - 8)];
+	unsigned int j, mask, bitbuf;
+	bitbuf = _bits.peekBits(BITBUFSIZ);
+	j = _pt_table[bitbuf >> (BITBUFSIZ - 8)];
 	if (j >= NP) {
 		mask = 1U << (BITBUFSIZ - 1 - 8);
 		do {
-			if (_bitbuf & mask) j = _right[j];
+			if (bitbuf & mask) j = _right[j];
 			else			   j = _left [j];
 			mask >>= 1;
 		} while (j >= NP);
 	}
-	fillbuf(_pt_len[j]);
-	if (j != 0) j = (1U << (j - 1)) + getbits(j - 1);
+	_bits.skipBits(_pt_len[j]);
+	if (j != 0) j = (1U << (j - 1)) + _bits.getBits(j - 1);
 	return j;
 }
 
 void LzhDecompressor::huf_decode_start() {
-	init_getbits();
 	_blocksize = 0;
 }
 
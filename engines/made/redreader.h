@@ -27,6 +27,7 @@
 #define MADE_REDREADER_H
 
 #include "common/util.h"
+#include "common/bitreader.h"
 #include "common/file.h"
 #include "common/stream.h"
 
@@ -64,12 +65,8 @@ public:
 	~LzhDecompressor();
 	int decompress(Common::SeekableReadStream &source, byte *dest, uint32 compSize, uint32 origSize);
 private:
-	Common::SeekableReadStream *_source;
-	uint32 _compSize, _blockPos;
+	Common::BitReaderMSB _bits;
 
-	uint16 _bitbuf;
-	uint _subbitbuf;
-	int _bitcount;
 	uint16 _left[2 * NC - 1], _right[2 * NC - 1];
 	byte _c_len[NC], _pt_len[NPT];
 	uint _blocksize;
@@ -82,11 +79,6 @@ private:
 	int decode_i, decode_j;
 	int count_len_depth;
 
-	byte readByte();
-
-	void fillbuf(int count);
-	uint getbits(int count);
-	void init_getbits();
 	void decode_start();
 	void decode(uint count, byte text[]);
 	void huf_decode_start();
@@ -279,6 +279,7 @@ bool Scene::playTitle(int title, int time, int mode) {
 	memset((byte *)backBufferSurface->pixels, 0,  backBufferSurface->w *  backBufferSurface->h);
 	_vm->_system->copyRectToScreen((byte *)backBufferSurface->pixels, backBufferSurface->w, 0, 0,
 							  backBufferSurface->w, backBufferSurface->h);
+	_vm->_render->invalidateScreen();
 
 	return interrupted;
 }
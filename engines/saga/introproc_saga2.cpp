@@ -30,6 +30,7 @@
 #include "saga/saga.h"
 #include "saga/scene.h"
 #include "saga/gfx.h"
+#include "saga/render.h"
 
 #include "sound/mixer.h"
 #include "graphics/surface.h"
@@ -122,6 +123,8 @@ void Scene::playMovie(const char *filename) {
 
 		_vm->_system->delayMillis(10);
 	}
+
+	_vm->_render->invalidateScreen();
 }
 
 } // End of namespace Saga
@@ -58,6 +58,9 @@ Render::Render(SagaEngine *vm, OSystem *system) {
 
 	_backGroundSurface.create(_vm->getDisplayInfo().width, _vm->getDisplayInfo().height, 1);
 
+	_shadowScreen = new Graphics::ShadowScreen(_vm->getDisplayInfo().width, _vm->getDisplayInfo().height);
+	_drawnPixels = 0;
+
 	_flags = 0;
 
 	_initialized = true;
@@ -69,6 +72,7 @@ Render::~Render() {
 #endif
 
 	_backGroundSurface.free();
+	delete _shadowScreen;
 
 	_initialized = false;
 }
@@ -168,8 +172,8 @@ void Render::drawScene() {
 #ifdef SAGA_DEBUG
 	// Display rendering information
 	if (_flags & RF_SHOW_FPS) {
-		char txtBuffer[20];
-		sprintf(txtBuffer, "%d", _fps);
+		char txtBuffer[24];
+		sprintf(txtBuffer, "%d %u", _fps, _drawnPixels);
 		textPoint.x = _vm->_gfx->getBackBufferWidth() - _vm->_font->getStringWidth(kKnownFontSmall, txtBuffer, 0, kFontOutline);
 		textPoint.y = 2;
 
@@ -259,15 +263,23 @@ void Render::restoreChangedRects() {
 
 void Render::drawDirtyRects() {
 	if (!_fullRefresh) {
+		_drawnPixels = 0;
 		Common::List<Common::Rect>::const_iterator it;
 		for (it = _dirtyRects.begin(); it != _dirtyRects.end(); ++it) {
 			//_backGroundSurface.frameRect(*it, 2);		// DEBUG
-			if (_vm->_interface->getFadeMode() != kFadeOut)
+			if (_vm->_interface->getFadeMode() != kFadeOut) {
 				g_system->copyRectToScreen(_vm->_gfx->getBackBufferPixels(), _backGroundSurface.w, it->left, it->top, it->width(), it->height());
+				_drawnPixels += it->width() * it->height();
+			}
 		}
+
+		// The shadow screen isn't kept up to date in this mode
+		_shadowScreen->invalidate();
 	} else {
-		_system->copyRectToScreen(_vm->_gfx->getBackBufferPixels(), _vm->_gfx->getBackBufferWidth(), 0, 0,
+		_shadowScreen->resetStats();
+		_shadowScreen->copyRectToScreen(_vm->_gfx->getBackBufferPixels(), _vm->_gfx->getBackBufferPitch(), 0, 0,
 								  _vm->_gfx->getBackBufferWidth(), _vm->_gfx->getBackBufferHeight());
+		_drawnPixels = _shadowScreen->getPixelsCopied();
 	}
 
 	_dirtyRects.clear();
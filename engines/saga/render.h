@@ -31,6 +31,7 @@
 #include "saga/sprite.h"
 #include "saga/gfx.h"
 #include "common/list.h"
+#include "graphics/shadowscreen.h"
 
 namespace Saga {
 
@@ -96,6 +97,17 @@ public:
 	void drawDirtyRects();
 	void restoreChangedRects();
 
+	// Call this after drawing to the screen directly, so that the whole
+	// back buffer is copied to the screen for the next frame
+	void invalidateScreen() {
+		_shadowScreen->invalidate();
+	}
+
+	// Returns the number of pixels copied to the screen for the last frame
+	uint32 getDrawnPixels() const {
+		return _drawnPixels;
+	}
+
 private:
 #ifdef SAGA_DEBUG
 	static void fpsTimerCallback(void *refCon);
@@ -113,6 +125,10 @@ private:
 	// Module data
 	Surface _backGroundSurface;
 
+	// Only copies the parts of the back buffer that changed to the screen
+	Graphics::ShadowScreen *_shadowScreen;
+	uint32 _drawnPixels;
+
 	uint32 _flags;
 };
 
@@ -0,0 +1,316 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "engines/saveindex.h"
+
+#include "common/algorithm.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "graphics/colormasks.h"
+#include "graphics/conversion.h"
+#include "graphics/surface.h"
+#include "graphics/thumbnail.h"
+
+#define SAVEINDEX_VERSION 3
+
+static const uint32 kIndexTag = MKID_BE('SIDX');
+static const uint32 kEntriesEndTag = MKID_BE('SEND');
+
+SaveStateIndex::SaveStateIndex(const Common::String &target, Common::SaveFileManager *saveFileMan)
+	: _target(target), _saveFileMan(saveFileMan), _modified(false) {
+	if (!_saveFileMan)
+		_saveFileMan = g_system->getSavefileManager();
+}
+
+Common::String SaveStateIndex::getIndexName(const Common::String &target) {
+	// The name must not match the patterns engines use to list their
+	// savegames, like "target.???" or "target.*".
+	return target + "-saves.idx";
+}
+
+Common::String SaveStateIndex::getThumbnailName(const Common::String &target, int slot) {
+	// Same as for getIndexName.
+	return Common::String::format("%s-saves.t%02d", target.c_str(), slot);
+}
+
+Common::String SaveStateIndex::readString(Common::ReadStream &in) {
+	Common::String str;
+	for (uint16 size = in.readUint16LE(); size > 0 && !in.eos(); --size)
+		str += (char)in.readByte();
+	return str;
+}
+
+static void writeString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint16LE(str.size());
+	out.write(str.c_str(), str.size());
+}
+
+Graphics::Surface *SaveStateIndex::convertThumbnail(const Graphics::Surface &thumb) {
+	Graphics::Surface *converted = new Graphics::Surface();
+	converted->create(thumb.w, thumb.h, sizeof(OverlayColor));
+	Graphics::crossBlit((byte *)converted->pixels, (const byte *)thumb.pixels, converted->pitch, thumb.pitch,
+	                    thumb.w, thumb.h, g_system->getOverlayFormat(), Graphics::createPixelFormat<565>());
+	return converted;
+}
+
+bool SaveStateIndex::writeThumbnail(int slot, const Graphics::Surface &thumb) {
+	// Thumbnails are stored as RGB565, like in the savegames, whatever the
+	// overlay format is. Graphics::loadThumbnail converts them back.
+	Graphics::Surface converted;
+	converted.create(thumb.w, thumb.h, 2);
+	Graphics::crossBlit((byte *)converted.pixels, (const byte *)thumb.pixels, converted.pitch, thumb.pitch,
+	                    thumb.w, thumb.h, Graphics::createPixelFormat<565>(), g_system->getOverlayFormat());
+
+	// Thumbnails are written along with savegames, which may be autosaves
+	Common::String filename = getThumbnailName(_target, slot);
+	Common::OutSaveFile *out = _saveFileMan->openForSavingInBackground(filename);
+	bool success = out != 0;
+	if (out) {
+		Graphics::saveThumbnail(*out, converted);
+		out->finalize();
+		success = !out->err();
+		delete out;
+	}
+
+	converted.free();
+
+	if (!success)
+		_saveFileMan->removeSavefile(filename);
+	return success;
+}
+
+bool SaveStateIndex::readEntries(Common::SeekableReadStream &in) {
+	if (in.readUint32BE() != kIndexTag || in.readUint32BE() != SAVEINDEX_VERSION)
+		return false;
+
+	uint32 count = in.readUint32LE();
+	for (uint32 i = 0; i < count && !in.eos() && !in.err(); ++i) {
+		Entry entry;
+		entry.file = readString(in);
+		entry.slot = in.readSint32LE();
+		entry.flags = in.readByte();
+
+		for (uint16 keys = in.readUint16LE(); keys > 0 && !in.eos(); --keys) {
+			Common::String key = readString(in);
+			entry.desc.setVal(key, readString(in));
+		}
+
+		_entries.push_back(entry);
+	}
+
+	return in.readUint32BE() == kEntriesEndTag && !in.eos() && !in.err();
+}
+
+bool SaveStateIndex::load() {
+	_entries.clear();
+	_modified = false;
+
+	Common::InSaveFile *in = _saveFileMan->openForLoading(getIndexName(_target));
+	bool success = in && readEntries(*in);
+	delete in;
+
+	if (!success) {
+		_entries.clear();
+		// Write a new index as soon as anything is added.
+		_modified = true;
+	}
+
+	return success;
+}
+
+bool SaveStateIndex::save() {
+	if (!_modified)
+		return true;
+
+	Common::String filename = getIndexName(_target);
+
+	// The index is written along with savegames, which may be autosaves
+	Common::OutSaveFile *out = _saveFileMan->openForSavingInBackground(filename);
+	if (!out)
+		return false;
+
+	out->writeUint32BE(kIndexTag);
+	out->writeUint32BE(SAVEINDEX_VERSION);
+	out->writeUint32LE(_entries.size());
+
+	for (EntryArray::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		writeString(*out, i->file);
+		out->writeSint32LE(i->slot);
+		out->writeByte(i->flags);
+
+		out->writeUint16LE(i->desc.size());
+		for (SaveStateDescriptor::const_iterator key = i->desc.begin(); key != i->desc.end(); ++key) {
+			writeString(*out, key->_key);
+			writeString(*out, key->_value);
+		}
+	}
+
+	out->writeUint32BE(kEntriesEndTag);
+
+	out->finalize();
+	bool success = !out->err();
+	delete out;
+
+	if (!success) {
+		// Don't leave a partial index behind.
+		_saveFileMan->removeSavefile(filename);
+		return false;
+	}
+
+	_modified = false;
+	return true;
+}
+
+int SaveStateIndex::findSlot(int slot) const {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (_entries[i].slot == slot)
+			return i;
+	}
+	return -1;
+}
+
+int SaveStateIndex::findFile(const Common::String &file) const {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (_entries[i].file == file)
+			return i;
+	}
+	return -1;
+}
+
+bool SaveStateIndex::matches(const Common::StringArray &files) const {
+	if (files.size() != _entries.size())
+		return false;
+
+	for (Common::StringArray::const_iterator file = files.begin(); file != files.end(); ++file) {
+		if (findFile(*file) < 0)
+			return false;
+	}
+
+	return true;
+}
+
+void SaveStateIndex::prune(const Common::StringArray &files) {
+	for (uint i = 0; i < _entries.size(); ) {
+		if (Common::find(files.begin(), files.end(), _entries[i].file) == files.end())
+			removeEntry(i);
+		else
+			++i;
+	}
+}
+
+bool SaveStateIndex::hasSave(const Common::String &file) const {
+	return findFile(file) >= 0;
+}
+
+void SaveStateIndex::removeEntry(uint i) {
+	if (_entries[i].flags & kFlagThumbnail)
+		_saveFileMan->removeSavefile(getThumbnailName(_target, _entries[i].slot));
+	_entries.remove_at(i);
+	_modified = true;
+}
+
+void SaveStateIndex::setSave(const Common::String &file, const SaveStateDescriptor &desc, bool metaInfos) {
+	Entry entry;
+	entry.file = file;
+	entry.slot = atoi(desc.save_slot().c_str());
+	entry.flags = metaInfos ? kFlagMetaInfos : 0;
+	entry.desc = desc;
+	entry.desc.setThumbnail(0);
+
+	const Graphics::Surface *thumb = desc.getThumbnail();
+	if (metaInfos && thumb && thumb->bytesPerPixel == 2 && writeThumbnail(entry.slot, *thumb))
+		entry.flags |= kFlagThumbnail;
+
+	int old = findFile(file);
+	if (old >= 0) {
+		// Keep the thumbnail just written.
+		_entries[old].flags &= ~kFlagThumbnail;
+		removeEntry(old);
+	}
+
+	// Keep the entries sorted by slot.
+	uint pos = 0;
+	while (pos < _entries.size() && _entries[pos].slot < entry.slot)
+		++pos;
+	_entries.insert_at(pos, entry);
+	_modified = true;
+}
+
+void SaveStateIndex::removeSave(const Common::String &file) {
+	int i = findFile(file);
+	if (i >= 0)
+		removeEntry(i);
+}
+
+SaveStateList SaveStateIndex::getSaveList() const {
+	SaveStateList saveList;
+	for (EntryArray::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		saveList.push_back(SaveStateDescriptor(i->slot, i->desc.description()));
+	return saveList;
+}
+
+bool SaveStateIndex::getMetaInfos(int slot, SaveStateDescriptor &desc) const {
+	int i = findSlot(slot);
+	if (i < 0 || !(_entries[i].flags & kFlagMetaInfos))
+		return false;
+
+	desc = _entries[i].desc;
+
+	if (_entries[i].flags & kFlagThumbnail) {
+		Common::InSaveFile *in = _saveFileMan->openForLoading(getThumbnailName(_target, slot));
+		Graphics::Surface *thumb = new Graphics::Surface();
+		if (!in || !Graphics::loadThumbnail(*in, *thumb)) {
+			delete in;
+			delete thumb;
+			return false;
+		}
+		delete in;
+		desc.setThumbnail(thumb);
+	}
+
+	return true;
+}
+
+bool SaveStateIndex::queryMetaInfos(const Common::String &target, int slot, SaveStateDescriptor &desc) {
+	SaveStateIndex index(target);
+	return index.load() && index.getMetaInfos(slot, desc);
+}
+
+void SaveStateIndex::updateSave(const Common::String &target, const Common::String &file, const SaveStateDescriptor &desc, bool metaInfos) {
+	SaveStateIndex index(target);
+	if (index.load()) {
+		index.setSave(file, desc, metaInfos);
+		index.save();
+	}
+}
+
+void SaveStateIndex::removeSave(const Common::String &target, const Common::String &file) {
+	SaveStateIndex index(target);
+	if (index.load()) {
+		index.removeSave(file);
+		index.save();
+	}
+}
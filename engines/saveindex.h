@@ -0,0 +1,192 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef ENGINES_SAVEINDEX_H
+#define ENGINES_SAVEINDEX_H
+
+#include "common/array.h"
+#include "common/str.h"
+#include "common/str-array.h"
+
+#include "engines/savestate.h"
+
+namespace Common {
+	class ReadStream;
+	class SaveFileManager;
+	class SeekableReadStream;
+}
+
+namespace Graphics {
+	struct Surface;
+}
+
+/**
+ * Index of the savegames of a target.
+ *
+ * The index keeps the meta infos of every savegame of a target in a single
+ * savefile, so that listing the savegames and showing their description,
+ * date and play time doesn't require opening each savegame. Thumbnails are
+ * kept in one small savefile per slot, so that a savegame can be updated
+ * without reading and writing the thumbnails of all others.
+ *
+ * The index is only a cache. Engines keep it up to date when they write or
+ * delete a savegame, using the meta infos they have at hand while saving.
+ * listSaves() checks the index against the names of the savegames that
+ * actually exist, without opening them. Savegames the index doesn't know
+ * of are read the old way and added to it, and a missing or corrupt index
+ * is simply rebuilt. A savegame overwritten without updating the index,
+ * e.g. because ScummVM crashed in between, keeps its old entry until it is
+ * saved again.
+ */
+class SaveStateIndex {
+public:
+	/**
+	 * @param target      Target whose savegames are indexed.
+	 * @param saveFileMan Savefile manager to use, or 0 for the one of
+	 *                    g_system.
+	 */
+	SaveStateIndex(const Common::String &target, Common::SaveFileManager *saveFileMan = 0);
+
+	/** Returns the name of the index savefile of a target. */
+	static Common::String getIndexName(const Common::String &target);
+
+	/** Returns the name of the savefile holding the thumbnail of a slot. */
+	static Common::String getThumbnailName(const Common::String &target, int slot);
+
+	/**
+	 * Reads the index of the target. Thumbnails are only read when the meta
+	 * infos of a savegame are looked up.
+	 *
+	 * @return false if the index is missing or corrupt. The index is
+	 *         empty then.
+	 */
+	bool load();
+
+	/**
+	 * Writes the index, if anything changed since it was read.
+	 *
+	 * @return false if the index couldn't be written.
+	 */
+	bool save();
+
+	/**
+	 * Checks whether the index describes exactly the given savegames.
+	 *
+	 * @param files File names of the savegames of the target.
+	 */
+	bool matches(const Common::StringArray &files) const;
+
+	/** Drops all savegames that aren't in the given list of file names. */
+	void prune(const Common::StringArray &files);
+
+	/** Returns whether the index contains the savegame with the given file name. */
+	bool hasSave(const Common::String &file) const;
+
+	/**
+	 * Adds a savegame to the index, or replaces it. The thumbnail of desc,
+	 * if any, is written right away.
+	 *
+	 * @param file      File name of the savegame.
+	 * @param desc      Description of the savegame.
+	 * @param metaInfos Whether desc contains all meta infos, as returned by
+	 *                  MetaEngine::querySaveMetaInfos, or only the slot and
+	 *                  the description.
+	 */
+	void setSave(const Common::String &file, const SaveStateDescriptor &desc, bool metaInfos);
+
+	/** Removes a savegame from the index. */
+	void removeSave(const Common::String &file);
+
+	/**
+	 * Returns the savegames in the index, sorted by slot, with only their
+	 * slot and description set, as returned by MetaEngine::listSaves.
+	 */
+	SaveStateList getSaveList() const;
+
+	/**
+	 * Looks up the meta infos of a savegame, including its thumbnail.
+	 *
+	 * @return false if the index doesn't contain the meta infos of the slot.
+	 */
+	bool getMetaInfos(int slot, SaveStateDescriptor &desc) const;
+
+	/**
+	 * Reads the meta infos of a single savegame from the index of the
+	 * target.
+	 *
+	 * @return false if the index doesn't contain the meta infos of the slot.
+	 */
+	static bool queryMetaInfos(const Common::String &target, int slot, SaveStateDescriptor &desc);
+
+	/**
+	 * Stores the meta infos of a savegame in the index of the target, if it
+	 * has one. Engines call this after writing a savegame.
+	 *
+	 * @param metaInfos Whether desc contains all meta infos, see setSave().
+	 */
+	static void updateSave(const Common::String &target, const Common::String &file, const SaveStateDescriptor &desc, bool metaInfos = true);
+
+	/**
+	 * Removes a savegame from the index of the target, if it has one.
+	 * Engines call this when deleting a savegame.
+	 */
+	static void removeSave(const Common::String &target, const Common::String &file);
+
+	/**
+	 * Converts a thumbnail as written to savegames, i.e. in RGB565, into the
+	 * overlay format used by SaveStateDescriptor.
+	 */
+	static Graphics::Surface *convertThumbnail(const Graphics::Surface &thumb);
+
+private:
+	enum {
+		kFlagMetaInfos = 1 << 0,
+		kFlagThumbnail = 1 << 1
+	};
+
+	struct Entry {
+		Common::String file;
+		int slot;
+		byte flags;
+		SaveStateDescriptor desc; ///< Without the thumbnail
+	};
+
+	typedef Common::Array<Entry> EntryArray;
+
+	bool readEntries(Common::SeekableReadStream &in);
+	bool writeThumbnail(int slot, const Graphics::Surface &thumb);
+	void removeEntry(uint i);
+	int findSlot(int slot) const;
+	int findFile(const Common::String &file) const;
+
+	static Common::String readString(Common::ReadStream &in);
+
+	Common::String _target;
+	Common::SaveFileManager *_saveFileMan;
+	EntryArray _entries; ///< Sorted by slot
+	bool _modified;
+};
+
+#endif
@@ -1163,6 +1163,7 @@ bool Console::cmdSaveGame(int argc, const char **argv) {
 		DebugPrintf("Note: Game state has %d open file handles.\n", result);
 
 	Common::SaveFileManager *saveFileMan = g_engine->getSaveFileManager();
+	_engine->invalidateSaveIndex(argv[1]);
 	Common::OutSaveFile *out = saveFileMan->openForSaving(argv[1]);
 	const char *version = "";
 	if (!out) {
@@ -48,59 +48,24 @@ int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, ui
 	return (src->eos() || src->err()) ? 1 : 0;
 }
 
+Decompressor::~Decompressor() {
+	delete[] _packedData;
+}
+
 void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
-	_src = src;
+	delete[] _packedData;
+	_packedData = new byte[nPacked];
+
+	// Reading beyond the packed data returns zero bits
+	uint32 size = src->read(_packedData, nPacked);
+	_bitsMSB.reset(_packedData, size);
+	_bitsLSB.reset(_packedData, size);
+
 	_dest = dest;
 	_szPacked = nPacked;
 	_szUnpacked = nUnpacked;
-	_nBits = 0;
-	_dwRead = _dwWrote = 0;
-	_dwBits = 0;
-}
-
-void Decompressor::fetchBitsMSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
-		_nBits += 8;
-		_dwRead++;
-	}
-}
-
-uint32 Decompressor::getBitsMSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsMSB();
-	uint32 ret = _dwBits >> (32 - n);
-	_dwBits <<= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte Decompressor::getByteMSB() {
-	return getBitsMSB(8);
-}
-
-void Decompressor::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
-		_nBits += 8;
-		_dwRead++;
-	}
-}
-
-uint32 Decompressor::getBitsLSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~((~0) << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte Decompressor::getByteLSB() {
-	return getBitsLSB(8);
+	_dwWrote = 0;
 }
 
 void Decompressor::putByte(byte b) {
@@ -116,20 +81,26 @@ int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPac
 	int16 c;
 	uint16 terminator;
 
-	numnodes = _src->readByte();
-	terminator = _src->readByte() | 0x100;
-	_nodes = new byte [numnodes << 1];
-	_src->read(_nodes, numnodes << 1);
+	if (nPacked < 2)
+		return 1;
+
+	numnodes = _packedData[0];
+	terminator = _packedData[1] | 0x100;
+	if (nPacked < 2 + (uint32)(numnodes << 1))
+		return 1;
+
+	// The tree is followed by the bit stream
+	_nodes = _packedData + 2;
+	_bitsMSB.reset(_nodes + (numnodes << 1), nPacked - 2 - (numnodes << 1));
 
 	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
 		putByte(c);
 
-	delete[] _nodes;
 	return _dwWrote == _szUnpacked ? 0 : 1;
 }
 
 int16 DecompressorHuffman::getc2() {
-	byte *node = _nodes;
+	const byte *node = _nodes;
 	int16 next;
 	while (node[1]) {
 		if (getBitsMSB(1)) {
@@ -27,6 +27,8 @@
 #define SCI_DECOMPRESSOR_H
 
 #include "common/scummsys.h"
+#include "common/bitreader.h"
+#include "common/util.h"
 
 namespace Common { class ReadStream; }
 
@@ -52,8 +54,8 @@ enum ResourceCompression {
  */
 class Decompressor {
 public:
-	Decompressor() {}
-	virtual ~Decompressor() {}
+	Decompressor() : _packedData(0) {}
+	virtual ~Decompressor();
 
 
 	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
@@ -61,6 +63,7 @@ public:
 protected:
 	/**
 	 * Initialize decompressor.
+	 * Reads the packed data from the source stream into memory.
 	 * @param src		source stream to read from
 	 * @param dest		destination stream to write to
 	 * @param nPacked	size of packed data
@@ -70,30 +73,36 @@ protected:
 	virtual void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	/**
-	 * Get a number of bits from _src stream, starting with the most
-	 * significant unread bit of the current four byte block.
+	 * Get a number of bits from the packed data, starting with the most
+	 * significant unread bit of the current byte.
 	 * @param n		number of bits to get
 	 * @return n-bits number
 	 */
-	uint32 getBitsMSB(int n);
+	uint32 getBitsMSB(int n) {
+		return _bitsMSB.getBits(n);
+	}
 
 	/**
-	 * Get a number of bits from _src stream, starting with the least
-	 * significant unread bit of the current four byte block.
+	 * Get a number of bits from the packed data, starting with the least
+	 * significant unread bit of the current byte.
 	 * @param n		number of bits to get
 	 * @return n-bits number
 	 */
-	uint32 getBitsLSB(int n);
+	uint32 getBitsLSB(int n) {
+		return _bitsLSB.getBits(n);
+	}
 
 	/**
-	 * Get one byte from _src stream.
+	 * Get one byte from the packed data.
 	 * @return byte
 	 */
-	byte getByteMSB();
-	byte getByteLSB();
+	byte getByteMSB() {
+		return _bitsMSB.getByte();
+	}
 
-	void fetchBitsMSB();
-	void fetchBitsLSB();
+	byte getByteLSB() {
+		return _bitsLSB.getByte();
+	}
 
 	/**
 	 * Write one byte into _dest stream
@@ -107,16 +116,15 @@ protected:
 	 * and there is no more data in _src.
 	 */
 	bool isFinished() {
-		return (_dwWrote == _szUnpacked) && (_dwRead >= _szPacked);
+		return (_dwWrote == _szUnpacked) && (MAX(_bitsMSB.bytesFetched(), _bitsLSB.bytesFetched()) >= _szPacked);
 	}
 
-	uint32 _dwBits;		///< bits buffer
-	byte _nBits;		///< number of unread bits in _dwBits
+	Common::BitReaderMSB _bitsMSB;	///< bit reader for MSB first data
+	Common::BitReaderLSB _bitsLSB;	///< bit reader for LSB first data
+	byte *_packedData;	///< the compressed data
 	uint32 _szPacked;	///< size of the compressed data
 	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
 	uint32 _dwWrote;	///< number of bytes written to _dest
-	Common::ReadStream *_src;
 	byte *_dest;
 };
 
@@ -130,7 +138,7 @@ public:
 protected:
 	int16 getc2();
 
-	byte *_nodes;
+	const byte *_nodes;
 };
 
 /**
@@ -24,6 +24,7 @@
  */
 
 #include "engines/advancedDetector.h"
+#include "engines/saveindex.h"
 #include "base/plugins.h"
 #include "common/file.h"
 #include "common/savefile.h"
@@ -650,85 +651,95 @@ SaveStateList SciMetaEngine::listSaves(const char *target) const {
 	pattern += ".???";
 
 	filenames = saveFileMan->listSavefiles(pattern);
-	sort(filenames.begin(), filenames.end());	// Sort (hopefully ensuring we are sorted numerically..)
 
-	SaveStateList saveList;
-	int slotNum = 0;
-	for (Common::StringArray::const_iterator file = filenames.begin(); file != filenames.end(); ++file) {
+	// Only keep the files with a valid slot number
+	for (uint i = 0; i < filenames.size(); ) {
 		// Obtain the last 3 digits of the filename, since they correspond to the save slot
-		slotNum = atoi(file->c_str() + file->size() - 3);
-
-		if (slotNum >= 0 && slotNum <= 99) {
-			Common::InSaveFile *in = saveFileMan->openForLoading(*file);
-			if (in) {
-				SavegameMetadata meta;
-				if (!get_savegame_metadata(in, &meta)) {
-					// invalid
-					delete in;
-					continue;
-				}
-				saveList.push_back(SaveStateDescriptor(slotNum, meta.name));
-				delete in;
-			}
-		}
+		int slotNum = atoi(filenames[i].c_str() + filenames[i].size() - 3);
+		if (slotNum >= 0 && slotNum <= 99)
+			++i;
+		else
+			filenames.remove_at(i);
 	}
 
-	return saveList;
-}
+	// Use the index if it describes exactly these savegames
+	SaveStateIndex index(target);
+	if (index.load() && index.matches(filenames))
+		return index.getSaveList();
 
-SaveStateDescriptor SciMetaEngine::querySaveMetaInfos(const char *target, int slot) const {
-	Common::String fileName = Common::String::format("%s.%03d", target, slot);
-	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(fileName);
+	// Otherwise, only read the savegames the index doesn't know of yet
+	index.prune(filenames);
 
-	if (in) {
-		SavegameMetadata meta;
-		if (!get_savegame_metadata(in, &meta)) {
-			// invalid
-			delete in;
+	for (Common::StringArray::const_iterator file = filenames.begin(); file != filenames.end(); ++file) {
+		if (index.hasSave(*file))
+			continue;
 
-			SaveStateDescriptor desc(slot, "Invalid");
-			return desc;
+		int slotNum = atoi(file->c_str() + file->size() - 3);
+		Common::InSaveFile *in = saveFileMan->openForLoading(*file);
+		if (in) {
+			SavegameMetadata meta;
+			if (get_savegame_metadata(in, &meta))
+				index.setSave(*file, SaveStateDescriptor(slotNum, meta.name), false);
+			delete in;
 		}
+	}
+
+	index.save();
+	return index.getSaveList();
+}
 
-		SaveStateDescriptor desc(slot, meta.name);
+static bool readSaveMetaInfos(const char *target, int slot, SaveStateDescriptor &desc) {
+	Common::String fileName = Common::String::format("%s.%03d", target, slot);
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(fileName);
 
-		Graphics::Surface *thumbnail = new Graphics::Surface();
-		assert(thumbnail);
-		if (!Graphics::loadThumbnail(*in, *thumbnail)) {
-			delete thumbnail;
-			thumbnail = 0;
-		}
+	if (!in)
+		return false;
 
-		desc.setThumbnail(thumbnail);
+	SavegameMetadata meta;
+	if (!get_savegame_metadata(in, &meta)) {
+		// invalid
+		delete in;
 
-		desc.setDeletableFlag(true);
-		desc.setWriteProtectedFlag(false);
+		desc = SaveStateDescriptor(slot, "Invalid");
+		return false;
+	}
 
-		int day = (meta.saveDate >> 24) & 0xFF;
-		int month = (meta.saveDate >> 16) & 0xFF;
-		int year = meta.saveDate & 0xFFFF;
+	desc = SaveStateDescriptor(slot, meta.name);
 
-		desc.setSaveDate(year, month, day);
+	Graphics::Surface *thumbnail = new Graphics::Surface();
+	assert(thumbnail);
+	if (!Graphics::loadThumbnail(*in, *thumbnail)) {
+		delete thumbnail;
+		thumbnail = 0;
+	}
 
-		int hour = (meta.saveTime >> 16) & 0xFF;
-		int minutes = (meta.saveTime >> 8) & 0xFF;
+	desc.setThumbnail(thumbnail);
 
-		desc.setSaveTime(hour, minutes);
+	set_savegame_metainfos(desc, meta);
 
-		desc.setPlayTime(meta.playTime * 1000);
+	delete in;
 
-		delete in;
+	return true;
+}
 
+SaveStateDescriptor SciMetaEngine::querySaveMetaInfos(const char *target, int slot) const {
+	SaveStateDescriptor desc;
+	if (SaveStateIndex::queryMetaInfos(target, slot, desc))
 		return desc;
+
+	if (readSaveMetaInfos(target, slot, desc)) {
+		// Remember the meta infos, so the savegame needn't be opened next time
+		SaveStateIndex::updateSave(target, Common::String::format("%s.%03d", target, slot), desc);
 	}
 
-	return SaveStateDescriptor();
+	return desc;
 }
 
 int SciMetaEngine::getMaximumSaveSlot() const { return 99; }
 
 void SciMetaEngine::removeSaveState(const char *target, int slot) const {
 	Common::String fileName = Common::String::format("%s.%03d", target, slot);
+	SaveStateIndex::removeSave(target, fileName);
 	g_system->getSavefileManager()->removeSavefile(fileName);
 }
 
@@ -761,7 +772,8 @@ Common::Error SciEngine::saveGameState(int slot, const char *desc) {
 		return Common::kWritingFailed;
 	}
 
-	if (!gamestate_save(_gamestate, out, desc, version)) {
+	SaveStateDescriptor metaInfos(slot, desc);
+	if (!gamestate_save(_gamestate, out, desc, version, &metaInfos)) {
 		warning("Saving the game state to '%s' failed", fileName.c_str());
 		return Common::kWritingFailed;
 	} else {
@@ -773,9 +785,18 @@ Common::Error SciEngine::saveGameState(int slot, const char *desc) {
 		delete out;
 	}
 
+	updateSaveIndex(slot, metaInfos);
 	return Common::kNoError;
 }
 
+void SciEngine::invalidateSaveIndex(const Common::String &fileName) {
+	SaveStateIndex::removeSave(_targetName, fileName);
+}
+
+void SciEngine::updateSaveIndex(int slot, const SaveStateDescriptor &metaInfos) {
+	SaveStateIndex::updateSave(_targetName, getSavegameName(slot), metaInfos);
+}
+
 bool SciEngine::canLoadGameStateCurrently() {
 	return !_gamestate->executionStackBase;
 }
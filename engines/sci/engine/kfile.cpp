@@ -30,6 +30,8 @@
 #include "common/savefile.h"
 #include "common/translation.h"
 
+#include "engines/savestate.h"
+
 #include "gui/saveload.h"
 
 #include "sci/sci.h"
@@ -643,14 +645,17 @@ reg_t kSaveGame(EngineState *s, int argc, reg_t *argv) {
 	if (!(out = saveFileMan->openForSaving(filename))) {
 		warning("Error opening savegame \"%s\" for writing", filename.c_str());
 	} else {
-		if (!gamestate_save(s, out, game_description.c_str(), version.c_str())) {
+		SaveStateDescriptor metaInfos(savegameId, game_description);
+		if (!gamestate_save(s, out, game_description.c_str(), version.c_str(), &metaInfos)) {
 			warning("Saving the game failed");
 		} else {
 			out->finalize();
 			if (out->err()) {
 				warning("Writing the savegame failed");
+				g_sci->invalidateSaveIndex(filename);
 			} else {
 				s->r_acc = TRUE_REG; // success
+				g_sci->updateSaveIndex(savegameId, metaInfos);
 			}
 			delete out;
 		}
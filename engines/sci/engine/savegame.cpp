@@ -27,8 +27,11 @@
 #include "common/system.h"
 #include "common/func.h"
 #include "common/serializer.h"
+#include "graphics/scaler.h"
 #include "graphics/thumbnail.h"
 
+#include "engines/saveindex.h"
+
 #include "sci/sci.h"
 #include "sci/event.h"
 
@@ -794,7 +797,7 @@ void SegManager::reconstructClones() {
 #pragma mark -
 
 
-bool gamestate_save(EngineState *s, Common::WriteStream *fh, const char* savename, const char *version) {
+bool gamestate_save(EngineState *s, Common::WriteStream *fh, const char* savename, const char *version, SaveStateDescriptor *metaInfos) {
 	TimeDate curTime;
 	g_system->getTimeAndDate(curTime);
 
@@ -817,7 +820,20 @@ bool gamestate_save(EngineState *s, Common::WriteStream *fh, const char* savenam
 
 	Common::Serializer ser(0, fh);
 	sync_SavegameMetadata(ser, meta);
-	Graphics::saveThumbnail(*fh);
+
+	Graphics::Surface thumb;
+	if (createThumbnailFromScreen(&thumb)) {
+		Graphics::saveThumbnail(*fh, thumb);
+		if (metaInfos)
+			metaInfos->setThumbnail(SaveStateIndex::convertThumbnail(thumb));
+		thumb.free();
+	} else {
+		warning("Couldn't create thumbnail from screen, aborting thumbnail save");
+	}
+
+	if (metaInfos)
+		set_savegame_metainfos(*metaInfos, meta);
+
 	s->saveLoadWithSerializer(ser);		// FIXME: Error handling?
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->saveLoadWithSerializer(ser);
@@ -931,4 +947,22 @@ bool get_savegame_metadata(Common::SeekableReadStream *stream, SavegameMetadata
 	return true;
 }
 
+void set_savegame_metainfos(SaveStateDescriptor &desc, const SavegameMetadata &meta) {
+	desc.setDeletableFlag(true);
+	desc.setWriteProtectedFlag(false);
+
+	int day = (meta.saveDate >> 24) & 0xFF;
+	int month = (meta.saveDate >> 16) & 0xFF;
+	int year = meta.saveDate & 0xFFFF;
+
+	desc.setSaveDate(year, month, day);
+
+	int hour = (meta.saveTime >> 16) & 0xFF;
+	int minutes = (meta.saveTime >> 8) & 0xFF;
+
+	desc.setSaveTime(hour, minutes);
+
+	desc.setPlayTime(meta.playTime * 1000);
+}
+
 } // End of namespace Sci
@@ -31,6 +31,8 @@
 
 #include "sci/sci.h"
 
+class SaveStateDescriptor;
+
 namespace Sci {
 
 struct EngineState;
@@ -80,9 +82,11 @@ struct SavegameMetadata {
  * @param s			The state to save
  * @param save		The stream to save to
  * @param savename	The description of the savegame
+ * @param metaInfos	If non-null, receives the thumbnail, date and play time
+ *					written, for the savegame index
  * @return 0 on success, 1 otherwise
  */
-bool gamestate_save(EngineState *s, Common::WriteStream *save, const char *savename, const char *version);
+bool gamestate_save(EngineState *s, Common::WriteStream *save, const char *savename, const char *version, SaveStateDescriptor *metaInfos = 0);
 
 /**
  * Restores a game state from a directory.
@@ -96,6 +100,12 @@ void gamestate_restore(EngineState *s, Common::SeekableReadStream *save);
  */
 bool get_savegame_metadata(Common::SeekableReadStream* stream, SavegameMetadata* meta);
 
+/**
+ * Sets the flags, date and play time of a savegame descriptor from the
+ * header of the savegame.
+ */
+void set_savegame_metainfos(SaveStateDescriptor &desc, const SavegameMetadata &meta);
+
 
 } // End of namespace Sci
 
@@ -33,6 +33,7 @@
 #include "sci/debug.h"	// for DebugState
 
 struct ADGameDescription;
+class SaveStateDescriptor;
 
 /**
  * This is the namespace of the SCI engine.
@@ -248,6 +249,11 @@ public:
 	Common::String getSavegameName(int nr) const;
 	Common::String getSavegamePattern() const;
 
+	/** Drops a savegame from the savegame index, when it is written without updating the index afterwards. */
+	void invalidateSaveIndex(const Common::String &fileName);
+	/** Stores the meta infos of a savegame that has just been written in the savegame index. */
+	void updateSaveIndex(int slot, const SaveStateDescriptor &metaInfos);
+
 	Common::String getFilePrefix() const;
 
 	/** Prepend 'TARGET-' to the given filename. */
@@ -42,6 +42,7 @@
 #include "scumm/file_nes.h"
 
 #include "engines/metaengine.h"
+#include "engines/saveindex.h"
 
 
 namespace Scumm {
@@ -1143,64 +1144,58 @@ SaveStateList ScummMetaEngine::listSaves(const char *target) const {
 	pattern += ".s??";
 
 	filenames = saveFileMan->listSavefiles(pattern);
-	sort(filenames.begin(), filenames.end());	// Sort (hopefully ensuring we are sorted numerically..)
 
-	SaveStateList saveList;
-	for (Common::StringArray::const_iterator file = filenames.begin(); file != filenames.end(); ++file) {
+	// Only keep the files with a valid slot number
+	for (uint i = 0; i < filenames.size(); ) {
 		// Obtain the last 2 digits of the filename, since they correspond to the save slot
-		int slotNum = atoi(file->c_str() + file->size() - 2);
+		int slotNum = atoi(filenames[i].c_str() + filenames[i].size() - 2);
+		if (slotNum >= 0 && slotNum <= 99)
+			++i;
+		else
+			filenames.remove_at(i);
+	}
 
-		if (slotNum >= 0 && slotNum <= 99) {
-			Common::InSaveFile *in = saveFileMan->openForLoading(*file);
-			if (in) {
-				Scumm::getSavegameName(in, saveDesc, 0);	// FIXME: heversion?!?
-				saveList.push_back(SaveStateDescriptor(slotNum, saveDesc));
-				delete in;
-			}
+	// Use the index if it describes exactly these savegames
+	SaveStateIndex index(target);
+	if (index.load() && index.matches(filenames))
+		return index.getSaveList();
+
+	// Otherwise, only read the savegames the index doesn't know of yet
+	index.prune(filenames);
+
+	for (Common::StringArray::const_iterator file = filenames.begin(); file != filenames.end(); ++file) {
+		if (index.hasSave(*file))
+			continue;
+
+		int slotNum = atoi(file->c_str() + file->size() - 2);
+		Common::InSaveFile *in = saveFileMan->openForLoading(*file);
+		if (in) {
+			Scumm::getSavegameName(in, saveDesc, 0);	// FIXME: heversion?!?
+			index.setSave(*file, SaveStateDescriptor(slotNum, saveDesc), false);
+			delete in;
 		}
 	}
 
-	return saveList;
+	index.save();
+	return index.getSaveList();
 }
 
 void ScummMetaEngine::removeSaveState(const char *target, int slot) const {
 	Common::String filename = ScummEngine::makeSavegameName(target, slot, false);
+	SaveStateIndex::removeSave(target, filename);
 	g_system->getSavefileManager()->removeSavefile(filename);
 }
 
 SaveStateDescriptor ScummMetaEngine::querySaveMetaInfos(const char *target, int slot) const {
-	Common::String filename = ScummEngine::makeSavegameName(target, slot, false);
-	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(filename);
+	SaveStateDescriptor desc;
+	if (SaveStateIndex::queryMetaInfos(target, slot, desc))
+		return desc;
 
-	if (!in)
+	if (!ScummEngine::readSaveMetaInfos(target, slot, desc))
 		return SaveStateDescriptor();
 
-	Common::String saveDesc;
-	Scumm::getSavegameName(in, saveDesc, 0);	// FIXME: heversion?!?
-	delete in;
-
-	// TODO: Cleanup
-	Graphics::Surface *thumbnail = ScummEngine::loadThumbnailFromSlot(target, slot);
-
-	SaveStateDescriptor desc(slot, saveDesc);
-	desc.setDeletableFlag(true);
-	desc.setThumbnail(thumbnail);
-
-	InfoStuff infos;
-	memset(&infos, 0, sizeof(infos));
-	if (ScummEngine::loadInfosFromSlot(target, slot, &infos)) {
-		int day = (infos.date >> 24) & 0xFF;
-		int month = (infos.date >> 16) & 0xFF;
-		int year = infos.date & 0xFFFF;
-
-		desc.setSaveDate(year, month, day);
-
-		int hour = (infos.time >> 8) & 0xFF;
-		int minutes = infos.time & 0xFF;
-
-		desc.setSaveTime(hour, minutes);
-		desc.setPlayTime(infos.playtime * 1000);
-	}
+	// Remember the meta infos, so the savegame needn't be opened next time
+	SaveStateIndex::updateSave(target, ScummEngine::makeSavegameName(target, slot, false), desc);
 
 	return desc;
 }
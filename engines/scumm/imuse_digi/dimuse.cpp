@@ -44,6 +44,11 @@ void IMuseDigital::timer_handler(void *refCon) {
 	imuseDigital->callback();
 }
 
+void IMuseDigital::prefetch_handler(void *refCon) {
+	IMuseDigital *imuseDigital = (IMuseDigital *)refCon;
+	imuseDigital->prefetch();
+}
+
 IMuseDigital::IMuseDigital(ScummEngine_v7 *scumm, Audio::Mixer *mixer, int fps)
 	: _vm(scumm), _mixer(mixer) {
 	assert(_vm);
@@ -61,6 +66,8 @@ IMuseDigital::IMuseDigital(ScummEngine_v7 *scumm, Audio::Mixer *mixer, int fps)
 		_track[l]->trackId = l;
 	}
 	_vm->getTimerManager()->installTimerProc(timer_handler, 1000000 / _callbackFps, this);
+	// Prefetch twice per callback, so the decompression is spread between callbacks
+	_vm->getTimerManager()->installTimerProc(prefetch_handler, 1000000 / _callbackFps / 2, this);
 
 	_audioNames = NULL;
 	_numAudioNames = 0;
@@ -68,6 +75,7 @@ IMuseDigital::IMuseDigital(ScummEngine_v7 *scumm, Audio::Mixer *mixer, int fps)
 
 IMuseDigital::~IMuseDigital() {
 	_vm->getTimerManager()->removeTimerProc(timer_handler);
+	_vm->getTimerManager()->removeTimerProc(prefetch_handler);
 	stopAllSounds();
 	for (int l = 0; l < MAX_DIGITAL_TRACKS + MAX_DIGITAL_FADETRACKS; l++) {
 		delete _track[l];
@@ -365,6 +373,29 @@ void IMuseDigital::callback() {
 	}
 }
 
+void IMuseDigital::prefetch() {
+	Common::StackLock lock(_mutex, "IMuseDigital::prefetch()");
+
+	if (_pause)
+		return;
+
+	for (int l = 0; l < MAX_DIGITAL_TRACKS + MAX_DIGITAL_FADETRACKS; l++) {
+		Track *track = _track[l];
+		if (!track->used || !track->stream || track->souStreamUsed || track->curRegion == -1)
+			continue;
+
+		// Decompress what the next two callbacks will read
+		int32 offset = track->regionOffset;
+		int32 size = track->feedSize / _callbackFps * 2;
+		if (_sound->getBits(track->soundDesc) == 12) {
+			offset = (offset * 3) / 4;
+			size = (size * 3) / 4;
+		}
+
+		_sound->prefetchRegionData(track->soundDesc, track->curRegion, offset, size);
+	}
+}
+
 void IMuseDigital::switchToNextRegion(Track *track) {
 	assert(track);
 
@@ -89,6 +89,8 @@ private:
 
 	static void timer_handler(void *refConf);
 	void callback();
+	static void prefetch_handler(void *refConf);
+	void prefetch();
 	void switchToNextRegion(Track *track);
 	int allocSlot(int priority);
 	void startSound(int soundId, const char *soundName, int soundType, int volGroupId, Audio::AudioStream *input, int hookId, int volume, int priority, Track *otherTrack);
@@ -37,14 +37,14 @@ BundleDirCache::BundleDirCache() {
 		_budleDirCache[fileId].fileName[0] = 0;
 		_budleDirCache[fileId].numFiles = 0;
 		_budleDirCache[fileId].isCompressed = false;
-		_budleDirCache[fileId].indexTable = NULL;
+		_budleDirCache[fileId].indexMap = NULL;
 	}
 }
 
 BundleDirCache::~BundleDirCache() {
 	for (int fileId = 0; fileId < ARRAYSIZE(_budleDirCache); fileId++) {
 		free(_budleDirCache[fileId].bundleTable);
-		free(_budleDirCache[fileId].indexTable);
+		delete _budleDirCache[fileId].indexMap;
 	}
 }
 
@@ -56,8 +56,11 @@ int32 BundleDirCache::getNumFiles(int slot) {
 	return _budleDirCache[slot].numFiles;
 }
 
-BundleDirCache::IndexNode *BundleDirCache::getIndexTable(int slot) {
-	return _budleDirCache[slot].indexTable;
+int32 BundleDirCache::findFile(int slot, const char *filename) {
+	IndexMap::const_iterator i = _budleDirCache[slot].indexMap->find(filename);
+	if (i == _budleDirCache[slot].indexMap->end())
+		return -1;
+	return i->_value;
 }
 
 bool BundleDirCache::isSndDataExtComp(int slot) {
@@ -103,9 +106,7 @@ int BundleDirCache::matchFile(const char *filename) {
 
 		file.seek(offset, SEEK_SET);
 
-		_budleDirCache[freeSlot].indexTable =
-				(IndexNode *)calloc(_budleDirCache[freeSlot].numFiles, sizeof(IndexNode));
-		assert(_budleDirCache[freeSlot].indexTable);
+		_budleDirCache[freeSlot].indexMap = new IndexMap();
 
 		for (int32 i = 0; i < _budleDirCache[freeSlot].numFiles; i++) {
 			char name[24], c;
@@ -128,12 +129,12 @@ int BundleDirCache::matchFile(const char *filename) {
 			}
 			_budleDirCache[freeSlot].bundleTable[i].offset = file.readUint32BE();
 			_budleDirCache[freeSlot].bundleTable[i].size = file.readUint32BE();
-			strcpy(_budleDirCache[freeSlot].indexTable[i].filename,
-					_budleDirCache[freeSlot].bundleTable[i].filename);
-			_budleDirCache[freeSlot].indexTable[i].index = i;
+
+			// Keep the first of several files with the same name
+			IndexMap &indexMap = *_budleDirCache[freeSlot].indexMap;
+			if (!indexMap.contains(_budleDirCache[freeSlot].bundleTable[i].filename))
+				indexMap[_budleDirCache[freeSlot].bundleTable[i].filename] = i;
 		}
-		qsort(_budleDirCache[freeSlot].indexTable, _budleDirCache[freeSlot].numFiles,
-				sizeof(IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
 		return freeSlot;
 	} else {
 		return fileId;
@@ -142,6 +143,7 @@ int BundleDirCache::matchFile(const char *filename) {
 
 BundleMgr::BundleMgr(BundleDirCache *cache) {
 	_cache = cache;
+	_cacheSlot = -1;
 	_bundleTable = NULL;
 	_compTable = NULL;
 	_numFiles = 0;
@@ -150,6 +152,11 @@ BundleMgr::BundleMgr(BundleDirCache *cache) {
 	_fileBundleId = -1;
 	_file = new ScummFile();
 	_compInputBuff = NULL;
+	for (int i = 0; i < kMaxCachedBlocks; i++) {
+		_cachedBlocks[i].block = -1;
+		_cachedBlocks[i].data = NULL;
+	}
+	_blockUseCounter = 0;
 }
 
 BundleMgr::~BundleMgr() {
@@ -158,14 +165,11 @@ BundleMgr::~BundleMgr() {
 }
 
 Common::SeekableReadStream *BundleMgr::getFile(const char *filename, int32 &offset, int32 &size) {
-	BundleDirCache::IndexNode target;
-	strcpy(target.filename, filename);
-	BundleDirCache::IndexNode *found = (BundleDirCache::IndexNode *)bsearch(&target, _indexTable, _numFiles,
-			sizeof(BundleDirCache::IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
-	if (found) {
-		_file->seek(_bundleTable[found->index].offset, SEEK_SET);
-		offset = _bundleTable[found->index].offset;
-		size = _bundleTable[found->index].size;
+	int32 index = _cache->findFile(_cacheSlot, filename);
+	if (index != -1) {
+		_file->seek(_bundleTable[index].offset, SEEK_SET);
+		offset = _bundleTable[index].offset;
+		size = _bundleTable[index].size;
 		return _file;
 	}
 
@@ -185,17 +189,15 @@ bool BundleMgr::open(const char *filename, bool &compressed, bool errorFlag) {
 		return false;
 	}
 
-	int slot = _cache->matchFile(filename);
-	assert(slot != -1);
-	compressed = _cache->isSndDataExtComp(slot);
-	_numFiles = _cache->getNumFiles(slot);
+	_cacheSlot = _cache->matchFile(filename);
+	assert(_cacheSlot != -1);
+	compressed = _cache->isSndDataExtComp(_cacheSlot);
+	_numFiles = _cache->getNumFiles(_cacheSlot);
 	assert(_numFiles);
-	_bundleTable = _cache->getTable(slot);
-	_indexTable = _cache->getIndexTable(slot);
+	_bundleTable = _cache->getTable(_cacheSlot);
 	assert(_bundleTable);
 	_compTableLoaded = false;
-	_outputSize = 0;
-	_lastBlock = -1;
+	clearBlockCache();
 
 	return true;
 }
@@ -207,14 +209,54 @@ void BundleMgr::close() {
 		_numFiles = 0;
 		_numCompItems = 0;
 		_compTableLoaded = false;
-		_lastBlock = -1;
-		_outputSize = 0;
 		_curSampleId = -1;
 		free(_compTable);
 		_compTable = NULL;
 		free(_compInputBuff);
 		_compInputBuff = NULL;
+		clearBlockCache();
+		for (int i = 0; i < kMaxCachedBlocks; i++) {
+			free(_cachedBlocks[i].data);
+			_cachedBlocks[i].data = NULL;
+		}
+	}
+}
+
+void BundleMgr::clearBlockCache() {
+	for (int i = 0; i < kMaxCachedBlocks; i++)
+		_cachedBlocks[i].block = -1;
+}
+
+const BundleMgr::CachedBlock *BundleMgr::getBlock(int32 index, int32 block) {
+	// Look for the block, or else for an unused or the least recently used
+	// cache entry
+	CachedBlock *entry = &_cachedBlocks[0];
+	for (int i = 0; i < kMaxCachedBlocks; i++) {
+		if (_cachedBlocks[i].block == block) {
+			_cachedBlocks[i].lastUse = ++_blockUseCounter;
+			return &_cachedBlocks[i];
+		}
+		if (entry->block != -1 && (_cachedBlocks[i].block == -1 || _cachedBlocks[i].lastUse < entry->lastUse))
+			entry = &_cachedBlocks[i];
+	}
+
+	if (!entry->data) {
+		entry->data = (byte *)malloc(kBlockSize);
+		assert(entry->data);
+	}
+
+	// CMI hack: one more zero byte at the end of input buffer
+	_compInputBuff[_compTable[block].size] = 0;
+	_file->seek(_bundleTable[index].offset + _compTable[block].offset, SEEK_SET);
+	_file->read(_compInputBuff, _compTable[block].size);
+	entry->size = BundleCodecs::decompressCodec(_compTable[block].codec, _compInputBuff, entry->data, _compTable[block].size);
+	if (entry->size > kBlockSize) {
+		error("BundleMgr::getBlock() Decompressed block too big: %d", entry->size);
 	}
+	entry->block = block;
+	entry->lastUse = ++_blockUseCounter;
+
+	return entry;
 }
 
 bool BundleMgr::loadCompTable(int32 index) {
@@ -273,34 +315,24 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 			return 0;
 	}
 
-	firstBlock = (offset + headerSize) / 0x2000;
-	lastBlock = (offset + headerSize + size - 1) / 0x2000;
+	firstBlock = (offset + headerSize) / kBlockSize;
+	lastBlock = (offset + headerSize + size - 1) / kBlockSize;
 
 	// Clip last_block by the total number of blocks (= "comp items")
 	if ((lastBlock >= _numCompItems) && (_numCompItems > 0))
 		lastBlock = _numCompItems - 1;
 
-	int32 blocksFinalSize = 0x2000 * (1 + lastBlock - firstBlock);
+	int32 blocksFinalSize = kBlockSize * (1 + lastBlock - firstBlock);
 	*compFinal = (byte *)malloc(blocksFinalSize);
 	assert(*compFinal);
 	finalSize = 0;
 
-	skip = (offset + headerSize) % 0x2000;
+	skip = (offset + headerSize) % kBlockSize;
 
 	for (i = firstBlock; i <= lastBlock; i++) {
-		if (_lastBlock != i) {
-			// CMI hack: one more zero byte at the end of input buffer
-			_compInputBuff[_compTable[i].size] = 0;
-			_file->seek(_bundleTable[index].offset + _compTable[i].offset, SEEK_SET);
-			_file->read(_compInputBuff, _compTable[i].size);
-			_outputSize = BundleCodecs::decompressCodec(_compTable[i].codec, _compInputBuff, _compOutputBuff, _compTable[i].size);
-			if (_outputSize > 0x2000) {
-				error("_outputSize: %d", _outputSize);
-			}
-			_lastBlock = i;
-		}
+		const CachedBlock *cachedBlock = getBlock(index, i);
 
-		outputSize = _outputSize;
+		outputSize = cachedBlock->size;
 
 		if (headerOutside) {
 			outputSize -= skip;
@@ -309,15 +341,15 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 				outputSize -= skip;
 		}
 
-		if ((outputSize + skip) > 0x2000) // workaround
-			outputSize -= (outputSize + skip) - 0x2000;
+		if ((outputSize + skip) > kBlockSize) // workaround
+			outputSize -= (outputSize + skip) - kBlockSize;
 
 		if (outputSize > size)
 			outputSize = size;
 
 		assert(finalSize + outputSize <= blocksFinalSize);
 
-		memcpy(*compFinal + finalSize, _compOutputBuff + skip, outputSize);
+		memcpy(*compFinal + finalSize, cachedBlock->data + skip, outputSize);
 		finalSize += outputSize;
 
 		size -= outputSize;
@@ -331,6 +363,30 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 	return finalSize;
 }
 
+void BundleMgr::prefetchByCurIndex(int32 offset, int32 size, int headerSize, int maxBlocks) {
+	if (!_file->isOpen() || _curSampleId == -1 || !_compTableLoaded || size <= 0)
+		return;
+
+	int32 firstBlock = (offset + headerSize) / kBlockSize;
+	int32 lastBlock = (offset + headerSize + size - 1) / kBlockSize;
+
+	// Don't evict the blocks which are about to be read
+	lastBlock = MIN<int32>(lastBlock, firstBlock + kMaxCachedBlocks / 2 - 1);
+	lastBlock = MIN<int32>(lastBlock, _numCompItems - 1);
+
+	for (int32 i = firstBlock; i <= lastBlock; i++) {
+		bool cached = false;
+		for (int j = 0; j < kMaxCachedBlocks && !cached; j++)
+			cached = (_cachedBlocks[j].block == i);
+
+		if (!cached) {
+			if (maxBlocks-- <= 0)
+				break;
+		}
+		getBlock(_curSampleId, i);
+	}
+}
+
 int32 BundleMgr::decompressSampleByName(const char *name, int32 offset, int32 size, byte **comp_final, bool header_outside) {
 	int32 final_size = 0;
 
@@ -339,12 +395,9 @@ int32 BundleMgr::decompressSampleByName(const char *name, int32 offset, int32 si
 		return 0;
 	}
 
-	BundleDirCache::IndexNode target;
-	strcpy(target.filename, name);
-	BundleDirCache::IndexNode *found = (BundleDirCache::IndexNode *)bsearch(&target, _indexTable, _numFiles,
-			sizeof(BundleDirCache::IndexNode), (int (*)(const void*, const void*))scumm_stricmp);
-	if (found) {
-		final_size = decompressSampleByIndex(found->index, offset, size, comp_final, 0, header_outside);
+	int32 index = _cache->findFile(_cacheSlot, name);
+	if (index != -1) {
+		final_size = decompressSampleByIndex(index, offset, size, comp_final, 0, header_outside);
 		return final_size;
 	}
 
@@ -27,6 +27,7 @@
 
 #include "common/scummsys.h"
 #include "common/file.h"
+#include "common/hash-str.h"
 
 namespace Scumm {
 
@@ -40,19 +41,17 @@ public:
 		int32 size;
 	};
 
-	struct IndexNode {
-		char filename[24];
-		int32 index;
-	};
-
 private:
 
+	/** Maps the names of the files in a bundle to their index in the bundle table */
+	typedef Common::HashMap<Common::String, int32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> IndexMap;
+
 	struct FileDirCache {
 		char fileName[20];
 		AudioTable *bundleTable;
 		int32 numFiles;
 		bool isCompressed;
-		IndexNode *indexTable;
+		IndexMap *indexMap;
 	} _budleDirCache[4];
 
 public:
@@ -61,7 +60,8 @@ public:
 
 	int matchFile(const char *filename);
 	AudioTable *getTable(int slot);
-	IndexNode *getIndexTable(int slot);
+	/** Returns the index of a file in the bundle table, or -1 if it is not in the bundle */
+	int32 findFile(int slot, const char *filename);
 	int32 getNumFiles(int slot);
 	bool isSndDataExtComp(int slot);
 };
@@ -76,9 +76,23 @@ private:
 		int32 codec;
 	};
 
+	enum {
+		kBlockSize = 0x2000,
+		/** Enough for the blocks read by one callback plus the prefetched ones */
+		kMaxCachedBlocks = 6
+	};
+
+	/** A decompressed block of the current sample */
+	struct CachedBlock {
+		int32 block;	///< -1 if unused
+		int32 size;
+		uint32 lastUse;
+		byte *data;
+	};
+
 	BundleDirCache *_cache;
+	int _cacheSlot;
 	BundleDirCache::AudioTable *_bundleTable;
-	BundleDirCache::IndexNode *_indexTable;
 	CompTable *_compTable;
 
 	int _numFiles;
@@ -87,12 +101,14 @@ private:
 	BaseScummFile *_file;
 	bool _compTableLoaded;
 	int _fileBundleId;
-	byte _compOutputBuff[0x2000];
 	byte *_compInputBuff;
-	int _outputSize;
-	int _lastBlock;
+
+	CachedBlock _cachedBlocks[kMaxCachedBlocks];
+	uint32 _blockUseCounter;
 
 	bool loadCompTable(int32 index);
+	const CachedBlock *getBlock(int32 index, int32 block);
+	void clearBlockCache();
 
 public:
 
@@ -105,6 +121,14 @@ public:
 	int32 decompressSampleByName(const char *name, int32 offset, int32 size, byte **compFinal, bool headerOutside);
 	int32 decompressSampleByIndex(int32 index, int32 offset, int32 size, byte **compFinal, int header_size, bool headerOutside);
 	int32 decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside);
+
+	/**
+	 * Decompresses the blocks of the current sample which a following
+	 * decompressSampleByCurIndex() call with the same parameters would
+	 * read, so that call only has to copy them. Decompresses at most
+	 * maxBlocks blocks which are not cached yet.
+	 */
+	void prefetchByCurIndex(int32 offset, int32 size, int headerSize, int maxBlocks);
 };
 
 namespace BundleCodecs {
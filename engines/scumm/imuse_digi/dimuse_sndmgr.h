@@ -149,6 +149,13 @@ public:
 	void getSyncSizeAndPtrById(SoundDesc *soundDesc, int number, int32 &sync_size, byte **sync_ptr);
 
 	int32 getDataFromRegion(SoundDesc *soundDesc, int region, byte **buf, int32 offset, int32 size);
+
+	/**
+	 * Decompresses ahead the data which getDataFromRegion() would return
+	 * for the same parameters, for sounds in compressed blocks. Decompresses
+	 * at most one block per call, to spread the work over several calls.
+	 */
+	void prefetchRegionData(SoundDesc *soundDesc, int region, int32 offset, int32 size);
 };
 
 } // End of namespace Scumm
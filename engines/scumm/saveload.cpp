@@ -48,6 +48,9 @@
 
 #include "backends/audiocd/audiocd.h"
 
+#include "engines/saveindex.h"
+
+#include "graphics/scaler.h"
 #include "graphics/thumbnail.h"
 
 namespace Scumm {
@@ -165,7 +168,7 @@ static bool saveSaveGameHeader(Common::OutSaveFile *out, SaveGameHeader &hdr) {
 	return true;
 }
 
-bool ScummEngine::saveState(Common::OutSaveFile *out, bool writeHeader) {
+bool ScummEngine::saveState(Common::OutSaveFile *out, bool writeHeader, SaveStateDescriptor *metaInfos) {
 	SaveGameHeader hdr;
 
 	if (writeHeader) {
@@ -173,9 +176,20 @@ bool ScummEngine::saveState(Common::OutSaveFile *out, bool writeHeader) {
 		saveSaveGameHeader(out, hdr);
 	}
 #if !defined(__DS__) && !defined(__N64__) /* && !defined(__PLAYSTATION2__) */
-	Graphics::saveThumbnail(*out);
+	Graphics::Surface thumb;
+	if (createThumbnailFromScreen(&thumb)) {
+		Graphics::saveThumbnail(*out, thumb);
+		if (metaInfos)
+			metaInfos->setThumbnail(SaveStateIndex::convertThumbnail(thumb));
+		thumb.free();
+	} else {
+		warning("Couldn't create thumbnail from screen, aborting thumbnail save");
+	}
 #endif
-	saveInfos(out);
+	InfoStuff infos;
+	saveInfos(out, &infos);
+	if (metaInfos)
+		setSaveMetaInfos(*metaInfos, infos);
 
 	Serializer ser(0, out, CURRENT_VER);
 	saveOrLoad(&ser);
@@ -195,11 +209,25 @@ bool ScummEngine::saveState(int slot, bool compat) {
 	} else {
 		filename = makeSavegameName(slot, compat);
 	}
-	if (!(out = _saveFileMan->openForSaving(filename)))
+
+	bool indexed = !compat && _saveLoadSlot != 255;
+
+	char name[sizeof(_saveLoadName)];
+	memcpy(name, _saveLoadName, sizeof(name));
+	name[sizeof(name) - 1] = 0;
+	SaveStateDescriptor metaInfos(slot, name);
+	metaInfos.setDeletableFlag(true);
+
+	// Autosaves are written in the background, so that they don't stall the game
+	if (indexed && slot == 0)
+		out = _saveFileMan->openForSavingInBackground(filename);
+	else
+		out = _saveFileMan->openForSaving(filename);
+	if (!out)
 		return false;
 
 	saveFailed = false;
-	if (!saveState(out))
+	if (!saveState(out, true, indexed ? &metaInfos : 0))
 		saveFailed = true;
 
 	out->finalize();
@@ -213,6 +241,9 @@ bool ScummEngine::saveState(int slot, bool compat) {
 	}
 	debug(1, "State saved as '%s'", filename.c_str());
 
+	if (indexed)
+		SaveStateIndex::updateSave(_targetName, filename, metaInfos);
+
 	pauseEngine(false);
 
 	return true;
@@ -226,11 +257,12 @@ void ScummEngine_v4::prepareSavegame() {
 	// free memory of the last prepared savegame
 	delete _savePreparedSavegame;
 	_savePreparedSavegame = NULL;
+	_savePreparedMetaInfos = SaveStateDescriptor();
 
 	// store headerless savegame in a compressed memory stream
 	memStream = new Common::MemoryWriteStreamDynamic();
 	writeStream = Common::wrapCompressedWriteStream(memStream);
-	if (saveState(writeStream, false)) {
+	if (saveState(writeStream, false, &_savePreparedMetaInfos)) {
 		// we have to finalize the compression-stream first, otherwise the internal
 		// memory-stream pointer will be zero (Important: flush() does not work here!).
 		writeStream->finalize();
@@ -299,6 +331,13 @@ bool ScummEngine_v4::savePreparedSavegame(int slot, char *desc) {
 		return false;
 	} else {
 		debug(1, "State saved as '%s'", filename.c_str());
+
+		// The thumbnail and infos are those of the prepared savegame
+		SaveStateDescriptor metaInfos = _savePreparedMetaInfos;
+		metaInfos.save_slot() = Common::String::format("%d", slot);
+		metaInfos.description() = hdr.name;
+		metaInfos.setDeletableFlag(true);
+		SaveStateIndex::updateSave(_targetName, filename, metaInfos);
 		return true;
 	}
 }
@@ -741,6 +780,69 @@ bool ScummEngine::loadInfosFromSlot(const char *target, int slot, InfoStuff *stu
 	return true;
 }
 
+bool ScummEngine::readSaveMetaInfos(const char *target, int slot, SaveStateDescriptor &desc) {
+	Common::SeekableReadStream *in;
+	SaveGameHeader hdr;
+
+	if (slot < 0)
+		return false;
+
+	Common::String filename = makeSavegameName(target, slot, false);
+	if (!(in = g_system->getSavefileManager()->openForLoading(filename))) {
+		return false;
+	}
+
+	Common::String saveDesc;
+	Scumm::getSavegameName(in, saveDesc, 0);	// FIXME: heversion?!?
+
+	desc = SaveStateDescriptor(slot, saveDesc);
+	desc.setDeletableFlag(true);
+
+	// Read the thumbnail and the infos from the same stream, instead of
+	// opening the savegame again for each of them.
+	in->seek(0, SEEK_SET);
+	if (!loadSaveGameHeader(in, hdr)) {
+		delete in;
+		return true;
+	}
+
+	if (hdr.ver > CURRENT_VER)
+		hdr.ver = TO_LE_32(hdr.ver);
+
+	if (hdr.ver >= VER(52) && Graphics::checkThumbnailHeader(*in)) {
+		Graphics::Surface *thumb = new Graphics::Surface();
+		assert(thumb);
+		if (Graphics::loadThumbnail(*in, *thumb)) {
+			desc.setThumbnail(thumb);
+		} else {
+			delete thumb;
+			delete in;
+			return true;
+		}
+	}
+
+	InfoStuff infos;
+	if (hdr.ver >= VER(56) && loadInfos(in, &infos))
+		setSaveMetaInfos(desc, infos);
+
+	delete in;
+	return true;
+}
+
+void ScummEngine::setSaveMetaInfos(SaveStateDescriptor &desc, const InfoStuff &infos) {
+	int day = (infos.date >> 24) & 0xFF;
+	int month = (infos.date >> 16) & 0xFF;
+	int year = infos.date & 0xFFFF;
+
+	desc.setSaveDate(year, month, day);
+
+	int hour = (infos.time >> 8) & 0xFF;
+	int minutes = infos.time & 0xFF;
+
+	desc.setSaveTime(hour, minutes);
+	desc.setPlayTime(infos.playtime * 1000);
+}
+
 bool ScummEngine::loadInfos(Common::SeekableReadStream *file, InfoStuff *stuff) {
 	memset(stuff, 0, sizeof(InfoStuff));
 
@@ -791,7 +893,7 @@ bool ScummEngine::loadInfos(Common::SeekableReadStream *file, InfoStuff *stuff)
 	return true;
 }
 
-void ScummEngine::saveInfos(Common::WriteStream* file) {
+void ScummEngine::saveInfos(Common::WriteStream* file, InfoStuff *stuff) {
 	SaveInfoSection section;
 	section.type = MKID_BE('INFO');
 	section.version = INFOSECTION_VERSION;
@@ -814,6 +916,12 @@ void ScummEngine::saveInfos(Common::WriteStream* file) {
 	file->writeUint32BE(section.playtime);
 	file->writeUint32BE(section.date);
 	file->writeUint16BE(section.time);
+
+	if (stuff) {
+		stuff->date = section.date;
+		stuff->time = section.time;
+		stuff->playtime = section.playtime;
+	}
 }
 
 void ScummEngine::saveOrLoad(Serializer *s) {
@@ -63,6 +63,7 @@ namespace Common {
 	class SeekableReadStream;
 	class WriteStream;
 }
+class SaveStateDescriptor;
 
 /**
  * This is the namespace of the SCUMM engine.
@@ -664,7 +665,11 @@ protected:
 	Common::String _saveLoadFileName;
 	char _saveLoadName[32];
 
-	bool saveState(Common::OutSaveFile *out, bool writeHeader = true);
+	/**
+	 * Writes a savegame. If metaInfos is given, the thumbnail and infos
+	 * written are stored in it as well.
+	 */
+	bool saveState(Common::OutSaveFile *out, bool writeHeader = true, SaveStateDescriptor *metaInfos = 0);
 	bool saveState(int slot, bool compat);
 	bool loadState(int slot, bool compat);
 	virtual void saveOrLoad(Serializer *s);
@@ -696,9 +701,16 @@ public:
 
 	static bool loadInfosFromSlot(const char *target, int slot, InfoStuff *stuff);
 
+	/**
+	 * Reads the description, thumbnail and infos of a savegame, opening
+	 * it only once. Returns false if the savegame doesn't exist.
+	 */
+	static bool readSaveMetaInfos(const char *target, int slot, SaveStateDescriptor &desc);
+
 protected:
-	void saveInfos(Common::WriteStream* file);
+	void saveInfos(Common::WriteStream* file, InfoStuff *stuff = 0);
 	static bool loadInfos(Common::SeekableReadStream *file, InfoStuff *stuff);
+	static void setSaveMetaInfos(SaveStateDescriptor &desc, const InfoStuff &infos);
 
 protected:
 	/* Script VM - should be in Script class */
@@ -26,6 +26,8 @@
 #ifndef SCUMM_SCRIPT_V4_H
 #define SCUMM_SCRIPT_V4_H
 
+#include "engines/savestate.h"
+
 #include "scumm/scumm_v5.h"
 
 namespace Scumm {
@@ -46,6 +48,9 @@ public:
 	 */
 	Common::SeekableReadStream *_savePreparedSavegame;
 
+	/** Thumbnail and infos of the prepared savegame, for the savegame index. */
+	SaveStateDescriptor _savePreparedMetaInfos;
+
 	void prepareSavegame();
 	bool savePreparedSavegame(int slot, char *desc);
 
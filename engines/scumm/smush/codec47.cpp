@@ -72,6 +72,140 @@ namespace Scumm {
 		(dst)[1] = val;	\
 	} while (0)
 
+// SSE2 is part of the x86-64 baseline and NEON of AArch64, so the vector
+// block routines only depend on the compiler target. The ARM assembler
+// decoder replaces decode2 completely and takes precedence.
+#if !defined(USE_ARM_SMUSH_ASM)
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define SMUSH_HAVE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SMUSH_HAVE_NEON
+#endif
+#endif
+
+#if defined(SMUSH_HAVE_SSE2)
+#include <emmintrin.h>
+#elif defined(SMUSH_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(SMUSH_HAVE_SSE2) || defined(SMUSH_HAVE_NEON)
+#define SMUSH_USE_SIMD
+
+// Each glyph is stored as a byte mask in block order, 0xFF for the pixels
+// taking the first color and 0x00 for those taking the second one.
+enum {
+	kGlyphBigSize = 8 * 8,
+	kGlyphSmallSize = 4 * 4,
+	kGlyphSmallMasks = 256 * kGlyphBigSize,
+	kGlyphMasksSize = 256 * (kGlyphBigSize + kGlyphSmallSize)
+};
+#endif
+
+#if defined(SMUSH_HAVE_SSE2)
+
+static inline void copy8x8(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++) {
+		_mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+		dst += pitch;
+		src += pitch;
+	}
+}
+
+static inline void fill8x8(byte *dst, byte val, int pitch) {
+	const __m128i v = _mm_set1_epi8((char)val);
+	for (int i = 0; i < 8; i++) {
+		_mm_storel_epi64((__m128i *)dst, v);
+		dst += pitch;
+	}
+}
+
+static inline __m128i selectGlyph(const byte *mask, __m128i v1, __m128i v2) {
+	const __m128i m = _mm_loadu_si128((const __m128i *)mask);
+	return _mm_or_si128(_mm_and_si128(m, v1), _mm_andnot_si128(m, v2));
+}
+
+static inline void drawGlyph8x8(byte *dst, const byte *mask, byte val1, byte val2, int pitch) {
+	const __m128i v1 = _mm_set1_epi8((char)val1);
+	const __m128i v2 = _mm_set1_epi8((char)val2);
+	for (int i = 0; i < 4; i++) {
+		const __m128i rows = selectGlyph(mask, v1, v2);
+		_mm_storel_epi64((__m128i *)dst, rows);
+		_mm_storel_epi64((__m128i *)(dst + pitch), _mm_srli_si128(rows, 8));
+		mask += 16;
+		dst += pitch * 2;
+	}
+}
+
+static inline void drawGlyph4x4(byte *dst, const byte *mask, byte val1, byte val2, int pitch) {
+	__m128i rows = selectGlyph(mask, _mm_set1_epi8((char)val1), _mm_set1_epi8((char)val2));
+	for (int i = 0; i < 4; i++) {
+		WRITE_UINT32(dst, _mm_cvtsi128_si32(rows));
+		rows = _mm_srli_si128(rows, 4);
+		dst += pitch;
+	}
+}
+
+#elif defined(SMUSH_HAVE_NEON)
+
+static inline void copy8x8(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++) {
+		vst1_u8(dst, vld1_u8(src));
+		dst += pitch;
+		src += pitch;
+	}
+}
+
+static inline void fill8x8(byte *dst, byte val, int pitch) {
+	const uint8x8_t v = vdup_n_u8(val);
+	for (int i = 0; i < 8; i++) {
+		vst1_u8(dst, v);
+		dst += pitch;
+	}
+}
+
+static inline void drawGlyph8x8(byte *dst, const byte *mask, byte val1, byte val2, int pitch) {
+	const uint8x16_t v1 = vdupq_n_u8(val1);
+	const uint8x16_t v2 = vdupq_n_u8(val2);
+	for (int i = 0; i < 4; i++) {
+		const uint8x16_t rows = vbslq_u8(vld1q_u8(mask), v1, v2);
+		vst1_u8(dst, vget_low_u8(rows));
+		vst1_u8(dst + pitch, vget_high_u8(rows));
+		mask += 16;
+		dst += pitch * 2;
+	}
+}
+
+static inline void drawGlyph4x4(byte *dst, const byte *mask, byte val1, byte val2, int pitch) {
+	byte rows[16];
+	vst1q_u8(rows, vbslq_u8(vld1q_u8(mask), vdupq_n_u8(val1), vdupq_n_u8(val2)));
+	for (int i = 0; i < 4; i++) {
+		COPY_4X1_LINE(dst, rows + i * 4);
+		dst += pitch;
+	}
+}
+
+#else
+
+static inline void copy8x8(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++) {
+		COPY_4X1_LINE(dst + 0, src + 0);
+		COPY_4X1_LINE(dst + 4, src + 4);
+		dst += pitch;
+		src += pitch;
+	}
+}
+
+static inline void fill8x8(byte *dst, byte val, int pitch) {
+	for (int i = 0; i < 8; i++) {
+		FILL_4X1_LINE(dst, val);
+		FILL_4X1_LINE(dst + 4, val);
+		dst += pitch;
+	}
+}
+
+#endif
+
 static const  int8 codec47_table_small1[] = {
   0, 1, 2, 3, 3, 3, 3, 2, 1, 0, 0, 0, 1, 2, 2, 1,
 };
@@ -264,6 +398,14 @@ void Codec47Decoder::makeTablesInterpolation(int param) {
 				}
 			}
 
+#ifdef SMUSH_USE_SIMD
+			if (_glyphMasks) {
+				byte *mask = _glyphMasks + (param == 8 ? (x * 16 + y) * kGlyphBigSize : kGlyphSmallMasks + (x * 16 + y) * kGlyphSmallSize);
+				for (i = 0; i < param * param; i++)
+					mask[i] = tableSmallBig[i] ? 0xFF : 0x00;
+			}
+#endif
+
 			if (param == 8) {
 				for (i = 64 - 1; i >= 0; i--) {
 					if (tableSmallBig[i] != 0) {
@@ -417,6 +559,11 @@ void Codec47Decoder::level2(byte *d_dst) {
 			d_dst += _d_pitch;
 		}
 	} else if (code == 0xFD) {
+#ifdef SMUSH_USE_SIMD
+		const byte *mask = _glyphMasks + kGlyphSmallMasks + _d_src[0] * kGlyphSmallSize;
+		drawGlyph4x4(d_dst, mask, _d_src[1], _d_src[2], _d_pitch);
+		_d_src += 3;
+#else
 		byte *tmp_ptr = _tableSmall + *_d_src++ * 128;
 		int32 l = tmp_ptr[96];
 		byte val = *_d_src++;
@@ -432,6 +579,7 @@ void Codec47Decoder::level2(byte *d_dst) {
 			*(d_dst + READ_LE_UINT16(tmp_ptr2)) = val;
 			tmp_ptr2++;
 		}
+#endif
 	} else if (code == 0xFC) {
 		tmp = _offset2;
 		for (i = 0; i < 4; i++) {
@@ -448,17 +596,11 @@ void Codec47Decoder::level2(byte *d_dst) {
 }
 
 void Codec47Decoder::level1(byte *d_dst) {
-	int32 tmp, tmp2;
 	byte code = *_d_src++;
-	int i;
 
 	if (code < 0xF8) {
-		tmp2 = _table[code] + _offset1;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst + 0, d_dst + tmp2);
-			COPY_4X1_LINE(d_dst + 4, d_dst + tmp2 + 4);
-			d_dst += _d_pitch;
-		}
+		int32 tmp2 = _table[code] + _offset1;
+		copy8x8(d_dst, d_dst + tmp2, _d_pitch);
 	} else if (code == 0xFF) {
 		level2(d_dst);
 		d_dst += 4;
@@ -469,13 +611,14 @@ void Codec47Decoder::level1(byte *d_dst) {
 		level2(d_dst);
 	} else if (code == 0xFE) {
 		byte t = *_d_src++;
-		for (i = 0; i < 8; i++) {
-			FILL_4X1_LINE(d_dst, t);
-			FILL_4X1_LINE(d_dst + 4, t);
-			d_dst += _d_pitch;
-		}
+		fill8x8(d_dst, t, _d_pitch);
 	} else if (code == 0xFD) {
-		tmp = *_d_src++;
+#ifdef SMUSH_USE_SIMD
+		const byte *mask = _glyphMasks + _d_src[0] * kGlyphBigSize;
+		drawGlyph8x8(d_dst, mask, _d_src[1], _d_src[2], _d_pitch);
+		_d_src += 3;
+#else
+		int32 tmp = *_d_src++;
 		byte *tmp_ptr = _tableBig + tmp * 388;
 		byte l = tmp_ptr[384];
 		byte val = *_d_src++;
@@ -491,20 +634,11 @@ void Codec47Decoder::level1(byte *d_dst) {
 			*(d_dst + READ_LE_UINT16(tmp_ptr2)) = val;
 			tmp_ptr2++;
 		}
+#endif
 	} else if (code == 0xFC) {
-		tmp2 = _offset2;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst + 0, d_dst + tmp2);
-			COPY_4X1_LINE(d_dst + 4, d_dst + tmp2 + 4);
-			d_dst += _d_pitch;
-		}
+		copy8x8(d_dst, d_dst + _offset2, _d_pitch);
 	} else {
-		byte t = _paramPtr[code];
-		for (i = 0; i < 8; i++) {
-			FILL_4X1_LINE(d_dst, t);
-			FILL_4X1_LINE(d_dst + 4, t);
-			d_dst += _d_pitch;
-		}
+		fill8x8(d_dst, _paramPtr[code], _d_pitch);
 	}
 }
 
@@ -533,6 +667,11 @@ Codec47Decoder::Codec47Decoder(int width, int height) {
 	_height = height;
 	_tableBig = (byte *)malloc(256 * 388);
 	_tableSmall = (byte *)malloc(256 * 128);
+#ifdef SMUSH_USE_SIMD
+	_glyphMasks = (byte *)malloc(kGlyphMasksSize);
+#else
+	_glyphMasks = NULL;
+#endif
 	if ((_tableBig != NULL) && (_tableSmall != NULL)) {
 		makeTablesInterpolation(4);
 		makeTablesInterpolation(8);
@@ -555,6 +694,8 @@ Codec47Decoder::~Codec47Decoder() {
 		free(_tableSmall);
 		_tableSmall = NULL;
 	}
+	free(_glyphMasks);
+	_glyphMasks = NULL;
 	_lastTableWidth = -1;
 	if (_deltaBuf) {
 		free(_deltaBuf);
@@ -568,6 +709,10 @@ Codec47Decoder::~Codec47Decoder() {
 bool Codec47Decoder::decode(byte *dst, const byte *src) {
 	if ((_tableBig == NULL) || (_tableSmall == NULL) || (_deltaBuf == NULL))
 		return false;
+#ifdef SMUSH_USE_SIMD
+	if (_glyphMasks == NULL)
+		return false;
+#endif
 
 	_offset1 = _deltaBufs[1] - _curBuf;
 	_offset2 = _deltaBufs[0] - _curBuf;
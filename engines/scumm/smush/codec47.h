@@ -44,6 +44,7 @@ private:
 	int32 _offset1, _offset2;
 	byte *_tableBig;
 	byte *_tableSmall;
+	byte *_glyphMasks;
 	int16 _table[256];
 	int32 _frameSize;
 	int _width, _height;
@@ -59,6 +60,7 @@ public:
 	Codec47Decoder(int width, int height);
 	~Codec47Decoder();
 	bool decode(byte *dst, const byte *src);
+	int32 getFrameSize() const { return _frameSize; }
 };
 
 } // End of namespace Scumm
@@ -27,6 +27,7 @@
 
 #include "common/config-manager.h"
 #include "common/file.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/util.h"
 
@@ -176,6 +177,41 @@ public:
 	}
 };
 
+/**
+ * Walks the sub chunks of a frame. Sub chunks are padded to an even size.
+ * The stream is positioned at the start of the data of the current sub
+ * chunk, and may be read from freely until next() is called again.
+ */
+class SubChunkIterator {
+public:
+	SubChunkIterator(Common::SeekableReadStream &stream, int32 frameSize)
+		: type(0), size(0), offset(0), _stream(stream), _left(frameSize), _nextOffset(stream.pos()) {}
+
+	/** Moves to the next sub chunk. Returns false at the end of the frame. */
+	bool next() {
+		_stream.seek(_nextOffset, SEEK_SET);
+		if (_left <= 0)
+			return false;
+
+		type = _stream.readUint32BE();
+		size = _stream.readUint32BE();
+		offset = _stream.pos();
+
+		_nextOffset = offset + size + (size & 1);
+		_left -= size + 8 + (size & 1);
+		return true;
+	}
+
+	uint32 type;
+	int32 size;
+	int32 offset;
+
+private:
+	Common::SeekableReadStream &_stream;
+	int32 _left;
+	int32 _nextOffset;
+};
+
 static StringResource *getStrings(ScummEngine *vm, const char *file, bool is_encoded) {
 	debugC(DEBUG_SMUSH, "trying to read text resources from %s", file);
 	ScummFile theFile;
@@ -243,6 +279,10 @@ SmushPlayer::SmushPlayer(ScummEngine_v7 *scumm) {
 	_paused = false;
 	_pauseStartTime = 0;
 	_pauseTime = 0;
+	_decodeAhead = false;
+	_decodeAheadEnd = false;
+	_curChunk = NULL;
+	_curObject = 0;
 }
 
 SmushPlayer::~SmushPlayer() {
@@ -281,6 +321,8 @@ void SmushPlayer::init(int32 speed) {
 void SmushPlayer::release() {
 	_vm->_smushVideoShouldFinish = true;
 
+	stopDecodeAhead();
+
 	for (int i = 0; i < 5; i++) {
 		delete _sf[i];
 		_sf[i] = NULL;
@@ -724,20 +766,40 @@ void SmushPlayer::handleNewPalette(int32 subSize, Common::SeekableReadStream &b)
 
 void smush_decode_codec1(byte *dst, const byte *src, int left, int top, int width, int height, int pitch);
 
-void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height) {
-	if ((height == 242) && (width == 384)) {
-		if (_specialBuffer == 0)
-			_specialBuffer = (byte *)malloc(242 * 384);
-		_dst = _specialBuffer;
-	} else if ((height > _vm->_screenHeight) || (width > _vm->_screenWidth))
-		return;
+bool SmushPlayer::isFrameObjectVisible(int width, int height) const {
+	if ((height == 242) && (width == 384))
+		return true;
+	if ((height > _vm->_screenHeight) || (width > _vm->_screenWidth))
+		return false;
 	// FT Insane uses smaller frames to draw overlays with moving objects
 	// Other .san files do have them as well but their purpose in unknown
 	// and often it causes memory overdraw. So just skip those frames
-	else if (!_insanity && ((height != _vm->_screenHeight) || (width != _vm->_screenWidth)))
+	if (!_insanity && ((height != _vm->_screenHeight) || (width != _vm->_screenWidth)))
+		return false;
+	return true;
+}
+
+int32 SmushPlayer::prepareCodec(int codec, int width, int height) {
+	if (codec == 37) {
+		if (!_codec37)
+			_codec37 = new Codec37Decoder(width, height);
+		return _codec37->getFrameSize();
+	}
+
+	assert(codec == 47);
+	if (!_codec47)
+		_codec47 = new Codec47Decoder(width, height);
+	return _codec47->getFrameSize();
+}
+
+void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height, const DecodedObject *decoded) {
+	if (!isFrameObjectVisible(width, height))
 		return;
 
 	if ((height == 242) && (width == 384)) {
+		if (_specialBuffer == 0)
+			_specialBuffer = (byte *)malloc(242 * 384);
+		_dst = _specialBuffer;
 		_width = width;
 		_height = height;
 	} else {
@@ -745,25 +807,25 @@ void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int t
 		_height = _vm->_screenHeight;
 	}
 
-	switch (codec) {
-	case 1:
-	case 3:
-		smush_decode_codec1(_dst, src, left, top, width, height, _vm->_screenWidth);
-		break;
-	case 37:
-		if (!_codec37)
-			_codec37 = new Codec37Decoder(width, height);
-		if (_codec37)
+	if (decoded && decoded->pixels) {
+		memcpy(_dst, decoded->pixels, decoded->size);
+	} else {
+		switch (codec) {
+		case 1:
+		case 3:
+			smush_decode_codec1(_dst, src, left, top, width, height, _vm->_screenWidth);
+			break;
+		case 37:
+			prepareCodec(codec, width, height);
 			_codec37->decode(_dst, src);
-		break;
-	case 47:
-		if (!_codec47)
-			_codec47 = new Codec47Decoder(width, height);
-		if (_codec47)
+			break;
+		case 47:
+			prepareCodec(codec, width, height);
 			_codec47->decode(_dst, src);
-		break;
-	default:
-		error("Invalid codec for frame object : %d", codec);
+			break;
+		default:
+			error("Invalid codec for frame object : %d", codec);
+		}
 	}
 
 	if (_storeFrame) {
@@ -777,11 +839,17 @@ void SmushPlayer::decodeFrameObject(int codec, const uint8 *src, int left, int t
 
 #ifdef USE_ZLIB
 void SmushPlayer::handleZlibFrameObject(int32 subSize, Common::SeekableReadStream &b) {
+	const DecodedObject *decoded = nextDecodedObject();
 	if (_skipNext) {
 		_skipNext = false;
 		return;
 	}
 
+	if (decoded && decoded->pixels) {
+		decodeFrameObject(decoded->codec, 0, decoded->left, decoded->top, decoded->width, decoded->height, decoded);
+		return;
+	}
+
 	int32 chunkSize = subSize;
 	byte *chunkBuffer = (byte *)malloc(chunkSize);
 	assert(chunkBuffer);
@@ -808,11 +876,17 @@ void SmushPlayer::handleZlibFrameObject(int32 subSize, Common::SeekableReadStrea
 
 void SmushPlayer::handleFrameObject(int32 subSize, Common::SeekableReadStream &b) {
 	assert(subSize >= 14);
+	const DecodedObject *decoded = nextDecodedObject();
 	if (_skipNext) {
 		_skipNext = false;
 		return;
 	}
 
+	if (decoded && decoded->pixels) {
+		decodeFrameObject(decoded->codec, 0, decoded->left, decoded->top, decoded->width, decoded->height, decoded);
+		return;
+	}
+
 	int codec = b.readUint16LE();
 	int left = b.readUint16LE();
 	int top = b.readUint16LE();
@@ -840,10 +914,10 @@ void SmushPlayer::handleFrame(int32 frameSize, Common::SeekableReadStream &b) {
 		_vm->_insane->procPreRendering();
 	}
 
-	while (frameSize > 0) {
-		const uint32 subType = b.readUint32BE();
-		const int32 subSize = b.readUint32BE();
-		const int32 subOffset = b.pos();
+	SubChunkIterator sub(b, frameSize);
+	while (sub.next()) {
+		const uint32 subType = sub.type;
+		const int32 subSize = sub.size;
 		switch (subType) {
 		case MKID_BE('NPAL'):
 			handleNewPalette(subSize, b);
@@ -884,13 +958,6 @@ void SmushPlayer::handleFrame(int32 frameSize, Common::SeekableReadStream &b) {
 		default:
 			error("Unknown frame subChunk found : %s, %d", tag2str(subType), subSize);
 		}
-
-		frameSize -= subSize + 8;
-		b.seek(subOffset + subSize, SEEK_SET);
-		if (subSize & 1) {
-			b.skip(1);
-			frameSize--;
-		}
 	}
 
 	if (_insanity) {
@@ -971,6 +1038,9 @@ SmushFont *SmushPlayer::getFont(int font) {
 void SmushPlayer::parseNextFrame() {
 
 	if (_seekPos >= 0) {
+		// The decoder thread owns the file while it decodes ahead
+		stopDecodeAhead();
+
 		if (_smixer)
 			_smixer->stop();
 
@@ -1012,34 +1082,67 @@ void SmushPlayer::parseNextFrame() {
 		_startTime = _vm->_system->getMillis();
 
 		_seekPos = -1;
+
+		// Insane seeks around in the file and skips frame objects, so its
+		// frames are always decoded on demand
+		if (!_insanity)
+			startDecodeAhead();
 	}
 
-	assert(_base);
+	if (_decodeAhead) {
+		DecodedChunk *chunk = nextDecodedChunk();
+		if (chunk->endOfFile) {
+			freeDecodedChunk(chunk);
+			_vm->_smushVideoShouldFinish = true;
+			_endOfFile = true;
+			return;
+		}
 
-	const uint32 subType = _base->readUint32BE();
-	const int32 subSize = _base->readUint32BE();
-	const int32 subOffset = _base->pos();
+		Common::MemoryReadStream b(chunk->data, chunk->size);
+		_curChunk = chunk;
+		_curObject = 0;
 
-	if (_base->pos() >= (int32)_baseSize) {
-		_vm->_smushVideoShouldFinish = true;
-		_endOfFile = true;
-		return;
-	}
+		switch (chunk->type) {
+		case MKID_BE('AHDR'):
+			handleAnimHeader(chunk->size, b);
+			break;
+		case MKID_BE('FRME'):
+			handleFrame(chunk->size, b);
+			break;
+		default:
+			error("Unknown Chunk found: %s, %d", tag2str(chunk->type), chunk->size);
+		}
 
-	debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
+		_curChunk = NULL;
+		freeDecodedChunk(chunk);
+	} else {
+		assert(_base);
 
-	switch (subType) {
-	case MKID_BE('AHDR'): // FT INSANE may seek file to the beginning
-		handleAnimHeader(subSize, *_base);
-		break;
-	case MKID_BE('FRME'):
-		handleFrame(subSize, *_base);
-		break;
-	default:
-		error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
-	}
+		const uint32 subType = _base->readUint32BE();
+		const int32 subSize = _base->readUint32BE();
+		const int32 subOffset = _base->pos();
 
-	_base->seek(subOffset + subSize, SEEK_SET);
+		if (_base->pos() >= (int32)_baseSize) {
+			_vm->_smushVideoShouldFinish = true;
+			_endOfFile = true;
+			return;
+		}
+
+		debug(3, "Chunk: %s at %x", tag2str(subType), subOffset);
+
+		switch (subType) {
+		case MKID_BE('AHDR'): // FT INSANE may seek file to the beginning
+			handleAnimHeader(subSize, *_base);
+			break;
+		case MKID_BE('FRME'):
+			handleFrame(subSize, *_base);
+			break;
+		default:
+			error("Unknown Chunk found at %x: %s, %d", subOffset, tag2str(subType), subSize);
+		}
+
+		_base->seek(subOffset + subSize, SEEK_SET);
+	}
 
 	if (_insanity)
 		_vm->_sound->processSound();
@@ -1047,6 +1150,128 @@ void SmushPlayer::parseNextFrame() {
 	_vm->_imuseDigital->flushTracks();
 }
 
+void SmushPlayer::startDecodeAhead() {
+	assert(_base && !_decodeAhead);
+
+	_decodeAhead = true;
+	_decodeAheadEnd = false;
+}
+
+void SmushPlayer::stopDecodeAhead() {
+	if (!_decodeAhead)
+		return;
+
+	_decodeAhead = false;
+
+	while (!_decodeQueue.empty())
+		freeDecodedChunk(_decodeQueue.pop());
+}
+
+bool SmushPlayer::decodeAhead() {
+	if (!_decodeAhead || _decodeAheadEnd || _decodeQueue.size() >= kDecodeQueueSize)
+		return false;
+
+	_decodeQueue.push(decodeChunk());
+	return true;
+}
+
+SmushPlayer::DecodedChunk *SmushPlayer::decodeChunk() {
+	assert(!_decodeAheadEnd);
+
+	DecodedChunk *chunk = new DecodedChunk;
+	chunk->type = _base->readUint32BE();
+	chunk->size = _base->readUint32BE();
+	chunk->data = 0;
+	chunk->endOfFile = false;
+
+	const int32 subOffset = _base->pos();
+	if (subOffset >= (int32)_baseSize) {
+		chunk->endOfFile = true;
+		_decodeAheadEnd = true;
+	} else {
+		debug(3, "Chunk: %s at %x", tag2str(chunk->type), subOffset);
+
+		chunk->data = (byte *)malloc(chunk->size);
+		assert(chunk->data);
+		_base->read(chunk->data, chunk->size);
+		_base->seek(subOffset + chunk->size, SEEK_SET);
+
+		if (chunk->type == MKID_BE('FRME'))
+			decodeAheadObjects(chunk);
+	}
+
+	return chunk;
+}
+
+void SmushPlayer::decodeAheadObjects(DecodedChunk *chunk) {
+	// Only the codecs which keep state between frames are decoded here, as
+	// the others draw on top of the current frame. One object is recorded
+	// for every frame object handleFrame() will find.
+	Common::MemoryReadStream b(chunk->data, chunk->size);
+	SubChunkIterator sub(b, chunk->size);
+	while (sub.next()) {
+		const byte *data = chunk->data + sub.offset;
+
+		byte *fobjBuffer = 0;
+		if (sub.type == MKID_BE('ZFOB')) {
+#ifdef USE_ZLIB
+			unsigned long decompressedSize = READ_BE_UINT32(data);
+			fobjBuffer = (byte *)malloc(decompressedSize);
+			if (!Common::uncompress(fobjBuffer, &decompressedSize, data + 4, sub.size - 4))
+				error("SmushPlayer::decodeAheadObjects() Zlib uncompress error");
+			data = fobjBuffer;
+#else
+			continue;
+#endif
+		} else if (sub.type != MKID_BE('FOBJ')) {
+			continue;
+		}
+
+		DecodedObject obj;
+		obj.codec = READ_LE_UINT16(data + 0);
+		obj.left = READ_LE_UINT16(data + 2);
+		obj.top = READ_LE_UINT16(data + 4);
+		obj.width = READ_LE_UINT16(data + 6);
+		obj.height = READ_LE_UINT16(data + 8);
+		obj.pixels = 0;
+		obj.size = 0;
+
+		if ((obj.codec == 37 || obj.codec == 47) && isFrameObjectVisible(obj.width, obj.height)) {
+			obj.size = prepareCodec(obj.codec, obj.width, obj.height);
+			obj.pixels = (byte *)malloc(obj.size);
+			assert(obj.pixels);
+			if (obj.codec == 37)
+				_codec37->decode(obj.pixels, data + 14);
+			else
+				_codec47->decode(obj.pixels, data + 14);
+		}
+
+		free(fobjBuffer);
+		chunk->objects.push_back(obj);
+	}
+}
+
+SmushPlayer::DecodedChunk *SmushPlayer::nextDecodedChunk() {
+	if (!_decodeQueue.empty())
+		return _decodeQueue.pop();
+
+	// There was no time to decode ahead, decode the chunk right here
+	return decodeChunk();
+}
+
+const SmushPlayer::DecodedObject *SmushPlayer::nextDecodedObject() {
+	if (!_curChunk || _curObject >= _curChunk->objects.size())
+		return 0;
+	return &_curChunk->objects[_curObject++];
+}
+
+void SmushPlayer::freeDecodedChunk(DecodedChunk *chunk) {
+	for (uint i = 0; i < chunk->objects.size(); i++)
+		free(chunk->objects[i].pixels);
+	free(chunk->data);
+	delete chunk;
+}
+
 void SmushPlayer::setPalette(const byte *palette) {
 	memcpy(_pal, palette, 0x300);
 	setDirtyColors(0, 255);
@@ -1263,7 +1488,9 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 			_IACTpos = 0;
 			break;
 		}
-		_vm->_system->delayMillis(10);
+		// Use the time until the next frame is due for decoding ahead
+		if (!decodeAhead())
+			_vm->_system->delayMillis(10);
 	}
 
 	release();
@@ -26,6 +26,8 @@
 #if !defined(SCUMM_SMUSH_PLAYER_H) && defined(ENABLE_SCUMM_7_8)
 #define SCUMM_SMUSH_PLAYER_H
 
+#include "common/array.h"
+#include "common/queue.h"
 #include "common/util.h"
 #include "scumm/sound.h"
 
@@ -85,6 +87,37 @@ private:
 	bool _middleAudio;
 	bool _skipPalette;
 
+	/**
+	 * Frame objects of a chunk which were decoded ahead of time. The
+	 * pixels are NULL for objects left to the main thread.
+	 */
+	struct DecodedObject {
+		int codec, left, top, width, height;
+		byte *pixels;
+		int32 size;
+	};
+
+	struct DecodedChunk {
+		uint32 type;
+		int32 size;
+		byte *data;
+		bool endOfFile;
+		Common::Array<DecodedObject> objects;
+	};
+
+	enum {
+		kDecodeQueueSize = 3
+	};
+
+	// While decoding ahead, _base is read and the codecs are used only
+	// when a chunk is put into the queue, which play() does while it waits
+	// for the next frame to be due.
+	bool _decodeAhead;
+	bool _decodeAheadEnd;
+	Common::Queue<DecodedChunk *> _decodeQueue;
+	DecodedChunk *_curChunk;
+	uint _curObject;
+
 public:
 	SmushPlayer(ScummEngine_v7 *scumm);
 	~SmushPlayer();
@@ -120,7 +153,7 @@ private:
 	void tryCmpFile(const char *filename);
 
 	bool readString(const char *file);
-	void decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height);
+	void decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height, const DecodedObject *decoded = 0);
 	void handleAnimHeader(int32 subSize, Common::SeekableReadStream &);
 	void handleFrame(int32 frameSize, Common::SeekableReadStream &);
 	void handleNewPalette(int32 subSize, Common::SeekableReadStream &);
@@ -136,6 +169,17 @@ private:
 	void handleTextResource(uint32 subType, int32 subSize, Common::SeekableReadStream &);
 	void handleDeltaPalette(int32 subSize, Common::SeekableReadStream &);
 	void readPalette(byte *, Common::SeekableReadStream &);
+	bool isFrameObjectVisible(int width, int height) const;
+	int32 prepareCodec(int codec, int width, int height);
+
+	void startDecodeAhead();
+	void stopDecodeAhead();
+	bool decodeAhead();
+	DecodedChunk *decodeChunk();
+	void decodeAheadObjects(DecodedChunk *chunk);
+	DecodedChunk *nextDecodedChunk();
+	const DecodedObject *nextDecodedObject();
+	void freeDecodedChunk(DecodedChunk *chunk);
 
 	void timerCallback();
 };
@@ -247,6 +247,10 @@ bool Debugger::Cmd_Mem(int argc, const char **argv) {
 
 	DebugPrintf("---------------------------------------------------------------------------\n");
 	DebugPrintf("%9d\n", _vm->_memory->getTotAlloc());
+	DebugPrintf("\n");
+	DebugPrintf("Peak usage:  %d bytes in %d blocks\n", _vm->_memory->getMaxAlloc(), _vm->_memory->getMaxBlocks());
+	DebugPrintf("Allocations: %d\n", _vm->_memory->getNumAllocs());
+	DebugPrintf("Frees:       %d\n", _vm->_memory->getNumFrees());
 
 	return true;
 }
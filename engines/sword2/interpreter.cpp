@@ -258,6 +258,10 @@ int Logic::runScript2(byte *scriptData, byte *objectData, byte *offsetPtr) {
 
 	header.read(scriptData);
 
+	// The script and object data are memory blocks of their own. Pointers
+	// into them are encoded relative to the start of the block.
+	byte *scriptBlock = scriptData;
+
 	scriptData += ResHeader::size() + ObjectHub::size();
 
 	// The script data format:
@@ -450,7 +454,7 @@ int Logic::runScript2(byte *scriptData, byte *objectData, byte *offsetPtr) {
 			// CP_PUSH_DEREFERENCED_STRUCTURE opcode.
 
 			Read16ip(parameter);
-			stack.push(_vm->_memory->encodePtr(localVars + parameter));
+			stack.push(_vm->_memory->encodePtr(localVars + parameter, scriptBlock));
 			debug(9, "CP_PUSH_LOCAL_ADDR: &localVars[%d] => %p", parameter / 4, localVars + parameter);
 			break;
 		case CP_PUSH_STRING:
@@ -460,7 +464,7 @@ int Logic::runScript2(byte *scriptData, byte *objectData, byte *offsetPtr) {
 
 			// ip now points to the string
 			ptr = code + ip;
-			stack.push(_vm->_memory->encodePtr(ptr));
+			stack.push(_vm->_memory->encodePtr(ptr, scriptBlock));
 			debug(9, "CP_PUSH_STRING: \"%s\"", ptr);
 			ip += (parameter + 1);
 			break;
@@ -468,7 +472,7 @@ int Logic::runScript2(byte *scriptData, byte *objectData, byte *offsetPtr) {
 			// Push the address of a dereferenced structure
 			Read32ip(parameter);
 			ptr = objectData + 4 + ResHeader::size() + ObjectHub::size() + parameter;
-			stack.push(_vm->_memory->encodePtr(ptr));
+			stack.push(_vm->_memory->encodePtr(ptr, objectData));
 			debug(9, "CP_PUSH_DEREFERENCED_STRUCTURE: %d => %p", parameter, ptr);
 			break;
 		case CP_POP_LOCAL_VAR32:
@@ -54,6 +54,15 @@
 
 namespace Sword2 {
 
+// Every memory block is preceded by a small header holding the block's id.
+// It is eight bytes long, so the blocks stay aligned for values of up to eight
+// bytes. That is less than malloc() guarantees on some targets, but the blocks
+// only hold resource data, which is never accessed with wider alignment.
+
+enum {
+	kBlockHeaderSize = 8
+};
+
 MemoryManager::MemoryManager(Sword2Engine *vm) : _vm(vm) {
 	// The id stack contains all the possible ids for the memory blocks.
 	// We use this to ensure that no two blocks ever have the same id.
@@ -62,57 +71,63 @@ MemoryManager::MemoryManager(Sword2Engine *vm) : _vm(vm) {
 	// id. This means that given a block id we can find the pointer with a
 	// simple array lookup.
 
-	// The memory block index is an array of pointers to the memory block
-	// array, sorted on the memory block's pointer. This means that given
-	// a pointer into a memory block we can find its id with binary
-	// searching.
-	//
-	// A balanced tree might have been more efficient - the index has to
-	// be re-sorted every time a block is allocated or freed - but such
-	// beasts are tricky to implement. Anyway, it wouldn't have made
-	// encoding or decoding pointers any faster, and these are by far the
-	// most common operations.
+	// Given the pointer to the start of a memory block, its id is read
+	// from the block header. There used to be an index of the blocks,
+	// sorted on their pointers, that was binary searched for any pointer
+	// into a block. However, the only pointers the scripts ever need
+	// encoded point into the script and object resources they are run
+	// with, so the interpreter passes the start of the block along.
+	// memFree() may be handed any pointer, so it looks the pointer up in
+	// the table of blocks instead of reading a header that may not exist.
 
 	_idStack = (int16 *)malloc(MAX_MEMORY_BLOCKS * sizeof(int16));
 	_memBlocks = (MemBlock *)malloc(MAX_MEMORY_BLOCKS * sizeof(MemBlock));
-	_memBlockIndex = (MemBlock **)malloc(MAX_MEMORY_BLOCKS * sizeof(MemBlock *));
 
 	_totAlloc = 0;
 	_numBlocks = 0;
 
+	_maxBlocks = 0;
+	_maxAlloc = 0;
+	_numAllocs = 0;
+	_numFrees = 0;
+
 	for (int i = 0; i < MAX_MEMORY_BLOCKS; i++) {
 		_idStack[i] = MAX_MEMORY_BLOCKS - i - 1;
 		_memBlocks[i].ptr = NULL;
-		_memBlockIndex[i] = NULL;
 	}
 
 	_idStackPtr = MAX_MEMORY_BLOCKS;
 }
 
 MemoryManager::~MemoryManager() {
-	for (int i = 0; i < MAX_MEMORY_BLOCKS; i++)
-		free(_memBlocks[i].ptr);
+	for (int i = 0; i < MAX_MEMORY_BLOCKS; i++) {
+		if (_memBlocks[i].ptr)
+			free(_memBlocks[i].ptr - kBlockHeaderSize);
+	}
 	free(_memBlocks);
-	free(_memBlockIndex);
 	free(_idStack);
 }
 
-int32 MemoryManager::encodePtr(byte *ptr) {
+/**
+ * Encodes a pointer into a memory block as a 32-bit integer.
+ * @param ptr	the pointer to encode
+ * @param block	the start of the memory block ptr points into
+ */
+int32 MemoryManager::encodePtr(byte *ptr, byte *block) {
 	if (ptr == NULL)
 		return 0;
 
-	int idx = findPointerInIndex(ptr);
+	int16 id = findBlock(block);
 
-	assert(idx != -1);
+	assert(id != -1);
 
-	uint32 id = _memBlockIndex[idx]->id;
-	uint32 offset = ptr - _memBlocks[id].ptr;
+	uint32 offset = ptr - block;
 
 	assert(id < 0x03ff);
 	assert(offset <= 0x003fffff);
 	assert(offset < _memBlocks[id].size);
 
-	return ((id + 1) << 22) | (ptr - _memBlocks[id].ptr);
+	return ((id + 1) << 22) | offset;
 }
 
 byte *MemoryManager::decodePtr(int32 n) {
@@ -128,70 +143,38 @@ byte *MemoryManager::decodePtr(int32 n) {
 	return _memBlocks[id].ptr + offset;
 }
 
-int16 MemoryManager::findExactPointerInIndex(byte *ptr) {
-	int left = 0;
-	int right = _numBlocks - 1;
-
-	while (right >= left) {
-		int n = (left + right) / 2;
+/**
+ * Returns the id of a memory block, read from its header.
+ * @param ptr	the start of a block returned by memAlloc()
+ */
+int16 MemoryManager::findBlock(byte *ptr) {
+	if (ptr == NULL)
+		return -1;
 
-		if (_memBlockIndex[n]->ptr == ptr)
-			return n;
+	int16 id = *(int16 *)(ptr - kBlockHeaderSize);
 
-		if (_memBlockIndex[n]->ptr > ptr)
-			right = n - 1;
-		else
-			left = n + 1;
-	}
+	if (id < 0 || id >= MAX_MEMORY_BLOCKS || _memBlocks[id].ptr != ptr)
+		return -1;
 
-	return -1;
+	return id;
 }
 
-int16 MemoryManager::findPointerInIndex(byte *ptr) {
-	int left = 0;
-	int right = _numBlocks - 1;
-
-	while (right >= left) {
-		int n = (left + right) / 2;
-
-		if (_memBlockIndex[n]->ptr <= ptr && _memBlockIndex[n]->ptr + _memBlockIndex[n]->size > ptr)
-			return n;
+/**
+ * Returns the id of the memory block starting at a pointer, or -1 if no
+ * block starts there. Unlike findBlock(), the pointer isn't dereferenced.
+ */
+int16 MemoryManager::lookupBlock(byte *ptr) {
+	if (ptr == NULL)
+		return -1;
 
-		if (_memBlockIndex[n]->ptr > ptr)
-			right = n - 1;
-		else
-			left = n + 1;
+	for (int16 id = 0; id < MAX_MEMORY_BLOCKS; id++) {
+		if (_memBlocks[id].ptr == ptr)
+			return id;
 	}
 
 	return -1;
 }
 
-int16 MemoryManager::findInsertionPointInIndex(byte *ptr) {
-	if (_numBlocks == 0)
-		return 0;
-
-	int left = 0;
-	int right = _numBlocks - 1;
-	int n = 0;
-
-	while (right >= left) {
-		n = (left + right) / 2;
-
-		if (_memBlockIndex[n]->ptr == ptr)
-			return -1;
-
-		if (_memBlockIndex[n]->ptr > ptr)
-			right = n - 1;
-		else
-			left = n + 1;
-	}
-
-	if (_memBlockIndex[n]->ptr < ptr)
-		n++;
-
-	return n;
-}
-
 byte *MemoryManager::memAlloc(uint32 size, int16 uid) {
 	assert(_idStackPtr > 0);
 
@@ -199,52 +182,48 @@ byte *MemoryManager::memAlloc(uint32 size, int16 uid) {
 	int16 id = _idStack[--_idStackPtr];
 
 	// Allocate the new memory block
-	byte *ptr = (byte *)malloc(size);
+	byte *ptr = (byte *)malloc(size + kBlockHeaderSize);
 
 	assert(ptr);
 
+	*(int16 *)ptr = id;
+	ptr += kBlockHeaderSize;
+
 	_memBlocks[id].id = id;
 	_memBlocks[id].uid = uid;
 	_memBlocks[id].ptr = ptr;
 	_memBlocks[id].size = size;
 
-	// Update the memory block index.
-	int16 idx = findInsertionPointInIndex(ptr);
-
-	assert(idx != -1);
-
-	for (int i = _numBlocks; i > idx; i--)
-		_memBlockIndex[i] = _memBlockIndex[i - 1];
-
-	_memBlockIndex[idx] = &_memBlocks[id];
 	_numBlocks++;
 	_totAlloc += size;
 
+	_numAllocs++;
+	if (_numBlocks > _maxBlocks)
+		_maxBlocks = _numBlocks;
+	if (_totAlloc > _maxAlloc)
+		_maxAlloc = _totAlloc;
+
 	return _memBlocks[id].ptr;
 }
 
 void MemoryManager::memFree(byte *ptr) {
-	int16 idx = findExactPointerInIndex(ptr);
+	int16 id = lookupBlock(ptr);
 
-	if (idx == -1) {
+	if (id == -1) {
 		warning("Freeing non-allocated pointer %p", ptr);
 		return;
 	}
 
 	// Put back the id on the stack
-	_idStack[_idStackPtr++] = _memBlockIndex[idx]->id;
+	_idStack[_idStackPtr++] = id;
 
 	// Release the memory block
-	free(_memBlockIndex[idx]->ptr);
-	_memBlockIndex[idx]->ptr = NULL;
+	free(_memBlocks[id].ptr - kBlockHeaderSize);
+	_memBlocks[id].ptr = NULL;
 
-	_totAlloc -= _memBlockIndex[idx]->size;
-
-	// Remove the memory block from the index
+	_totAlloc -= _memBlocks[id].size;
 	_numBlocks--;
-
-	for (int i = idx; i < _numBlocks; i++)
-		_memBlockIndex[i] = _memBlockIndex[i + 1];
+	_numFrees++;
 }
 
 } // End of namespace Sword2
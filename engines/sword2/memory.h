@@ -46,17 +46,21 @@ private:
 	Sword2Engine *_vm;
 
 	MemBlock *_memBlocks;
-	MemBlock **_memBlockIndex;
 	int16 _numBlocks;
 
 	uint32 _totAlloc;
 
+	// Allocation statistics
+	int16 _maxBlocks;
+	uint32 _maxAlloc;
+	uint32 _numAllocs;
+	uint32 _numFrees;
+
 	int16 *_idStack;
 	int16 _idStackPtr;
 
-	int16 findExactPointerInIndex(byte *ptr);
-	int16 findPointerInIndex(byte *ptr);
-	int16 findInsertionPointInIndex(byte *ptr);
+	int16 findBlock(byte *ptr);
+	int16 lookupBlock(byte *ptr);
 
 public:
 	MemoryManager(Sword2Engine *vm);
@@ -66,7 +70,12 @@ public:
 	uint32 getTotAlloc() { return _totAlloc; }
 	MemBlock *getMemBlocks() { return _memBlocks; }
 
-	int32 encodePtr(byte *ptr);
+	int16 getMaxBlocks() { return _maxBlocks; }
+	uint32 getMaxAlloc() { return _maxAlloc; }
+	uint32 getNumAllocs() { return _numAllocs; }
+	uint32 getNumFrees() { return _numFrees; }
+
+	int32 encodePtr(byte *ptr, byte *block);
 	byte *decodePtr(int32 n);
 
 	byte *memAlloc(uint32 size, int16 uid);
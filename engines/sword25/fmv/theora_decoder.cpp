@@ -41,7 +41,7 @@
 
 #ifdef USE_THEORADEC
 #include "common/system.h"
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 #include "sound/decoders/raw.h"
 #include "sword25/kernel/common.h"
 
@@ -437,7 +437,7 @@ const Graphics::Surface *TheoraDecoder::decodeNextFrame() {
 		th_decode_ycbcr_out(_theoraDecode, yuv);
 
 		// Convert YUV data to RGB data
-		translateYUVtoRGBA(yuv, (byte *)_surface->getBasePtr(0, 0));
+		translateYUVtoRGBA(yuv);
 		
 		_videobufReady = false;
 	}
@@ -495,22 +495,13 @@ Audio::QueuingAudioStream *TheoraDecoder::createAudioStream() {
 	return Audio::makeQueuingAudioStream(_vorbisInfo.rate, _vorbisInfo.channels);
 }
 
-static void convertYUVtoBGRA(int y, int u, int v, byte *dst) {
-	byte r, g, b;
-	Graphics::YUV2RGB(y, u, v, r, g, b);
-	*(dst + 0) = b;
-	*(dst + 1) = g;
-	*(dst + 2) = r;
-	*(dst + 3) = 0xFF;
-}
-
 enum TheoraYUVBuffers {
 	kBufferY = 0,
 	kBufferU = 1,
 	kBufferV = 2
 };
 
-void TheoraDecoder::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, byte *pixelData) {
+void TheoraDecoder::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer) {
 	// Width and height of all buffers have to be divisible by 2.
 	assert((YUVBuffer[kBufferY].width & 1)   == 0);
 	assert((YUVBuffer[kBufferY].height & 1)  == 0);
@@ -523,40 +514,12 @@ void TheoraDecoder::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, byte *pixelDa
 	assert(YUVBuffer[kBufferU].height == YUVBuffer[kBufferY].height >> 1);
 	assert(YUVBuffer[kBufferV].height == YUVBuffer[kBufferY].height >> 1);
 
-	const byte *ySrc = YUVBuffer[kBufferY].data;
-	const byte *uSrc = YUVBuffer[kBufferU].data;
-	const byte *vSrc = YUVBuffer[kBufferV].data;
-	byte *dst  = pixelData;
-	int u = 0, v = 0;
-
-	const int blockSize = YUVBuffer[kBufferY].width << 2;
-	const int halfHeight = YUVBuffer[kBufferY].height >> 1;
-	const int halfWidth = YUVBuffer[kBufferY].width >> 1;
-	const int yStep = (YUVBuffer[kBufferY].stride << 1) - YUVBuffer[kBufferY].width;
-	// The UV step is usually 0, since in most cases stride == width.
-	// The asserts at the top ensure that the U and V steps are equal
-	// (and they must always be equal)
-	const int uvStep = YUVBuffer[kBufferU].stride - YUVBuffer[kBufferU].width;
-	const int stride = YUVBuffer[kBufferY].stride;
-
-	for (int h = 0; h < halfHeight; ++h) {
-		for (int w = 0; w < halfWidth; ++w) {
-			u = *uSrc++;
-			v = *vSrc++;
-
-			for (int i = 0; i <= 1; i++) {
-				convertYUVtoBGRA(*ySrc, u, v, dst);
-				convertYUVtoBGRA(*(ySrc + stride), u, v, dst + blockSize);
-				ySrc++;
-				dst += 4;	// BGRA
-			}
-		}
+	// The U and V planes share their stride
+	assert(YUVBuffer[kBufferU].stride == YUVBuffer[kBufferV].stride);
 
-		dst   += blockSize;
-		ySrc  += yStep;
-		uSrc  += uvStep;
-		vSrc  += uvStep;
-	}
+	YUVToRGBMan.getLookup(getPixelFormat())->convert420(_surface, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data,
+			YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height,
+			YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 }
 
 } // End of namespace Sword25
@@ -107,7 +107,7 @@ private:
 	void queuePage(ogg_page *page);
 	int bufferData();
 	Audio::QueuingAudioStream *createAudioStream();
-	void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, byte *pixelData);
+	void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer);
 
 private:
 	Common::SeekableReadStream *_fileStream;
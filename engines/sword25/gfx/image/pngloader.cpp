@@ -217,7 +217,7 @@ bool PNGLoader::doDecodeImage(const byte *fileDataPtr, uint fileSize, byte *&unc
 #else
 	Common::MemoryReadStream *fileStr = new Common::MemoryReadStream(fileDataPtr, fileSize, DisposeAfterUse::NO);
 	Graphics::PNG *png = new Graphics::PNG();
-	if (!png->read(fileStr))	// the fileStr pointer, and thus pFileData will be deleted after this is done
+	if (!png->read(fileStr))	// the fileStr pointer will be deleted along with png
 		error("Error while reading PNG image");	
 
 	Graphics::PixelFormat format = Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
@@ -423,7 +423,7 @@ void Scene::init(int id, const Common::Point &pos) {
 	if (now_playing != res->dseg.get_byte(0xDB90))
 		_engine->music->load(res->dseg.get_byte(0xDB90));
 
-	_system->copyRectToScreen((const byte *)background.pixels, background.pitch, 0, 0, background.w, background.h);
+	memcpy(_engine->getFrame()->pixels, background.pixels, background.h * background.pitch);
 	setPalette(0);
 }
 
@@ -616,13 +616,12 @@ bool Scene::render(bool tick_game, bool tick_mark, uint32 delta) {
 			}
 		}
 
+		Graphics::Surface *surface = _engine->getFrame();
+
 		switch(current_event.type) {
 		case SceneEvent::kCredits: {
-			_system->fillScreen(0);
-			///\todo: optimize me
-			Graphics::Surface *surface = _system->lockScreen();
+			surface->fillRect(Common::Rect(surface->w, surface->h), 0);
 			res->font7.render(surface, current_event.dst.x, current_event.dst.y -= game_delta, current_event.message, current_event.color);
-			_system->unlockScreen();
 
 			if (current_event.dst.y < -(int)current_event.timer)
 				current_event.clear();
@@ -642,24 +641,20 @@ bool Scene::render(bool tick_game, bool tick_mark, uint32 delta) {
 		}
 
 		if (current_event.type == SceneEvent::kCreditsMessage) {
-			_system->fillScreen(0);
-			Graphics::Surface *surface = _system->lockScreen();
+			surface->fillRect(Common::Rect(surface->w, surface->h), 0);
 			if (current_event.lan == 8) {
 				res->font8.shadow_color = current_event.orientation;
 				res->font8.render(surface, current_event.dst.x, current_event.dst.y, message, current_event.color);
 			} else {
 				res->font7.render(surface, current_event.dst.x, current_event.dst.y, message, 0xd1);
 			}
-			_system->unlockScreen();
 			return true;
 		}
 
 		if (background.pixels && debug_features.feature[DebugFeatures::kShowBack]) {
-			_system->copyRectToScreen((const byte *)background.pixels, background.pitch, 0, 0, background.w, background.h);
+			memcpy(surface->pixels, background.pixels, background.h * background.pitch);
 		} else
-			_system->fillScreen(0);
-
-		Graphics::Surface *surface = _system->lockScreen();
+			surface->fillRect(Common::Rect(surface->w, surface->h), 0);
 
 		bool got_any_animation = false;
 
@@ -808,10 +803,8 @@ bool Scene::render(bool tick_game, bool tick_mark, uint32 delta) {
 			}
 		}
 
-		if (restart) {
-			_system->unlockScreen();
+		if (restart)
 			continue;
-		}
 		//removed mark == null. In final scene of chapter 2 mark rendered above table. 
 		//if it'd cause any bugs, add hack here. (_id != 23 && mark == NULL) 
 		if (on_enabled && 
@@ -873,8 +866,6 @@ bool Scene::render(bool tick_game, bool tick_mark, uint32 delta) {
 			}
 		}
 
-		_system->unlockScreen();
-
 		if (current_event.type == SceneEvent::kWait) {
 			if (current_event.timer > delta) {
 				busy = true;
@@ -1121,6 +1112,9 @@ bool Scene::processEventQueue() {
 			break;
 
 		case SceneEvent::kEffect:
+			// Show the scene drawn so far while shaking
+			_engine->copyFrameToScreen();
+
 			_system->delayMillis(80); //2 vsyncs
 			_system->setShakePos(8);
 			_system->updateScreen();
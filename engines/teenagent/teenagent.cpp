@@ -24,6 +24,7 @@
 
 #include "common/config-manager.h"
 #include "common/debug.h"
+#include "common/debug-channels.h"
 #include "common/events.h"
 #include "common/savefile.h"
 #include "common/system.h"
@@ -49,15 +50,23 @@
 namespace TeenAgent {
 
 TeenAgentEngine::TeenAgentEngine(OSystem *system, const ADGameDescription *gd) : Engine(system), action(kActionNone), _gameDescription(gd) {
+	DebugMan.addDebugChannel(kDebugScreen, "Screen", "Screen debug level");
+
 	music = new MusicPlayer();
 
 	console = 0;
+	_shadowScreen = 0;
 }
 
 TeenAgentEngine::~TeenAgentEngine() {
 	delete music;
 
 	delete console;
+
+	delete _shadowScreen;
+	_frame.free();
+
+	DebugMan.clearAllDebugChannels();
 }
 
 bool TeenAgentEngine::trySelectedObject() {
@@ -466,6 +475,8 @@ Common::Error TeenAgentEngine::run() {
 	Common::EventManager *_event = _system->getEventManager();
 
 	initGraphics(320, 200, false);
+	_frame.create(320, 200, 1);
+	_shadowScreen = new Graphics::ShadowScreen(320, 200);
 	console = new Console(this);
 
 	scene = new Scene(this, _system);
@@ -594,7 +605,7 @@ Common::Error TeenAgentEngine::run() {
 
 		bool busy = inventory->active() || scene_busy;
 
-		Graphics::Surface *surface = _system->lockScreen();
+		Graphics::Surface *surface = &_frame;
 
 		if (!busy) {
 			InventoryObject *selected_object = inventory->selectedObject();
@@ -620,8 +631,7 @@ Common::Error TeenAgentEngine::run() {
 
 		inventory->render(surface, tick_game? 1: 0);
 
-		_system->unlockScreen();
-
+		copyFrameToScreen();
 		_system->updateScreen();
 
 		console->onFrame();
@@ -636,6 +646,14 @@ Common::Error TeenAgentEngine::run() {
 	return Common::kNoError;
 }
 
+void TeenAgentEngine::copyFrameToScreen() {
+	// The scene is drawn from scratch into the frame, so only pass on the
+	// parts that actually differ from the previous one.
+	_shadowScreen->resetStats();
+	_shadowScreen->copyRectToScreen(_frame.pixels, _frame.pitch, 0, 0, _frame.w, _frame.h);
+	debugC(1, kDebugScreen, "copyFrameToScreen() %d pixels copied, %d skipped", _shadowScreen->getPixelsCopied(), _shadowScreen->getPixelsSkipped());
+}
+
 Common::String TeenAgentEngine::parseMessage(uint16 addr) {
 	Common::String message;
 	for (
@@ -32,6 +32,8 @@
 #include "sound/audiostream.h"
 #include "sound/mixer.h"
 #include "common/random.h"
+#include "graphics/shadowscreen.h"
+#include "graphics/surface.h"
 
 struct ADGameDescription;
 
@@ -45,6 +47,10 @@ struct ADGameDescription;
  */
 namespace TeenAgent {
 
+enum TeenAgentDebugChannels {
+	kDebugScreen = 1 << 0
+};
+
 struct Object;
 class Scene;
 class MusicPlayer;
@@ -129,6 +135,12 @@ public:
 
 	void setMusic(byte id);
 
+	/** The surface the scene and the inventory are drawn into. */
+	Graphics::Surface *getFrame() { return &_frame; }
+
+	/** Copies the parts of the frame that changed to the screen. */
+	void copyFrameToScreen();
+
 private:
 	void processObject();
 	bool trySelectedObject();
@@ -143,6 +155,9 @@ private:
 
 	uint _mark_delay, _game_delay;
 
+	Graphics::Surface _frame;
+	Graphics::ShadowScreen *_shadowScreen;
+
 	Common::Array<Common::Array<UseHotspot> > use_hotspots;
 };
 
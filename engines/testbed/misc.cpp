@@ -23,10 +23,91 @@
  */
 
 #include "testbed/misc.h"
+#include "common/dcl.h"
+#include "common/savefile.h"
 #include "common/timer.h"
 
+#include "gui/ThemeEngine.h"
+
 namespace Testbed {
 
+namespace {
+
+/**
+ * Writes a PKWARE DCL stream in binary mode, with a dictionary of 4096
+ * bytes. Only matches of 3 to 9 bytes are used, which keeps the encoder
+ * simple but still exercises all paths of the decoder.
+ */
+class DCLWriter {
+public:
+	DCLWriter() : _bitBuf(0), _bitCount(0) {
+		_data.push_back(0);	// binary mode
+		_data.push_back(6);	// length_param, 64 << 6 = 4096 byte dictionary
+	}
+
+	void literal(byte value) {
+		putBits(0, 1);
+		putBits(value, 8);
+	}
+
+	void match(uint length, uint distance) {
+		// Codes of the lengths 2 to 9 and of the high bits of the distance,
+		// with the first bit in the stream as their most significant bit
+		static const byte lengthCodes[8][2] = {
+			{ 0x05, 3 }, { 0x03, 2 }, { 0x04, 3 }, { 0x03, 3 },
+			{ 0x05, 4 }, { 0x04, 4 }, { 0x03, 4 }, { 0x05, 5 }
+		};
+		static const byte distanceCodes[64][2] = {
+			{ 0x03, 2 }, { 0x0B, 4 }, { 0x0A, 4 }, { 0x13, 5 }, { 0x12, 5 }, { 0x11, 5 }, { 0x10, 5 }, { 0x1F, 6 },
+			{ 0x1E, 6 }, { 0x1D, 6 }, { 0x1C, 6 }, { 0x1B, 6 }, { 0x1A, 6 }, { 0x19, 6 }, { 0x18, 6 }, { 0x17, 6 },
+			{ 0x16, 6 }, { 0x15, 6 }, { 0x14, 6 }, { 0x13, 6 }, { 0x12, 6 }, { 0x11, 6 }, { 0x21, 7 }, { 0x20, 7 },
+			{ 0x1F, 7 }, { 0x1E, 7 }, { 0x1D, 7 }, { 0x1C, 7 }, { 0x1B, 7 }, { 0x1A, 7 }, { 0x19, 7 }, { 0x18, 7 },
+			{ 0x17, 7 }, { 0x16, 7 }, { 0x15, 7 }, { 0x14, 7 }, { 0x13, 7 }, { 0x12, 7 }, { 0x11, 7 }, { 0x10, 7 },
+			{ 0x0F, 7 }, { 0x0E, 7 }, { 0x0D, 7 }, { 0x0C, 7 }, { 0x0B, 7 }, { 0x0A, 7 }, { 0x09, 7 }, { 0x08, 7 },
+			{ 0x0F, 8 }, { 0x0E, 8 }, { 0x0D, 8 }, { 0x0C, 8 }, { 0x0B, 8 }, { 0x0A, 8 }, { 0x09, 8 }, { 0x08, 8 },
+			{ 0x07, 8 }, { 0x06, 8 }, { 0x05, 8 }, { 0x04, 8 }, { 0x03, 8 }, { 0x02, 8 }, { 0x01, 8 }, { 0x00, 8 }
+		};
+
+		assert(length >= 3 && length <= 9 && distance >= 1 && distance <= 4096);
+		putBits(1, 1);
+		putCode(lengthCodes[length - 2][0], lengthCodes[length - 2][1]);
+		putCode(distanceCodes[(distance - 1) >> 6][0], distanceCodes[(distance - 1) >> 6][1]);
+		putBits((distance - 1) & 0x3F, 6);
+	}
+
+	const Common::Array<byte> &finish() {
+		if (_bitCount)
+			_data.push_back(_bitBuf);
+		_bitBuf = _bitCount = 0;
+		return _data;
+	}
+
+private:
+	void putBits(uint32 value, uint count) {
+		for (uint i = 0; i < count; ++i)
+			putBit((value >> i) & 1);
+	}
+
+	void putCode(uint32 code, uint length) {
+		while (length--)
+			putBit((code >> length) & 1);
+	}
+
+	void putBit(uint bit) {
+		_bitBuf |= bit << _bitCount;
+		if (++_bitCount == 8) {
+			_data.push_back(_bitBuf);
+			_bitBuf = _bitCount = 0;
+		}
+	}
+
+	Common::Array<byte> _data;
+	byte _bitBuf;
+	uint _bitCount;
+};
+
+} // End of anonymous namespace
+
 Common::String MiscTests::getHumanReadableFormat(TimeDate &td) {
 	return Common::String::format("%d:%d:%d on %d/%d/%d (dd/mm/yyyy)", td.tm_hour, td.tm_min, td.tm_sec, td.tm_mday, td.tm_mon + 1, td.tm_year + 1900);
 }
@@ -38,6 +119,18 @@ void MiscTests::timerCallback(void *arg) {
 	valToModify = 999; // some arbitrary value
 }
 
+void MiscTests::timerAccuracyCallback(void *arg) {
+	TimerAccuracyVars &vars = *((TimerAccuracyVars *)arg);
+	const uint32 now = g_system->getMillis();
+
+	if (vars.calls) {
+		const uint32 gap = now - vars.lastCall;
+		vars.maxGap = MAX(vars.maxGap, gap);
+	}
+	vars.lastCall = now;
+	vars.calls++;
+}
+
 void MiscTests::criticalSection(void *arg) {
 	SharedVars &sv = *((SharedVars *)arg);
 
@@ -125,6 +218,153 @@ TestExitStatus MiscTests::testTimers() {
 	return kTestFailed;
 }
 
+TestExitStatus MiscTests::testTimerAccuracy() {
+	const int intervalMicros = 5000;
+	const int durationMillis = 2000;
+	static TimerAccuracyVars vars;
+	memset(&vars, 0, sizeof(vars));
+
+	if (!g_system->getTimerManager()->installTimerProc(timerAccuracyCallback, intervalMicros, &vars))
+		return kTestFailed;
+
+	const uint32 start = g_system->getMillis();
+	g_system->delayMillis(durationMillis);
+	g_system->getTimerManager()->removeTimerProc(timerAccuracyCallback);
+	const uint32 elapsed = g_system->getMillis() - start;
+
+	const uint32 expected = elapsed * 1000 / intervalMicros;
+	Testsuite::logDetailedPrintf("Timer called %d times in %d ms, expected %d, longest gap %d ms\n",
+		vars.calls, elapsed, expected, vars.maxGap);
+
+	// The timer resolution may be lower than the interval, but the timer
+	// must not drift
+	if (vars.calls + expected / 20 < expected || vars.calls > expected + expected / 20 + 1)
+		return kTestFailed;
+
+	return kTestPassed;
+}
+
+uint32 MiscTests::loadTheme(const Common::String &id, Common::String &themeId) {
+	const uint32 start = g_system->getMillis();
+
+	GUI::ThemeEngine theme(id, GUI::ThemeEngine::kGfxStandard16bit);
+	if (!theme.init())
+		return (uint32)-1;
+
+	themeId = theme.getThemeId();
+	return g_system->getMillis() - start;
+}
+
+TestExitStatus MiscTests::testThemeStartup() {
+	// Compares loading the themes by parsing their STX files to loading
+	// them from the compiled theme cache
+	const char *themes[] = { "scummmodern", "scummclassic", "builtin" };
+	const int runs = 5;
+
+	for (int i = 0; i < ARRAYSIZE(themes); ++i) {
+		// The first load finds the theme and warms up the file cache
+		Common::String themeId;
+		if (loadTheme(themes[i], themeId) == (uint32)-1) {
+			Testsuite::logDetailedPrintf("Theme '%s' could not be loaded\n", themes[i]);
+			return kTestFailed;
+		}
+
+		uint32 parsed = 0, cached = 0;
+		for (int run = 0; run < runs; ++run) {
+			g_system->getSavefileManager()->removeSavefile(GUI::ThemeEngine::getThemeCacheName(themeId));
+			const uint32 parseTime = loadTheme(themes[i], themeId);
+			const uint32 cacheTime = loadTheme(themes[i], themeId);
+
+			if (parseTime == (uint32)-1 || cacheTime == (uint32)-1)
+				return kTestFailed;
+
+			parsed += parseTime;
+			cached += cacheTime;
+		}
+
+		Testsuite::logDetailedPrintf("Theme '%s': %d ms parsed, %d ms from the theme cache\n",
+			themeId.c_str(), parsed / runs, cached / runs);
+	}
+
+	return kTestPassed;
+}
+
+TestExitStatus MiscTests::testDecompression() {
+	// Measures the throughput of the DCL decompressor on text like data,
+	// which SCI and Mohawk games compress their resources with
+	static const char *const words[] = {
+		"the ", "of ", "and ", "you ", "door ", "look ", "open ", "key ",
+		"with ", "castle ", "guard ", "sword ", "quest ", "is ", "a ", "\n"
+	};
+	const uint32 size = 1024 * 1024;
+	const int runs = 5;
+
+	Common::Array<byte> text;
+	uint32 seed = 0x1234567;
+	while (text.size() < size) {
+		seed = seed * 1103515245 + 12345;
+		for (const char *c = words[(seed >> 16) & 15]; *c && text.size() < size; ++c)
+			text.push_back(*c);
+	}
+
+	// Greedy compression, looking up the last occurrence of every three
+	// byte sequence
+	uint32 *last = new uint32[4096];
+	memset(last, 0xFF, 4096 * sizeof(uint32));
+
+	DCLWriter writer;
+	for (uint32 pos = 0; pos < size; ) {
+		uint length = 0;
+		uint32 distance = 0;
+		if (pos + 3 <= size) {
+			const uint hash = (text[pos] * 33 * 33 + text[pos + 1] * 33 + text[pos + 2]) & 4095;
+			const uint32 candidate = last[hash];
+			last[hash] = pos;
+
+			if (candidate != 0xFFFFFFFF && pos - candidate <= 4096) {
+				while (length < 9 && pos + length < size && text[candidate + length] == text[pos + length])
+					++length;
+				distance = pos - candidate;
+			}
+		}
+
+		if (length >= 3) {
+			writer.match(length, distance);
+			pos += length;
+		} else {
+			writer.literal(text[pos]);
+			++pos;
+		}
+	}
+	delete[] last;
+
+	const Common::Array<byte> &packed = writer.finish();
+	byte *unpacked = new byte[size];
+	bool success = true;
+
+	uint32 time = 0;
+	for (int run = 0; run < runs && success; ++run) {
+		const uint32 start = g_system->getMillis();
+		success = Common::decompressDCL(packed.begin(), unpacked, packed.size(), size);
+		time += g_system->getMillis() - start;
+	}
+
+	if (success && memcmp(unpacked, text.begin(), size) != 0)
+		success = false;
+	delete[] unpacked;
+
+	if (!success) {
+		Testsuite::logDetailedPrintf("DCL data was not decompressed correctly\n");
+		return kTestFailed;
+	}
+
+	time = MAX<uint32>(time / runs, 1);
+	Testsuite::logDetailedPrintf("DCL: %d KB packed to %d KB, unpacked in %d ms (%d KB/ms)\n",
+		size / 1024, packed.size() / 1024, time, size / 1024 / time);
+
+	return kTestPassed;
+}
+
 TestExitStatus MiscTests::testMutexes() {
 
 	if (ConfParams.isSessionInteractive()) {
@@ -166,7 +406,10 @@ TestExitStatus MiscTests::testMutexes() {
 MiscTestSuite::MiscTestSuite() {
 	addTest("Datetime", &MiscTests::testDateTime, false);
 	addTest("Timers", &MiscTests::testTimers, false);
+	addTest("TimerAccuracy", &MiscTests::testTimerAccuracy, false);
 	addTest("Mutexes", &MiscTests::testMutexes, false);
+	addTest("ThemeStartup", &MiscTests::testThemeStartup, false);
+	addTest("Decompression", &MiscTests::testDecompression, false);
 }
 
 } // End of namespace Testbed
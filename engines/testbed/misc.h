@@ -38,6 +38,13 @@ struct SharedVars {
 	OSystem::MutexRef mutex;
 };
 
+// Shared variables used in the timer accuracy test
+struct TimerAccuracyVars {
+	uint32 calls;
+	uint32 lastCall;
+	uint32 maxGap;
+};
+
 namespace MiscTests {
 
 // Miscellaneous tests include testing datetime, timers and mutexes
@@ -45,12 +52,17 @@ namespace MiscTests {
 // Helper functions for Misc tests
 Common::String getHumanReadableFormat(TimeDate &td);
 void timerCallback(void *arg);
+void timerAccuracyCallback(void *arg);
 void criticalSection(void *arg);
+uint32 loadTheme(const Common::String &id, Common::String &themeId);
 
 // will contain function declarations for Misc tests
 TestExitStatus testDateTime();
 TestExitStatus testTimers();
+TestExitStatus testTimerAccuracy();
 TestExitStatus testMutexes();
+TestExitStatus testThemeStartup();
+TestExitStatus testDecompression();
 // add more here
 
 } // End of namespace MiscTests
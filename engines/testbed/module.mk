@@ -12,7 +12,8 @@ MODULE_OBJS := \
 	savegame.o \
 	sound.o \
 	testbed.o \
-	testsuite.o
+	testsuite.o \
+	video.o
 
 MODULE_DIRS += \
 	engines/testbed
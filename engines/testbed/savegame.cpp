@@ -22,6 +22,7 @@
  * $Id$
  */
 
+#include "common/random.h"
 #include "common/savefile.h"
 
 #include "testbed/savegame.h"
@@ -188,12 +189,82 @@ TestExitStatus SaveGametests::testErrorMessages() {
 	return kTestPassed;
 }
 
+/**
+ * Writes a savefile in the background and checks that it can be listed and
+ * read back while it is being written, and after it has been written.
+ * Also logs how long the caller is blocked compared to a normal save.
+ */
+TestExitStatus SaveGametests::testBackgroundSaving() {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	const uint32 size = 1024 * 1024;
+	const char *fileName = "tBedBackgroundSavefile.0";
+
+	byte *data = new byte[size];
+	Common::RandomSource rnd;
+	for (uint32 i = 0; i < size; ++i)
+		data[i] = (i & 0x100) ? (byte)rnd.getRandomNumber(255) : (byte)i;
+
+	uint32 times[2];
+	for (int background = 0; background < 2; ++background) {
+		uint32 start = g_system->getMillis();
+		Common::OutSaveFile *saveFile = background ? saveFileMan->openForSavingInBackground(fileName) : saveFileMan->openForSaving(fileName);
+		if (!saveFile) {
+			Testsuite::logDetailedPrintf("Can't open saveFile %s\n", fileName);
+			delete[] data;
+			return kTestFailed;
+		}
+		saveFile->write(data, size);
+		saveFile->finalize();
+		delete saveFile;
+		times[background] = g_system->getMillis() - start;
+
+		// Check the savefile twice: possibly while it is still being
+		// written, and when it is surely done
+		for (int pass = 0; pass < 2; ++pass) {
+			if (pass == 1)
+				saveFileMan->waitForSaves();
+
+			Common::StringArray savefileList = saveFileMan->listSavefiles("tBedBackgroundSavefile.?");
+			if (savefileList.size() != 1) {
+				Testsuite::logDetailedPrintf("Listing the savefile failed\n");
+				delete[] data;
+				return kTestFailed;
+			}
+
+			Common::InSaveFile *loadFile = saveFileMan->openForLoading(fileName);
+			bool match = loadFile && loadFile->size() == (int32)size;
+			for (uint32 i = 0; match && i < size; ++i)
+				match = (loadFile->readByte() == data[i]);
+			delete loadFile;
+
+			if (!match) {
+				Testsuite::logDetailedPrintf("Reading back the savefile failed\n");
+				delete[] data;
+				return kTestFailed;
+			}
+		}
+
+		if (saveFileMan->isSaving(fileName)) {
+			Testsuite::logDetailedPrintf("The savefile is still being written after waitForSaves()\n");
+			delete[] data;
+			return kTestFailed;
+		}
+	}
+
+	delete[] data;
+	saveFileMan->removeSavefile(fileName);
+
+	Testsuite::logDetailedPrintf("Saving 1MB blocked for %d ms normally, %d ms in the background\n", times[0], times[1]);
+	return kTestPassed;
+}
+
 SaveGameTestSuite::SaveGameTestSuite() {
 	addTest("OpeningSaveFile", &SaveGametests::testSaveLoadState, false);
 	addTest("RemovingSaveFile", &SaveGametests::testRemovingSavefile, false);
 	addTest("RenamingSaveFile", &SaveGametests::testRenamingSavefile, false);
 	addTest("ListingSaveFile", &SaveGametests::testListingSavefile, false);
 	addTest("VerifyErrorMessages", &SaveGametests::testErrorMessages, false);
+	addTest("BackgroundSaving", &SaveGametests::testBackgroundSaving, false);
 }
 
 } // End of namespace Testbed
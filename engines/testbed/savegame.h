@@ -40,6 +40,7 @@ TestExitStatus testRemovingSavefile();
 TestExitStatus testRenamingSavefile();
 TestExitStatus testListingSavefile();
 TestExitStatus testErrorMessages();
+TestExitStatus testBackgroundSaving();
 // add more here
 
 } // End of namespace SaveGametests
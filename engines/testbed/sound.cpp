@@ -22,6 +22,9 @@
  * $Id$
  */
 
+#include "common/archive.h"
+
+#include "sound/softsynth/emumidi.h"
 #include "sound/softsynth/pcspk.h"
 
 #include "backends/audiocd/audiocd.h"
@@ -261,6 +264,197 @@ TestExitStatus SoundSubsystem::sampleRates() {
 	return passed;
 }
 
+/**
+ * Renders a fixed MIDI sequence through the MT-32 emulator as fast as
+ * possible and reports the real-time factor of the emulation.
+ */
+TestExitStatus SoundSubsystem::mt32Rendering() {
+	const int seconds = 30;
+	const int stepMillis = 125;
+
+	MidiDriver::DeviceHandle dev = MidiDriver::getDeviceHandle("mt32");
+	if (!dev) {
+		Testsuite::logPrintf("Info! Skipping test : MT-32 Rendering, the MT-32 emulator is not available\n");
+		return kTestSkipped;
+	}
+
+	MidiDriver *driver = MidiDriver::createMidi(dev);
+	if (!(SearchMan.hasFile("MT32_CONTROL.ROM") || SearchMan.hasFile("CM32L_CONTROL.ROM")) ||
+		!(SearchMan.hasFile("MT32_PCM.ROM") || SearchMan.hasFile("CM32L_PCM.ROM"))) {
+		Testsuite::logPrintf("Info! Skipping test : MT-32 Rendering, the MT-32 ROMs were not found\n");
+		delete driver;
+		return kTestSkipped;
+	}
+
+	if (driver->open()) {
+		Testsuite::logDetailedPrintf("Error! Could not open the MT-32 emulator\n");
+		delete driver;
+		return kTestFailed;
+	}
+
+	// The emulator is an audio stream feeding the mixer. Keep the mixer from
+	// pulling samples while they are rendered here.
+	Audio::Mixer *mixer = g_system->getMixer();
+	mixer->pauseAll(true);
+
+	MidiDriver_Emulated *emulator = static_cast<MidiDriver_Emulated *>(driver);
+	const int samplesPerStep = emulator->getRate() * stepMillis / 1000;
+	int16 *buffer = new int16[samplesPerStep * 2];
+
+	// Eight melodic parts playing broken chords over a drum pattern
+	static const int arpeggio[8] = { 0, 4, 7, 12, 7, 4, 0, -5 };
+	static const byte drums[8] = { 36, 42, 38, 42, 36, 36, 38, 46 };
+	byte playing[8];
+	memset(playing, 0, sizeof(playing));
+
+	for (int part = 0; part < 8; ++part)
+		driver->send(0xC0 | (part + 1) | ((part * 9) << 8));
+
+	uint32 renderTime = 0;
+	const int steps = seconds * 1000 / stepMillis;
+	for (int step = 0; step < steps; ++step) {
+		for (int part = 0; part < 8; ++part) {
+			if (playing[part])
+				driver->send(0x80 | (part + 1) | (playing[part] << 8));
+			playing[part] = 36 + part * 5 + arpeggio[(step + part) & 7];
+			driver->send(0x90 | (part + 1) | (playing[part] << 8) | ((64 + ((step * 7) & 63)) << 16));
+		}
+		driver->send(0x99 | (drums[step & 7] << 8) | (100 << 16));
+
+		uint32 start = g_system->getMillis();
+		emulator->readBuffer(buffer, samplesPerStep * 2);
+		renderTime += g_system->getMillis() - start;
+	}
+
+	delete[] buffer;
+	mixer->pauseAll(false);
+	driver->close();
+	delete driver;
+
+	if (renderTime) {
+		uint32 factor = seconds * 100000 / renderTime;
+		Testsuite::logPrintf("Info! Rendered %d seconds of MT-32 music in %d ms (%d.%02d times real time)\n",
+			seconds, renderTime, factor / 100, factor % 100);
+	} else {
+		Testsuite::logPrintf("Info! Rendered %d seconds of MT-32 music in less than a millisecond\n", seconds);
+	}
+
+	return kTestPassed;
+}
+
+namespace {
+
+/**
+ * Emulated MIDI driver whose output is a running sample counter plus the
+ * value of the last event received, so that any difference in the timing
+ * of events shows up in the output.
+ */
+class CountingMidiDriver : public MidiDriver_Emulated {
+public:
+	CountingMidiDriver() : MidiDriver_Emulated(g_system->getMixer()), _position(0), _ticks(0), _value(0) {
+		_baseFreq = 1000;
+	}
+
+	int open() {
+		MidiDriver_Emulated::open();
+		return 0;
+	}
+	void close() { stopRenderAhead(); }
+	void send(uint32 b) { sendEvent(b); }
+	MidiChannel *allocateChannel() { return 0; }
+	MidiChannel *getPercussionChannel() { return 0; }
+
+	bool isStereo() const { return false; }
+	int getRate() const { return 11025; }
+
+	void startRenderAhead(uint32 millis) { MidiDriver_Emulated::startRenderAhead(millis); }
+
+	uint32 _position;
+	uint32 _ticks;
+	Common::Array<uint32> _eventPositions;
+
+protected:
+	void generateSamples(int16 *buf, int len) {
+		for (int i = 0; i < len; ++i)
+			buf[i] = (int16)(_position + i + _value);
+		_position += len;
+	}
+
+	void processEvent(uint32 b) {
+		_value = b;
+		_eventPositions.push_back(_position);
+	}
+
+private:
+	uint32 _value;
+};
+
+void countingTimerCallback(void *refCon) {
+	CountingMidiDriver *driver = (CountingMidiDriver *)refCon;
+	driver->send(++driver->_ticks * 97);
+}
+
+}
+
+/**
+ * Checks that rendering ahead on the timer thread produces the same output
+ * as rendering in the mixer thread, with the events sent by the timer
+ * callback delayed by exactly the length of the ring buffer.
+ */
+TestExitStatus SoundSubsystem::renderAhead() {
+	const int totalSamples = 11025;
+	const int chunkSamples = 441;
+	const uint32 renderAheadMillis = 100;
+
+	int16 *actual = new int16[totalSamples];
+
+	CountingMidiDriver reference;
+	reference.open();
+	reference.setTimerCallback(&reference, &countingTimerCallback);
+	for (int i = 0; i < totalSamples; i += chunkSamples)
+		reference.readBuffer(actual + i, chunkSamples);
+	reference.close();
+
+	CountingMidiDriver driver;
+	driver.open();
+	driver.setTimerCallback(&driver, &countingTimerCallback);
+	driver.startRenderAhead(renderAheadMillis);
+	const uint32 latency = driver.getRate() * renderAheadMillis / 1000;
+
+	for (int i = 0; i < totalSamples; i += chunkSamples) {
+		driver.readBuffer(actual + i, chunkSamples);
+		g_system->delayMillis(chunkSamples * 1000 / driver.getRate());
+	}
+	uint32 underruns = driver.getUnderruns();
+	uint32 rendered = driver._position;
+	driver.close();
+
+	// Every event of the reference is expected one ring buffer later
+	bool sameOutput = true;
+	int16 value = 0;
+	uint event = 0;
+	for (int i = 0; sameOutput && i < totalSamples; ++i) {
+		while (event < reference._eventPositions.size() && reference._eventPositions[event] + latency <= (uint32)i)
+			value = (int16)(++event * 97);
+		sameOutput = actual[i] == (int16)(i + value);
+	}
+
+	delete[] actual;
+
+	if (underruns) {
+		Testsuite::logDetailedPrintf("Error! Rendering ahead fell behind %d times\n", underruns);
+		return kTestFailed;
+	}
+
+	if (!sameOutput) {
+		Testsuite::logDetailedPrintf("Error! Rendering ahead changed the output or the event timing\n");
+		return kTestFailed;
+	}
+
+	Testsuite::logDetailedPrintf("Rendered %d samples, %d samples ahead of the mixer\n", rendered, rendered - totalSamples);
+	return kTestPassed;
+}
+
 SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 	addTest("SimpleBeeps", &SoundSubsystem::playBeeps, true);
 	addTest("MixSounds", &SoundSubsystem::mixSounds, true);
@@ -276,6 +470,8 @@ SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 		}
 	}
 	addTest("SampleRates", &SoundSubsystem::sampleRates, true);
+	addTest("MT32Rendering", &SoundSubsystem::mt32Rendering, false);
+	addTest("RenderAhead", &SoundSubsystem::renderAhead, false);
 }
 
 }	// End of namespace Testbed
@@ -50,6 +50,8 @@ TestExitStatus playBeeps();
 TestExitStatus mixSounds();
 TestExitStatus audiocdOutput();
 TestExitStatus sampleRates();
+TestExitStatus mt32Rendering();
+TestExitStatus renderAhead();
 }
 
 class SoundSubsystemTestSuite : public Testsuite {
@@ -0,0 +1,897 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/substream.h"
+
+#include "graphics/conversion.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "video/qt_decoder.h"
+#include "video/smk_decoder.h"
+#include "video/decode_ahead_decoder.h"
+
+#include "testbed/video.h"
+
+namespace Testbed {
+
+namespace {
+
+/**
+ * Writes bits in the LSB-first order the Smacker decoder reads them in.
+ */
+class SmackerBitWriter {
+public:
+	SmackerBitWriter() : _curByte(0), _bitCount(0) {}
+
+	void putBits(uint32 value, int count) {
+		for (int i = 0; i < count; ++i) {
+			_curByte |= ((value >> i) & 1) << _bitCount;
+			if (++_bitCount == 8) {
+				_data.push_back(_curByte);
+				_curByte = 0;
+				_bitCount = 0;
+			}
+		}
+	}
+
+	// Pads with zero bits up to a multiple of the given number of bytes
+	void align(uint bytes) {
+		if (_bitCount)
+			putBits(0, 8 - _bitCount);
+		while (_data.size() % bytes)
+			_data.push_back(0);
+	}
+
+	const Common::Array<byte> &getData() const { return _data; }
+
+private:
+	Common::Array<byte> _data;
+	byte _curByte;
+	int _bitCount;
+};
+
+/**
+ * Huffman tree over a fixed set of values, in the format used by Smacker.
+ * The tree is deliberately lopsided, so that both short codes and codes
+ * longer than the lookup tables of the decoder are used.
+ */
+class SmackerTreeWriter {
+public:
+	SmackerTreeWriter(const Common::Array<uint16> &values) {
+		build(values, 0, values.size(), 0, 0);
+	}
+
+	// Writes the tree in the format of the trees holding 8-bit values
+	void writeSmallTree(SmackerBitWriter &bw) const {
+		bw.putBits(1, 1);
+		writeNode(bw, 0, 0, 0);
+		bw.putBits(0, 1);
+	}
+
+	// Writes the tree in the format of the trees holding 16-bit values
+	void writeBigTree(SmackerBitWriter &bw, const SmackerTreeWriter &loBytes, const SmackerTreeWriter &hiBytes, const uint16 *markers) const {
+		bw.putBits(1, 1);
+		loBytes.writeSmallTree(bw);
+		hiBytes.writeSmallTree(bw);
+		for (int i = 0; i < 3; ++i)
+			bw.putBits(markers[i], 16);
+		writeNode(bw, 0, &loBytes, &hiBytes);
+		bw.putBits(0, 1);
+	}
+
+	void putValue(SmackerBitWriter &bw, uint16 value) const {
+		const Node &leaf = _nodes[_leaves[value]];
+		bw.putBits(leaf.code, leaf.length);
+	}
+
+	// Picks a leaf with the probability a real Huffman code would give it
+	uint16 getRandomValue(Common::RandomSource &rnd) const {
+		uint node = 0;
+		while (_nodes[node].child[0] >= 0)
+			node = _nodes[node].child[rnd.getRandomNumber(1)];
+		return _nodes[node].value;
+	}
+
+	// Size to store in the Smacker header for this tree
+	uint32 getAllocSize() const { return (_nodes.size() + 3) * 4; }
+
+private:
+	struct Node {
+		int child[2];
+		uint16 value;
+		uint32 code;
+		int length;
+	};
+
+	Common::Array<Node> _nodes;
+	Common::HashMap<uint16, uint> _leaves;
+
+	int build(const Common::Array<uint16> &values, uint first, uint count, uint32 code, int length) {
+		Node node;
+		node.child[0] = node.child[1] = -1;
+		node.value = values[first];
+		node.code = code;
+		node.length = length;
+
+		int index = _nodes.size();
+		_nodes.push_back(node);
+
+		if (count == 1) {
+			_leaves[node.value] = index;
+			return index;
+		}
+
+		uint leftCount = MAX<uint>(count / 4, 1);
+		int left = build(values, first, leftCount, code, length + 1);
+		int right = build(values, first + leftCount, count - leftCount, code | (1 << length), length + 1);
+
+		_nodes[index].child[0] = left;
+		_nodes[index].child[1] = right;
+		return index;
+	}
+
+	void writeNode(SmackerBitWriter &bw, int index, const SmackerTreeWriter *loBytes, const SmackerTreeWriter *hiBytes) const {
+		const Node &node = _nodes[index];
+
+		if (node.child[0] >= 0) {
+			bw.putBits(1, 1);
+			writeNode(bw, node.child[0], loBytes, hiBytes);
+			writeNode(bw, node.child[1], loBytes, hiBytes);
+		} else {
+			bw.putBits(0, 1);
+			if (loBytes) {
+				loBytes->putValue(bw, node.value & 0xFF);
+				hiBytes->putValue(bw, node.value >> 8);
+			} else {
+				bw.putBits(node.value, 8);
+			}
+		}
+	}
+};
+
+// Fills a list with distinct pseudo-random 16-bit values; the values following
+// the list are used as tree markers, which therefore never show up in a frame
+void fillTreeValues(Common::Array<uint16> &values, uint16 *markers, uint count) {
+	for (uint i = 0; i < count; ++i)
+		values.push_back(i * 0x9E37 + 0x1234);
+	for (uint i = 0; i < 3; ++i)
+		markers[i] = (count + i) * 0x9E37 + 0x1234;
+}
+
+void writeSmackerPair(byte *out, uint32 p1, uint32 p2) {
+	out[0] = p1 & 0xFF;
+	out[1] = p1 >> 8;
+	out[2] = p2 & 0xFF;
+	out[3] = p2 >> 8;
+}
+
+/**
+ * Writes big endian QuickTime atoms, filling in the size of each atom
+ * when it is closed.
+ */
+class QuickTimeAtomWriter {
+public:
+	void beginAtom(uint32 type) {
+		_openAtoms.push_back(_data.size());
+		writeUint32(0);
+		writeUint32(type);
+	}
+
+	void endAtom() {
+		uint32 start = _openAtoms.back();
+		_openAtoms.pop_back();
+		WRITE_BE_UINT32(&_data[start], _data.size() - start);
+	}
+
+	void writeByte(byte value) { _data.push_back(value); }
+	void writeUint16(uint16 value) { writeByte(value >> 8); writeByte(value & 0xFF); }
+	void writeUint32(uint32 value) { writeUint16(value >> 16); writeUint16(value & 0xFFFF); }
+	void writeZeros(uint count) { _data.resize(_data.size() + count); }
+
+	const Common::Array<byte> &getData() const { return _data; }
+
+private:
+	Common::Array<byte> _data;
+	Common::Array<uint32> _openAtoms;
+};
+
+/**
+ * Writes one 8-bit QuickTime RLE frame updating the given lines, using
+ * literal runs only.
+ */
+void writeQTRLEFrame(Common::Array<byte> &out, const byte *frame, uint width, uint startLine, uint lineCount) {
+	out.clear();
+
+	for (uint i = 0; i < 4; ++i)
+		out.push_back(0);	// chunk size, unused
+	out.push_back(0);
+	out.push_back(8);	// header: start line and line count follow
+	out.push_back(startLine >> 8);
+	out.push_back(startLine & 0xFF);
+	out.push_back(0);
+	out.push_back(0);
+	out.push_back(lineCount >> 8);
+	out.push_back(lineCount & 0xFF);
+	out.push_back(0);
+	out.push_back(0);
+
+	for (uint y = startLine; y < startLine + lineCount; ++y) {
+		const byte *line = frame + y * width;
+		out.push_back(1);	// no skip
+
+		// The decoder keeps the byte count of a run in an int8
+		for (uint x = 0; x < width; ) {
+			uint groups = MIN<uint>(31, (width - x) / 4);
+			out.push_back(groups);
+			for (uint i = 0; i < groups * 4; ++i)
+				out.push_back(line[x++]);
+		}
+
+		out.push_back(0xFF);	// end of line
+	}
+}
+
+/**
+ * QuickTimeDecoder counting the frames it decodes, including those decoded
+ * while seeking.
+ */
+class CountingQuickTimeDecoder : public Video::QuickTimeDecoder {
+public:
+	CountingQuickTimeDecoder() : _decodedFrames(0) {}
+
+	const Graphics::Surface *decodeNextFrame() {
+		_decodedFrames++;
+		return Video::QuickTimeDecoder::decodeNextFrame();
+	}
+
+	uint getDecodedFrameCount() const { return _decodedFrames; }
+
+private:
+	uint _decodedFrames;
+};
+
+} // End of anonymous namespace
+
+/**
+ * Creates a Smacker v4 video, using all block types and full block modes.
+ * The expected contents of every frame are stored in expectedFrames, which
+ * must hold frameCount * width * height bytes.
+ */
+Common::SeekableReadStream *VideoTests::createSmackerStream(uint width, uint height, uint frameCount, byte *expectedFrames) {
+	Common::RandomSource rnd;
+	rnd.setSeed(0x5EED);
+
+	Common::Array<uint16> byteValues;
+	for (uint i = 0; i < 256; ++i)
+		byteValues.push_back(i);
+
+	// Block types: MONO, FULL and SKIP blocks with several run lengths, and
+	// FILL blocks with a handful of colors
+	static const byte runIndices[] = { 0, 1, 3, 7, 15, 59 };
+	Common::Array<uint16> typeValues;
+	for (uint type = 0; type < 3; ++type)
+		for (uint i = 0; i < ARRAYSIZE(runIndices); ++i)
+			typeValues.push_back((runIndices[i] << 2) | type);
+	for (uint color = 0; color < 256; color += 17) {
+		typeValues.push_back((color << 8) | 3);
+		typeValues.push_back((color << 8) | (3 << 2) | 3);
+	}
+	const uint16 typeMarkers[3] = { 0xFFFF, 0xFFFE, 0xFFFD };
+
+	Common::Array<uint16> mapValues, clrValues, fullValues;
+	uint16 mapMarkers[3], clrMarkers[3], fullMarkers[3];
+	fillTreeValues(mapValues, mapMarkers, 300);
+	fillTreeValues(clrValues, clrMarkers, 200);
+	fillTreeValues(fullValues, fullMarkers, 600);
+
+	SmackerTreeWriter byteTree(byteValues);
+	SmackerTreeWriter typeTree(typeValues);
+	SmackerTreeWriter mapTree(mapValues);
+	SmackerTreeWriter clrTree(clrValues);
+	SmackerTreeWriter fullTree(fullValues);
+
+	SmackerBitWriter trees;
+	mapTree.writeBigTree(trees, byteTree, byteTree, mapMarkers);
+	clrTree.writeBigTree(trees, byteTree, byteTree, clrMarkers);
+	fullTree.writeBigTree(trees, byteTree, byteTree, fullMarkers);
+	typeTree.writeBigTree(trees, byteTree, byteTree, typeMarkers);
+	trees.align(4);
+
+	const uint bw = width / 4;
+	const uint blocks = bw * (height / 4);
+	Common::Array<SmackerBitWriter> frames;
+	frames.resize(frameCount);
+
+	for (uint frame = 0; frame < frameCount; ++frame) {
+		byte *expected = expectedFrames + frame * width * height;
+		if (frame > 0)
+			memcpy(expected, expected - width * height, width * height);
+		else
+			memset(expected, 0, width * height);
+
+		SmackerBitWriter &fw = frames[frame];
+		uint block = 0;
+
+		while (block < blocks) {
+			uint16 type = typeTree.getRandomValue(rnd);
+			typeTree.putValue(fw, type);
+
+			uint index = (type >> 2) & 0x3f;
+			uint run = MIN<uint>((index <= 58) ? index + 1 : 128 << (index - 59), blocks - block);
+			uint mode = rnd.getRandomNumber(2);
+
+			if ((type & 3) == 1) {
+				// Full block mode bits: 00 - mode 0, 10 - mode 1, 01 - mode 2
+				if (mode == 1) {
+					fw.putBits(1, 1);
+				} else {
+					fw.putBits(0, 1);
+					fw.putBits(mode == 2, 1);
+				}
+			}
+
+			for (; run > 0; --run, ++block) {
+				byte *out = expected + (block / bw) * width * 4 + (block % bw) * 4;
+
+				switch (type & 3) {
+				case 0: {
+					uint16 clr = clrTree.getRandomValue(rnd);
+					uint16 map = mapTree.getRandomValue(rnd);
+					clrTree.putValue(fw, clr);
+					mapTree.putValue(fw, map);
+					for (uint i = 0; i < 16; ++i)
+						out[(i / 4) * width + (i % 4)] = (map & (1 << i)) ? (clr >> 8) : (clr & 0xFF);
+					break;
+				}
+				case 1:
+					if (mode == 0) {
+						for (uint i = 0; i < 4; ++i) {
+							uint16 p1 = fullTree.getRandomValue(rnd);
+							uint16 p2 = fullTree.getRandomValue(rnd);
+							fullTree.putValue(fw, p1);
+							fullTree.putValue(fw, p2);
+							writeSmackerPair(out + i * width, p2, p1);
+						}
+					} else if (mode == 1) {
+						for (uint i = 0; i < 2; ++i) {
+							uint16 p = fullTree.getRandomValue(rnd);
+							fullTree.putValue(fw, p);
+							for (uint j = 0; j < 2; ++j) {
+								byte *line = out + (i * 2 + j) * width;
+								line[0] = line[1] = p & 0xFF;
+								line[2] = line[3] = p >> 8;
+							}
+						}
+					} else {
+						for (uint i = 0; i < 2; ++i) {
+							uint16 p2 = fullTree.getRandomValue(rnd);
+							uint16 p1 = fullTree.getRandomValue(rnd);
+							fullTree.putValue(fw, p2);
+							fullTree.putValue(fw, p1);
+							writeSmackerPair(out + (i * 2) * width, p1, p2);
+							writeSmackerPair(out + (i * 2 + 1) * width, p1, p2);
+						}
+					}
+					break;
+				case 2:
+					break;
+				case 3:
+					for (uint i = 0; i < 4; ++i)
+						memset(out + i * width, type >> 8, 4);
+					break;
+				}
+			}
+		}
+
+		fw.align(4);
+	}
+
+	// Header, frame sizes and types, trees and frame data
+	uint32 size = 104 + frameCount * 5 + trees.getData().size();
+	for (uint frame = 0; frame < frameCount; ++frame)
+		size += frames[frame].getData().size();
+
+	byte *data = (byte *)malloc(size);
+	Common::MemoryWriteStream out(data, size);
+
+	out.writeUint32BE(MKID_BE('SMK4'));
+	out.writeUint32LE(width);
+	out.writeUint32LE(height);
+	out.writeUint32LE(frameCount);
+	out.writeSint32LE(66);	// ms per frame
+	out.writeUint32LE(0);	// flags
+	for (uint i = 0; i < 7; ++i)
+		out.writeUint32LE(0);	// audio sizes
+	out.writeUint32LE(trees.getData().size());
+	out.writeUint32LE(mapTree.getAllocSize());
+	out.writeUint32LE(clrTree.getAllocSize());
+	out.writeUint32LE(fullTree.getAllocSize());
+	out.writeUint32LE(typeTree.getAllocSize());
+	for (uint i = 0; i < 7; ++i)
+		out.writeUint32LE(0);	// audio info
+	out.writeUint32LE(0);
+
+	for (uint frame = 0; frame < frameCount; ++frame)
+		out.writeUint32LE(frames[frame].getData().size());
+	for (uint frame = 0; frame < frameCount; ++frame)
+		out.writeByte(0);
+
+	out.write(trees.getData().begin(), trees.getData().size());
+	for (uint frame = 0; frame < frameCount; ++frame)
+		out.write(frames[frame].getData().begin(), frames[frame].getData().size());
+
+	assert(out.pos() == size);
+	return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+}
+
+/**
+ * Creates a QuickTime movie with one 8-bit QuickTime RLE video track. Key
+ * frames replace the whole image, the frames in between only a band of
+ * lines, so they can only be decoded correctly from the preceding key
+ * frame. Frames are stored four to a chunk. The expected contents of every
+ * frame are stored in expectedFrames, which must hold
+ * frameCount * width * height bytes. The width has to be a multiple of 4.
+ */
+Common::SeekableReadStream *VideoTests::createQuickTimeStream(uint width, uint height, uint frameCount, uint keyFrameInterval, byte *expectedFrames) {
+	Common::RandomSource rnd;
+	rnd.setSeed(0x5EED);
+
+	const uint framesPerChunk = 4;
+	const uint chunkCount = (frameCount + framesPerChunk - 1) / framesPerChunk;
+	const uint timeScale = 600;
+	const uint frameDuration = 40;
+
+	Common::Array<Common::Array<byte> > frames;
+	frames.resize(frameCount);
+
+	for (uint frame = 0; frame < frameCount; ++frame) {
+		byte *expected = expectedFrames + frame * width * height;
+		uint startLine = 0, lineCount = height;
+
+		if (frame % keyFrameInterval) {
+			memcpy(expected, expected - width * height, width * height);
+			lineCount = 8 + rnd.getRandomNumber(24);
+			startLine = rnd.getRandomNumber(height - lineCount);
+		}
+
+		for (uint i = startLine * width; i < (startLine + lineCount) * width; ++i)
+			expected[i] = rnd.getRandomNumber(255);
+
+		writeQTRLEFrame(frames[frame], expected, width, startLine, lineCount);
+	}
+
+	// The movie atom comes first, so its size is needed for the chunk
+	// offsets: write it twice
+	QuickTimeAtomWriter movie;
+	for (uint pass = 0; pass < 2; ++pass) {
+		uint32 dataOffset = movie.getData().size() + 8;
+		movie = QuickTimeAtomWriter();
+
+		movie.beginAtom(MKID_BE('moov'));
+
+		movie.beginAtom(MKID_BE('mvhd'));
+		movie.writeZeros(12);	// version, flags, creation and modification time
+		movie.writeUint32(timeScale);
+		movie.writeUint32(frameCount * frameDuration);
+		movie.writeUint32(0x10000);	// preferred rate
+		movie.writeUint16(0x100);	// preferred volume
+		movie.writeZeros(10);
+		movie.writeUint32(0x10000);	// display matrix
+		movie.writeZeros(12);
+		movie.writeUint32(0x10000);
+		movie.writeZeros(16);
+		movie.writeZeros(28);	// preview, poster, selection, current time, next track
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('trak'));
+
+		movie.beginAtom(MKID_BE('tkhd'));
+		movie.writeZeros(12);	// version, flags, creation and modification time
+		movie.writeUint32(1);	// track id
+		movie.writeUint32(0);
+		movie.writeUint32(frameCount * frameDuration);
+		movie.writeZeros(16);	// reserved, layer, alternate group, volume
+		movie.writeUint32(0x10000);	// display matrix
+		movie.writeZeros(12);
+		movie.writeUint32(0x10000);
+		movie.writeZeros(16);
+		movie.writeUint32(width << 16);
+		movie.writeUint32(height << 16);
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('mdia'));
+
+		movie.beginAtom(MKID_BE('mdhd'));
+		movie.writeZeros(12);	// version, flags, creation and modification time
+		movie.writeUint32(timeScale);
+		movie.writeUint32(frameCount * frameDuration);
+		movie.writeUint32(0);	// language, quality
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('hdlr'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(MKID_BE('mhlr'));
+		movie.writeUint32(MKID_BE('vide'));
+		movie.writeZeros(12);	// manufacturer, flags, flags mask
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('minf'));
+		movie.beginAtom(MKID_BE('stbl'));
+
+		movie.beginAtom(MKID_BE('stsd'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(1);	// entries
+		movie.beginAtom(MKID_BE('rle '));
+		movie.writeZeros(6);
+		movie.writeUint16(1);	// data reference index
+		movie.writeZeros(16);	// version, revision, vendor, quality
+		movie.writeUint16(width);
+		movie.writeUint16(height);
+		movie.writeUint32(0x480000);	// resolution
+		movie.writeUint32(0x480000);
+		movie.writeUint32(0);	// data size
+		movie.writeUint16(1);	// frames per sample
+		movie.writeZeros(32);	// codec name
+		movie.writeUint16(40);	// 8-bit greyscale
+		movie.writeUint16(0);	// color table id
+		movie.endAtom();
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('stts'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(1);	// entries
+		movie.writeUint32(frameCount);
+		movie.writeUint32(frameDuration);
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('stsc'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(1);	// entries
+		movie.writeUint32(1);	// first chunk
+		movie.writeUint32(framesPerChunk);
+		movie.writeUint32(1);	// sample description
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('stsz'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(0);	// sizes follow
+		movie.writeUint32(frameCount);
+		for (uint frame = 0; frame < frameCount; ++frame)
+			movie.writeUint32(frames[frame].size());
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('stco'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32(chunkCount);
+		uint32 offset = dataOffset;
+		for (uint frame = 0; frame < frameCount; ++frame) {
+			if (frame % framesPerChunk == 0)
+				movie.writeUint32(offset);
+			offset += frames[frame].size();
+		}
+		movie.endAtom();
+
+		movie.beginAtom(MKID_BE('stss'));
+		movie.writeUint32(0);	// version, flags
+		movie.writeUint32((frameCount + keyFrameInterval - 1) / keyFrameInterval);
+		for (uint frame = 0; frame < frameCount; frame += keyFrameInterval)
+			movie.writeUint32(frame + 1);
+		movie.endAtom();
+
+		movie.endAtom();	// stbl
+		movie.endAtom();	// minf
+		movie.endAtom();	// mdia
+		movie.endAtom();	// trak
+		movie.endAtom();	// moov
+	}
+
+	movie.beginAtom(MKID_BE('mdat'));
+	for (uint frame = 0; frame < frameCount; ++frame)
+		for (uint i = 0; i < frames[frame].size(); ++i)
+			movie.writeByte(frames[frame][i]);
+	movie.endAtom();
+
+	const Common::Array<byte> &movieData = movie.getData();
+	byte *data = (byte *)malloc(movieData.size());
+	memcpy(data, movieData.begin(), movieData.size());
+
+	return new Common::MemoryReadStream(data, movieData.size(), DisposeAfterUse::YES);
+}
+
+/**
+ * Decodes a synthetic Smacker video several times, verifying every frame
+ * and reporting the decoding speed in the log.
+ */
+TestExitStatus VideoTests::testSmackerDecoding() {
+	const uint width = 640;
+	const uint height = 480;
+	const uint frameCount = 30;
+	const uint passes = 4;
+
+	byte *expectedFrames = new byte[frameCount * width * height];
+	Common::SeekableReadStream *stream = createSmackerStream(width, height, frameCount, expectedFrames);
+
+	bool framesMatch = true;
+	uint32 decodeTime = 0;
+
+	for (uint pass = 0; pass < passes && framesMatch; ++pass) {
+		Video::SmackerDecoder decoder(g_system->getMixer());
+
+		// The decoder takes ownership of the stream it is given
+		if (!decoder.load(new Common::SeekableSubReadStream(stream, 0, stream->size()))) {
+			Testsuite::logDetailedPrintf("Failed to load the generated Smacker video\n");
+			framesMatch = false;
+			break;
+		}
+
+		for (uint frame = 0; frame < frameCount; ++frame) {
+			uint32 start = g_system->getMillis();
+			const Graphics::Surface *surface = decoder.decodeNextFrame();
+			decodeTime += g_system->getMillis() - start;
+
+			const byte *expected = expectedFrames + frame * width * height;
+			for (uint y = 0; y < height; ++y) {
+				if (memcmp(surface->getBasePtr(0, y), expected + y * width, width)) {
+					Testsuite::logDetailedPrintf("Frame %d, line %d differs from the expected contents\n", frame, y);
+					framesMatch = false;
+					break;
+				}
+			}
+
+			if (!framesMatch)
+				break;
+		}
+	}
+
+	delete stream;
+	delete[] expectedFrames;
+
+	if (!framesMatch)
+		return kTestFailed;
+
+	uint frames = frameCount * passes;
+	Testsuite::logPrintf("Info! Decoded %d Smacker frames of %dx%d in %d ms (%d frames per second)\n",
+		frames, width, height, decodeTime, decodeTime ? frames * 1000 / decodeTime : 0);
+
+	return kTestPassed;
+}
+
+/**
+ * Plays a synthetic Smacker video in real time through a DecodeAheadVideoDecoder,
+ * verifying every frame and logging how many frames were decoded ahead.
+ */
+TestExitStatus VideoTests::testDecodeAhead() {
+	const uint width = 640;
+	const uint height = 480;
+	const uint frameCount = 30;
+
+	byte *expectedFrames = new byte[frameCount * width * height];
+	Common::SeekableReadStream *stream = createSmackerStream(width, height, frameCount, expectedFrames);
+
+	Video::DecodeAheadVideoDecoder decoder(new Video::SmackerDecoder(g_system->getMixer()));
+	bool framesMatch = decoder.load(stream);
+	uint framesDecodedAhead = 0;
+	uint32 decodeTime = 0;
+
+	while (framesMatch && !decoder.endOfVideo()) {
+		if (!decoder.needsUpdate()) {
+			// Use the time until the next frame is due for decoding ahead
+			if (!decoder.decodeAhead())
+				g_system->delayMillis(MIN<uint32>(decoder.getTimeToNextFrame(), 10));
+			continue;
+		}
+
+		if (decoder.getQueuedFrameCount() > 0)
+			framesDecodedAhead++;
+
+		uint32 start = g_system->getMillis();
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		decodeTime += g_system->getMillis() - start;
+
+		uint frame = decoder.getCurFrame();
+		const byte *expected = expectedFrames + frame * width * height;
+		for (uint y = 0; y < height; ++y) {
+			if (memcmp(surface->getBasePtr(0, y), expected + y * width, width)) {
+				Testsuite::logDetailedPrintf("Frame %d, line %d differs from the expected contents\n", frame, y);
+				framesMatch = false;
+				break;
+			}
+		}
+	}
+
+	decoder.close();
+	delete[] expectedFrames;
+
+	if (!framesMatch)
+		return kTestFailed;
+
+	Testsuite::logPrintf("Info! %d of %d frames were decoded ahead, %d ms were spent in decodeNextFrame()\n",
+		framesDecodedAhead, frameCount, decodeTime);
+
+	return kTestPassed;
+}
+
+/**
+ * Converts a synthetic YUV 4:2:0 image into 16 and 32 bits per pixel,
+ * verifying the result against YUV2RGB() and reporting the conversion speed.
+ */
+TestExitStatus VideoTests::testYUVConversion() {
+	const int width = 640;
+	const int height = 480;
+	const uint passes = 20;
+
+	const Graphics::PixelFormat formats[] = {
+		Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+		Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)
+	};
+
+	byte *yPlane = new byte[width * height];
+	byte *uPlane = new byte[(width / 2) * (height / 2)];
+	byte *vPlane = new byte[(width / 2) * (height / 2)];
+
+	Common::RandomSource rnd;
+	for (int i = 0; i < width * height; ++i)
+		yPlane[i] = rnd.getRandomNumber(255);
+	for (int i = 0; i < (width / 2) * (height / 2); ++i) {
+		uPlane[i] = rnd.getRandomNumber(255);
+		vPlane[i] = rnd.getRandomNumber(255);
+	}
+
+	bool pixelsMatch = true;
+
+	for (uint f = 0; f < ARRAYSIZE(formats) && pixelsMatch; ++f) {
+		const Graphics::PixelFormat &format = formats[f];
+		const Graphics::YUVToRGBLookup *lookup = YUVToRGBMan.getLookup(format);
+
+		Graphics::Surface surface;
+		surface.create(width, height, format.bytesPerPixel);
+
+		uint32 start = g_system->getMillis();
+		for (uint pass = 0; pass < passes; ++pass)
+			lookup->convert420(&surface, yPlane, uPlane, vPlane, width, height, width, width / 2);
+		uint32 convertTime = g_system->getMillis() - start;
+
+		for (int y = 0; y < height && pixelsMatch; ++y) {
+			for (int x = 0; x < width; ++x) {
+				const int uvOffset = (y / 2) * (width / 2) + x / 2;
+
+				byte r, g, b;
+				Graphics::YUV2RGB(yPlane[y * width + x], uPlane[uvOffset], vPlane[uvOffset], r, g, b);
+
+				uint32 expected = format.RGBToColor(r, g, b);
+				uint32 color = (format.bytesPerPixel == 2) ? *((uint16 *)surface.getBasePtr(x, y)) : *((uint32 *)surface.getBasePtr(x, y));
+
+				if (color != expected) {
+					Testsuite::logDetailedPrintf("Pixel %d, %d converted to %d bits per pixel differs from YUV2RGB()\n", x, y, format.bytesPerPixel * 8);
+					pixelsMatch = false;
+					break;
+				}
+			}
+		}
+
+		if (pixelsMatch) {
+			Testsuite::logPrintf("Info! Converted %d images of %dx%d to %d bits per pixel in %d ms (%d kpixels per ms)\n",
+				passes, width, height, format.bytesPerPixel * 8, convertTime, convertTime ? passes * width * height / 1000 / convertTime : 0);
+		}
+
+		surface.free();
+	}
+
+	delete[] yPlane;
+	delete[] uPlane;
+	delete[] vPlane;
+
+	return pixelsMatch ? kTestPassed : kTestFailed;
+}
+
+/**
+ * Seeks to random frames and times of a synthetic QuickTime movie, verifying
+ * the frames and checking that no seek decodes more frames than there are
+ * between two key frames. The time spent seeking is reported in the log.
+ */
+TestExitStatus VideoTests::testQuickTimeSeeking() {
+	const uint width = 320;
+	const uint height = 240;
+	const uint frameCount = 120;
+	const uint keyFrameInterval = 12;
+	const uint seekCount = 200;
+
+	byte *expectedFrames = new byte[frameCount * width * height];
+	Common::SeekableReadStream *stream = createQuickTimeStream(width, height, frameCount, keyFrameInterval, expectedFrames);
+
+	CountingQuickTimeDecoder decoder;
+	bool framesMatch = decoder.load(stream);
+	if (!framesMatch)
+		Testsuite::logDetailedPrintf("Failed to load the generated QuickTime movie\n");
+
+	Common::RandomSource rnd;
+	rnd.setSeed(0x5EED);
+
+	uint maxSeekDecodes = 0;
+	uint totalSeekDecodes = 0;
+	uint32 seekTime = 0;
+
+	for (uint seek = 0; seek < seekCount && framesMatch; ++seek) {
+		uint frame = rnd.getRandomNumber(frameCount - 1);
+		uint decodedFrames = decoder.getDecodedFrameCount();
+
+		uint32 start = g_system->getMillis();
+		if (seek & 1)
+			decoder.seekToFrame(frame);
+		else
+			decoder.seekToTime(Video::VideoTimestamp(frame * 40 + rnd.getRandomNumber(39), 600));
+		seekTime += g_system->getMillis() - start;
+
+		uint seekDecodes = decoder.getDecodedFrameCount() - decodedFrames;
+		totalSeekDecodes += seekDecodes;
+		maxSeekDecodes = MAX(maxSeekDecodes, seekDecodes);
+
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		if (!surface || decoder.getCurFrame() != (int32)frame) {
+			Testsuite::logDetailedPrintf("Seeking to frame %d failed\n", frame);
+			framesMatch = false;
+			break;
+		}
+
+		const byte *expected = expectedFrames + frame * width * height;
+		for (uint y = 0; y < height; ++y) {
+			if (memcmp(surface->getBasePtr(0, y), expected + y * width, width)) {
+				Testsuite::logDetailedPrintf("Frame %d, line %d differs from the expected contents after seeking\n", frame, y);
+				framesMatch = false;
+				break;
+			}
+		}
+	}
+
+	decoder.close();
+	delete[] expectedFrames;
+
+	if (!framesMatch)
+		return kTestFailed;
+
+	if (maxSeekDecodes >= keyFrameInterval) {
+		Testsuite::logDetailedPrintf("A seek decoded %d frames, but key frames are only %d frames apart\n", maxSeekDecodes, keyFrameInterval);
+		return kTestFailed;
+	}
+
+	Testsuite::logPrintf("Info! %d QuickTime seeks took %d ms, decoding %d frames (at most %d) before the target frames\n",
+		seekCount, seekTime, totalSeekDecodes, maxSeekDecodes);
+
+	return kTestPassed;
+}
+
+VideoDecoderTestSuite::VideoDecoderTestSuite() {
+	addTest("SmackerDecoding", &VideoTests::testSmackerDecoding, false);
+	addTest("DecodeAhead", &VideoTests::testDecodeAhead, false);
+	addTest("YUVConversion", &VideoTests::testYUVConversion, false);
+	addTest("QuickTimeSeeking", &VideoTests::testQuickTimeSeeking, false);
+}
+
+} // End of namespace Testbed
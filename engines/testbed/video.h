@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#ifndef TESTBED_VIDEO_H
+#define TESTBED_VIDEO_H
+
+#include "testbed/testsuite.h"
+
+namespace Testbed {
+
+namespace VideoTests {
+
+// Video tests decode synthetic files generated in memory, so that they can
+// verify the decoded frames and measure decoding speed without game data
+
+// Helper functions for Video tests
+Common::SeekableReadStream *createSmackerStream(uint width, uint height, uint frameCount, byte *expectedFrames);
+Common::SeekableReadStream *createQuickTimeStream(uint width, uint height, uint frameCount, uint keyFrameInterval, byte *expectedFrames);
+
+// will contain function declarations for Video tests
+TestExitStatus testSmackerDecoding();
+TestExitStatus testDecodeAhead();
+TestExitStatus testYUVConversion();
+TestExitStatus testQuickTimeSeeking();
+// add more here
+
+} // End of namespace VideoTests
+
+class VideoDecoderTestSuite : public Testsuite {
+public:
+	/**
+	 * The constructor for the VideoDecoderTestSuite
+	 * For every test to be executed one must:
+	 * 1) Create a function that would invoke the test
+	 * 2) Add that test to list by executing addTest()
+	 *
+	 * @see addTest()
+	 */
+	VideoDecoderTestSuite();
+	~VideoDecoderTestSuite() {}
+	const char *getName() const {
+		return "Video";
+	}
+	const char *getDescription() const {
+		return "Video decoders: correctness and decoding speed";
+	}
+};
+
+} // End of namespace Testbed
+
+#endif // TESTBED_VIDEO_H
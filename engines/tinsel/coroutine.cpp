@@ -25,6 +25,7 @@
 #include "tinsel/coroutine.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/textconsole.h"
 
 namespace Tinsel {
 
@@ -62,6 +63,68 @@ static void displayCoroStats() {
 }
 #endif
 
+namespace {
+
+enum {
+	kPoolGranularity = 16,	///< difference in size between the pools
+	kPoolCount = 16			///< contexts up to 256 bytes are pooled
+};
+
+/** Stored in front of every context, aligned like any context member. */
+union PoolHeader {
+	uint sizeClass;		///< number of the pool, or 0 if not pooled
+	PoolHeader *next;	///< next free block in the pool
+	void *align1;
+	double align2;
+};
+
+PoolHeader *s_freeBlocks[kPoolCount];
+
+} // End of anonymous namespace
+
+void *CoroBaseContext::operator new(size_t size) {
+	uint sizeClass = (size + kPoolGranularity - 1) / kPoolGranularity;
+	if (sizeClass > kPoolCount)
+		sizeClass = 0;
+
+	PoolHeader *block;
+	if (sizeClass && s_freeBlocks[sizeClass - 1]) {
+		block = s_freeBlocks[sizeClass - 1];
+		s_freeBlocks[sizeClass - 1] = block->next;
+	} else {
+		block = (PoolHeader *)malloc(sizeof(PoolHeader) + (sizeClass ? sizeClass * kPoolGranularity : size));
+		if (!block)
+			error("Cannot allocate coroutine context");
+	}
+
+	block->sizeClass = sizeClass;
+	return block + 1;
+}
+
+void CoroBaseContext::operator delete(void *ptr) {
+	if (!ptr)
+		return;
+
+	PoolHeader *block = (PoolHeader *)ptr - 1;
+	const uint sizeClass = block->sizeClass;
+	if (sizeClass) {
+		block->next = s_freeBlocks[sizeClass - 1];
+		s_freeBlocks[sizeClass - 1] = block;
+	} else {
+		free(block);
+	}
+}
+
+void CoroBaseContext::freePools() {
+	for (int i = 0; i < kPoolCount; ++i) {
+		while (s_freeBlocks[i]) {
+			PoolHeader *block = s_freeBlocks[i];
+			s_freeBlocks[i] = block->next;
+			free(block);
+		}
+	}
+}
+
 CoroBaseContext::CoroBaseContext(const char *func)
 	: _line(0), _sleep(0), _subctx(0) {
 #if COROUTINE_DEBUG
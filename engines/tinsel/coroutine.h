@@ -76,6 +76,14 @@ struct CoroBaseContext {
 #endif
 	CoroBaseContext(const char *func);
 	~CoroBaseContext();
+
+	// Contexts are created and destroyed on every coroutine call, so they
+	// are taken from pools of blocks of the same size.
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr);
+
+	/** Frees the blocks in the pools. */
+	static void freePools();
 };
 
 typedef CoroBaseContext *CoroContext;
@@ -27,7 +27,9 @@
 #include "tinsel/debugger.h"
 #include "tinsel/dialogs.h"
 #include "tinsel/pcode.h"
+#include "tinsel/pid.h"
 #include "tinsel/scene.h"
+#include "tinsel/sched.h"
 #include "tinsel/sound.h"
 #include "tinsel/music.h"
 #include "tinsel/font.h"
@@ -62,6 +64,41 @@ int strToInt(const char *s) {
 	return (int)tmp;
 }
 
+/**
+ * Sleeps in a nested coroutine, so that every wake up of a benchmark
+ * process releases a context and the next sleep allocates one again.
+ */
+static void BenchSleep(CORO_PARAM, int delay) {
+	CORO_BEGIN_CONTEXT;
+		int delay;
+	CORO_END_CONTEXT(_ctx);
+
+	CORO_BEGIN_CODE(_ctx);
+
+	_ctx->delay = delay;
+	CORO_SLEEP(_ctx->delay);
+
+	CORO_END_CODE;
+}
+
+/**
+ * Benchmark process, sleeps for the number of ticks passed as parameter.
+ */
+static void BenchProcess(CORO_PARAM, const void *param) {
+	CORO_BEGIN_CONTEXT;
+		int delay;
+	CORO_END_CONTEXT(_ctx);
+
+	CORO_BEGIN_CODE(_ctx);
+
+	_ctx->delay = *(const int *)param;
+	for (;;) {
+		CORO_INVOKE_1(BenchSleep, _ctx->delay);
+	}
+
+	CORO_END_CODE;
+}
+
 //----------------- CONSOLE CLASS  ---------------------
 
 Console::Console() : GUI::Debugger() {
@@ -70,6 +107,7 @@ Console::Console() : GUI::Debugger() {
 	DCmd_Register("music",		WRAP_METHOD(Console, cmd_music));
 	DCmd_Register("sound",		WRAP_METHOD(Console, cmd_sound));
 	DCmd_Register("string",		WRAP_METHOD(Console, cmd_string));
+	DCmd_Register("sched_bench",	WRAP_METHOD(Console, cmd_schedBench));
 }
 
 Console::~Console() {
@@ -164,4 +202,51 @@ bool Console::cmd_string(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmd_schedBench(int argc, const char **argv) {
+	if (argc > 3) {
+		DebugPrintf("%s [processes [ticks]]\n", argv[0]);
+		DebugPrintf("Measures the time the scheduler takes for sleeping processes\n");
+		return true;
+	}
+
+	const int processes = (argc > 1) ? MAX(1, strToInt(argv[1])) : 500;
+	const int ticks = (argc > 2) ? MAX(1, strToInt(argv[2])) : 10000;
+
+	// A scheduler only holds NUM_PROCESS processes, so the processes are
+	// spread over several schedulers which run one after the other. The
+	// game scheduler is left untouched.
+	Scheduler *gameScheduler = g_scheduler;
+	Common::Array<Scheduler *> schedulers;
+
+	for (int i = 0; i < processes; ) {
+		Scheduler *scheduler = new Scheduler();
+		scheduler->reset();
+		schedulers.push_back(scheduler);
+
+		for (int j = 0; j < NUM_PROCESS && i < processes; ++j, ++i) {
+			// Most processes are asleep in any tick
+			const int delay = 1 + i % 8;
+			scheduler->createProcess(PID_PROCESS, BenchProcess, &delay, sizeof(delay));
+		}
+	}
+
+	const uint32 start = g_system->getMillis();
+	for (int tick = 0; tick < ticks; ++tick) {
+		for (uint i = 0; i < schedulers.size(); ++i) {
+			g_scheduler = schedulers[i];
+			schedulers[i]->schedule();
+		}
+	}
+	const uint32 time = g_system->getMillis() - start;
+
+	for (uint i = 0; i < schedulers.size(); ++i)
+		delete schedulers[i];
+	g_scheduler = gameScheduler;
+
+	DebugPrintf("%d processes in %d schedulers, %d ticks: %d ms, %d ns per process and tick\n",
+		processes, schedulers.size(), ticks, time, time * 1000 / ticks * 1000 / processes);
+
+	return true;
+}
+
 } // End of namespace Tinsel
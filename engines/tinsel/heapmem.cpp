@@ -44,9 +44,12 @@ namespace Tinsel {
 struct MEM_NODE {
 	MEM_NODE *pNext;	// link to the next node in the list
 	MEM_NODE *pPrev;	// link to the previous node in the list
+	MEM_NODE *pLruNext;	// link to the next newer node in the LRU list
+	MEM_NODE *pLruPrev;	// link to the next older node in the LRU list
 	uint8 *pBaseAddr;	// base address of the memory object
 	long size;		// size of the memory object
 	uint32 lruTime;		// time when memory object was last accessed
+	uint32 allocNum;	// number of the allocation, orders blocks with the same lruTime
 	int flags;		// allocation attributes
 };
 
@@ -72,6 +75,12 @@ MEM_NODE s_fixedMnodesList[5];
 // the mnode heap sentinel
 static MEM_NODE heapSentinel;
 
+// sentinel of the list of allocated heap blocks, ordered by their LRU time
+static MEM_NODE lruSentinel;
+
+// number of the next heap allocation
+static uint32 nextAllocNum;
+
 //
 static MEM_NODE *AllocMemNode();
 
@@ -128,6 +137,12 @@ void MemoryInit() {
 	// flag sentinel as locked
 	heapSentinel.flags = DWM_LOCKED | DWM_SENTINEL;
 
+	// the LRU list starts out empty
+	lruSentinel.pLruPrev = &lruSentinel;
+	lruSentinel.pLruNext = &lruSentinel;
+	lruSentinel.flags = DWM_LOCKED | DWM_SENTINEL;
+	nextAllocNum = 0;
+
 	// store the current heap size in the sentinel
 	uint32 size = MemoryPoolSize[0];
 	if (TinselVersion == TINSEL_V1) size = MemoryPoolSize[1];
@@ -191,28 +206,71 @@ void FreeMemNode(MEM_NODE *pMemNode) {
 }
 
 
+/**
+ * Removes a memory object from the LRU list.
+ * @param pMemNode			Node of the memory object
+ */
+static void LruUnlink(MEM_NODE *pMemNode) {
+	pMemNode->pLruPrev->pLruNext = pMemNode->pLruNext;
+	pMemNode->pLruNext->pLruPrev = pMemNode->pLruPrev;
+}
+
+/**
+ * Adds a memory object to the LRU list, behind all objects that were
+ * accessed before it. Objects accessed at the same time are ordered by
+ * their position in the heap list, i.e. the order they were allocated in.
+ * @param pMemNode			Node of the memory object
+ */
+static void LruInsert(MEM_NODE *pMemNode) {
+	// Usually the object is the most recently used one, so start at the end
+	MEM_NODE *pPrev = lruSentinel.pLruPrev;
+	while (pPrev != &lruSentinel && (pPrev->lruTime > pMemNode->lruTime ||
+			(pPrev->lruTime == pMemNode->lruTime && pPrev->allocNum > pMemNode->allocNum)))
+		pPrev = pPrev->pLruPrev;
+
+	pMemNode->pLruPrev = pPrev;
+	pMemNode->pLruNext = pPrev->pLruNext;
+	pPrev->pLruNext->pLruPrev = pMemNode;
+	pPrev->pLruNext = pMemNode;
+}
+
+/**
+ * Updates the LRU time of a memory object, keeping the LRU list ordered.
+ * @param pMemNode			Node of the memory object
+ */
+static void LruSetTime(MEM_NODE *pMemNode, uint32 time) {
+	// Fixed and discarded objects aren't in the list
+	const bool inList = pMemNode >= mnodeList && pMemNode <= mnodeList + NUM_MNODES - 1
+		&& (pMemNode->flags & DWM_DISCARDED) == 0;
+
+	if (inList && pMemNode->lruTime != time) {
+		LruUnlink(pMemNode);
+		pMemNode->lruTime = time;
+		LruInsert(pMemNode);
+	} else {
+		pMemNode->lruTime = time;
+	}
+}
+
 /**
  * Tries to make space for the specified number of bytes on the specified heap.
  * @param size			Number of bytes to free up
  * @return true if any blocks were discarded, false otherwise
  */
 static bool HeapCompact(long size) {
-	const MEM_NODE *pHeap = &heapSentinel;
 	MEM_NODE *pCur, *pOldest;
-	uint32 oldest;		// time of the oldest discardable block
 
 	while (heapSentinel.size < size) {
 
-		// find the oldest discardable block
-		oldest = DwGetCurrentTime();
+		// find the oldest discardable block, blocks used since the
+		// current time are kept
+		const uint32 now = DwGetCurrentTime();
 		pOldest = NULL;
-		for (pCur = pHeap->pNext; pCur != pHeap; pCur = pCur->pNext) {
-			if (pCur->flags == DWM_USED) {
+		for (pCur = lruSentinel.pLruNext; pCur != &lruSentinel && pCur->lruTime < now; pCur = pCur->pLruNext) {
+			if ((pCur->flags & DWM_LOCKED) == 0) {
 				// found a non-discarded discardable block
-				if (pCur->lruTime < oldest) {
-					oldest = pCur->lruTime;
-					pOldest = pCur;
-				}
+				pOldest = pCur;
+				break;
 			}
 		}
 
@@ -267,8 +325,12 @@ static MEM_NODE *MemoryAlloc(long size) {
 	// Set flags, LRU time and size
 	pNode->flags = DWM_USED;
 	pNode->lruTime = DwGetCurrentTime() + 1;
+	pNode->allocNum = nextAllocNum++;
 	pNode->size = size;
 
+	// the block is discardable once it is older than the current time
+	LruInsert(pNode);
+
 	// set mnode at the end of the list
 	pNode->pPrev = pHeap->pPrev;
 	pNode->pNext = pHeap;
@@ -352,6 +414,8 @@ void MemoryDiscard(MEM_NODE *pMemNode) {
 
 	// discard it if it isn't already
 	if ((pMemNode->flags & DWM_DISCARDED) == 0) {
+		LruUnlink(pMemNode);
+
 		// free memory
 		free(pMemNode->pBaseAddr);
 		heapSentinel.size += pMemNode->size;
@@ -407,7 +471,7 @@ void MemoryUnlock(MEM_NODE *pMemNode) {
 #endif
 
 	// update the LRU time
-	pMemNode->lruTime = DwGetCurrentTime();
+	LruSetTime(pMemNode, DwGetCurrentTime());
 }
 
 /**
@@ -449,6 +513,10 @@ void MemoryReAlloc(MEM_NODE *pMemNode, long size) {
 		pMemNode->pPrev->pNext = pMemNode;
 		pMemNode->pNext->pPrev = pMemNode;
 
+		// and into the LRU list
+		pMemNode->pLruPrev->pLruNext = pMemNode;
+		pMemNode->pLruNext->pLruPrev = pMemNode;
+
 		// free the new node
 		FreeMemNode(pNew);
 	}
@@ -462,7 +530,7 @@ void MemoryReAlloc(MEM_NODE *pMemNode, long size) {
  */
 void MemoryTouch(MEM_NODE *pMemNode) {
 	// update the LRU time
-	pMemNode->lruTime = DwGetCurrentTime();
+	LruSetTime(pMemNode, DwGetCurrentTime());
 }
 
 uint8 *MemoryDeref(MEM_NODE *pMemNode) {
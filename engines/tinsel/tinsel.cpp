@@ -910,6 +910,7 @@ TinselEngine::~TinselEngine() {
 	delete _config;
 
 	MemoryDeinit();
+	CoroBaseContext::freePools();
 }
 
 Common::String TinselEngine::getSavegameFilename(int16 saveNum) const {
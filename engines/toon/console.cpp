@@ -25,13 +25,27 @@
 
 #include "toon/console.h"
 #include "toon/toon.h"
+#include "toon/path.h"
 
 namespace Toon {
 
 ToonConsole::ToonConsole(ToonEngine *vm) : GUI::Debugger(), _vm(vm) {
+	DCmd_Register("path_check", WRAP_METHOD(ToonConsole, cmd_checkPaths));
 }
 
 ToonConsole::~ToonConsole() {
 }
 
+bool ToonConsole::cmd_checkPaths(int argc, const char **argv) {
+	int queries = (argc > 1) ? MAX(1, atoi(argv[1])) : 100;
+
+	int32 searches = 0;
+	uint32 memsetTime = 0, stampTime = 0;
+	int32 mismatches = _vm->getPathFinding()->checkPaths(queries, searches, memsetTime, stampTime);
+
+	DebugPrintf("%d of %d paths on the current mask differ in length from the old search\n", mismatches, searches);
+	DebugPrintf("Old search: %d ms, current search: %d ms\n", memsetTime, stampTime);
+	return true;
+}
+
 } // End of namespace Toon
@@ -38,6 +38,8 @@ public:
 	virtual ~ToonConsole(void);
 
 private:
+	bool cmd_checkPaths(int argc, const char **argv);
+
 	ToonEngine *_vm;
 };
 
@@ -87,6 +87,7 @@ void Movie::play(Common::String video, int32 flags) {
 		_vm->getAudioManager()->setMusicVolume(0);
 	_decoder->loadFile(video.c_str(), flags);
 	playVideo();
+	_vm->getShadowScreen()->invalidate();
 	_vm->flushPalette(false);
 	if (flags & 1)
 		_vm->getAudioManager()->setMusicVolume(_vm->getAudioManager()->isMusicMuted() ? 0 : 255);
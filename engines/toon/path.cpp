@@ -57,8 +57,8 @@ int32 PathFindingHeap::unload() {
 int32 PathFindingHeap::clear() {
 	//debugC(1, kDebugPath, "clear()");
 
+	// push() writes all entries before pop() reads them
 	_count = 0;
-	memset(_data, 0, sizeof(HeapDataGrid) * _alloc * 2);
 	return 1;
 }
 
@@ -138,6 +138,9 @@ PathFinding::PathFinding(ToonEngine *vm) : _vm(vm) {
 	_height = 0;
 	_heap = new PathFindingHeap();
 	_gridTemp = NULL;
+	_gridStamp = NULL;
+	_currentStamp = 0;
+	_blockingMap = NULL;
 	_numBlockingRects = 0;
 }
 
@@ -146,20 +149,63 @@ PathFinding::~PathFinding(void) {
 		_heap->unload();
 	delete _heap;
 	delete[] _gridTemp;
+	delete[] _gridStamp;
+	delete[] _blockingMap;
+}
+
+bool PathFinding::isInBlockingRect(int32 rect, int32 x, int32 y) const {
+	const int32 *r = _blockingRects[rect];
+	if (r[4] == 0)
+		return x >= r[0] && x <= r[2] && y >= r[1] && y < r[3];
+
+	int32 dx = abs(r[0] - x);
+	int32 dy = abs(r[1] - y);
+	return (dx << 8) / r[2] < (1 << 8) && (dy << 8) / r[3] < (1 << 8);
+}
+
+void PathFinding::drawBlockingRect(int32 rect, uint8 value) {
+	if (!_blockingMap)
+		return;
+
+	const int32 *r = _blockingRects[rect];
+	int32 x1, y1, x2, y2;
+	if (r[4] == 0) {
+		x1 = r[0];
+		y1 = r[1];
+		x2 = r[2];
+		y2 = r[3] - 1;
+	} else {
+		// The points covered by the ellipse are within its size from
+		// its center
+		if (r[2] <= 0 || r[3] <= 0)
+			return;
+		x1 = r[0] - r[2];
+		y1 = r[1] - r[3];
+		x2 = r[0] + r[2];
+		y2 = r[1] + r[3];
+	}
+
+	x1 = MAX<int32>(x1, 0);
+	y1 = MAX<int32>(y1, 0);
+	x2 = MIN<int32>(x2, _width - 1);
+	y2 = MIN<int32>(y2, _height - 1);
+
+	for (int32 y = y1; y <= y2; y++) {
+		uint8 *dst = _blockingMap + y * _width;
+		for (int32 x = x1; x <= x2; x++) {
+			if (value == 0 || isInBlockingRect(rect, x, y))
+				dst[x] = value;
+		}
+	}
 }
 
 bool PathFinding::isLikelyWalkable(int32 x, int32 y) {
+	if (_blockingMap && x >= 0 && x < _width && y >= 0 && y < _height)
+		return !_blockingMap[x + y * _width];
+
 	for (int32 i = 0; i < _numBlockingRects; i++) {
-		if (_blockingRects[i][4] == 0) {
-			if (x >= _blockingRects[i][0] && x <= _blockingRects[i][2] && y >= _blockingRects[i][1] && y < _blockingRects[i][3])
-				return false;
-		} else {
-			int32 dx = abs(_blockingRects[i][0] - x);
-			int32 dy = abs(_blockingRects[i][1] - y);
-			if ((dx << 8) / _blockingRects[i][2] < (1 << 8) && (dy << 8) / _blockingRects[i][3] < (1 << 8)) {
-				return false;
-			}
-		}
+		if (isInBlockingRect(i, x, y))
+			return false;
 	}
 	return true;
 }
@@ -184,9 +230,12 @@ int32 PathFinding::findClosestWalkingPoint(int32 xx, int32 yy, int32 *fxx, int32
 	if (origY == -1)
 		origY = yy;
 
-	for (int y = 0; y < _height; y++) {
+	const uint8 *mask = _currentMask->getDataPtr();
+
+	for (int y = 0; y < _height && mask; y++) {
 		for (int x = 0; x < _width; x++) {
-			if (isWalkable(x, y) && isLikelyWalkable(x,y)) {
+			const int32 node = x + y * _width;
+			if ((mask[node] & 0x1f) && !_blockingMap[node]) {
 				int32 ndist = (x - xx) * (x - xx) + (y - yy) * (y - yy);
 				int32 ndist2 = (x - origX) * (x - origX) + (y - origY) * (y - origY);
 				if (currentFound < 0 || ndist < dist || (ndist == dist && ndist2 < dist2)) {
@@ -288,6 +337,152 @@ int32 PathFinding::findPath(int32 x, int32 y, int32 destx, int32 desty) {
 		return true;
 	}
 
+	// no direct line, we use the standard A* algorithm
+	const uint8 *mask = _currentMask->getDataPtr();
+	if (!mask) {
+		_gridPathCount = 0;
+		return false;
+	}
+
+	// Forget the costs of the previous search
+	if (++_currentStamp == 0) {
+		memset(_gridStamp, 0, _width * _height * sizeof(uint16));
+		_currentStamp = 1;
+	}
+
+	_heap->clear();
+	int32 curX = x;
+	int32 curY = y;
+	int32 curWeight = 0;
+
+	setGridValue(curX + curY * _width, 1);
+	_heap->push(curX, curY, abs(destx - x) + abs(desty - y));
+	int wei = 0;
+
+	while (_heap->_count) {
+		wei = 0;
+		_heap->pop(&curX, &curY, &curWeight);
+		int curNode = curX + curY * _width;
+
+		int32 endX = MIN<int32>(curX + 1, _width - 1);
+		int32 endY = MIN<int32>(curY + 1, _height - 1);
+		int32 startX = MAX<int32>(curX - 1, 0);
+		int32 startY = MAX<int32>(curY - 1, 0);
+
+		for (int32 px = startX; px <= endX; px++) {
+			for (int py = startY; py <= endY; py++) {
+				if (px != curX || py != curY) {
+					wei = ((abs(px - curX) + abs(py - curY)));
+
+					int32 curPNode = px + py * _width;
+					if (mask[curPNode] & 0x1f) { // walkable ?
+						int sum = getGridValue(curNode) + wei * (1 + (_blockingMap[curPNode] ? 0 : 5));
+						int32 value = getGridValue(curPNode);
+						if (value > sum || !value) {
+							int newWeight = abs(destx - px) + abs(desty - py);
+							setGridValue(curPNode, sum);
+							_heap->push(px, py, sum + newWeight);
+							if (!newWeight)
+								goto next; // we found it !
+						}
+					}
+				}
+			}
+		}
+	}
+
+next:
+
+	// let's see if we found a result !
+	if (!getGridValue(destx + desty * _width)) {
+		// didn't find anything
+		_gridPathCount = 0;
+		return false;
+	}
+
+	curX = destx;
+	curY = desty;
+
+	int32 retPathX[4096];
+	int32 retPathY[4096];
+	int32 numpath = 0;
+
+	retPathX[numpath] = curX;
+	retPathY[numpath] = curY;
+	numpath++;
+	int32 bestscore = getGridValue(destx + desty * _width);
+
+	while (1) {
+		int32 bestX = -1;
+		int32 bestY = -1;
+
+		int32 endX = MIN<int32>(curX + 1, _width - 1);
+		int32 endY = MIN<int32>(curY + 1, _height - 1);
+		int32 startX = MAX<int32>(curX - 1, 0);
+		int32 startY = MAX<int32>(curY - 1, 0);
+
+		for (int32 px = startX; px <= endX; px++) {
+			for (int32 py = startY; py <= endY; py++) {
+				if (px != curX || py != curY) {
+					wei = abs(px - curX) + abs(py - curY);
+
+					int PNode = px + py * _width;
+					int32 value = getGridValue(PNode);
+					if (value && (mask[PNode] & 0x1f)) {
+						if (value < bestscore) {
+							bestscore = value;
+							bestX = px;
+							bestY = py;
+						}
+					}
+				}
+			}
+		}
+
+		if (bestX < 0 || bestY < 0)
+			return 0;
+
+		retPathX[numpath] = bestX;
+		retPathY[numpath] = bestY;
+		numpath++;
+
+		if ((bestX == x && bestY == y)) {
+			_gridPathCount = numpath;
+
+			memcpy(_tempPathX, retPathX, sizeof(int32) * numpath);
+			memcpy(_tempPathY, retPathY, sizeof(int32) * numpath);
+			return true;
+		}
+
+		curX = bestX;
+		curY = bestY;
+	}
+
+	return false;
+}
+
+/**
+ * The search findPath() replaced, which clears the whole cost grid and
+ * tests every point against all blocking rects. Only used by checkPaths().
+ */
+int32 PathFinding::findPathMemset(int32 x, int32 y, int32 destx, int32 desty) {
+	if (x == destx && y == desty) {
+		_gridPathCount = 0;
+		return true;
+	}
+
+	// ignore path finding if the character is outside the screen
+	if (x < 0 || x > 1280 || y < 0 || y > 400 || destx < 0 || destx > 1280 || desty < 0 || desty > 400) {
+		_gridPathCount = 0;
+		return true;
+	}
+
+	// first test direct line
+	if (lineIsWalkable(x,y,destx,desty)) {
+		walkLine(x,y,destx,desty);
+		return true;
+	}
+
 	// no direct line, we use the standard A* algorithm
 	memset(_gridTemp , 0, _width * _height * sizeof(int32));
 	_heap->clear();
@@ -317,7 +512,10 @@ int32 PathFinding::findPath(int32 x, int32 y, int32 destx, int32 desty) {
 
 					int32 curPNode = px + py * _width;
 					if (isWalkable(px, py)) { // walkable ?
-						int sum = sq[curNode] + wei * (1 + (isLikelyWalkable(px,py) ? 5 : 0));
+						bool blocked = false;
+						for (int32 i = 0; i < _numBlockingRects && !blocked; i++)
+							blocked = isInBlockingRect(i, px, py);
+						int sum = sq[curNode] + wei * (1 + (blocked ? 0 : 5));
 						if (sq[curPNode] > sum || !sq[curPNode]) {
 							int newWeight = abs(destx - px) + abs(desty - py);
 							sq[curPNode] = sum;
@@ -400,6 +598,47 @@ next:
 	return false;
 }
 
+int32 PathFinding::checkPaths(int32 queries, int32 &searches, uint32 &memsetTime, uint32 &stampTime) {
+	searches = 0;
+	memsetTime = stampTime = 0;
+
+	if (!_currentMask || !_currentMask->getDataPtr())
+		return 0;
+
+	// Same queries for every call, so that timings can be compared
+	Common::RandomSource rnd;
+	rnd.setSeed(0x70A7);
+
+	int32 mismatches = 0;
+	for (int32 attempt = 0; searches < queries && attempt < queries * 1000; attempt++) {
+		int32 x = rnd.getRandomNumber(_width - 1);
+		int32 y = rnd.getRandomNumber(_height - 1);
+		int32 destX = rnd.getRandomNumber(_width - 1);
+		int32 destY = rnd.getRandomNumber(_height - 1);
+
+		// Only queries which need a search are of interest
+		if ((x == destX && y == destY) || !isWalkable(x, y) || !isWalkable(destX, destY) || lineIsWalkable(x, y, destX, destY))
+			continue;
+		searches++;
+
+		uint32 start = g_system->getMillis();
+		int32 memsetResult = findPathMemset(x, y, destX, destY);
+		int32 memsetCount = _gridPathCount;
+		memsetTime += g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		int32 stampResult = findPath(x, y, destX, destY);
+		stampTime += g_system->getMillis() - start;
+
+		if (stampResult != memsetResult || _gridPathCount != memsetCount) {
+			debugC(1, kDebugPath, "checkPaths: Path from (%d, %d) to (%d, %d) has %d points instead of %d", x, y, destX, destY, _gridPathCount, memsetCount);
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
 void PathFinding::init(Picture *mask) {
 	debugC(1, kDebugPath, "init(mask)");
 
@@ -410,9 +649,21 @@ void PathFinding::init(Picture *mask) {
 	_heap->init(_width * _height);
 	delete[] _gridTemp;
 	_gridTemp = new int32[_width*_height];
+	delete[] _gridStamp;
+	_gridStamp = new uint16[_width * _height];
+	memset(_gridStamp, 0, _width * _height * sizeof(uint16));
+	_currentStamp = 0;
+
+	delete[] _blockingMap;
+	_blockingMap = new uint8[_width * _height];
+	memset(_blockingMap, 0, _width * _height);
+	for (int32 i = 0; i < _numBlockingRects; i++)
+		drawBlockingRect(i, 1);
 }
 
 void PathFinding::resetBlockingRects() {
+	for (int32 i = 0; i < _numBlockingRects; i++)
+		drawBlockingRect(i, 0);
 	_numBlockingRects = 0;
 }
 
@@ -424,6 +675,7 @@ void PathFinding::addBlockingRect(int32 x1, int32 y1, int32 x2, int32 y2) {
 	_blockingRects[_numBlockingRects][2] = x2;
 	_blockingRects[_numBlockingRects][3] = y2;
 	_blockingRects[_numBlockingRects][4] = 0;
+	drawBlockingRect(_numBlockingRects, 1);
 	_numBlockingRects++;
 }
 
@@ -435,6 +687,7 @@ void PathFinding::addBlockingEllipse(int32 x1, int32 y1, int32 w, int32 h) {
 	_blockingRects[_numBlockingRects][2] = w;
 	_blockingRects[_numBlockingRects][3] = h;
 	_blockingRects[_numBlockingRects][4] = 1;
+	drawBlockingRect(_numBlockingRects, 1);
 	_numBlockingRects++;
 }
 
@@ -59,6 +59,7 @@ void ToonEngine::init() {
 
 	_mainSurface = new Graphics::Surface();
 	_mainSurface->create(1280, 400, 1);
+	_shadowScreen = new Graphics::ShadowScreen(640, 400);
 
 	_finalPalette = new uint8[768];
 	_backupPalette = new uint8[768];
@@ -474,7 +475,9 @@ void ToonEngine::copyToVirtualScreen(bool updateScreen) {
 		_cursorAnimationInstance->setPosition(_mouseX - 40 + state()->_currentScrollValue - _cursorOffsetX, _mouseY - 40 - _cursorOffsetY, 0, false);
 		_cursorAnimationInstance->render();
 	}
-	_system->copyRectToScreen((byte *)_mainSurface->pixels + state()->_currentScrollValue, 1280, 0, 0, 640, 400);
+	_shadowScreen->resetStats();
+	_shadowScreen->copyRectToScreen((byte *)_mainSurface->pixels + state()->_currentScrollValue, 1280, 0, 0, 640, 400);
+	debugC(1, kDebugScreen, "copyToVirtualScreen() %d pixels copied, %d skipped", _shadowScreen->getPixelsCopied(), _shadowScreen->getPixelsSkipped());
 	if (updateScreen) {
 		_system->updateScreen();
 		_shouldQuit = shouldQuit();	// update game quit flag - this shouldn't be called all the time, as it's a virtual function
@@ -759,11 +762,13 @@ ToonEngine::ToonEngine(OSystem *syst, const ADGameDescription *gameDescription)
 	DebugMan.addDebugChannel(kDebugState, "State", "State debug level");
 	DebugMan.addDebugChannel(kDebugTools, "Tools", "Tools debug level");
 	DebugMan.addDebugChannel(kDebugText, "Text", "Text debug level");
+	DebugMan.addDebugChannel(kDebugScreen, "Screen", "Screen debug level");
 
 	_resources = NULL;
 	_animationManager = NULL;
 	_moviePlayer = NULL;
 	_mainSurface = NULL;
+	_shadowScreen = NULL;
 
 	_finalPalette = NULL;
 	_backupPalette = NULL;
@@ -845,6 +850,7 @@ ToonEngine::~ToonEngine() {
 		_mainSurface->free();
 		delete _mainSurface;
 	}
+	delete _shadowScreen;
 	
 	delete[] _finalPalette;
 	delete[] _backupPalette;
@@ -29,6 +29,7 @@
 #include "engines/advancedDetector.h"
 #include "engines/engine.h"
 #include "graphics/surface.h"
+#include "graphics/shadowscreen.h"
 #include "common/random.h"
 #include "common/error.h"
 #include "toon/resource.h"
@@ -78,7 +79,8 @@ enum ToonDebugChannels {
 	kDebugResource  = 1 <<  8,
 	kDebugState     = 1 <<  9,
 	kDebugTools     = 1 << 10,
-	kDebugText      = 1 << 11
+	kDebugText      = 1 << 11,
+	kDebugScreen    = 1 << 12
 };
 
 class Picture;
@@ -224,6 +226,10 @@ public:
 		return *_mainSurface;
 	}
 
+	Graphics::ShadowScreen *getShadowScreen() {
+		return _shadowScreen;
+	}
+
 	Picture *getMask() {
 		return _currentMask;
 	}
@@ -371,6 +377,7 @@ protected:
 	bool _updatingSceneScriptRunFlag;
 
 	Graphics::Surface *_mainSurface;
+	Graphics::ShadowScreen *_shadowScreen;
 
 	AnimationInstance *_cursorAnimationInstance;
 	Animation *_cursorAnimation;
@@ -489,6 +489,7 @@ AnimationSequencePlayer::AnimationSequencePlayer(OSystem *system, Audio::Mixer *
 	_soundSeqDataIndex = 0;
 	_soundSeqData = 0;
 	_offscreenBuffer = (uint8 *)malloc(kScreenWidth * kScreenHeight);
+	_shadowScreen = new ::Graphics::ShadowScreen(kScreenWidth, kScreenHeight);
 	_updateScreenWidth = 0;
 	_updateScreenPicture = false;
 	_picBufPtr = _pic2BufPtr = 0;
@@ -497,6 +498,7 @@ AnimationSequencePlayer::AnimationSequencePlayer(OSystem *system, Audio::Mixer *
 AnimationSequencePlayer::~AnimationSequencePlayer() {
 	unloadAnimation();
 	free(_offscreenBuffer);
+	delete _shadowScreen;
 }
 
 void AnimationSequencePlayer::mainLoop() {
@@ -549,7 +551,7 @@ void AnimationSequencePlayer::mainLoop() {
 		} else {
 			updateSounds();
 		}
-		_system->copyRectToScreen(_offscreenBuffer, kScreenWidth, 0, 0, kScreenWidth, kScreenHeight);
+		_shadowScreen->copyRectToScreen(_offscreenBuffer, kScreenWidth, 0, 0, kScreenWidth, kScreenHeight);
 		_system->setPalette(_animationPalette, 0, 256);
 		_system->updateScreen();
 		syncTime();
@@ -718,6 +720,7 @@ void AnimationSequencePlayer::fadeOutPalette() {
 		_system->delayMillis(1000 / 60);
 	}
 	_system->fillScreen(0);
+	_shadowScreen->invalidate();
 }
 
 void AnimationSequencePlayer::unloadAnimation() {
@@ -832,7 +835,7 @@ void AnimationSequencePlayer::displayLoadingScreen() {
 			f.read(_animationPalette + i, 3);
 		}
 		f.read(_offscreenBuffer, 64000);
-		_system->copyRectToScreen(_offscreenBuffer, 320, 0, 0, kScreenWidth, kScreenHeight);
+		_shadowScreen->copyRectToScreen(_offscreenBuffer, 320, 0, 0, kScreenWidth, kScreenHeight);
 		fadeInPalette();
 	}
 }
@@ -875,7 +878,7 @@ void AnimationSequencePlayer::loadIntroSeq3_4() {
 	loadSounds(kSoundsList_Seq3_4);
 	_picBufPtr = loadPicture("graphics/house.pic");
 	openAnimation(0, "graphics/intro1.flc");
-	_system->copyRectToScreen(_offscreenBuffer, 320, 0, 0, kScreenWidth, kScreenHeight);
+	_shadowScreen->copyRectToScreen(_offscreenBuffer, 320, 0, 0, kScreenWidth, kScreenHeight);
 	fadeInPalette();
 	_updateScreenPicture = false;
 }
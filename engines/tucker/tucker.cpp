@@ -24,6 +24,7 @@
  */
 
 #include "common/config-manager.h"
+#include "common/debug-channels.h"
 #include "common/events.h"
 #include "common/system.h"
 
@@ -38,11 +39,15 @@ namespace Tucker {
 
 TuckerEngine::TuckerEngine(OSystem *system, Common::Language language, uint32 flags)
 	: Engine(system), _gameLang(language), _gameFlags(flags) {
+	DebugMan.addDebugChannel(kDebugScreen, "Screen", "Screen debug level");
 	_console = new TuckerConsole(this);
+	_shadowScreen = new ::Graphics::ShadowScreen(kScreenWidth, kScreenHeight);
 }
 
 TuckerEngine::~TuckerEngine() {
+	DebugMan.clearAllDebugChannels();
 	delete _console;
+	delete _shadowScreen;
 }
 
 bool TuckerEngine::hasFeature(EngineFeature f) const {
@@ -3816,9 +3821,10 @@ void TuckerEngine::drawSpeechTextLine(const uint8 *dataPtr, int pos, int count,
 void TuckerEngine::redrawScreen(int offset) {
 	debug(9, "redrawScreen() _fullRedraw %d offset %d _dirtyRectsCount %d", _fullRedraw, offset, _dirtyRectsCount);
 	assert(offset <= kScreenWidth);
+	_shadowScreen->resetStats();
 	if (_fullRedraw) {
 		_fullRedraw = false;
-		_system->copyRectToScreen(_locationBackgroundGfxBuf + offset, kScreenPitch, 0, 0, kScreenWidth, kScreenHeight);
+		_shadowScreen->copyRectToScreen(_locationBackgroundGfxBuf + offset, kScreenPitch, 0, 0, kScreenWidth, kScreenHeight);
 	} else {
 		Common::Rect clipRect(offset, 0, offset + kScreenWidth, kScreenHeight);
 		for (int i = 0; i < _dirtyRectsPrevCount + _dirtyRectsCount; ++i) {
@@ -3835,6 +3841,7 @@ void TuckerEngine::redrawScreen(int offset) {
 		_fullRedraw = true;
 	}
 	_dirtyRectsCount = 0;
+	debugC(1, kDebugScreen, "redrawScreen() %d pixels copied, %d skipped", _shadowScreen->getPixelsCopied(), _shadowScreen->getPixelsSkipped());
 	_system->updateScreen();
 }
 
@@ -3858,7 +3865,7 @@ void TuckerEngine::redrawScreenRect(const Common::Rect &clip, const Common::Rect
 			_locationBackgroundGfxBuf[y * 640 + r.left + w - 1] = outlineColor;
 		}
 #endif
-		_system->copyRectToScreen(src, 640, r.left, r.top, w, h);
+		_shadowScreen->copyRectToScreen(src, 640, r.left, r.top, w, h);
 	}
 }
 
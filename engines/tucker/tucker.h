@@ -39,6 +39,8 @@
 
 #include "engines/engine.h"
 
+#include "graphics/shadowscreen.h"
+
 #include "tucker/console.h"
 
 namespace Audio {
@@ -185,6 +187,10 @@ struct LocationMusic {
 	int num;
 };
 
+enum TuckerDebugChannels {
+	kDebugScreen = 1 << 0
+};
+
 enum {
 	kScreenWidth = 320,
 	kScreenHeight = 200,
@@ -574,6 +580,7 @@ protected:
 	virtual bool canSaveGameStateCurrently();
 
 	TuckerConsole *_console;
+	::Graphics::ShadowScreen *_shadowScreen;
 
 	void handleIntroSequence();
 	void handleCreditsSequence();
@@ -982,6 +989,7 @@ private:
 	int _soundSeqDataIndex;
 	const SoundSequenceData *_soundSeqData;
 	uint8 *_offscreenBuffer;
+	::Graphics::ShadowScreen *_shadowScreen;
 	int _updateScreenWidth;
 	int _updateScreenPicture;
 	int _updateScreenCounter;
@@ -264,6 +264,13 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the active drawing surface.
+	 */
+	Surface *getSurface() const {
+		return _activeSurface;
+	}
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -416,6 +423,16 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors and drawing options of the specified draw step,
+	 * without drawing anything. This leaves the renderer in the same state
+	 * as drawStep() does.
+	 *
+	 * @param step Pointer to a DrawStep struct.
+	 * @param extra Dynamic data of the step.
+	 */
+	void applyStepState(const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -472,6 +489,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsEnabled() const { return !_disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
@@ -45,7 +45,7 @@ inline static void RGB2YUV(byte r, byte g, byte b, byte &y, byte &u, byte &v) {
 	v = CLIP<int>( ((r * 512) >> 10) - ((g * 429) >> 10) - ((b *  83) >> 10) + 128, 0, 255);
 }
 
-// TODO: generic YUV to RGB blit
+// See graphics/yuv_to_rgb.h for converting whole YUV images
 
 /**
  * Blits a rectangle from one graphical format to another.
@@ -23,9 +23,9 @@
  *
  */
 
-#include "graphics/conversion.h"
 #include "graphics/jpeg.h"
 #include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
 
 #include "common/endian.h"
 #include "common/util.h"
@@ -98,16 +98,10 @@ Surface *JPEG::getSurface(const PixelFormat &format) {
 	Graphics::Surface *output = new Graphics::Surface();
 	output->create(yComponent->w, yComponent->h, format.bytesPerPixel);
 
-	for (uint16 i = 0; i < output->h; i++) {
-		for (uint16 j = 0; j < output->w; j++) {
-			byte r = 0, g = 0, b = 0;
-			YUV2RGB(*((byte *)yComponent->getBasePtr(j, i)), *((byte *)uComponent->getBasePtr(j, i)), *((byte *)vComponent->getBasePtr(j, i)), r, g, b);
-			if (format.bytesPerPixel == 2)
-				*((uint16 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-			else
-				*((uint32 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-		}
-	}
+	// The chroma components have already been upsampled to the full size
+	assert(uComponent->pitch == vComponent->pitch);
+	YUVToRGBMan.getLookup(format)->convert444(output, (const byte *)yComponent->pixels, (const byte *)uComponent->pixels,
+			(const byte *)vComponent->pixels, output->w, output->h, yComponent->pitch, uComponent->pitch);
 
 	return output;
 }
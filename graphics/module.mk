@@ -19,11 +19,13 @@ MODULE_OBJS := \
 	primitives.o \
 	scaler.o \
 	scaler/thumbnail_intern.o \
+	shadowscreen.o \
 	sjis.o \
 	surface.o \
 	thumbnail.o \
 	VectorRenderer.o \
-	VectorRendererSpec.o
+	VectorRendererSpec.o \
+	yuv_to_rgb.o
 
 ifdef USE_SCALERS
 MODULE_OBJS += \
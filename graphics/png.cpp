@@ -23,12 +23,10 @@
  *
  */
 
-#include "graphics/conversion.h"
 #include "graphics/png.h"
 #include "graphics/pixelformat.h"
 
 #include "common/endian.h"
-#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/util.h"
 #include "common/zlib.h"
@@ -101,8 +99,92 @@ enum PNGFilters {
 
 #define PNG_HEADER(a, b, c, d) CONSTANT_LE_32(d | (c << 8) | (b << 16) | (a << 24))
 
-PNG::PNG() : _compressedBuffer(0), _compressedBufferSize(0), 
-			_unfilteredSurface(0), _transparentColorSpecified(false) {
+/**
+ * Read stream over the contents of the IDAT chunks, which together form one
+ * zlib stream. Reading from the chunks directly means that the compressed
+ * data never has to be copied into a buffer of its own.
+ */
+class PNG::ImageDataStream : public Common::SeekableReadStream {
+public:
+	ImageDataStream(Common::SeekableReadStream *stream, const Common::Array<ImageDataChunk> &chunks) :
+			_stream(stream), _chunks(chunks), _size(0), _eos(false) {
+		for (uint i = 0; i < _chunks.size(); i++)
+			_size += _chunks[i].size;
+
+		seek(0);
+	}
+
+	bool err() const { return _stream->err(); }
+	void clearErr() { _stream->clearErr(); }
+
+	bool eos() const { return _eos; }
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		if (whence == SEEK_CUR)
+			offset += _pos;
+		else if (whence == SEEK_END)
+			offset += _size;
+
+		if (offset < 0 || offset > (int32)_size)
+			return false;
+
+		_pos = offset;
+		_eos = false;
+
+		// Find the chunk containing the new position
+		_curChunk = 0;
+		_curChunkStart = 0;
+		while (_curChunk < _chunks.size() && _curChunkStart + _chunks[_curChunk].size <= _pos)
+			_curChunkStart += _chunks[_curChunk++].size;
+
+		return true;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		byte *dest = (byte *)dataPtr;
+		uint32 bytesRead = 0;
+
+		while (bytesRead < dataSize && _curChunk < _chunks.size()) {
+			const ImageDataChunk &chunk = _chunks[_curChunk];
+			uint32 chunkPos = _pos - _curChunkStart;
+
+			if (chunkPos >= chunk.size) {
+				_curChunkStart += chunk.size;
+				_curChunk++;
+				continue;
+			}
+
+			uint32 length = MIN(dataSize - bytesRead, chunk.size - chunkPos);
+			if (!_stream->seek(chunk.offset + chunkPos))
+				break;
+			length = _stream->read(dest + bytesRead, length);
+			if (length == 0)
+				break;
+
+			bytesRead += length;
+			_pos += length;
+		}
+
+		if (bytesRead < dataSize)
+			_eos = true;
+
+		return bytesRead;
+	}
+
+private:
+	Common::SeekableReadStream *_stream;
+	const Common::Array<ImageDataChunk> &_chunks;
+	uint32 _size;
+	uint32 _pos;
+	uint _curChunk;
+	uint32 _curChunkStart;
+	bool _eos;
+};
+
+PNG::PNG() : _stream(0), _paletteEntries(0), _transparentColorSpecified(false), _unfilteredSurface(0) {
 }
 
 PNG::~PNG() {
@@ -110,91 +192,36 @@ PNG::~PNG() {
 		_unfilteredSurface->free();
 		delete _unfilteredSurface;
 	}
+
+	delete _stream;
 }
 
 Graphics::Surface *PNG::getSurface(const PixelFormat &format) {
+	if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4)
+		error("Unsupported pixel format for PNG images: %d bytes per pixel", format.bytesPerPixel);
+
 	Graphics::Surface *output = new Graphics::Surface();
-	output->create(_unfilteredSurface->w, _unfilteredSurface->h, format.bytesPerPixel);
-	byte *src = (byte *)_unfilteredSurface->pixels;
-	byte a = 0xFF;
-
-	if (_header.colorType != kIndexed) {
-		if (_header.colorType == kTrueColor || _header.colorType == kTrueColorWithAlpha) {
-			if (_unfilteredSurface->bytesPerPixel != 3 && _unfilteredSurface->bytesPerPixel != 4)
-				error("Unsupported truecolor PNG format");
-		} else if (_header.colorType == kGrayScale || _header.colorType == kGrayScaleWithAlpha) {
-			if (_unfilteredSurface->bytesPerPixel != 1 && _unfilteredSurface->bytesPerPixel != 2)
-				error("Unsupported grayscale PNG format");
-		}
+	output->create(_header.width, _header.height, format.bytesPerPixel);
 
-		for (uint16 i = 0; i < output->h; i++) {
-			for (uint16 j = 0; j < output->w; j++) {
-				if (format.bytesPerPixel == 2) {
-					if (_unfilteredSurface->bytesPerPixel == 1) {		// Grayscale
-						if (_transparentColorSpecified)
-							a = (src[0] == _transparentColor[0]) ? 0 : 0xFF;
-						*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(    a, src[0], src[0], src[0]);
-					} else if (_unfilteredSurface->bytesPerPixel == 2) {	// Grayscale + alpha
-						*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(src[1], src[0], src[0], src[0]);
-					} else if (_unfilteredSurface->bytesPerPixel == 3) {	// RGB
-						if (_transparentColorSpecified) {
-							bool isTransparentColor = (src[0] == _transparentColor[0] &&
-													   src[1] == _transparentColor[1] &&
-													   src[2] == _transparentColor[2]);
-							a = isTransparentColor ? 0 : 0xFF;
-						}
-						*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(     a, src[0], src[1], src[2]);
-					} else if (_unfilteredSurface->bytesPerPixel == 4) {	// RGBA
-						*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(src[3], src[0], src[1], src[2]);
-					}
-				} else {
-					if (_unfilteredSurface->bytesPerPixel == 1) {		// Grayscale
-						if (_transparentColorSpecified)
-							a = (src[0] == _transparentColor[0]) ? 0 : 0xFF;
-						*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(     a, src[0], src[0], src[0]);
-					} else if (_unfilteredSurface->bytesPerPixel == 2) {	// Grayscale + alpha
-						*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(src[1], src[0], src[0], src[0]);
-					} else if (_unfilteredSurface->bytesPerPixel == 3) {	// RGB
-						if (_transparentColorSpecified) {
-							bool isTransparentColor = (src[0] == _transparentColor[0] &&
-													   src[1] == _transparentColor[1] &&
-													   src[2] == _transparentColor[2]);
-							a = isTransparentColor ? 0 : 0xFF;
-						}
-						*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(     a, src[0], src[1], src[2]);
-					} else if (_unfilteredSurface->bytesPerPixel == 4) {	// RGBA
-						*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(src[3], src[0], src[1], src[2]);
-					}
-				}
-
-				src += _unfilteredSurface->bytesPerPixel;
-			}
-		}
-	} else {
-		byte index, r, g, b;
-
-		// Convert the indexed surface to the target pixel format
-		for (uint16 i = 0; i < output->h; i++) {
-			for (uint16 j = 0; j < output->w; j++) {
-				index = *src;
-				r = _palette[index * 4 + 0];
-				g = _palette[index * 4 + 1];
-				b = _palette[index * 4 + 2];
-				a = _palette[index * 4 + 3];
-
-				if (format.bytesPerPixel == 2)
-					*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(a, r, g, b);
-				else
-					*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(a, r, g, b);
-
-				src++;
-			}
-		}
-	}
+	decodeImage(output, &format);
 
 	return output;
 }
 
+Graphics::Surface *PNG::getIndexedSurface() {
+	if (_header.colorType != kIndexed)
+		error("Indexed surface requested for a non-indexed PNG");
+
+	if (!_unfilteredSurface) {
+		_unfilteredSurface = new Graphics::Surface();
+		_unfilteredSurface->create(_header.width, _header.height, 1);
+
+		decodeImage(_unfilteredSurface, 0);
+	}
+
+	return _unfilteredSurface;
+}
+
 bool PNG::read(Common::SeekableReadStream *str) {
 	uint32 chunkLength = 0, chunkType = 0;
 	_stream = str;
@@ -202,10 +229,12 @@ bool PNG::read(Common::SeekableReadStream *str) {
 	// First, check the PNG signature
 	if (_stream->readUint32BE() != PNG_HEADER(0x89, 0x50, 0x4e, 0x47)) {
 		delete _stream;
+		_stream = 0;
 		return false;
 	}
 	if (_stream->readUint32BE() != PNG_HEADER(0x0d, 0x0a, 0x1a, 0x0a)) {
 		delete _stream;
+		_stream = 0;
 		return false;
 	}
 
@@ -215,28 +244,22 @@ bool PNG::read(Common::SeekableReadStream *str) {
 		chunkLength = _stream->readUint32BE();
 		chunkType = _stream->readUint32BE();
 
+		if (_stream->eos() || _stream->err())
+			error("Unexpected end of PNG file");
+
 		switch (chunkType) {
 		case kChunkIHDR:
 			readHeaderChunk();
 			break;
-		case kChunkIDAT:
-			if (_compressedBufferSize == 0) {
-				_compressedBufferSize += chunkLength;
-				_compressedBuffer = new byte[_compressedBufferSize];
-				_stream->read(_compressedBuffer, chunkLength);
-			} else {
-				// Expand the buffer
-				uint32 prevSize = _compressedBufferSize;
-				_compressedBufferSize += chunkLength;
-				byte *tmp = new byte[prevSize];
-				memcpy(tmp, _compressedBuffer, prevSize);
-				delete[] _compressedBuffer;
-				_compressedBuffer = new byte[_compressedBufferSize];
-				memcpy(_compressedBuffer, tmp, prevSize);
-				delete[] tmp;
-				_stream->read(_compressedBuffer + prevSize, chunkLength);
-			}
+		case kChunkIDAT: {
+			// Only remember where the data is, it's decompressed when needed
+			ImageDataChunk chunk;
+			chunk.offset = _stream->pos();
+			chunk.size = chunkLength;
+			_imageDataChunks.push_back(chunk);
+			_stream->skip(chunkLength);
 			break;
+			}
 		case kChunkPLTE:	// only available in indexed PNGs
 			if (_header.colorType != kIndexed)
 				error("A palette chunk has been found in a non-indexed PNG file");
@@ -261,146 +284,217 @@ bool PNG::read(Common::SeekableReadStream *str) {
 			_stream->skip(4);	// skip the chunk CRC checksum
 	}
 
-	// We no longer need the file stream, thus close it here
-	delete _stream;
-	_stream = 0;
-
-	// Unpack the compressed buffer
-	Common::MemoryReadStream *compData = new Common::MemoryReadStream(_compressedBuffer, _compressedBufferSize, DisposeAfterUse::YES);
-	_imageData = Common::wrapCompressedReadStream(compData);
-	
-	// Construct the final image
-	constructImage();
-
-	// Close the uncompressed stream, which will also delete the memory stream,
-	// and thus the original compressed buffer
-	delete _imageData;
-
 	return true;
 }
 
 /**
  * Paeth predictor, used by PNG filter type 4
- * The parameters are of signed 16-bit integers, but should come
- * from unsigned chars. The integers  are only needed to make
- * the paeth calculation correct.
+ * The parameters should come from unsigned chars. The integers are
+ * only needed to make the paeth calculation correct.
  *
  * Taken from lodePNG, with a slight patch:
  * http://www.atalasoft.com/cs/blogs/stevehawley/archive/2010/02/23/libpng-you-re-doing-it-wrong.aspx
  */
-byte PNG::paethPredictor(int16 a, int16 b, int16 c) {
-  int16 pa = ABS<int16>(b - c);
-  int16 pb = ABS<int16>(a - c);
-  int16 pc = ABS<int16>(a + b - c - c);
-    
-  if (pa <= MIN<int16>(pb, pc))
-	  return (byte)a;
-  else if (pb <= pc)
-	  return (byte)b;
-  else
-	  return (byte)c;
+static inline byte paethPredictor(int a, int b, int c) {
+	const int p = b - c;
+	const int q = a - c;
+	const int pa = ABS(p);
+	const int pb = ABS(q);
+	const int pc = ABS(p + q);
+
+	if (pa <= pb && pa <= pc)
+		return (byte)a;
+	else if (pb <= pc)
+		return (byte)b;
+	else
+		return (byte)c;
+}
+
+// The filters work on single bytes. These helpers process the four bytes of
+// a word at once, without letting carries spill over into the next byte.
+
+/** Adds the bytes of two words, modulo 256 */
+static inline uint32 addBytes(uint32 a, uint32 b) {
+	return ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+}
+
+/** Averages the bytes of two words, rounding down */
+static inline uint32 averageBytes(uint32 a, uint32 b) {
+	return (a & b) + (((a ^ b) & 0xFEFEFEFE) >> 1);
 }
 
 /**
- * Unfilters a filtered PNG scan line.
+ * Unfilters a filtered PNG scan line in place.
  * PNG filters are defined in: http://www.w3.org/TR/PNG/#9Filters
- * Note that filters are always applied to bytes
+ * Note that filters are always applied to bytes. For the first scan line,
+ * prevLine has to point to a line of zeros, which gives the same results as
+ * filtering without a previous line.
  *
- * Taken from lodePNG
+ * Based on lodePNG
  */
-void PNG::unfilterScanLine(byte *dest, const byte *scanLine, const byte *prevLine, uint16 byteWidth, byte filterType, uint16 length) {
-	uint16 i;
+void PNG::unfilterScanLine(byte *line, const byte *prevLine, uint16 byteWidth, byte filterType, uint32 length) {
+	uint32 i = 0;
 
 	switch (filterType) {
 	case kFilterNone:		// no change
-		for (i = 0; i < length; i++)
-			dest[i] = scanLine[i];
 		break;
 	case kFilterSub:		// add the bytes to the left
-		for (i = 0; i < byteWidth; i++)
-			dest[i] = scanLine[i];
-		for (i = byteWidth; i < length; i++)
-			dest[i] = scanLine[i] + dest[i - byteWidth];
-		break;
-	case kFilterUp:			// add the bytes of the above scanline
-		if (prevLine) {
-			for (i = 0; i < length; i++)
-				dest[i] = scanLine[i] + prevLine[i];
+		if (byteWidth == 4) {
+			for (i = 4; i + 4 <= length; i += 4)
+				WRITE_UINT32(line + i, addBytes(READ_UINT32(line + i), READ_UINT32(line + i - 4)));
 		} else {
-			for (i = 0; i < length; i++)
-				dest[i] = scanLine[i];
+			i = byteWidth;
 		}
+		for (; i < length; i++)
+			line[i] += line[i - byteWidth];
+		break;
+	case kFilterUp:			// add the bytes of the above scanline
+		for (i = 0; i + 4 <= length; i += 4)
+			WRITE_UINT32(line + i, addBytes(READ_UINT32(line + i), READ_UINT32(prevLine + i)));
+		for (; i < length; i++)
+			line[i] += prevLine[i];
 		break;
 	case kFilterAverage:	// average value of the left and top left
-		if (prevLine) {
-			for (i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i] + prevLine[i] / 2;
-			for (i = byteWidth; i < length; i++)
-				dest[i] = scanLine[i] + ((dest[i - byteWidth] + prevLine[i]) / 2);
-		} else {
-			for (i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i];
-			for (i = byteWidth; i < length; i++)
-				dest[i] = scanLine[i] + dest[i - byteWidth] / 2;
+		for (i = 0; i < byteWidth; i++)
+			line[i] += prevLine[i] / 2;
+		if (byteWidth == 4) {
+			for (; i + 4 <= length; i += 4)
+				WRITE_UINT32(line + i, addBytes(READ_UINT32(line + i), averageBytes(READ_UINT32(line + i - 4), READ_UINT32(prevLine + i))));
 		}
+		for (; i < length; i++)
+			line[i] += (line[i - byteWidth] + prevLine[i]) / 2;
 		break;
 	case kFilterPaeth:		// Paeth filter: http://www.w3.org/TR/PNG/#9Filter-type-4-Paeth
-		if (prevLine) {
-			for(i = 0; i < byteWidth; i++)
-				dest[i] = (scanLine[i] + prevLine[i]); // paethPredictor(0, prevLine[i], 0) is always prevLine[i]
-			for(i = byteWidth; i < length; i++)
-				dest[i] = (scanLine[i] + paethPredictor(dest[i - byteWidth], prevLine[i], prevLine[i - byteWidth]));
-		} else {
-			for(i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i];
-			for(i = byteWidth; i < length; i++)
-				dest[i] = (scanLine[i] + dest[i - byteWidth]); // paethPredictor(dest[i - byteWidth], 0, 0) is always dest[i - byteWidth]
-		}
+		for (i = 0; i < byteWidth; i++)
+			line[i] += prevLine[i]; // paethPredictor(0, prevLine[i], 0) is always prevLine[i]
+		for (; i < length; i++)
+			line[i] += paethPredictor(line[i - byteWidth], prevLine[i], prevLine[i - byteWidth]);
 		break;
 	default:
 		error("Unknown line filter");
 	}
-
 }
 
-void PNG::constructImage() {
-	assert (_header.bitDepth != 0);
+/**
+ * Unpacks a scan line with a bit depth below 8 into one byte per sample.
+ */
+void PNG::unpackScanLine(byte *dest, const byte *scanLine) {
+	const byte bitDepth = _header.bitDepth;
+	const byte mask = (1 << bitDepth) - 1;
+	const uint32 samples = _header.width * getNumColorChannels();
+
+	for (uint32 i = 0; i < samples; i++) {
+		const uint32 bit = i * bitDepth;
+		// Samples are packed starting with the most significant bits
+		dest[i] = (scanLine[bit >> 3] >> (8 - bitDepth - (bit & 7))) & mask;
+	}
+}
 
-	byte *dest;
-	byte *scanLine;
-	byte *prevLine = 0;
-	byte filterType;
-	uint16 scanLineWidth = (_header.width * getNumColorChannels() * _header.bitDepth + 7) / 8;
+template<typename PixelInt>
+void PNG::convertScanLine(PixelInt *dest, const byte *src, const PixelFormat &format, const uint32 *paletteColors) {
+	const uint32 width = _header.width;
+	uint32 i;
 
-	if (_unfilteredSurface) {
-		_unfilteredSurface->free();
-		delete _unfilteredSurface;
-	}
-	_unfilteredSurface = new Graphics::Surface();
-	_unfilteredSurface->create(_header.width, _header.height, (getNumColorChannels() * _header.bitDepth + 7) / 8);
-	scanLine = new byte[_unfilteredSurface->pitch];
-	dest = (byte *)_unfilteredSurface->getBasePtr(0, 0);
-
-	switch(_header.interlaceType) {
-	case kNonInterlaced:
-		for (uint16 y = 0; y < _unfilteredSurface->h; y++) {
-			filterType = _imageData->readByte();
-			_imageData->read(scanLine, scanLineWidth);
-			unfilterScanLine(dest, scanLine, prevLine, _unfilteredSurface->bytesPerPixel, filterType, scanLineWidth);
-			prevLine = dest;
-			dest += _unfilteredSurface->pitch;
+	switch (_header.colorType) {
+	case kIndexed:
+		for (i = 0; i < width; i++)
+			dest[i] = paletteColors[src[i]];
+		break;
+	case kGrayScale: {
+		// Scale samples with a bit depth below 8 to the full range
+		const byte scale = 255 / ((1 << _header.bitDepth) - 1);
+		for (i = 0; i < width; i++) {
+			const byte a = (_transparentColorSpecified && src[i] == _transparentColor[0]) ? 0 : 0xFF;
+			const byte gray = src[i] * scale;
+			dest[i] = format.ARGBToColor(a, gray, gray, gray);
 		}
 		break;
-	case kInterlaced:
+		}
+	case kGrayScaleWithAlpha:
+		for (i = 0; i < width; i++, src += 2)
+			dest[i] = format.ARGBToColor(src[1], src[0], src[0], src[0]);
+		break;
+	case kTrueColor:
+		for (i = 0; i < width; i++, src += 3) {
+			byte a = 0xFF;
+			if (_transparentColorSpecified && src[0] == _transparentColor[0] &&
+					src[1] == _transparentColor[1] && src[2] == _transparentColor[2])
+				a = 0;
+			dest[i] = format.ARGBToColor(a, src[0], src[1], src[2]);
+		}
+		break;
+	case kTrueColorWithAlpha:
+		for (i = 0; i < width; i++, src += 4)
+			dest[i] = format.ARGBToColor(src[3], src[0], src[1], src[2]);
+		break;
+	default:
+		error("Unknown color type");
+	}
+}
+
+/**
+ * Decompresses and unfilters the image one scan line at a time. Each line
+ * is converted into the given pixel format, or copied as it is when no
+ * format is given (for indexed images).
+ */
+void PNG::decodeImage(Graphics::Surface *output, const PixelFormat *format) {
+	assert(_header.bitDepth != 0);
+
+	if (_header.interlaceType == kInterlaced) {
 		// Theoretically, this shouldn't be needed, as interlacing is only
 		// useful for web images. Interlaced PNG images require more complex
 		// handling, so unless having support for such images is needed, there
 		// is no reason to add support for them.
 		error("TODO: Support for interlaced PNG images");
-		break;
 	}
 
+	const byte numChannels = getNumColorChannels();
+	const uint32 scanLineWidth = (_header.width * numChannels * _header.bitDepth + 7) / 8;
+	// Filters work on whole pixels, or on single bytes for bit depths below 8
+	const uint16 byteWidth = (numChannels * _header.bitDepth + 7) / 8;
+
+	// Colors of the palette entries in the target format
+	uint32 paletteColors[256];
+	if (format && _header.colorType == kIndexed) {
+		memset(paletteColors, 0, sizeof(paletteColors));
+		for (uint i = 0; i < _paletteEntries; i++)
+			paletteColors[i] = format->ARGBToColor(_palette[i * 4 + 3], _palette[i * 4 + 0], _palette[i * 4 + 1], _palette[i * 4 + 2]);
+	}
+
+	// The previous line starts out as zeros, see unfilterScanLine()
+	byte *scanLine = new byte[scanLineWidth];
+	byte *prevLine = new byte[scanLineWidth];
+	memset(prevLine, 0, scanLineWidth);
+	byte *unpackedLine = (_header.bitDepth < 8) ? new byte[_header.width * numChannels] : 0;
+
+	Common::SeekableReadStream *imageData = Common::wrapCompressedReadStream(new ImageDataStream(_stream, _imageDataChunks));
+
+	for (uint32 y = 0; y < _header.height; y++) {
+		byte filterType = imageData->readByte();
+		imageData->read(scanLine, scanLineWidth);
+		unfilterScanLine(scanLine, prevLine, byteWidth, filterType, scanLineWidth);
+
+		const byte *src = scanLine;
+		if (unpackedLine) {
+			unpackScanLine(unpackedLine, scanLine);
+			src = unpackedLine;
+		}
+
+		byte *dest = (byte *)output->getBasePtr(0, y);
+		if (!format)
+			memcpy(dest, src, _header.width);
+		else if (format->bytesPerPixel == 2)
+			convertScanLine<uint16>((uint16 *)dest, src, *format, paletteColors);
+		else
+			convertScanLine<uint32>((uint32 *)dest, src, *format, paletteColors);
+
+		SWAP(scanLine, prevLine);
+	}
+
+	delete imageData;
 	delete[] scanLine;
+	delete[] prevLine;
+	delete[] unpackedLine;
 }
 
 void PNG::readHeaderChunk() {
@@ -31,6 +31,7 @@
 #ifndef GRAPHICS_PNG_H
 #define GRAPHICS_PNG_H
 
+#include "common/array.h"
 #include "graphics/surface.h"
 
 // PNG decoder, based on the W3C specs:
@@ -91,7 +92,10 @@ public:
 	~PNG();
 
 	/**
-	 * Reads a PNG image from the specified stream
+	 * Reads a PNG image from the specified stream. Only the chunk headers
+	 * are read here: the image data is decompressed line by line when the
+	 * image is requested, so the PNG object takes ownership of the stream
+	 * and keeps it open until it is destroyed.
 	 */
 	bool read(Common::SeekableReadStream *str);
 
@@ -101,7 +105,9 @@ public:
 	PNGHeader getHeader() const { return _header; }
 
 	/**
-	 * Returns the PNG image, formatted for the specified pixel format.
+	 * Returns the PNG image, formatted for the specified pixel format. Each
+	 * scan line is converted as soon as it has been unfiltered, so the image
+	 * is never held in its original format in memory.
 	 */
 	Graphics::Surface *getSurface(const PixelFormat &format);
 
@@ -110,11 +116,7 @@ public:
 	 * palette, when they're shown on an 8-bit color screen, as no translation
 	 * is taking place.
 	 */
-	Graphics::Surface *getIndexedSurface() {
-		if (_header.colorType != kIndexed)
-			error("Indexed surface requested for a non-indexed PNG");
-		return _unfilteredSurface;
-	}
+	Graphics::Surface *getIndexedSurface();
 
 	/**
 	 * Returns the palette of the specified PNG8 image
@@ -133,14 +135,25 @@ private:
 	void readPaletteChunk();
 	void readTransparencyChunk(uint32 chunkLength);
 
-	void constructImage();
-	void unfilterScanLine(byte *dest, const byte *scanLine, const byte *prevLine, uint16 byteWidth, byte filterType, uint16 length);
-	byte paethPredictor(int16 a, int16 b, int16 c);
+	void decodeImage(Graphics::Surface *output, const PixelFormat *format);
+	void unfilterScanLine(byte *line, const byte *prevLine, uint16 byteWidth, byte filterType, uint32 length);
+	void unpackScanLine(byte *dest, const byte *scanLine);
+	template<typename PixelInt>
+	void convertScanLine(PixelInt *dest, const byte *src, const PixelFormat &format, const uint32 *paletteColors);
 
 	// The original file stream
 	Common::SeekableReadStream *_stream;
-	// The unzipped image data stream
-	Common::SeekableReadStream *_imageData;
+
+	// Position and size of an IDAT chunk in the file stream
+	struct ImageDataChunk {
+		uint32 offset;
+		uint32 size;
+	};
+	// The IDAT chunks, which together form the compressed image data
+	Common::Array<ImageDataChunk> _imageDataChunks;
+
+	// Reads the compressed image data straight from the IDAT chunks
+	class ImageDataStream;
 
 	PNGHeader _header;
 
@@ -149,9 +162,7 @@ private:
 	uint16 _transparentColor[3];
 	bool _transparentColorSpecified;
 
-	byte *_compressedBuffer;
-	uint32 _compressedBufferSize;
-
+	// The indexed image, only decoded when requested
 	Graphics::Surface *_unfilteredSurface;
 };
 
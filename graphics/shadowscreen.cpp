@@ -0,0 +1,147 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+
+#include "graphics/shadowscreen.h"
+#include "common/system.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+ShadowScreen::ShadowScreen(int width, int height, int bytesPerPixel)
+	: _width(width), _height(height), _bytesPerPixel(bytesPerPixel), _valid(false) {
+
+	_pitch = width * bytesPerPixel;
+	_pixels = new byte[_pitch * height];
+	resetStats();
+}
+
+ShadowScreen::~ShadowScreen() {
+	delete[] _pixels;
+}
+
+void ShadowScreen::invalidate() {
+	_valid = false;
+}
+
+void ShadowScreen::resetStats() {
+	_pixelsCopied = 0;
+	_pixelsSkipped = 0;
+}
+
+void ShadowScreen::copyRect(const byte *buf, int pitch, int x, int y, int w, int h) {
+	g_system->copyRectToScreen(buf, pitch, x, y, w, h);
+	_pixelsCopied += w * h;
+}
+
+void ShadowScreen::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+	const byte *src = (const byte *)buf;
+
+	// Clip the rectangle, like the backends do
+	if (x < 0) {
+		w += x;
+		src -= x * _bytesPerPixel;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		src -= y * pitch;
+		y = 0;
+	}
+	w = MIN(w, _width - x);
+	h = MIN(h, _height - y);
+	if (w <= 0 || h <= 0)
+		return;
+
+	const int lineSize = w * _bytesPerPixel;
+	const uint32 pixelsCopied = _pixelsCopied;
+	byte *dst = _pixels + y * _pitch + x * _bytesPerPixel;
+
+	if (!_valid) {
+		for (int i = 0; i < h; ++i)
+			memcpy(dst + i * _pitch, src + i * pitch, lineSize);
+		copyRect(src, pitch, x, y, w, h);
+		_valid = (w == _width && h == _height);
+		return;
+	}
+
+	// The rectangle covering the changes in the current run of lines
+	int runTop = 0, runLeft = 0, runRight = 0;
+	bool inRun = false;
+
+	for (int i = 0; i <= h; ++i) {
+		int left = lineSize;
+		int right = 0;
+
+		if (i < h) {
+			const byte *line = src + i * pitch;
+			byte *copy = dst + i * _pitch;
+
+			if (memcmp(line, copy, lineSize) != 0) {
+				// Narrow down the changes 16 bytes at a time, then byte by byte
+				left = 0;
+				while (left + 16 <= lineSize && !memcmp(line + left, copy + left, 16))
+					left += 16;
+				while (line[left] == copy[left])
+					++left;
+
+				right = lineSize;
+				while (right - 16 >= left && !memcmp(line + right - 16, copy + right - 16, 16))
+					right -= 16;
+				while (line[right - 1] == copy[right - 1])
+					--right;
+
+				memcpy(copy + left, line + left, right - left);
+
+				// Convert to whole pixels
+				left /= _bytesPerPixel;
+				right = (right + _bytesPerPixel - 1) / _bytesPerPixel;
+			}
+		}
+
+		if (left < right && inRun && left <= runRight && right >= runLeft) {
+			// Overlaps the changes in the lines above, so extend the run
+			runLeft = MIN(runLeft, left);
+			runRight = MAX(runRight, right);
+			continue;
+		}
+
+		if (inRun) {
+			copyRect(src + runTop * pitch + runLeft * _bytesPerPixel, pitch,
+				x + runLeft, y + runTop, runRight - runLeft, i - runTop);
+			inRun = false;
+		}
+
+		if (left < right) {
+			runTop = i;
+			runLeft = left;
+			runRight = right;
+			inRun = true;
+		}
+	}
+
+	_pixelsSkipped += w * h - (_pixelsCopied - pixelsCopied);
+}
+
+} // End of namespace Graphics
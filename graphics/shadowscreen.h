@@ -0,0 +1,98 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+
+#ifndef GRAPHICS_SHADOWSCREEN_H
+#define GRAPHICS_SHADOWSCREEN_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Keeps a copy of what the screen shows, so that only the parts of a frame
+ * which actually changed are passed on to OSystem::copyRectToScreen().
+ *
+ * Engines which draw every frame into a buffer of their own, and copy all of
+ * it to the screen, can pass it through copyRectToScreen() of this class
+ * instead. Each line is compared with the copy, and runs of changed lines are
+ * copied to the screen as single rectangles, as wide as the changes in these
+ * lines. The backend then only has to update, and scale, the parts of the
+ * screen which changed.
+ *
+ * Anything drawn to the screen by other means, like OSystem::fillScreen() or
+ * OSystem::lockScreen(), is not known to the copy. invalidate() has to be
+ * called afterwards.
+ */
+class ShadowScreen {
+public:
+	/**
+	 * @param width			the width of the screen
+	 * @param height		the height of the screen
+	 * @param bytesPerPixel	the number of bytes per pixel of the screen
+	 */
+	ShadowScreen(int width, int height, int bytesPerPixel = 1);
+	~ShadowScreen();
+
+	/**
+	 * Copies the parts of a rectangle which differ from what the screen
+	 * shows to the screen. The parameters are the same as those of
+	 * OSystem::copyRectToScreen().
+	 */
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h);
+
+	/**
+	 * Makes the next calls copy their rectangles completely, until all of
+	 * the screen has been copied in one call.
+	 */
+	void invalidate();
+
+	/** Returns the number of pixels copied to the screen since resetStats(). */
+	uint32 getPixelsCopied() const { return _pixelsCopied; }
+
+	/**
+	 * Returns the number of pixels which didn't need to be copied to the
+	 * screen since resetStats().
+	 */
+	uint32 getPixelsSkipped() const { return _pixelsSkipped; }
+
+	void resetStats();
+
+private:
+	void copyRect(const byte *buf, int pitch, int x, int y, int w, int h);
+
+	byte *_pixels;
+	int _width;
+	int _height;
+	int _bytesPerPixel;
+	int _pitch;
+	bool _valid;
+
+	uint32 _pixelsCopied;
+	uint32 _pixelsSkipped;
+};
+
+} // End of namespace Graphics
+
+#endif
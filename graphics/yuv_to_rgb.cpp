@@ -0,0 +1,189 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/surface.h"
+
+#include "common/util.h"
+
+DECLARE_SINGLETON(Graphics::YUVToRGBManager);
+
+namespace Graphics {
+
+YUVToRGBLookup::YUVToRGBLookup(const PixelFormat &format, YUVFormula formula) : _format(format), _formula(formula) {
+	// Channel values from -256 to 511, clipped to 0 to 255
+	for (int i = 0; i < 768; i++) {
+		byte c = CLIP<int>(i - 256, 0, 255);
+		_rgbToPix[i] = format.RGBToColor(c, 0, 0);
+		_rgbToPix[768 + i] = format.RGBToColor(0, c, 0);
+		_rgbToPix[1536 + i] = format.RGBToColor(0, 0, c);
+	}
+
+	// These have to match YUV2RGB() and CPYUV2RGB() exactly, including
+	// the rounding of the original expressions
+	for (int i = 0; i < 256; i++) {
+		int c = i - 128;
+
+		if (formula == kYUVFormulaCinepak) {
+			_vToR[i] = 2 * c;
+			_uToG[i] = -(c / 2);
+			_vToG[i] = -c;
+			_uToB[i] = 2 * c;
+		} else {
+			_vToR[i] = (1357 * c) >> 10;
+			_uToG[i] = -((333 * c) >> 10);
+			_vToG[i] = -((691 * c) >> 10);
+			_uToB[i] = (1715 * c) >> 10;
+		}
+
+		_vToR[i] += 256;
+		_uToG[i] += 768 + 256;
+		_uToB[i] += 1536 + 256;
+	}
+}
+
+template<typename PixelInt>
+void YUVToRGBLookup::convert444Intern(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const {
+	byte *dstPtr = (byte *)dst->pixels;
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *out = (PixelInt *)dstPtr;
+
+		for (int w = 0; w < yWidth; w++) {
+			const byte y = ySrc[w];
+			*out++ = _rgbToPix[y + _vToR[vSrc[w]]] | _rgbToPix[y + _uToG[uSrc[w]] + _vToG[vSrc[w]]] | _rgbToPix[y + _uToB[uSrc[w]]];
+		}
+
+		dstPtr += dst->pitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<typename PixelInt>
+void YUVToRGBLookup::convert420Intern(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const {
+	byte *dstPtr = (byte *)dst->pixels;
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *out = (PixelInt *)dstPtr;
+		const byte *u = uSrc + (h >> 1) * uvPitch;
+		const byte *v = vSrc + (h >> 1) * uvPitch;
+
+		// Both pixels of a pair share the chroma values
+		for (int w = 0; w < yWidth; w += 2) {
+			const int r = _vToR[*v];
+			const int g = _uToG[*u] + _vToG[*v];
+			const int b = _uToB[*u];
+			u++;
+			v++;
+
+			byte y = ySrc[w];
+			*out++ = _rgbToPix[y + r] | _rgbToPix[y + g] | _rgbToPix[y + b];
+
+			if (w + 1 < yWidth) {
+				y = ySrc[w + 1];
+				*out++ = _rgbToPix[y + r] | _rgbToPix[y + g] | _rgbToPix[y + b];
+			}
+		}
+
+		dstPtr += dst->pitch;
+		ySrc += yPitch;
+	}
+}
+
+template<typename PixelInt>
+void YUVToRGBLookup::convertPackedIntern(Surface *dst, const byte *src, int width, int height, int srcPitch) const {
+	byte *dstPtr = (byte *)dst->pixels;
+
+	for (int h = 0; h < height; h++) {
+		PixelInt *out = (PixelInt *)dstPtr;
+		const byte *in = src;
+
+		for (int w = 0; w < width; w++, in += 3)
+			*out++ = _rgbToPix[in[0] + _vToR[in[2]]] | _rgbToPix[in[0] + _uToG[in[1]] + _vToG[in[2]]] | _rgbToPix[in[0] + _uToB[in[1]]];
+
+		dstPtr += dst->pitch;
+		src += srcPitch;
+	}
+}
+
+void YUVToRGBLookup::convert444(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const {
+	assert(dst && dst->bytesPerPixel == _format.bytesPerPixel);
+	assert(dst->w >= yWidth && dst->h >= yHeight);
+
+	if (_format.bytesPerPixel == 4)
+		convert444Intern<uint32>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else if (_format.bytesPerPixel == 2)
+		convert444Intern<uint16>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else if (_format.bytesPerPixel == 1)
+		convert444Intern<byte>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		error("YUVToRGBLookup::convert444(): Unsupported bytes per pixel %d", _format.bytesPerPixel);
+}
+
+void YUVToRGBLookup::convert420(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const {
+	assert(dst && dst->bytesPerPixel == _format.bytesPerPixel);
+	assert(dst->w >= yWidth && dst->h >= yHeight);
+
+	if (_format.bytesPerPixel == 4)
+		convert420Intern<uint32>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else if (_format.bytesPerPixel == 2)
+		convert420Intern<uint16>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else if (_format.bytesPerPixel == 1)
+		convert420Intern<byte>(dst, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		error("YUVToRGBLookup::convert420(): Unsupported bytes per pixel %d", _format.bytesPerPixel);
+}
+
+void YUVToRGBLookup::convertPacked(Surface *dst, const byte *src, int width, int height, int srcPitch) const {
+	assert(dst && dst->bytesPerPixel == _format.bytesPerPixel);
+	assert(dst->w >= width && dst->h >= height);
+
+	if (_format.bytesPerPixel == 4)
+		convertPackedIntern<uint32>(dst, src, width, height, srcPitch);
+	else if (_format.bytesPerPixel == 2)
+		convertPackedIntern<uint16>(dst, src, width, height, srcPitch);
+	else if (_format.bytesPerPixel == 1)
+		convertPackedIntern<byte>(dst, src, width, height, srcPitch);
+	else
+		error("YUVToRGBLookup::convertPacked(): Unsupported bytes per pixel %d", _format.bytesPerPixel);
+}
+
+YUVToRGBManager::~YUVToRGBManager() {
+	for (Common::List<YUVToRGBLookup *>::iterator it = _lookups.begin(); it != _lookups.end(); ++it)
+		delete *it;
+}
+
+const YUVToRGBLookup *YUVToRGBManager::getLookup(const PixelFormat &format, YUVFormula formula) {
+	for (Common::List<YUVToRGBLookup *>::iterator it = _lookups.begin(); it != _lookups.end(); ++it)
+		if ((*it)->getFormat() == format && (*it)->getFormula() == formula)
+			return *it;
+
+	YUVToRGBLookup *lookup = new YUVToRGBLookup(format, formula);
+	_lookups.push_back(lookup);
+	return lookup;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+
+#ifndef GRAPHICS_YUV_TO_RGB_H
+#define GRAPHICS_YUV_TO_RGB_H
+
+#include "common/scummsys.h"
+#include "common/list.h"
+#include "common/singleton.h"
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+
+struct Surface;
+
+/** The YUV to RGB formulas used by the different codecs. */
+enum YUVFormula {
+	kYUVFormulaDefault,	///< The formula of YUV2RGB() in graphics/conversion.h
+	kYUVFormulaCinepak	///< The simplified formula used by Cinepak
+};
+
+/**
+ * Lookup tables converting YUV colors into one specific pixel format.
+ *
+ * Clipping and packing each channel into the pixel format are folded into
+ * one table per channel, so converting a pixel takes a few table lookups
+ * and no branches or shifts. The results are identical to converting with
+ * YUV2RGB() and PixelFormat::RGBToColor().
+ */
+class YUVToRGBLookup {
+public:
+	YUVToRGBLookup(const PixelFormat &format, YUVFormula formula);
+
+	const PixelFormat &getFormat() const { return _format; }
+	YUVFormula getFormula() const { return _formula; }
+
+	/** Converts a single color */
+	uint32 convert(byte y, byte u, byte v) const {
+		return _rgbToPix[y + _vToR[v]] | _rgbToPix[y + _uToG[u] + _vToG[v]] | _rgbToPix[y + _uToB[u]];
+	}
+
+	/**
+	 * Converts a planar YUV image without chroma subsampling. The surface
+	 * has to be large enough and use the format of this lookup.
+	 */
+	void convert444(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const;
+
+	/**
+	 * Converts a planar YUV image whose chroma planes are subsampled by two
+	 * in both directions. The surface has to be large enough and use the
+	 * format of this lookup.
+	 */
+	void convert420(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const;
+
+	/**
+	 * Converts a packed image with 3 bytes (Y, U, V) per pixel. The surface
+	 * has to be large enough and use the format of this lookup.
+	 */
+	void convertPacked(Surface *dst, const byte *src, int width, int height, int srcPitch) const;
+
+private:
+	template<typename PixelInt>
+	void convert444Intern(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const;
+	template<typename PixelInt>
+	void convert420Intern(Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) const;
+	template<typename PixelInt>
+	void convertPackedIntern(Surface *dst, const byte *src, int width, int height, int srcPitch) const;
+
+	PixelFormat _format;
+	YUVFormula _formula;
+
+	// Packed red, green and blue values for clipped channel values of
+	// -256 to 511, one block of 768 entries per channel
+	uint32 _rgbToPix[3 * 768];
+
+	// Indices into _rgbToPix, minus the luminance
+	int16 _vToR[256];
+	int16 _uToG[256];
+	int16 _vToG[256];
+	int16 _uToB[256];
+};
+
+/**
+ * Keeps the YUV to RGB lookup tables, so that every codec converting into
+ * the same pixel format shares them.
+ */
+class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
+public:
+	/**
+	 * Returns the lookup tables for the given format and formula, creating
+	 * them on first use. The tables stay valid as long as the manager exists.
+	 */
+	const YUVToRGBLookup *getLookup(const PixelFormat &format, YUVFormula formula = kYUVFormulaDefault);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	YUVToRGBManager() {}
+	~YUVToRGBManager();
+
+	Common::List<YUVToRGBLookup *> _lookups;
+};
+
+} // End of namespace Graphics
+
+#define YUVToRGBMan (::Graphics::YUVToRGBManager::instance())
+
+#endif
@@ -0,0 +1,464 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/endian.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "base/version.h"
+
+#include "graphics/VectorRenderer.h"
+
+#include "gui/ThemeCache.h"
+#include "gui/ThemeEval.h"
+
+namespace GUI {
+
+enum {
+	kThemeCacheVersion = 1
+};
+
+typedef Graphics::VectorRenderer VR;
+
+/** Drawing functions, stored by their index in this table */
+static const Graphics::DrawingFunctionCallback kDrawingCalls[] = {
+	&VR::drawCallback_CIRCLE,
+	&VR::drawCallback_SQUARE,
+	&VR::drawCallback_ROUNDSQ,
+	&VR::drawCallback_BEVELSQ,
+	&VR::drawCallback_LINE,
+	&VR::drawCallback_TRIANGLE,
+	&VR::drawCallback_FILLSURFACE,
+	&VR::drawCallback_TAB,
+	&VR::drawCallback_VOID,
+	&VR::drawCallback_BITMAP,
+	&VR::drawCallback_CROSS
+};
+
+static void writeColor(Common::WriteStream &stream, const Graphics::DrawStep::Color &color) {
+	stream.writeByte(color.r);
+	stream.writeByte(color.g);
+	stream.writeByte(color.b);
+	stream.writeByte(color.set ? 1 : 0);
+}
+
+static void readColor(Common::ReadStream &stream, Graphics::DrawStep::Color &color) {
+	color.r = stream.readByte();
+	color.g = stream.readByte();
+	color.b = stream.readByte();
+	color.set = stream.readByte() != 0;
+}
+
+ThemeCache::ThemeCache() : _commands(DisposeAfterUse::YES) {
+}
+
+void ThemeCache::writeString(const Common::String &str) {
+	_commands.writeUint16LE(str.size());
+	_commands.write(str.c_str(), str.size());
+}
+
+Common::String ThemeCache::readString(Common::ReadStream &stream) {
+	Common::String str;
+	for (uint16 size = stream.readUint16LE(); size > 0 && !stream.eos(); --size)
+		str += (char)stream.readByte();
+	return str;
+}
+
+void ThemeCache::addDrawData(const Common::String &id, bool cached) {
+	_commands.writeByte(kCmdDrawData);
+	writeString(id);
+	_commands.writeByte(cached ? 1 : 0);
+}
+
+void ThemeCache::addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &bitmap) {
+	uint call = 0;
+	while (call < ARRAYSIZE(kDrawingCalls) && kDrawingCalls[call] != step.drawingCall)
+		++call;
+	assert(call < ARRAYSIZE(kDrawingCalls));
+
+	_commands.writeByte(kCmdDrawStep);
+	writeString(drawDataId);
+	_commands.writeByte(call);
+	writeString(bitmap);
+
+	writeColor(_commands, step.fgColor);
+	writeColor(_commands, step.bgColor);
+	writeColor(_commands, step.gradColor1);
+	writeColor(_commands, step.gradColor2);
+	writeColor(_commands, step.bevelColor);
+
+	_commands.writeByte(step.autoWidth ? 1 : 0);
+	_commands.writeByte(step.autoHeight ? 1 : 0);
+	_commands.writeSint16LE(step.x);
+	_commands.writeSint16LE(step.y);
+	_commands.writeSint16LE(step.w);
+	_commands.writeSint16LE(step.h);
+	_commands.writeByte(step.xAlign);
+	_commands.writeByte(step.yAlign);
+
+	_commands.writeByte(step.shadow);
+	_commands.writeByte(step.stroke);
+	_commands.writeByte(step.factor);
+	_commands.writeByte(step.radius);
+	_commands.writeByte(step.bevel);
+	_commands.writeByte(step.fillMode);
+	_commands.writeUint32LE(step.extraData);
+	_commands.writeUint32LE(step.scale);
+}
+
+void ThemeCache::addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV) {
+	_commands.writeByte(kCmdTextData);
+	writeString(drawDataId);
+	_commands.writeSint16LE(textId);
+	_commands.writeSint16LE(colorId);
+	_commands.writeSint16LE(alignH);
+	_commands.writeSint16LE(alignV);
+}
+
+void ThemeCache::addFont(TextData textId, const Common::String &file) {
+	_commands.writeByte(kCmdFont);
+	_commands.writeSint16LE(textId);
+	writeString(file);
+}
+
+void ThemeCache::addTextColor(TextColor colorId, int r, int g, int b) {
+	_commands.writeByte(kCmdTextColor);
+	_commands.writeSint16LE(colorId);
+	_commands.writeByte(r);
+	_commands.writeByte(g);
+	_commands.writeByte(b);
+}
+
+void ThemeCache::addBitmap(const Common::String &filename) {
+	_commands.writeByte(kCmdBitmap);
+	writeString(filename);
+}
+
+void ThemeCache::createCursor(const Common::String &filename, int hotspotX, int hotspotY, int scale) {
+	_commands.writeByte(kCmdCursor);
+	writeString(filename);
+	_commands.writeSint16LE(hotspotX);
+	_commands.writeSint16LE(hotspotY);
+	_commands.writeSint16LE(scale);
+}
+
+void ThemeCache::setVar(const Common::String &name, int value) {
+	_commands.writeByte(kCmdSetVar);
+	writeString(name);
+	_commands.writeSint32LE(value);
+}
+
+void ThemeCache::addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset) {
+	_commands.writeByte(kCmdDialog);
+	writeString(name);
+	writeString(overlays);
+	_commands.writeByte(enabled ? 1 : 0);
+	_commands.writeSint32LE(inset);
+}
+
+void ThemeCache::addLayout(ThemeLayout::LayoutType type, int spacing, bool center) {
+	_commands.writeByte(kCmdLayout);
+	_commands.writeByte(type);
+	_commands.writeSint32LE(spacing);
+	_commands.writeByte(center ? 1 : 0);
+}
+
+void ThemeCache::addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align) {
+	_commands.writeByte(kCmdWidget);
+	writeString(name);
+	_commands.writeSint32LE(w);
+	_commands.writeSint32LE(h);
+	writeString(type);
+	_commands.writeByte(enabled ? 1 : 0);
+	_commands.writeSint16LE(align);
+}
+
+void ThemeCache::addImportedLayout(const Common::String &name) {
+	_commands.writeByte(kCmdImport);
+	writeString(name);
+}
+
+void ThemeCache::addSpace(int size) {
+	_commands.writeByte(kCmdSpace);
+	_commands.writeSint32LE(size);
+}
+
+void ThemeCache::addPadding(int16 l, int16 r, int16 t, int16 b) {
+	_commands.writeByte(kCmdPadding);
+	_commands.writeSint16LE(l);
+	_commands.writeSint16LE(r);
+	_commands.writeSint16LE(t);
+	_commands.writeSint16LE(b);
+}
+
+void ThemeCache::closeLayout() {
+	_commands.writeByte(kCmdCloseLayout);
+}
+
+void ThemeCache::closeDialog() {
+	_commands.writeByte(kCmdCloseDialog);
+}
+
+bool ThemeCache::save(const Common::String &filename, const uint8 hash[16]) {
+	Common::OutSaveFile *file = g_system->getSavefileManager()->openForSaving(filename);
+	if (!file)
+		return false;
+
+	_commands.writeByte(kCmdEnd);
+
+	uint8 digest[16];
+	Common::MemoryReadStream commands(_commands.getData(), _commands.size());
+	Common::computeStreamMD5(commands, digest);
+
+	file->writeUint32BE(MKID_BE('STHC'));
+	file->writeUint32LE(kThemeCacheVersion);
+	file->writeUint16LE(strlen(gScummVMFullVersion));
+	file->write(gScummVMFullVersion, strlen(gScummVMFullVersion));
+	file->writeUint16LE(g_system->getOverlayWidth());
+	file->writeUint16LE(g_system->getOverlayHeight());
+	file->write(hash, 16);
+	file->write(digest, 16);
+	file->writeUint32LE(_commands.size());
+	file->write(_commands.getData(), _commands.size());
+
+	file->finalize();
+	const bool result = !file->err();
+	delete file;
+
+	return result;
+}
+
+bool ThemeCache::load(const Common::String &filename, const uint8 hash[16], ThemeEngine *theme) {
+	Common::InSaveFile *file = g_system->getSavefileManager()->openForLoading(filename);
+	if (!file)
+		return false;
+
+	bool valid = file->readUint32BE() == MKID_BE('STHC') && file->readUint32LE() == kThemeCacheVersion;
+	valid = valid && readString(*file) == gScummVMFullVersion;
+	valid = valid && file->readUint16LE() == g_system->getOverlayWidth();
+	valid = valid && file->readUint16LE() == g_system->getOverlayHeight();
+
+	uint8 fileHash[16], digest[16];
+	file->read(fileHash, 16);
+	file->read(digest, 16);
+	valid = valid && !memcmp(fileHash, hash, 16);
+
+	const uint32 size = file->readUint32LE();
+	byte *commands = 0;
+	if (valid && !file->err() && !file->eos() && size > 0) {
+		commands = (byte *)malloc(size);
+		valid = file->read(commands, size) == size;
+	} else {
+		valid = false;
+	}
+	delete file;
+
+	// Check the commands before replaying anything, so a damaged file
+	// doesn't leave a partly loaded theme behind
+	if (valid) {
+		uint8 commandsDigest[16];
+		Common::MemoryReadStream stream(commands, size);
+		Common::computeStreamMD5(stream, commandsDigest);
+		valid = !memcmp(commandsDigest, digest, 16);
+	}
+
+	if (valid) {
+		Common::MemoryReadStream stream(commands, size);
+		valid = replay(stream, theme);
+	}
+
+	free(commands);
+	return valid;
+}
+
+bool ThemeCache::replay(Common::ReadStream &stream, ThemeEngine *theme) {
+	ThemeEval *eval = theme->getEvaluator();
+
+	for (;;) {
+		const byte command = stream.readByte();
+		if (stream.eos())
+			return false;
+
+		switch (command) {
+		case kCmdEnd:
+			return true;
+
+		case kCmdDrawData: {
+			const Common::String id = readString(stream);
+			const bool cached = stream.readByte() != 0;
+			if (!theme->addDrawData(id, cached))
+				return false;
+			break;
+		}
+
+		case kCmdDrawStep: {
+			Graphics::DrawStep step;
+			const Common::String id = readString(stream);
+			const uint call = stream.readByte();
+			const Common::String bitmap = readString(stream);
+
+			if (call >= ARRAYSIZE(kDrawingCalls))
+				return false;
+			step.drawingCall = kDrawingCalls[call];
+			step.blitSrc = 0;
+			if (!bitmap.empty() && !(step.blitSrc = theme->getBitmap(bitmap)))
+				return false;
+
+			readColor(stream, step.fgColor);
+			readColor(stream, step.bgColor);
+			readColor(stream, step.gradColor1);
+			readColor(stream, step.gradColor2);
+			readColor(stream, step.bevelColor);
+
+			step.autoWidth = stream.readByte() != 0;
+			step.autoHeight = stream.readByte() != 0;
+			step.x = stream.readSint16LE();
+			step.y = stream.readSint16LE();
+			step.w = stream.readSint16LE();
+			step.h = stream.readSint16LE();
+			step.xAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+			step.yAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+
+			step.shadow = stream.readByte();
+			step.stroke = stream.readByte();
+			step.factor = stream.readByte();
+			step.radius = stream.readByte();
+			step.bevel = stream.readByte();
+			step.fillMode = stream.readByte();
+			step.extraData = stream.readUint32LE();
+			step.scale = stream.readUint32LE();
+
+			theme->addDrawStep(id, step);
+			break;
+		}
+
+		case kCmdTextData: {
+			const Common::String id = readString(stream);
+			const TextData textId = (TextData)stream.readSint16LE();
+			const TextColor colorId = (TextColor)stream.readSint16LE();
+			const Graphics::TextAlign alignH = (Graphics::TextAlign)stream.readSint16LE();
+			const ThemeEngine::TextAlignVertical alignV = (ThemeEngine::TextAlignVertical)stream.readSint16LE();
+			if (!theme->addTextData(id, textId, colorId, alignH, alignV))
+				return false;
+			break;
+		}
+
+		case kCmdFont: {
+			const TextData textId = (TextData)stream.readSint16LE();
+			if (!theme->addFont(textId, readString(stream)))
+				return false;
+			break;
+		}
+
+		case kCmdTextColor: {
+			const TextColor colorId = (TextColor)stream.readSint16LE();
+			const int r = stream.readByte();
+			const int g = stream.readByte();
+			const int b = stream.readByte();
+			if (!theme->addTextColor(colorId, r, g, b))
+				return false;
+			break;
+		}
+
+		case kCmdBitmap:
+			if (!theme->addBitmap(readString(stream)))
+				return false;
+			break;
+
+		case kCmdCursor: {
+			const Common::String filename = readString(stream);
+			const int hotspotX = stream.readSint16LE();
+			const int hotspotY = stream.readSint16LE();
+			const int scale = stream.readSint16LE();
+			if (!theme->createCursor(filename, hotspotX, hotspotY, scale))
+				return false;
+			break;
+		}
+
+		case kCmdSetVar: {
+			const Common::String name = readString(stream);
+			eval->setVar(name, stream.readSint32LE());
+			break;
+		}
+
+		case kCmdDialog: {
+			const Common::String name = readString(stream);
+			const Common::String overlays = readString(stream);
+			const bool enabled = stream.readByte() != 0;
+			eval->addDialog(name, overlays, enabled, stream.readSint32LE());
+			break;
+		}
+
+		case kCmdLayout: {
+			const ThemeLayout::LayoutType type = (ThemeLayout::LayoutType)stream.readByte();
+			const int spacing = stream.readSint32LE();
+			eval->addLayout(type, spacing, stream.readByte() != 0);
+			break;
+		}
+
+		case kCmdWidget: {
+			const Common::String name = readString(stream);
+			const int w = stream.readSint32LE();
+			const int h = stream.readSint32LE();
+			const Common::String type = readString(stream);
+			const bool enabled = stream.readByte() != 0;
+			eval->addWidget(name, w, h, type, enabled, (Graphics::TextAlign)stream.readSint16LE());
+			break;
+		}
+
+		case kCmdImport:
+			if (!eval->addImportedLayout(readString(stream)))
+				return false;
+			break;
+
+		case kCmdSpace:
+			eval->addSpace(stream.readSint32LE());
+			break;
+
+		case kCmdPadding: {
+			const int16 l = stream.readSint16LE();
+			const int16 r = stream.readSint16LE();
+			const int16 t = stream.readSint16LE();
+			const int16 b = stream.readSint16LE();
+			eval->addPadding(l, r, t, b);
+			break;
+		}
+
+		case kCmdCloseLayout:
+			eval->closeLayout();
+			break;
+
+		case kCmdCloseDialog:
+			eval->closeDialog();
+			break;
+
+		default:
+			return false;
+		}
+	}
+}
+
+} // End of namespace GUI
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef GUI_THEMECACHE_H
+#define GUI_THEMECACHE_H
+
+#include "common/scummsys.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "gui/ThemeEngine.h"
+#include "gui/ThemeLayout.h"
+
+namespace Graphics {
+	struct DrawStep;
+}
+
+namespace GUI {
+
+/**
+ * Compiled form of a parsed theme.
+ *
+ * While a theme is parsed, ThemeParser records every call it makes into
+ * the ThemeEngine and its ThemeEval, with all variables and expressions
+ * already resolved. The recorded calls are saved to a binary file, which
+ * is replayed on the next start instead of parsing the STX files again.
+ *
+ * The file is only used when it was written by the same ScummVM version
+ * for the same overlay resolution, and when the hash of the theme sources
+ * it was compiled from matches.
+ */
+class ThemeCache {
+public:
+	ThemeCache();
+
+	/** @name Recording, called by ThemeParser for each successful call */
+	//@{
+	void addDrawData(const Common::String &id, bool cached);
+	void addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &bitmap);
+	void addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV);
+	void addFont(TextData textId, const Common::String &file);
+	void addTextColor(TextColor colorId, int r, int g, int b);
+	void addBitmap(const Common::String &filename);
+	void createCursor(const Common::String &filename, int hotspotX, int hotspotY, int scale);
+
+	void setVar(const Common::String &name, int value);
+	void addDialog(const Common::String &name, const Common::String &overlays, bool enabled, int inset);
+	void addLayout(ThemeLayout::LayoutType type, int spacing, bool center);
+	void addWidget(const Common::String &name, int w, int h, const Common::String &type, bool enabled, Graphics::TextAlign align);
+	void addImportedLayout(const Common::String &name);
+	void addSpace(int size);
+	void addPadding(int16 l, int16 r, int16 t, int16 b);
+	void closeLayout();
+	void closeDialog();
+	//@}
+
+	/**
+	 * Writes the recorded calls to a savefile.
+	 *
+	 * @param filename Name of the savefile.
+	 * @param hash     MD5 of the theme sources.
+	 * @return true if the file was written.
+	 */
+	bool save(const Common::String &filename, const uint8 hash[16]);
+
+	/**
+	 * Replays a compiled theme from a savefile into a theme engine.
+	 *
+	 * Nothing is replayed if the file is missing, corrupt or doesn't
+	 * match the hash, the ScummVM version or the overlay resolution.
+	 * If a call fails while replaying, the calls before it have already
+	 * been made, and the caller has to clear the theme again.
+	 *
+	 * @param filename Name of the savefile.
+	 * @param hash     MD5 of the theme sources.
+	 * @param theme    Theme engine to replay the calls into.
+	 * @return true if the theme was loaded from the file.
+	 */
+	static bool load(const Common::String &filename, const uint8 hash[16], ThemeEngine *theme);
+
+private:
+	enum Command {
+		kCmdEnd = 0,
+		kCmdDrawData,
+		kCmdDrawStep,
+		kCmdTextData,
+		kCmdFont,
+		kCmdTextColor,
+		kCmdBitmap,
+		kCmdCursor,
+		kCmdSetVar,
+		kCmdDialog,
+		kCmdLayout,
+		kCmdWidget,
+		kCmdImport,
+		kCmdSpace,
+		kCmdPadding,
+		kCmdCloseLayout,
+		kCmdCloseDialog
+	};
+
+	static bool replay(Common::ReadStream &stream, ThemeEngine *theme);
+
+	void writeString(const Common::String &str);
+	static Common::String readString(Common::ReadStream &stream);
+
+	Common::MemoryWriteStreamDynamic _commands;
+};
+
+} // End of namespace GUI
+
+#endif
@@ -28,6 +28,8 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -40,6 +42,7 @@
 #include "graphics/VectorRenderer.h"
 
 #include "gui/launcher.h"
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -62,6 +65,11 @@ struct WidgetDrawData {
 	/** List of all the steps needed to draw this widget */
 	Common::List<Graphics::DrawStep> _steps;
 
+	DrawData _id;
+
+	/** Whether the widget cache can store and stretch this widget */
+	WidgetImageCache::StepInfo _cacheInfo;
+
 	TextData _textDataId;
 	TextColor _textColorId;
 	Graphics::TextAlign _textAlignH;
@@ -221,7 +229,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
+	if (draw && !_engine->widgetCache().draw(_engine->renderer(), _data->_id, _data->_steps, _data->_cacheInfo,
+			_area, _engine->kDirtyRectangleThreshold + _data->_backgroundOffset, _dynamicData)) {
 		Common::List<Graphics::DrawStep>::const_iterator step;
 		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
 			_engine->renderer()->drawStep(_area, *step, _dynamicData);
@@ -262,7 +271,7 @@ void ThemeItemBitmap::drawSelf(bool draw, bool restore) {
  *	ThemeEngine class
  *********************************************************/
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
-	_system(0), _vectorRenderer(0),
+	_system(0), _vectorRenderer(0), _widgetCache(kWidgetCacheSize),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
 	_font(0), _initOk(false), _themeOk(false), _enabled(false), _cursor(0) {
 
@@ -375,6 +384,7 @@ bool ThemeEngine::init() {
 	_initOk = false;
 	setGraphicsMode(_graphicsMode);
 	_overlayFormat = _system->getOverlayFormat();
+	_widgetCache.setFormat(_overlayFormat);
 
 	if (_screen.pixels && _backBuffer.pixels) {
 		_initOk = true;
@@ -507,6 +517,9 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
+
+	// The cached widgets were drawn by the old renderer
+	_widgetCache.clear();
 }
 
 void WidgetDrawData::calcBackgroundOffset() {
@@ -651,6 +664,7 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 		delete _widgets[id];
 
 	_widgets[id] = new WidgetDrawData;
+	_widgets[id]->_id = id;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
 	_widgets[id]->_textDataId = kTextDataNone;
 
@@ -681,6 +695,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->_cacheInfo = WidgetImageCache::analyzeSteps(_widgets[i]->_steps);
 		}
 	}
 }
@@ -689,6 +704,13 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	clearThemeData();
+	_themeOk = false;
+}
+
+void ThemeEngine::clearThemeData() {
+	_widgetCache.clear();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -705,7 +727,14 @@ void ThemeEngine::unloadTheme() {
 	}
 
 	_themeEval->reset();
-	_themeOk = false;
+}
+
+bool ThemeEngine::loadThemeCache(const uint8 hash[16]) {
+	if (ThemeCache::load(getThemeCacheName(_themeId), hash, this))
+		return true;
+
+	clearThemeData();
+	return false;
 }
 
 bool ThemeEngine::loadDefaultXML() {
@@ -719,16 +748,29 @@ bool ThemeEngine::loadDefaultXML() {
 #include "themes/default.inc"
 	;
 
-	if (!_parser->loadBuffer((const byte*)defaultXML, strlen(defaultXML)))
-		return false;
-
 	_themeName = "ScummVM Classic Theme (Builtin Version)";
 	_themeId = "builtin";
 	_themeFile.clear();
 
+	uint8 hash[16];
+	Common::MemoryReadStream source((const byte *)defaultXML, strlen(defaultXML));
+	Common::computeStreamMD5(source, hash);
+
+	if (loadThemeCache(hash))
+		return true;
+
+	if (!_parser->loadBuffer((const byte*)defaultXML, strlen(defaultXML)))
+		return false;
+
+	ThemeCache cache;
+	_parser->setCache(&cache);
 	bool result = _parser->parse();
+	_parser->setCache(0);
 	_parser->close();
 
+	if (result)
+		cache.save(getThemeCacheName(_themeId), hash);
+
 	return result;
 #else
 	warning("The built-in theme is not enabled in the current build. Please load an external theme");
@@ -766,30 +808,82 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 	}
 
 	//
-	// Loop over all STX files, load and parse them
+	// Read all STX files and hash them. If the theme has been compiled
+	// from the same files before, it is loaded from the compiled cache.
 	//
+	Common::Array<Common::SeekableReadStream *> sources;
+	byte *digests = new byte[members.size() * 16];
+
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
-		if (_parser->loadStream((*i)->createReadStream()) == false) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (stream) {
+			sources.push_back(stream->readStream(stream->size()));
+			delete stream;
+
+			Common::computeStreamMD5(*sources.back(), digests + (sources.size() - 1) * 16);
+			sources.back()->seek(0);
+		} else {
+			sources.push_back(0);
+			memset(digests + (sources.size() - 1) * 16, 0, 16);
+		}
+	}
+
+	uint8 hash[16];
+	Common::MemoryReadStream digestStream(digests, members.size() * 16, DisposeAfterUse::YES);
+	Common::computeStreamMD5(digestStream, hash);
+
+	if (loadThemeCache(hash)) {
+		for (uint i = 0; i < sources.size(); ++i)
+			delete sources[i];
+		return true;
+	}
+
+	//
+	// Loop over all STX files and parse them
+	//
+	ThemeCache cache;
+	_parser->setCache(&cache);
+
+	bool result = true;
+	uint source = 0;
+	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i, ++source) {
+		if (!result) {
+			delete sources[source];
+			continue;
+		}
+
+		if (!sources[source] || _parser->loadStream(sources[source]) == false) {
 			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
-			_parser->close();
-			return false;
+			delete sources[source];
+			result = false;
+			continue;
 		}
 
 		if (_parser->parse() == false) {
 			warning("Failed to parse STX file '%s'", (*i)->getDisplayName().c_str());
-			_parser->close();
-			return false;
+			result = false;
 		}
 
 		_parser->close();
 	}
 
+	_parser->setCache(0);
+
+	if (!result)
+		return false;
+
+	cache.save(getThemeCacheName(_themeId), hash);
+
 	assert(!_themeName.empty());
 	return true;
 }
 
+Common::String ThemeEngine::getThemeCacheName(const Common::String &themeId) {
+	return themeId + ".thc";
+}
+
 
 
 /**********************************************************
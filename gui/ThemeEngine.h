@@ -32,6 +32,8 @@
 #include "graphics/surface.h"
 #include "graphics/font.h"
 
+#include "gui/WidgetImageCache.h"
+
 #define SCUMMVM_THEME_VERSION_STR "SCUMMVM_STX0.8.2"
 
 namespace Graphics {
@@ -236,6 +238,9 @@ public:
 	/** Constant value to expand dirty rectangles, to make sure they are fully copied */
 	static const int kDirtyRectangleThreshold = 1;
 
+	/** Number of bytes the rendered widgets may take up in the widget cache */
+	static const uint32 kWidgetCacheSize = 2 * 1024 * 1024;
+
 	struct Renderer {
 		const char *name;
 		const char *shortname;
@@ -461,6 +466,7 @@ public:
 
 	inline ThemeEval *getEvaluator() { return _themeEval; }
 	inline Graphics::VectorRenderer *renderer() { return _vectorRenderer; }
+	inline WidgetImageCache &widgetCache() { return _widgetCache; }
 
 	inline bool supportsImages() const { return true; }
 	inline bool ownCursor() const { return _useCursor; }
@@ -494,6 +500,13 @@ public:
 
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
+
+	/**
+	 * Returns the name of the savefile that the compiled form of the
+	 * given theme is cached in.
+	 */
+	static Common::String getThemeCacheName(const Common::String &themeId);
+
 	int getGraphicsMode() const { return _graphicsMode; }
 
 protected:
@@ -528,6 +541,18 @@ protected:
 	 */
 	void unloadTheme();
 
+	/**
+	 *	Frees the draw data, texts, colors and layouts of the theme.
+	 */
+	void clearThemeData();
+
+	/**
+	 *	Loads the theme from its compiled cache. If the cache fails after
+	 *	a part of it has been loaded, that part is dropped again, so the
+	 *	theme can be parsed from scratch.
+	 */
+	bool loadThemeCache(const uint8 hash[16]);
+
 	const Graphics::Font *loadFont(const Common::String &filename);
 	const Graphics::Font *loadFontFromArchive(const Common::String &filename);
 	const Graphics::Font *loadCachedFontFromArchive(const Common::String &filename);
@@ -590,6 +615,9 @@ protected:
 	/** Vector Renderer object, does the actual drawing on screen */
 	Graphics::VectorRenderer *_vectorRenderer;
 
+	/** Rendered DrawData items, reused instead of drawing the steps again */
+	WidgetImageCache _widgetCache;
+
 	/** XML Parser, does the Theme parsing instead of the default parser */
 	GUI::ThemeParser *_parser;
 
@@ -23,6 +23,7 @@
  *
  */
 
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -109,6 +110,7 @@ ThemeParser::ThemeParser(ThemeEngine *parent) : XMLParser() {
 	_defaultStepGlobal = defaultDrawStep();
 	_defaultStepLocal = 0;
 	_theme = parent;
+	_cache = 0;
 }
 
 ThemeParser::~ThemeParser() {
@@ -183,6 +185,9 @@ bool ThemeParser::parserCallback_font(ParserNode *node) {
 	if (!_theme->addFont(textDataId, node->values["file"]))
 		return parserError("Error loading Font in theme engine.");
 
+	if (_cache)
+		_cache->addFont(textDataId, node->values["file"]);
+
 	return true;
 }
 
@@ -201,6 +206,9 @@ bool ThemeParser::parserCallback_text_color(ParserNode *node) {
 	if (!_theme->addTextColor(colorId, red, green, blue))
 		return parserError("Error while adding text color information.");
 
+	if (_cache)
+		_cache->addTextColor(colorId, red, green, blue);
+
 	return true;
 }
 
@@ -225,6 +233,9 @@ bool ThemeParser::parserCallback_cursor(ParserNode *node) {
 	if (!_theme->createCursor(node->values["file"], spotx, spoty, scale))
 		return parserError("Error creating Bitmap Cursor.");
 
+	if (_cache)
+		_cache->createCursor(node->values["file"], spotx, spoty, scale);
+
 	return true;
 }
 
@@ -237,6 +248,9 @@ bool ThemeParser::parserCallback_bitmap(ParserNode *node) {
 	if (!_theme->addBitmap(node->values["filename"]))
 		return parserError("Error loading Bitmap file '%s'", node->values["filename"].c_str());
 
+	if (_cache)
+		_cache->addBitmap(node->values["filename"]);
+
 	return true;
 }
 
@@ -257,6 +271,9 @@ bool ThemeParser::parserCallback_text(ParserNode *node) {
 	if (!_theme->addTextData(id, textDataId, textColorId, alignH, alignV))
 		return parserError("Error adding Text Data for '%s'.", id.c_str());
 
+	if (_cache)
+		_cache->addTextData(id, textDataId, textColorId, alignH, alignV);
+
 	return true;
 }
 
@@ -341,6 +358,10 @@ bool ThemeParser::parserCallback_drawstep(ParserNode *node) {
 		return false;
 
 	_theme->addDrawStep(getParentNode(node)->values["id"], *drawstep);
+
+	if (_cache)
+		_cache->addDrawStep(getParentNode(node)->values["id"], *drawstep, drawstep->blitSrc ? node->values["file"] : "");
+
 	delete drawstep;
 
 	return true;
@@ -365,6 +386,9 @@ bool ThemeParser::parserCallback_drawdata(ParserNode *node) {
 	if (_theme->addDrawData(node->values["id"], cached) == false)
 		return parserError("Error adding Draw Data set: Invalid DrawData name.");
 
+	if (_cache)
+		_cache->addDrawData(node->values["id"], cached);
+
 	delete _defaultStepLocal;
 	_defaultStepLocal = 0;
 
@@ -572,7 +596,7 @@ bool ThemeParser::parserCallback_def(ParserNode *node) {
 	else if (!parseIntegerKey(node->values["value"], 1, &value))
 		return parserError("Invalid definition for '%s'.", var.c_str());
 
-	_theme->getEvaluator()->setVar(var, value);
+	setVar(var, value);
 	return true;
 }
 
@@ -628,6 +652,9 @@ bool ThemeParser::parserCallback_widget(ParserNode *node) {
 		}
 
 		_theme->getEvaluator()->addWidget(var, width, height, node->values["type"], enabled, alignH);
+
+		if (_cache)
+			_cache->addWidget(var, width, height, node->values["type"], enabled, alignH);
 	}
 
 	return true;
@@ -657,6 +684,9 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 
 	_theme->getEvaluator()->addDialog(var, node->values["overlays"], enabled, inset);
 
+	if (_cache)
+		_cache->addDialog(var, node->values["overlays"], enabled, inset);
+
 	if (node->values.contains("shading")) {
 		int shading = 0;
 		if (node->values["shading"] == "dim")
@@ -665,7 +695,7 @@ bool ThemeParser::parserCallback_dialog(ParserNode *node) {
 			shading = 2;
 		else return parserError("Invalid value for Dialog background shading.");
 
-		_theme->getEvaluator()->setVar(var + ".Shading", shading);
+		setVar(var + ".Shading", shading);
 	}
 
 	return true;
@@ -675,6 +705,10 @@ bool ThemeParser::parserCallback_import(ParserNode *node) {
 
 	if (!_theme->getEvaluator()->addImportedLayout(node->values["layout"]))
 		return parserError("Error importing external layout");
+
+	if (_cache)
+		_cache->addImportedLayout(node->values["layout"]);
+
 	return true;
 }
 
@@ -686,13 +720,18 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 			return false;
 	}
 
+	GUI::ThemeLayout::LayoutType type;
 	if (node->values["type"] == "vertical")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutVertical, spacing, node->values["center"] == "true");
+		type = GUI::ThemeLayout::kLayoutVertical;
 	else if (node->values["type"] == "horizontal")
-		_theme->getEvaluator()->addLayout(GUI::ThemeLayout::kLayoutHorizontal, spacing, node->values["center"] == "true");
+		type = GUI::ThemeLayout::kLayoutHorizontal;
 	else
 		return parserError("Invalid layout type. Only 'horizontal' and 'vertical' layouts allowed.");
 
+	_theme->getEvaluator()->addLayout(type, spacing, node->values["center"] == "true");
+
+	if (_cache)
+		_cache->addLayout(type, spacing, node->values["center"] == "true");
 
 	if (node->values.contains("padding")) {
 		int paddingL, paddingR, paddingT, paddingB;
@@ -701,6 +740,9 @@ bool ThemeParser::parserCallback_layout(ParserNode *node) {
 			return false;
 
 		_theme->getEvaluator()->addPadding(paddingL, paddingR, paddingT, paddingB);
+
+		if (_cache)
+			_cache->addPadding(paddingL, paddingR, paddingT, paddingB);
 	}
 
 	return true;
@@ -718,18 +760,36 @@ bool ThemeParser::parserCallback_space(ParserNode *node) {
 	}
 
 	_theme->getEvaluator()->addSpace(size);
+
+	if (_cache)
+		_cache->addSpace(size);
+
 	return true;
 }
 
 bool ThemeParser::closedKeyCallback(ParserNode *node) {
-	if (node->name == "layout")
+	if (node->name == "layout") {
 		_theme->getEvaluator()->closeLayout();
-	else if (node->name == "dialog")
+
+		if (_cache)
+			_cache->closeLayout();
+	} else if (node->name == "dialog") {
 		_theme->getEvaluator()->closeDialog();
 
+		if (_cache)
+			_cache->closeDialog();
+	}
+
 	return true;
 }
 
+void ThemeParser::setVar(const Common::String &name, int value) {
+	_theme->getEvaluator()->setVar(name, value);
+
+	if (_cache)
+		_cache->setVar(name, value);
+}
+
 bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String &var) {
 	if (node->values.contains("size")) {
 		int width, height;
@@ -772,8 +832,8 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		}
 
 
-		_theme->getEvaluator()->setVar(var + "Width", width);
-		_theme->getEvaluator()->setVar(var + "Height", height);
+		setVar(var + "Width", width);
+		setVar(var + "Height", height);
 	}
 
 	if (node->values.contains("pos")) {
@@ -828,8 +888,8 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 				return false;
 		}
 
-		_theme->getEvaluator()->setVar(var + "X", x);
-		_theme->getEvaluator()->setVar(var + "Y", y);
+		setVar(var + "X", x);
+		setVar(var + "Y", y);
 	}
 
 	if (node->values.contains("padding")) {
@@ -838,10 +898,10 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		if (!parseIntegerKey(node->values["padding"], 4, &paddingL, &paddingR, &paddingT, &paddingB))
 			return false;
 
-		_theme->getEvaluator()->setVar(var + "Padding.Left", paddingL);
-		_theme->getEvaluator()->setVar(var + "Padding.Right", paddingR);
-		_theme->getEvaluator()->setVar(var + "Padding.Top", paddingT);
-		_theme->getEvaluator()->setVar(var + "Padding.Bottom", paddingB);
+		setVar(var + "Padding.Left", paddingL);
+		setVar(var + "Padding.Right", paddingR);
+		setVar(var + "Padding.Top", paddingT);
+		setVar(var + "Padding.Bottom", paddingB);
 	}
 
 
@@ -851,7 +911,7 @@ bool ThemeParser::parseCommonLayoutProps(ParserNode *node, const Common::String
 		if ((alignH = parseTextHAlign(node->values["textalign"])) == Graphics::kTextAlignInvalid)
 			return parserError("Invalid value for text alignment.");
 
-		_theme->getEvaluator()->setVar(var + "Align", alignH);
+		setVar(var + "Align", alignH);
 	}
 	return true;
 }
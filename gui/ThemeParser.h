@@ -31,6 +31,7 @@
 
 namespace GUI {
 
+class ThemeCache;
 class ThemeEngine;
 
 class ThemeParser : public Common::XMLParser {
@@ -50,8 +51,12 @@ public:
 		return true;
 	}
 
+	/** Records the calls made while parsing into the given cache. */
+	void setCache(ThemeCache *cache) { _cache = cache; }
+
 protected:
 	ThemeEngine *_theme;
+	ThemeCache *_cache;
 
 	CUSTOM_XML_PARSER(ThemeParser) {
 		XML_KEY(render_info)
@@ -249,6 +254,8 @@ protected:
 	bool parseDrawStep(ParserNode *stepNode, Graphics::DrawStep *drawstep, bool functionSpecific);
 	bool parseCommonLayoutProps(ParserNode *node, const Common::String &var);
 
+	void setVar(const Common::String &name, int value);
+
 	Graphics::DrawStep *_defaultStepGlobal;
 	Graphics::DrawStep *_defaultStepLocal;
 
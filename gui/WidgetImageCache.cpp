@@ -0,0 +1,370 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "common/util.h"
+
+#include "graphics/surface.h"
+#include "graphics/VectorRenderer.h"
+
+#include "gui/WidgetImageCache.h"
+
+namespace GUI {
+
+typedef Graphics::VectorRenderer VR;
+
+WidgetImageCache::StepInfo WidgetImageCache::analyzeSteps(const Common::List<Graphics::DrawStep> &steps) {
+	StepInfo info;
+	info.flags = kCacheable | kStretchWidth | kStretchHeight;
+	info.radius = 0;
+	info.extent = 0;
+
+	// Colors which are not set by a step keep the value of the last step
+	// that set them, possibly one of another widget. Images which use
+	// such colors depend on the drawing order and can't be cached.
+	bool fgSet = false, bgSet = false, gradientSet = false, bevelSet = false;
+
+	for (Common::List<Graphics::DrawStep>::const_iterator step = steps.begin(); step != steps.end(); ++step) {
+		const Graphics::DrawingFunctionCallback call = step->drawingCall;
+		const bool box = call == &VR::drawCallback_ROUNDSQ || call == &VR::drawCallback_SQUARE || call == &VR::drawCallback_BEVELSQ;
+
+		if (call == &VR::drawCallback_VOID)
+			continue;
+
+		// Surface fills, bitmaps and tabs don't stay within the widget area
+		if (!box && call != &VR::drawCallback_TRIANGLE && call != &VR::drawCallback_LINE &&
+			call != &VR::drawCallback_CIRCLE && call != &VR::drawCallback_CROSS) {
+			info.flags = 0;
+			return info;
+		}
+
+		fgSet = fgSet || step->fgColor.set;
+		bgSet = bgSet || step->bgColor.set;
+		gradientSet = gradientSet || (step->gradColor1.set && step->gradColor2.set);
+		bevelSet = bevelSet || step->bevelColor.set;
+
+		const bool needsFg = !(box && call != &VR::drawCallback_BEVELSQ && step->fillMode == VR::kFillGradient && step->stroke == 0);
+		const bool needsBg = step->fillMode == VR::kFillBackground || call == &VR::drawCallback_BEVELSQ;
+		const bool needsGradient = step->fillMode == VR::kFillGradient;
+		const bool needsBevel = step->bevel > 0 || call == &VR::drawCallback_BEVELSQ;
+
+		if ((needsFg && !fgSet) || (needsBg && !bgSet) || (needsGradient && !gradientSet) || (needsBevel && !bevelSet)) {
+			info.flags = 0;
+			return info;
+		}
+
+		// Only boxes filling the whole widget look the same all along
+		// their edges. Gradients run from the top to the bottom.
+		if (!box || (call == &VR::drawCallback_ROUNDSQ && step->radius == 0xFF)) {
+			info.flags &= ~(kStretchWidth | kStretchHeight);
+			continue;
+		}
+		if (!step->autoWidth)
+			info.flags &= ~kStretchWidth;
+		if (!step->autoHeight || step->fillMode == VR::kFillGradient)
+			info.flags &= ~kStretchHeight;
+
+		int radius = 0;
+		if (call == &VR::drawCallback_ROUNDSQ) {
+			radius = step->radius;
+			if (step->scale != (1 << 16) && step->scale != 0)
+				radius = (radius * step->scale) >> 16;
+		}
+
+		info.radius = MAX(info.radius, radius);
+		info.extent = MAX(info.extent, radius + step->stroke + step->bevel + step->shadow + 2);
+	}
+
+	return info;
+}
+
+WidgetImageCache::WidgetImageCache(uint32 budget) : _budget(budget), _size(0), _black(0), _white(0xFFFF) {
+}
+
+WidgetImageCache::~WidgetImageCache() {
+	clear();
+}
+
+void WidgetImageCache::clear() {
+	for (EntryList::iterator i = _lru.begin(); i != _lru.end(); ++i) {
+		delete[] (*i)->black;
+		delete *i;
+	}
+
+	_lru.clear();
+	_entries.clear();
+	_size = 0;
+}
+
+void WidgetImageCache::setFormat(const Graphics::PixelFormat &format) {
+	if (format == _format)
+		return;
+
+	clear();
+	_format = format;
+	_black = _format.RGBToColor(0, 0, 0);
+	_white = _format.RGBToColor(255, 255, 255);
+}
+
+bool WidgetImageCache::draw(Graphics::VectorRenderer *renderer, int id, const Common::List<Graphics::DrawStep> &steps,
+	const StepInfo &info, const Common::Rect &area, int margin, uint32 dynamic) {
+
+	if (!(info.flags & kCacheable) || area.isEmpty())
+		return false;
+
+	Graphics::Surface *target = renderer->getSurface();
+	if (!target || target->bytesPerPixel != sizeof(uint16))
+		return false;
+
+	// The shapes are clipped against the edges of the surface they are
+	// drawn to, so only images which are away from the edges of the
+	// target look the same as in the cache.
+	Common::Rect r = area;
+	r.grow(margin);
+	if (r.left < 0 || r.top < 0 || r.right + 2 > target->w || r.bottom + 2 > target->h)
+		return false;
+
+	Key key;
+	key.id = id;
+	key.width = area.width();
+	key.height = area.height();
+	key.dynamic = dynamic;
+	key.shadows = renderer->shadowsEnabled();
+
+	// Stretchable images are rendered with a single uniform row or column
+	// in the middle. Rounded corners shrink when the widget is smaller
+	// than their diameter, which must not happen in either image.
+	const int sliceSize = info.extent * 2 + 1;
+	if ((info.flags & kStretchWidth) && key.width > sliceSize && info.radius * 2 <= area.height())
+		key.width = sliceSize;
+	if ((info.flags & kStretchHeight) && key.height > sliceSize && info.radius * 2 <= area.width())
+		key.height = sliceSize;
+
+	Entry *entry;
+	EntryMap::iterator i = _entries.find(key);
+	if (i != _entries.end()) {
+		entry = i->_value;
+		_lru.erase(entry->lru);
+		_lru.push_front(entry);
+		entry->lru = _lru.begin();
+	} else {
+		const uint32 size = (key.width + margin * 2) * (key.height + margin * 2) * 2 * sizeof(uint16);
+
+		// Leave room for a couple of images, large dialog backgrounds
+		// would otherwise evict everything else.
+		if (size > _budget / 4)
+			return false;
+
+		while (_size + size > _budget && !_lru.empty())
+			removeEntry(_lru.back());
+
+		entry = render(renderer, key, steps, margin);
+		_lru.push_front(entry);
+		entry->lru = _lru.begin();
+		_entries[key] = entry;
+		_size += entry->size;
+	}
+
+	blit(entry, target, r);
+
+	// Leave the renderer in the state drawing the steps would have left it in
+	for (Common::List<Graphics::DrawStep>::const_iterator step = steps.begin(); step != steps.end(); ++step)
+		renderer->applyStepState(*step, dynamic);
+
+	return true;
+}
+
+WidgetImageCache::Entry *WidgetImageCache::render(Graphics::VectorRenderer *renderer, const Key &key, const Common::List<Graphics::DrawStep> &steps, int margin) {
+	Entry *entry = new Entry;
+	entry->key = key;
+	entry->width = key.width + margin * 2;
+	entry->height = key.height + margin * 2;
+	entry->size = entry->width * entry->height * 2 * sizeof(uint16);
+	entry->black = new uint16[entry->width * entry->height * 2];
+	entry->white = entry->black + entry->width * entry->height;
+
+	// Two spare pixels to the right and bottom make the shapes pass the
+	// same clipping checks as on the target surface, see draw()
+	Graphics::Surface surface;
+	surface.create(entry->width + 2, entry->height + 2, sizeof(uint16));
+
+	Graphics::Surface *target = renderer->getSurface();
+	renderer->setSurface(&surface);
+
+	const Common::Rect area(margin, margin, margin + key.width, margin + key.height);
+
+	for (int pass = 0; pass < 2; ++pass) {
+		const uint16 background = pass ? _white : _black;
+		uint16 *image = pass ? entry->white : entry->black;
+
+		uint16 *dst = (uint16 *)surface.pixels;
+		for (int n = surface.w * surface.h; n > 0; --n)
+			*dst++ = background;
+
+		for (Common::List<Graphics::DrawStep>::const_iterator step = steps.begin(); step != steps.end(); ++step)
+			renderer->drawStep(area, *step, key.dynamic);
+
+		for (int y = 0; y < entry->height; ++y) {
+			memcpy(image, surface.getBasePtr(0, y), entry->width * sizeof(uint16));
+			image += entry->width;
+		}
+	}
+
+	renderer->setSurface(target);
+	surface.free();
+
+	// Split the rows into runs of opaque, translucent and untouched pixels
+	for (int y = 0; y < entry->height; ++y) {
+		const uint16 *black = entry->black + y * entry->width;
+		const uint16 *white = entry->white + y * entry->width;
+
+		entry->rowRuns.push_back(entry->runs.size());
+
+		for (int x = 0; x < entry->width; ++x) {
+			RunType type = kRunTranslucent;
+			if (black[x] == white[x])
+				type = kRunOpaque;
+			else if (black[x] == _black && white[x] == _white)
+				type = kRunTransparent;
+
+			if (x > 0 && entry->runs.back().type == type) {
+				entry->runs.back().length++;
+			} else {
+				Run run;
+				run.start = x;
+				run.length = 1;
+				run.type = type;
+				entry->runs.push_back(run);
+			}
+		}
+	}
+	entry->rowRuns.push_back(entry->runs.size());
+	entry->size += entry->runs.size() * sizeof(Run) + entry->rowRuns.size() * sizeof(uint);
+
+	return entry;
+}
+
+/**
+ * Maps a position in a stretched image to the position in the cached one.
+ * The image is split in the middle, the row or column there is repeated.
+ */
+static inline int mapSlice(int pos, int size, int cachedSize) {
+	const int middle = cachedSize / 2;
+	if (pos < middle)
+		return pos;
+	if (pos >= size - (cachedSize - middle - 1))
+		return pos - (size - cachedSize);
+	return middle;
+}
+
+/**
+ * Fills a row of pixels with one color. The filled part is doubled by
+ * each copy, which is a lot faster than storing the pixels one by one.
+ */
+static inline void fillPixels(uint16 *dst, uint16 color, int count) {
+	if (count <= 0)
+		return;
+
+	dst[0] = color;
+	int filled = 1;
+	while (filled < count) {
+		const int n = MIN(filled, count - filled);
+		memcpy(dst + filled, dst, n * sizeof(uint16));
+		filled += n;
+	}
+}
+
+uint16 WidgetImageCache::blendPixel(uint16 black, uint16 white, uint16 background) const {
+	// The pixel is black + (white - black) * background
+	uint8 br, bg, bb, wr, wg, wb, dr, dg, db;
+	_format.colorToRGB(black, br, bg, bb);
+	_format.colorToRGB(white, wr, wg, wb);
+	_format.colorToRGB(background, dr, dg, db);
+
+	return _format.RGBToColor(
+		CLIP(br + (wr - br) * dr / 255, 0, 255),
+		CLIP(bg + (wg - bg) * dg / 255, 0, 255),
+		CLIP(bb + (wb - bb) * db / 255, 0, 255));
+}
+
+void WidgetImageCache::blit(const Entry *entry, Graphics::Surface *target, const Common::Rect &r) {
+	const int width = r.width();
+	const int height = r.height();
+
+	// Stretched images repeat the middle column this many extra times
+	const int middle = entry->width / 2;
+	const int stretch = width - entry->width;
+
+	int lastRow = -1;
+	for (int y = 0; y < height; ++y) {
+		const int row = mapSlice(y, height, entry->height);
+		const uint16 *black = entry->black + row * entry->width;
+		const uint16 *white = entry->white + row * entry->width;
+		uint16 *dst = (uint16 *)target->getBasePtr(r.left, r.top + y);
+
+		// The opaque parts of a repeated row are the same as in the row above
+		const bool repeated = (row == lastRow);
+		lastRow = row;
+
+		for (uint i = entry->rowRuns[row]; i < entry->rowRuns[row + 1]; ++i) {
+			const Run &run = entry->runs[i];
+			const int start = run.start;
+			const int end = run.start + run.length;
+
+			if (run.type == kRunTransparent)
+				continue;
+
+			if (run.type == kRunTranslucent) {
+				const int dstStart = (start > middle) ? start + stretch : start;
+				const int dstEnd = (end <= middle) ? end : end + stretch;
+				for (int x = dstStart; x < dstEnd; ++x) {
+					const int src = mapSlice(x, width, entry->width);
+					dst[x] = blendPixel(black[src], white[src], dst[x]);
+				}
+			} else if (repeated) {
+				const int dstStart = (start > middle) ? start + stretch : start;
+				const int dstEnd = (end <= middle) ? end : end + stretch;
+				memcpy(dst + dstStart, dst + dstStart - target->pitch / sizeof(uint16), (dstEnd - dstStart) * sizeof(uint16));
+			} else if (end <= middle || start > middle || stretch == 0) {
+				const int dstStart = (start > middle) ? start + stretch : start;
+				memcpy(dst + dstStart, black + start, run.length * sizeof(uint16));
+			} else {
+				memcpy(dst + start, black + start, (middle - start) * sizeof(uint16));
+				fillPixels(dst + middle, black[middle], stretch + 1);
+				memcpy(dst + middle + stretch + 1, black + middle + 1, (end - middle - 1) * sizeof(uint16));
+			}
+		}
+	}
+}
+
+void WidgetImageCache::removeEntry(Entry *entry) {
+	_entries.erase(entry->key);
+	_lru.erase(entry->lru);
+	_size -= entry->size;
+
+	delete[] entry->black;
+	delete entry;
+}
+
+} // End of namespace GUI
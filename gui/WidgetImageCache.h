@@ -0,0 +1,173 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef GUI_WIDGETIMAGECACHE_H
+#define GUI_WIDGETIMAGECACHE_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/rect.h"
+
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+	struct DrawStep;
+	struct Surface;
+	class VectorRenderer;
+}
+
+namespace GUI {
+
+/**
+ * Cache of rasterized DrawData images.
+ *
+ * Every image is rendered twice, once over black and once over white.
+ * Per pixel, the two results give the color the steps add and how much
+ * of the background shows through, so the image can later be blended
+ * over any background. Opaque pixels are reproduced exactly.
+ *
+ * Widgets made only of stretchable shapes are rendered once at a small
+ * size. Larger sizes are then composed nine-slice style, with the
+ * corners copied and the middle row and column repeated.
+ *
+ * The least recently used images are evicted once the total size of
+ * the cached images exceeds the byte budget.
+ */
+class WidgetImageCache {
+public:
+	enum {
+		kCacheable    = 1 << 0, ///< The image only depends on the steps, the size and the dynamic data
+		kStretchWidth = 1 << 1, ///< The steps can be stretched horizontally
+		kStretchHeight = 1 << 2 ///< The steps can be stretched vertically
+	};
+
+	/** Properties of the steps of a DrawData item, see analyzeSteps(). */
+	struct StepInfo {
+		uint32 flags;
+		int radius; ///< Largest corner radius of the shapes
+		int extent; ///< Distance from the edges beyond which stretchable shapes are uniform
+	};
+
+	/**
+	 * Determines whether the images of a list of steps can be cached and
+	 * stretched. This is done once for each DrawData item after loading
+	 * a theme.
+	 */
+	static StepInfo analyzeSteps(const Common::List<Graphics::DrawStep> &steps);
+
+	WidgetImageCache(uint32 budget);
+	~WidgetImageCache();
+
+	/** Drops all images, e.g. after the theme or the overlay format changed. */
+	void clear();
+
+	void setFormat(const Graphics::PixelFormat &format);
+
+	/**
+	 * Draws a DrawData item to the active surface of the renderer, from
+	 * the cache if possible. The renderer is left in the same state as
+	 * drawing the steps directly would have left it in.
+	 *
+	 * @param renderer Renderer to draw with.
+	 * @param id       Id of the DrawData item.
+	 * @param steps    Draw steps of the item.
+	 * @param info     Result of analyzeSteps() for the steps.
+	 * @param area     Area of the widget.
+	 * @param margin   Space around the area that the steps may draw to.
+	 * @param dynamic  Dynamic data passed to the steps.
+	 * @return false if the image can't be cached. The caller has to draw
+	 *         the steps itself then.
+	 */
+	bool draw(Graphics::VectorRenderer *renderer, int id, const Common::List<Graphics::DrawStep> &steps,
+		const StepInfo &info, const Common::Rect &area, int margin, uint32 dynamic);
+
+	/** Returns the number of bytes used by the cached images. */
+	uint32 getSize() const { return _size; }
+
+private:
+	struct Key {
+		int id;
+		int16 width, height;
+		uint32 dynamic;
+		bool shadows;
+
+		bool operator==(const Key &other) const {
+			return id == other.id && width == other.width && height == other.height
+				&& dynamic == other.dynamic && shadows == other.shadows;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return (key.id * 31 + key.width) * 1021 + key.height * 7 + key.dynamic * 131 + (key.shadows ? 1 : 0);
+		}
+	};
+
+	struct Entry;
+	typedef Common::List<Entry *> EntryList;
+	typedef Common::HashMap<Key, Entry *, KeyHash> EntryMap;
+
+	enum RunType {
+		kRunTransparent,
+		kRunOpaque,
+		kRunTranslucent
+	};
+
+	/** Pixels of an image row that are drawn the same way. */
+	struct Run {
+		uint16 start, length;
+		RunType type;
+	};
+
+	struct Entry {
+		Key key;
+		int width, height; ///< Size of the image, including the margin
+		uint16 *black;     ///< The image rendered over black
+		uint16 *white;     ///< The image rendered over white
+		Common::Array<Run> runs;
+		Common::Array<uint> rowRuns; ///< Index of the first run of each row, and the end
+		uint32 size;       ///< Size of the image data in bytes
+		EntryList::iterator lru;
+	};
+
+	Entry *render(Graphics::VectorRenderer *renderer, const Key &key, const Common::List<Graphics::DrawStep> &steps, int margin);
+	void blit(const Entry *entry, Graphics::Surface *target, const Common::Rect &r);
+	uint16 blendPixel(uint16 black, uint16 white, uint16 background) const;
+	void removeEntry(Entry *entry);
+
+	uint32 _budget;
+	uint32 _size;
+	Graphics::PixelFormat _format;
+	uint16 _black, _white;
+
+	EntryMap _entries;
+	EntryList _lru; ///< Cached images, most recently used first
+};
+
+} // End of namespace GUI
+
+#endif
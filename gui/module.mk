@@ -15,12 +15,14 @@ MODULE_OBJS := \
 	options.o \
 	saveload.o \
 	themebrowser.o \
+	ThemeCache.o \
 	ThemeEngine.o \
 	ThemeEval.o \
 	ThemeLayout.o \
 	ThemeParser.o \
 	Tooltip.o \
 	widget.o \
+	WidgetImageCache.o \
 	widgets/editable.o \
 	widgets/edittext.o \
 	widgets/list.o \
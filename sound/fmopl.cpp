@@ -48,7 +48,7 @@ OPL::OPL() {
 
 const Config::EmulatorDescription Config::_drivers[] = {
 	{ "auto", "<default>", kAuto, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
-	{ "mame", _s("MAME OPL emulator"), kMame, kFlagOpl2 },
+	{ "mame", _s("MAME OPL emulator"), kMame, kFlagOpl2 | kFlagDualOpl2 },
 #ifndef DISABLE_DOSBOX_OPL
 	{ "db", _s("DOSBox OPL emulator"), kDOSBox, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
 #endif
@@ -96,16 +96,24 @@ Config::DriverId Config::detect(OplType type) {
 		}
 	}
 
-	// Detect the first matching emulator
+	// Detect the first matching emulator. The MAME emulator is only
+	// a fallback for dual OPL2, since it has no real stereo chip.
 	drv = -1;
 
 	for (int i = 1; _drivers[i].name; ++i) {
-		if (_drivers[i].flags & flags) {
+		if ((_drivers[i].flags & flags) && (_drivers[i].id != kMame || type == kOpl2)) {
 			drv = _drivers[i].id;
 			break;
 		}
 	}
 
+	if (drv == -1) {
+		for (int i = 1; _drivers[i].name; ++i) {
+			if (_drivers[i].id == kMame && (_drivers[i].flags & flags))
+				drv = kMame;
+		}
+	}
+
 	return drv;
 }
 
@@ -135,11 +143,11 @@ OPL *Config::create(DriverId driver, OplType type) {
 
 	switch (driver) {
 	case kMame:
-		if (type == kOpl2)
-			return new MAME::OPL();
-		else
-			warning("MAME OPL emulator only supports OPL2 emulation");
-			return 0;
+		if (type != kOpl3)
+			return new MAME::OPL(type);
+
+		warning("MAME OPL emulator only supports OPL2 and dual OPL2 emulation");
+		return 0;
 
 #ifndef DISABLE_DOSBOX_OPL
 	case kDOSBox:
@@ -0,0 +1,288 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ */
+
+#include "sound/softsynth/emumidi.h"
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+MidiDriver_Emulated::MidiDriver_Emulated(Audio::Mixer *mixer) : _mixer(mixer) {
+	_isOpen = false;
+
+	_timerProc = 0;
+	_timerParam = 0;
+
+	_nextTick = 0;
+	_samplesPerTick = 0;
+
+	_ringBuffer = 0;
+	_ringSize = 0;
+	_ringStart = 0;
+	_ringFill = 0;
+	_playedSamples = 0;
+	_renderedSamples = 0;
+	_underruns = 0;
+	_renderAheadStep = 0;
+
+	_baseFreq = 250;
+}
+
+MidiDriver_Emulated::~MidiDriver_Emulated() {
+	// Subclasses have to stop rendering ahead while their synthesizer still exists
+	assert(!_ringBuffer);
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+
+	if (_ringBuffer)
+		playFromRing(data, len);
+	else
+		synthesize(data, len);
+
+	return numSamples;
+}
+
+void MidiDriver_Emulated::synthesize(int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int step;
+
+	while (len > 0) {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		generateSamples(data, step);
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+			onTimer();
+			_nextTick += _samplesPerTick;
+		}
+		data += step * stereoFactor;
+		len -= step;
+	}
+}
+
+void MidiDriver_Emulated::playFromRing(int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int step;
+
+	while (len > 0) {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		int copied = copyFromRing(data, step);
+
+		// The timer callback follows the samples actually played
+		_nextTick -= copied << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+			onTimer();
+			_nextTick += _samplesPerTick;
+		}
+		data += copied * stereoFactor;
+		len -= copied;
+
+		if (copied < step) {
+			// The timer thread fell behind. Do not wait for it, play silence
+			// instead and let the music wait as well.
+			memset(data, 0, len * stereoFactor * sizeof(int16));
+			_underruns++;
+			break;
+		}
+	}
+}
+
+uint32 MidiDriver_Emulated::copyFromRing(int16 *data, uint32 len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	// The lock is only ever held for updating the positions and the event
+	// queue, never while rendering
+	Common::StackLock lock(_queueMutex);
+
+	len = MIN(len, _ringFill);
+	uint32 copied = 0;
+	while (copied < len) {
+		uint32 chunk = MIN(len - copied, _ringSize - _ringStart);
+		memcpy(data + copied * stereoFactor, _ringBuffer + _ringStart * stereoFactor, chunk * stereoFactor * sizeof(int16));
+		copied += chunk;
+		_ringStart = (_ringStart + chunk) % _ringSize;
+	}
+	_ringFill -= len;
+	_playedSamples += len;
+
+	return len;
+}
+
+void MidiDriver_Emulated::sendEvent(uint32 b) {
+	if (!_ringBuffer) {
+		processEvent(b);
+		return;
+	}
+
+	QueuedEvent event;
+	event.b = b;
+	event.sysEx = 0;
+	event.length = 0;
+	queueEvent(event);
+}
+
+void MidiDriver_Emulated::sendSysExEvent(const byte *msg, uint16 length) {
+	if (!_ringBuffer) {
+		processSysEx(msg, length);
+		return;
+	}
+
+	QueuedEvent event;
+	event.b = 0;
+	event.sysEx = new byte[length];
+	event.length = length;
+	memcpy(event.sysEx, msg, length);
+	queueEvent(event);
+}
+
+void MidiDriver_Emulated::queueEvent(QueuedEvent &event) {
+	Common::StackLock lock(_queueMutex);
+
+	// Delaying all events by the length of the ring keeps their distances.
+	// The timer thread can't have rendered that far yet.
+	event.position = _playedSamples + _ringSize;
+	_events.push(event);
+}
+
+void MidiDriver_Emulated::dispatchEvents(bool all) {
+	// Handle the events without holding the lock, so that the threads
+	// sending them do not have to wait for the synthesizer
+	for (;;) {
+		QueuedEvent event;
+		{
+			Common::StackLock lock(_queueMutex);
+			if (_events.empty())
+				return;
+			if (!all && (int32)(_events.front().position - _renderedSamples) > 0)
+				return;
+			event = _events.pop();
+		}
+
+		if (event.sysEx) {
+			processSysEx(event.sysEx, event.length);
+			delete[] event.sysEx;
+		} else {
+			processEvent(event.b);
+		}
+	}
+}
+
+void MidiDriver_Emulated::startRenderAhead(uint32 millis) {
+	if (_ringBuffer || !millis)
+		return;
+
+	const int stereoFactor = isStereo() ? 2 : 1;
+	_ringSize = MAX<uint32>(getRate() * millis / 1000, 1);
+	_ringBuffer = new int16[_ringSize * stereoFactor];
+	_ringStart = 0;
+	_ringFill = 0;
+	_playedSamples = 0;
+	_renderedSamples = 0;
+	_underruns = 0;
+
+	// Each call renders at most an eighth of the ring, so that the other
+	// timer procs never wait for long. Calling it every sixteenth of the
+	// buffer length renders up to twice as fast as the audio is played.
+	_renderAheadStep = MAX<uint32>(_ringSize / 8, 1);
+
+	// Nothing reads from the ring yet, so fill it right away
+	while (renderAhead())
+		;
+
+	g_system->getTimerManager()->installTimerProc(&renderAheadProc, MAX<uint32>(millis * 1000 / 16, 1000), this);
+}
+
+void MidiDriver_Emulated::stopRenderAhead() {
+	if (!_ringBuffer)
+		return;
+
+	// This also guarantees that renderAheadProc is not running anymore
+	g_system->getTimerManager()->removeTimerProc(&renderAheadProc, this);
+
+	dispatchEvents(true);
+
+	if (_underruns)
+		debug(1, "MidiDriver_Emulated: Rendering ahead fell behind the mixer %d times", _underruns);
+
+	delete[] _ringBuffer;
+	_ringBuffer = 0;
+	_ringSize = 0;
+	_ringStart = 0;
+	_ringFill = 0;
+}
+
+void MidiDriver_Emulated::renderAheadProc(void *refCon) {
+	((MidiDriver_Emulated *)refCon)->renderAhead();
+}
+
+bool MidiDriver_Emulated::renderAhead() {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	uint32 start, len;
+	{
+		Common::StackLock lock(_queueMutex);
+		start = (_ringStart + _ringFill) % _ringSize;
+		len = MIN(_ringSize - _ringFill, _ringSize - start);
+	}
+	len = MIN(len, _renderAheadStep);
+
+	if (!len)
+		return false;
+
+	// The mixer thread only reads the filled part of the ring
+	int16 *data = _ringBuffer + start * stereoFactor;
+	uint32 rendered = 0;
+	while (rendered < len) {
+		dispatchEvents(false);
+
+		// Stop at the next queued event
+		uint32 step = len - rendered;
+		{
+			Common::StackLock lock(_queueMutex);
+			if (!_events.empty())
+				step = MIN(step, _events.front().position - _renderedSamples);
+		}
+
+		generateSamples(data + rendered * stereoFactor, step);
+		_renderedSamples += step;
+		rendered += step;
+	}
+
+	Common::StackLock lock(_queueMutex);
+	_ringFill += len;
+	return true;
+}
@@ -25,6 +25,9 @@
 #ifndef SOUND_SOFTSYNTH_EMUMIDI_H
 #define SOUND_SOFTSYNTH_EMUMIDI_H
 
+#include "common/mutex.h"
+#include "common/queue.h"
+
 #include "sound/audiostream.h"
 #include "sound/mididrv.h"
 #include "sound/mixer.h"
@@ -44,24 +47,85 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	/** A MIDI event waiting for the rendering thread */
+	struct QueuedEvent {
+		uint32 b;
+		byte *sysEx;	///< 0 for short messages
+		uint16 length;
+		uint32 position;	///< Sample at which to handle the event
+	};
+
+	// Rendering ahead
+	int16 *_ringBuffer;	///< 0 unless rendering ahead
+	uint32 _ringSize;	///< in sample frames
+	uint32 _ringStart;
+	uint32 _ringFill;
+	uint32 _playedSamples;	///< Samples taken from the ring by the mixer
+	uint32 _renderedSamples;	///< Samples put into the ring by the timer thread
+	uint32 _underruns;
+	uint32 _renderAheadStep;	///< Most sample frames rendered per timer call
+	Common::Queue<QueuedEvent> _events;
+	/** Guards the ring buffer positions and the event queue */
+	Common::Mutex _queueMutex;
+
+	void synthesize(int16 *data, int len);
+	void playFromRing(int16 *data, int len);
+	uint32 copyFromRing(int16 *data, uint32 len);
+	void queueEvent(QueuedEvent &event);
+	void dispatchEvents(bool all);
+	bool renderAhead();
+	static void renderAheadProc(void *refCon);
+
 protected:
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Makes the driver render ahead on the timer thread, into a ring buffer
+	 * holding the given amount of time, so that the mixer thread only has to
+	 * copy the audio. Each timer call renders at most an eighth of the ring,
+	 * so that other timer procs are not held up for long. The mixer thread never waits for the timer thread: if
+	 * the ring runs dry, the missing part is played as silence and counted
+	 * in getUnderruns().
+	 *
+	 * The timer callback and onTimer() still run on the mixer thread, in step
+	 * with the samples it takes from the ring. The synthesizer however is
+	 * accessed by the timer thread, so drivers using this have to pass all
+	 * their MIDI events through sendEvent() and sendSysExEvent() and handle
+	 * them in processEvent() and processSysEx(). Events are delayed by the
+	 * length of the ring buffer, so events sent from the timer callback keep
+	 * their exact distance in samples, just like when rendering in the mixer
+	 * thread.
+	 *
+	 * Must be called after open(), while the mixer is not reading from the
+	 * driver yet.
+	 */
+	void startRenderAhead(uint32 millis);
+
+	/**
+	 * Stops rendering ahead, handling the events still queued. Must be called
+	 * before the synthesizer is destroyed and while the mixer is not reading
+	 * from the driver anymore.
+	 */
+	void stopRenderAhead();
+
+	/**
+	 * Passes a MIDI event to processEvent(), right away or, when rendering
+	 * ahead, once the rendering thread has reached its sample.
+	 */
+	void sendEvent(uint32 b);
+	void sendSysExEvent(const byte *msg, uint16 length);
+
+	/** Handles an event passed to sendEvent() */
+	virtual void processEvent(uint32 b) {}
+	/** Handles a SysEx message passed to sendSysExEvent() */
+	virtual void processSysEx(const byte *msg, uint16 length) {}
+
 	int _baseFreq;
 
 public:
-	MidiDriver_Emulated(Audio::Mixer *mixer) : _mixer(mixer) {
-		_isOpen = false;
-
-		_timerProc = 0;
-		_timerParam = 0;
-
-		_nextTick = 0;
-		_samplesPerTick = 0;
-
-		_baseFreq = 250;
-	}
+	MidiDriver_Emulated(Audio::Mixer *mixer);
+	virtual ~MidiDriver_Emulated();
 
 	int open() {
 		_isOpen = true;
@@ -83,33 +147,15 @@ public:
 
 	uint32 getBaseTempo() { return 1000000 / _baseFreq; }
 
+	/**
+	 * Returns how often the mixer found the ring buffer empty while
+	 * rendering ahead.
+	 */
+	uint32 getUnderruns() const { return _underruns; }
+
 
 	// AudioStream API
-	int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-				onTimer();
-				_nextTick += _samplesPerTick;
-			}
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	int readBuffer(int16 *data, const int numSamples);
 	bool endOfData() const { return false; }
 };
 
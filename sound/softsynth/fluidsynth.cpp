@@ -49,6 +49,7 @@ protected:
 	void setStr(const char *name, const char *str);
 
 	void generateSamples(int16 *buf, int len);
+	void processEvent(uint32 b);
 
 public:
 	MidiDriver_FluidSynth(Audio::Mixer *mixer);
@@ -143,6 +144,9 @@ int MidiDriver_FluidSynth::open() {
 
 	MidiDriver_Emulated::open();
 
+	if (ConfMan.hasKey("midi_render_ahead"))
+		startRenderAhead(ConfMan.getInt("midi_render_ahead"));
+
 	// The MT-32 emulator uses kSFXSoundType here. I don't know why.
 	_mixer->playStream(Audio::Mixer::kMusicSoundType, &_handle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 	return 0;
@@ -154,6 +158,7 @@ void MidiDriver_FluidSynth::close() {
 	_isOpen = false;
 
 	_mixer->stopHandle(_handle);
+	stopRenderAhead();
 
 	if (_soundFont != -1)
 		fluid_synth_sfunload(_synth, _soundFont, 1);
@@ -163,6 +168,10 @@ void MidiDriver_FluidSynth::close() {
 }
 
 void MidiDriver_FluidSynth::send(uint32 b) {
+	sendEvent(b);
+}
+
+void MidiDriver_FluidSynth::processEvent(uint32 b) {
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	uint param2 = (byte) ((b >> 16) & 0xFF);
 	uint param1 = (byte) ((b >>  8) & 0xFF);
@@ -3,6 +3,7 @@ MODULE := sound/softsynth/mt32
 MODULE_OBJS := \
 	mt32_file.o \
 	i386.o \
+	simd.o \
 	part.o \
 	partial.o \
 	partialManager.o \
@@ -50,7 +50,22 @@
 #endif
 #endif
 
-#ifdef MT32EMU_HAVE_X86
+// SSE2 is part of the x86-64 baseline and NEON of AArch64, so these only
+// depend on the compiler target and need no run-time detection.
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define MT32EMU_HAVE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MT32EMU_HAVE_NEON
+#endif
+
+#if defined(MT32EMU_HAVE_SSE2) || defined(MT32EMU_HAVE_NEON)
+#define MT32EMU_USE_SIMD 1
+#else
+#define MT32EMU_USE_SIMD 0
+#endif
+
+// The MMX routines are only used where the SIMD ones are unavailable
+#if defined(MT32EMU_HAVE_X86) && MT32EMU_USE_SIMD == 0
 #define MT32EMU_USE_MMX 1
 #else
 #define MT32EMU_USE_MMX 0
@@ -60,6 +75,7 @@
 
 #include "structures.h"
 #include "i386.h"
+#include "simd.h"
 #include "mt32_file.h"
 #include "tables.h"
 #include "partial.h"
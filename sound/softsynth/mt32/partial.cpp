@@ -462,7 +462,12 @@ Bit16s *Partial::mixBuffers(Bit16s * buf1, Bit16s *buf2, int len) {
 		return buf1;
 
 	Bit16s *outBuf = buf1;
-#if MT32EMU_USE_MMX >= 1
+#if MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffers(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
+#elif MT32EMU_USE_MMX >= 1
 	// KG: This seems to be fine
 	int donelen = i386_mixBuffers(buf1, buf2, len);
 	len -= donelen;
@@ -481,6 +486,11 @@ Bit16s *Partial::mixBuffersRingMix(Bit16s * buf1, Bit16s *buf2, int len) {
 		return NULL;
 	if (buf2 == NULL) {
 		Bit16s *outBuf = buf1;
+#if MT32EMU_USE_SIMD > 0
+		int donelen = simd_clampBuffer(buf1, len);
+		len -= donelen;
+		buf1 += donelen;
+#endif
 		while (len--) {
 			if (*buf1 < -8192)
 				*buf1 = -8192;
@@ -492,7 +502,12 @@ Bit16s *Partial::mixBuffersRingMix(Bit16s * buf1, Bit16s *buf2, int len) {
 	}
 
 	Bit16s *outBuf = buf1;
-#if MT32EMU_USE_MMX >= 1
+#if MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffersRingMix(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
+#elif MT32EMU_USE_MMX >= 1
 	// KG: This seems to be fine
 	int donelen = i386_mixBuffersRingMix(buf1, buf2, len);
 	len -= donelen;
@@ -525,7 +540,12 @@ Bit16s *Partial::mixBuffersRing(Bit16s * buf1, Bit16s *buf2, int len) {
 	}
 
 	Bit16s *outBuf = buf1;
-#if MT32EMU_USE_MMX >= 1
+#if MT32EMU_USE_SIMD > 0
+	int donelen = simd_mixBuffersRing(buf1, buf2, len);
+	len -= donelen;
+	buf1 += donelen;
+	buf2 += donelen;
+#elif MT32EMU_USE_MMX >= 1
 	// FIXME:KG: Not really checked as working
 	int donelen = i386_mixBuffersRing(buf1, buf2, len);
 	len -= donelen;
@@ -639,7 +659,12 @@ bool Partial::produceOutput(Bit16s *partialBuf, long length) {
 	leftvol = patchCache->pansetptr->leftvol;
 	rightvol = patchCache->pansetptr->rightvol;
 
-#if MT32EMU_USE_MMX >= 2
+#if MT32EMU_USE_SIMD > 0
+	int donelen = simd_partialProductOutput(length, leftvol, rightvol, partialBuf, mixedBuf);
+	length -= donelen;
+	mixedBuf += donelen;
+	partialBuf += donelen * 2;
+#elif MT32EMU_USE_MMX >= 2
 	// FIXME:KG: This appears to introduce crackle
 	int donelen = i386_partialProductOutput(length, leftvol, rightvol, partialBuf, mixedBuf);
 	length -= donelen;
@@ -0,0 +1,277 @@
+/* Copyright (c) 2003-2005 Various contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mt32emu.h"
+
+#if MT32EMU_USE_SIMD > 0
+
+#if defined(MT32EMU_HAVE_SSE2)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+namespace MT32Emu {
+
+#if defined(MT32EMU_HAVE_SSE2)
+
+// Sign extends eight samples to two vectors of floats
+static inline void loadSamples(const Bit16s *src, __m128 &lo, __m128 &hi) {
+	__m128i v = _mm_loadu_si128((const __m128i *)src);
+	lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+	hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+// Truncates eight floats to samples, wrapping around like a (Bit16s) cast does
+static inline __m128i truncateSamples(__m128 lo, __m128 hi) {
+	__m128i l = _mm_cvttps_epi32(lo);
+	__m128i h = _mm_cvttps_epi32(hi);
+	l = _mm_srai_epi32(_mm_slli_epi32(l, 16), 16);
+	h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+	return _mm_packs_epi32(l, h);
+}
+
+// Computes (Bit16s)((a * b) >> 15) for eight samples
+static inline __m128i mulShift15(__m128i a, __m128i b) {
+	__m128i lo = _mm_mullo_epi16(a, b);
+	__m128i hi = _mm_mulhi_epi16(a, b);
+	return _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+}
+
+#else
+
+static inline void loadSamples(const Bit16s *src, float32x4_t &lo, float32x4_t &hi) {
+	int16x8_t v = vld1q_s16(src);
+	lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+	hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+
+static inline int16x8_t truncateSamples(float32x4_t lo, float32x4_t hi) {
+	return vcombine_s16(vmovn_s32(vcvtq_s32_f32(lo)), vmovn_s32(vcvtq_s32_f32(hi)));
+}
+
+static inline int16x8_t mulShift15(int16x8_t a, int16x4_t b) {
+	int16x4_t lo = vshrn_n_s32(vmull_s16(vget_low_s16(a), b), 15);
+	int16x4_t hi = vshrn_n_s32(vmull_s16(vget_high_s16(a), b), 15);
+	return vcombine_s16(lo, hi);
+}
+
+#endif
+
+int simd_partialProductOutput(int len, Bit16s leftvol, Bit16s rightvol, Bit16s *partialBuf, Bit16s *mixedBuf) {
+	int donelen = len & ~7;
+#if defined(MT32EMU_HAVE_SSE2)
+	__m128i left = _mm_set1_epi16(leftvol);
+	__m128i right = _mm_set1_epi16(rightvol);
+	for (int i = 0; i < donelen; i += 8) {
+		__m128i m = _mm_loadu_si128((const __m128i *)(mixedBuf + i));
+		__m128i l = mulShift15(m, left);
+		__m128i r = mulShift15(m, right);
+		_mm_storeu_si128((__m128i *)(partialBuf + i * 2), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i *)(partialBuf + i * 2 + 8), _mm_unpackhi_epi16(l, r));
+	}
+#else
+	int16x4_t left = vdup_n_s16(leftvol);
+	int16x4_t right = vdup_n_s16(rightvol);
+	for (int i = 0; i < donelen; i += 8) {
+		int16x8_t m = vld1q_s16(mixedBuf + i);
+		int16x8x2_t out;
+		out.val[0] = mulShift15(m, left);
+		out.val[1] = mulShift15(m, right);
+		vst2q_s16(partialBuf + i * 2, out);
+	}
+#endif
+	return donelen;
+}
+
+int simd_mixBuffers(Bit16s *buf1, Bit16s *buf2, int len) {
+	int donelen = len & ~7;
+	for (int i = 0; i < donelen; i += 8) {
+#if defined(MT32EMU_HAVE_SSE2)
+		__m128i a = _mm_loadu_si128((const __m128i *)(buf1 + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(buf2 + i));
+		_mm_storeu_si128((__m128i *)(buf1 + i), _mm_add_epi16(a, b));
+#else
+		vst1q_s16(buf1 + i, vaddq_s16(vld1q_s16(buf1 + i), vld1q_s16(buf2 + i)));
+#endif
+	}
+	return donelen;
+}
+
+int simd_mixBuffersRingMix(Bit16s *buf1, Bit16s *buf2, int len) {
+	int donelen = len & ~7;
+#if defined(MT32EMU_HAVE_SSE2)
+	const __m128 scale = _mm_set1_ps(8192.0f);
+	const __m128 invScale = _mm_set1_ps(1.0f / 8192.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		__m128 a0, a1, b0, b1;
+		loadSamples(buf1 + i, a0, a1);
+		loadSamples(buf2 + i, b0, b1);
+		a0 = _mm_mul_ps(a0, invScale);
+		a1 = _mm_mul_ps(a1, invScale);
+		a0 = _mm_add_ps(_mm_mul_ps(a0, _mm_mul_ps(b0, invScale)), a0);
+		a1 = _mm_add_ps(_mm_mul_ps(a1, _mm_mul_ps(b1, invScale)), a1);
+		a0 = _mm_max_ps(_mm_min_ps(a0, one), minusOne);
+		a1 = _mm_max_ps(_mm_min_ps(a1, one), minusOne);
+		_mm_storeu_si128((__m128i *)(buf1 + i), truncateSamples(_mm_mul_ps(a0, scale), _mm_mul_ps(a1, scale)));
+	}
+#else
+	const float32x4_t scale = vdupq_n_f32(8192.0f);
+	const float32x4_t invScale = vdupq_n_f32(1.0f / 8192.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		float32x4_t a0, a1, b0, b1;
+		loadSamples(buf1 + i, a0, a1);
+		loadSamples(buf2 + i, b0, b1);
+		a0 = vmulq_f32(a0, invScale);
+		a1 = vmulq_f32(a1, invScale);
+		a0 = vaddq_f32(vmulq_f32(a0, vmulq_f32(b0, invScale)), a0);
+		a1 = vaddq_f32(vmulq_f32(a1, vmulq_f32(b1, invScale)), a1);
+		a0 = vmaxq_f32(vminq_f32(a0, one), minusOne);
+		a1 = vmaxq_f32(vminq_f32(a1, one), minusOne);
+		vst1q_s16(buf1 + i, truncateSamples(vmulq_f32(a0, scale), vmulq_f32(a1, scale)));
+	}
+#endif
+	return donelen;
+}
+
+int simd_mixBuffersRing(Bit16s *buf1, Bit16s *buf2, int len) {
+	int donelen = len & ~7;
+#if defined(MT32EMU_HAVE_SSE2)
+	const __m128 scale = _mm_set1_ps(8192.0f);
+	const __m128 invScale = _mm_set1_ps(1.0f / 8192.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		__m128 a0, a1, b0, b1;
+		loadSamples(buf1 + i, a0, a1);
+		loadSamples(buf2 + i, b0, b1);
+		a0 = _mm_mul_ps(_mm_mul_ps(a0, invScale), _mm_mul_ps(b0, invScale));
+		a1 = _mm_mul_ps(_mm_mul_ps(a1, invScale), _mm_mul_ps(b1, invScale));
+		a0 = _mm_max_ps(_mm_min_ps(a0, one), minusOne);
+		a1 = _mm_max_ps(_mm_min_ps(a1, one), minusOne);
+		_mm_storeu_si128((__m128i *)(buf1 + i), truncateSamples(_mm_mul_ps(a0, scale), _mm_mul_ps(a1, scale)));
+	}
+#else
+	const float32x4_t scale = vdupq_n_f32(8192.0f);
+	const float32x4_t invScale = vdupq_n_f32(1.0f / 8192.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		float32x4_t a0, a1, b0, b1;
+		loadSamples(buf1 + i, a0, a1);
+		loadSamples(buf2 + i, b0, b1);
+		a0 = vmulq_f32(vmulq_f32(a0, invScale), vmulq_f32(b0, invScale));
+		a1 = vmulq_f32(vmulq_f32(a1, invScale), vmulq_f32(b1, invScale));
+		a0 = vmaxq_f32(vminq_f32(a0, one), minusOne);
+		a1 = vmaxq_f32(vminq_f32(a1, one), minusOne);
+		vst1q_s16(buf1 + i, truncateSamples(vmulq_f32(a0, scale), vmulq_f32(a1, scale)));
+	}
+#endif
+	return donelen;
+}
+
+int simd_clampBuffer(Bit16s *buf, int len) {
+	int donelen = len & ~7;
+	for (int i = 0; i < donelen; i += 8) {
+#if defined(MT32EMU_HAVE_SSE2)
+		__m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+		v = _mm_max_epi16(_mm_min_epi16(v, _mm_set1_epi16(8192)), _mm_set1_epi16(-8192));
+		_mm_storeu_si128((__m128i *)(buf + i), v);
+#else
+		int16x8_t v = vld1q_s16(buf + i);
+		vst1q_s16(buf + i, vmaxq_s16(vminq_s16(v, vdupq_n_s16(8192)), vdupq_n_s16(-8192)));
+#endif
+	}
+	return donelen;
+}
+
+int simd_produceOutput1(Bit16s *useBuf, Bit16s *stream, Bit32u len, Bit16s volume) {
+	// Four stereo frames per vector
+	int donelen = len & ~3;
+	int end = donelen * 2;
+#if defined(MT32EMU_HAVE_SSE2)
+	__m128i vol = _mm_set1_epi16(volume);
+	for (int i = 0; i < end; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(stream + i));
+		__m128i u = _mm_loadu_si128((const __m128i *)(useBuf + i));
+		_mm_storeu_si128((__m128i *)(stream + i), _mm_add_epi16(s, mulShift15(u, vol)));
+	}
+#else
+	int16x4_t vol = vdup_n_s16(volume);
+	for (int i = 0; i < end; i += 8)
+		vst1q_s16(stream + i, vaddq_s16(vld1q_s16(stream + i), mulShift15(vld1q_s16(useBuf + i), vol)));
+#endif
+	return donelen;
+}
+
+int simd_deinterleaveToFloat(const Bit16s *stream, float *left, float *right, Bit32u len) {
+	int donelen = len & ~3;
+#if defined(MT32EMU_HAVE_SSE2)
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	for (int i = 0; i < donelen; i += 4) {
+		__m128 lo, hi;
+		loadSamples(stream + i * 2, lo, hi);
+		_mm_storeu_ps(left + i, _mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), scale));
+		_mm_storeu_ps(right + i, _mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)), scale));
+	}
+#elif defined(__aarch64__)
+	const float32x4_t scale = vdupq_n_f32(32767.0f);
+	for (int i = 0; i < donelen; i += 4) {
+		int16x4x2_t v = vld2_s16(stream + i * 2);
+		vst1q_f32(left + i, vdivq_f32(vcvtq_f32_s32(vmovl_s16(v.val[0])), scale));
+		vst1q_f32(right + i, vdivq_f32(vcvtq_f32_s32(vmovl_s16(v.val[1])), scale));
+	}
+#else
+	// 32-bit NEON has no exact division
+	donelen = 0;
+#endif
+	return donelen;
+}
+
+int simd_interleaveFromFloat(const float *left, const float *right, Bit16s *stream, Bit32u len) {
+	int donelen = len & ~7;
+#if defined(MT32EMU_HAVE_SSE2)
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		__m128i l = truncateSamples(_mm_mul_ps(_mm_loadu_ps(left + i), scale), _mm_mul_ps(_mm_loadu_ps(left + i + 4), scale));
+		__m128i r = truncateSamples(_mm_mul_ps(_mm_loadu_ps(right + i), scale), _mm_mul_ps(_mm_loadu_ps(right + i + 4), scale));
+		_mm_storeu_si128((__m128i *)(stream + i * 2), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i *)(stream + i * 2 + 8), _mm_unpackhi_epi16(l, r));
+	}
+#else
+	const float32x4_t scale = vdupq_n_f32(32767.0f);
+	for (int i = 0; i < donelen; i += 8) {
+		int16x8x2_t out;
+		out.val[0] = truncateSamples(vmulq_f32(vld1q_f32(left + i), scale), vmulq_f32(vld1q_f32(left + i + 4), scale));
+		out.val[1] = truncateSamples(vmulq_f32(vld1q_f32(right + i), scale), vmulq_f32(vld1q_f32(right + i + 4), scale));
+		vst2q_s16(stream + i * 2, out);
+	}
+#endif
+	return donelen;
+}
+
+}
+
+#endif
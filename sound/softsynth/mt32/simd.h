@@ -0,0 +1,46 @@
+/* Copyright (c) 2003-2005 Various contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MT32EMU_SIMD_H
+#define MT32EMU_SIMD_H
+
+namespace MT32Emu {
+#if MT32EMU_USE_SIMD > 0
+
+// Like the i386_* routines, these process as many samples as fit into whole
+// vectors and return that count; the caller handles the remainder.
+// Unlike the MMX versions, the results match the scalar code bit for bit.
+
+int simd_partialProductOutput(int len, Bit16s leftvol, Bit16s rightvol, Bit16s *partialBuf, Bit16s *mixedBuf);
+int simd_mixBuffers(Bit16s *buf1, Bit16s *buf2, int len);
+int simd_mixBuffersRingMix(Bit16s *buf1, Bit16s *buf2, int len);
+int simd_mixBuffersRing(Bit16s *buf1, Bit16s *buf2, int len);
+int simd_clampBuffer(Bit16s *buf, int len);
+int simd_produceOutput1(Bit16s *useBuf, Bit16s *stream, Bit32u len, Bit16s volume);
+
+// Conversion between the interleaved stereo stream and the float buffers of the reverb model
+int simd_deinterleaveToFloat(const Bit16s *stream, float *left, float *right, Bit32u len);
+int simd_interleaveFromFloat(const float *left, const float *right, Bit16s *stream, Bit32u len);
+
+#endif
+}
+
+#endif
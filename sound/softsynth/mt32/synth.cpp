@@ -1105,7 +1105,12 @@ int Synth::dumpTimbres(const char *filename, int start, int len) {
 }
 
 void ProduceOutput1(Bit16s *useBuf, Bit16s *stream, Bit32u len, Bit16s volume) {
-#if MT32EMU_USE_MMX > 2
+#if MT32EMU_USE_SIMD > 0
+	int donelen = simd_produceOutput1(useBuf, stream, len, volume);
+	len -= donelen;
+	stream += donelen * 2;
+	useBuf += donelen * 2;
+#elif MT32EMU_USE_MMX > 2
 	//FIXME:KG: This appears to introduce crackle
 	int donelen = i386_produceOutput1(useBuf, stream, len, volume);
 	len -= donelen;
@@ -1142,16 +1147,23 @@ void Synth::doRender(Bit16s *stream, Bit32u len) {
 				}
 			}
 		}
-		Bit32u m = 0;
-		for (unsigned int i = 0; i < len; i++) {
+		Bit32u done = 0;
+#if MT32EMU_USE_SIMD > 0
+		done = simd_deinterleaveToFloat(stream, sndbufl, sndbufr, len);
+#endif
+		Bit32u m = done * 2;
+		for (unsigned int i = done; i < len; i++) {
 			sndbufl[i] = (float)stream[m] / 32767.0f;
 			m++;
 			sndbufr[i] = (float)stream[m] / 32767.0f;
 			m++;
 		}
 		reverbModel->processreplace(sndbufl, sndbufr, outbufl, outbufr, len, 1);
-		m=0;
-		for (unsigned int i = 0; i < len; i++) {
+#if MT32EMU_USE_SIMD > 0
+		done = simd_interleaveFromFloat(outbufl, outbufr, stream, len);
+#endif
+		m = done * 2;
+		for (unsigned int i = done; i < len; i++) {
 			stream[m] = (Bit16s)(outbufl[i] * 32767.0f);
 			m++;
 			stream[m] = (Bit16s)(outbufr[i] * 32767.0f);
@@ -44,37 +44,89 @@
 namespace OPL {
 namespace MAME {
 
+OPL::OPL(Config::OplType type) : _type(type) {
+	_opl[0] = _opl[1] = 0;
+}
+
 OPL::~OPL() {
-	MAME::OPLDestroy(_opl);
-	_opl = 0;
+	free();
+}
+
+void OPL::free() {
+	for (int i = 0; i < 2; ++i) {
+		if (_opl[i])
+			MAME::OPLDestroy(_opl[i]);
+		_opl[i] = 0;
+	}
 }
 
 bool OPL::init(int rate) {
-	if (_opl)
-		MAME::OPLDestroy(_opl);
+	free();
+
+	_opl[0] = MAME::makeAdLibOPL(rate);
+	if (_opl[0] && _type == Config::kDualOpl2)
+		_opl[1] = MAME::makeAdLibOPL(rate);
 
-	_opl = MAME::makeAdLibOPL(rate);
-	return (_opl != 0);
+	return _opl[0] != 0 && (_type != Config::kDualOpl2 || _opl[1] != 0);
 }
 
 void OPL::reset() {
-	MAME::OPLResetChip(_opl);
+	for (int i = 0; i < 2; ++i) {
+		if (_opl[i])
+			MAME::OPLResetChip(_opl[i]);
+	}
 }
 
 void OPL::write(int a, int v) {
-	MAME::OPLWrite(_opl, a, v);
+	if (_type != Config::kDualOpl2) {
+		MAME::OPLWrite(_opl[0], a, v);
+	} else if (!(a & 0x8)) {
+		// Not a 0x??8 port, then write to a specific chip
+		MAME::OPLWrite(_opl[(a & 2) >> 1], a, v);
+	} else {
+		// Write to both chips
+		MAME::OPLWrite(_opl[0], a, v);
+		MAME::OPLWrite(_opl[1], a, v);
+	}
 }
 
 byte OPL::read(int a) {
-	return MAME::OPLRead(_opl, a);
+	if (_type != Config::kDualOpl2)
+		return MAME::OPLRead(_opl[0], a);
+
+	// Only return for the lower ports
+	if (a & 1)
+		return 0xff;
+	return MAME::OPLRead(_opl[(a >> 1) & 1], a);
 }
 
 void OPL::writeReg(int r, int v) {
-	MAME::OPLWriteReg(_opl, r, v);
+	MAME::OPLWriteReg(_opl[0], r, v);
+	if (_opl[1])
+		MAME::OPLWriteReg(_opl[1], r, v);
 }
 
 void OPL::readBuffer(int16 *buffer, int length) {
-	MAME::YM3812UpdateOne(_opl, buffer, length);
+	if (_type != Config::kDualOpl2) {
+		MAME::YM3812UpdateOne(_opl[0], buffer, length);
+		return;
+	}
+
+	// Render the left and the right chip separately and interleave them
+	int16 tempBuffer[512];
+	length >>= 1;
+	while (length > 0) {
+		const int readSamples = MIN<int>(length, ARRAYSIZE(tempBuffer));
+
+		for (int chip = 0; chip < 2; ++chip) {
+			MAME::YM3812UpdateOne(_opl[chip], tempBuffer, readSamples);
+			for (int i = 0; i < readSamples; ++i)
+				buffer[i * 2 + chip] = tempBuffer[i];
+		}
+
+		buffer += readSamples * 2;
+		length -= readSamples;
+	}
 }
 
 /* -------------------- preliminary define section --------------------- */
@@ -375,8 +427,8 @@ inline void OPL_KEYOFF(OPL_SLOT *SLOT) {
 
 /* ---------- calcrate Envelope Generator & Phase Generator ---------- */
 
-/* return : envelope output */
-inline uint OPL_CALC_SLOT(OPL_SLOT *SLOT) {
+/* return : envelope output without LFO */
+inline uint OPL_CALC_EG(OPL_SLOT *SLOT) {
 	/* calcrate envelope generator */
 	if ((SLOT->evc += SLOT->evs) >= SLOT->eve) {
 		switch (SLOT->evm) {
@@ -405,7 +457,17 @@ inline uint OPL_CALC_SLOT(OPL_SLOT *SLOT) {
 		}
 	}
 	/* calcrate envelope */
-	return SLOT->TLL + ENV_CURVE[SLOT->evc>>ENV_BITS] + (SLOT->ams ? ams : 0);
+	return SLOT->TLL + ENV_CURVE[SLOT->evc>>ENV_BITS];
+}
+
+/* return : envelope output */
+inline uint OPL_CALC_SLOT(OPL_SLOT *SLOT) {
+	return OPL_CALC_EG(SLOT) + (SLOT->ams ? ams : 0);
+}
+
+/* true when the envelope has ended and produces no output until key on */
+inline bool OPL_SLOT_IDLE(OPL_SLOT *SLOT) {
+	return SLOT->evm == ENV_MOD_RR && SLOT->evc == EG_OFF && SLOT->eve == EG_OFF + 1;
 }
 
 /* set algorythm connection */
@@ -497,44 +559,62 @@ inline void set_sl_rr(FM_OPL *OPL, int slot, int v) {
 /* operator output calcrator */
 
 #define OP_OUT(slot,env,con)   slot->wavetable[((slot->Cnt + con)>>(24-SIN_ENT_SHIFT)) & (SIN_ENT-1)][env]
-/* ---------- calcrate one of channel ---------- */
-inline void OPL_CALC_CH(OPL_CH *CH) {
+/* ---------- calcrate one of channel for a block of samples ---------- */
+/* LFO values are taken from amsBuf and vibBuf, the output is added to  */
+/* buf.                                                                 */
+static void OPL_CALC_CH_BLOCK(OPL_CH *CH, int *buf, const int *amsBuf, const int *vibBuf, int length) {
+	OPL_SLOT *SLOT1P = &CH->SLOT[SLOT1];
+	OPL_SLOT *SLOT2P = &CH->SLOT[SLOT2];
 	uint env_out;
-	OPL_SLOT *SLOT;
+	int i;
 
-	feedback2 = 0;
-	/* SLOT 1 */
-	SLOT = &CH->SLOT[SLOT1];
-	env_out=OPL_CALC_SLOT(SLOT);
-	if (env_out < (uint)(EG_ENT - 1)) {
-		/* PG */
-		if (SLOT->vib)
-			SLOT->Cnt += (SLOT->Incr * vib) >> VIB_RATE_SHIFT;
-		else
-			SLOT->Cnt += SLOT->Incr;
-		/* connection */
-		if (CH->FB) {
-			int feedback1 = (CH->op1_out[0] + CH->op1_out[1]) >> CH->FB;
-			CH->op1_out[1] = CH->op1_out[0];
-			*CH->connect1 += CH->op1_out[0] = OP_OUT(SLOT, env_out, feedback1);
-		} else {
-			*CH->connect1 += OP_OUT(SLOT, env_out, 0);
-		}
-	} else {
-		CH->op1_out[1] = CH->op1_out[0];
+	/* silent channel : only the feedback history and a pending step change */
+	if (OPL_SLOT_IDLE(SLOT1P) && OPL_SLOT_IDLE(SLOT2P)) {
+		SLOT1P->evs = SLOT2P->evs = 0;
+		CH->op1_out[1] = (length > 1) ? 0 : CH->op1_out[0];
 		CH->op1_out[0] = 0;
+		return;
 	}
-	/* SLOT 2 */
-	SLOT = &CH->SLOT[SLOT2];
-	env_out=OPL_CALC_SLOT(SLOT);
-	if (env_out < (uint)(EG_ENT - 1)) {
-		/* PG */
-		if (SLOT->vib)
-			SLOT->Cnt += (SLOT->Incr * vib) >> VIB_RATE_SHIFT;
-		else
-			SLOT->Cnt += SLOT->Incr;
-		/* connection */
-		outd[0] += OP_OUT(SLOT, env_out, feedback2);
+
+	for (i = 0; i < length; i++) {
+		int modulation = 0;
+
+		/* SLOT 1 */
+		env_out = OPL_CALC_EG(SLOT1P) + (SLOT1P->ams ? amsBuf[i] : 0);
+		if (env_out < (uint)(EG_ENT - 1)) {
+			int out;
+			/* PG */
+			if (SLOT1P->vib)
+				SLOT1P->Cnt += (SLOT1P->Incr * vibBuf[i]) >> VIB_RATE_SHIFT;
+			else
+				SLOT1P->Cnt += SLOT1P->Incr;
+			/* connection */
+			if (CH->FB) {
+				int feedback1 = (CH->op1_out[0] + CH->op1_out[1]) >> CH->FB;
+				CH->op1_out[1] = CH->op1_out[0];
+				out = CH->op1_out[0] = OP_OUT(SLOT1P, env_out, feedback1);
+			} else {
+				out = OP_OUT(SLOT1P, env_out, 0);
+			}
+			if (CH->CON)
+				buf[i] += out;
+			else
+				modulation = out;
+		} else {
+			CH->op1_out[1] = CH->op1_out[0];
+			CH->op1_out[0] = 0;
+		}
+		/* SLOT 2 */
+		env_out = OPL_CALC_EG(SLOT2P) + (SLOT2P->ams ? amsBuf[i] : 0);
+		if (env_out < (uint)(EG_ENT - 1)) {
+			/* PG */
+			if (SLOT2P->vib)
+				SLOT2P->Cnt += (SLOT2P->Incr * vibBuf[i]) >> VIB_RATE_SHIFT;
+			else
+				SLOT2P->Cnt += SLOT2P->Incr;
+			/* connection */
+			buf[i] += OP_OUT(SLOT2P, env_out, modulation);
+		}
 	}
 }
 
@@ -1017,6 +1097,11 @@ static void OPL_UnLockTable(void) {
 /*******************************************************************************/
 
 /* ---------- update one of chip ----------- */
+/* The chip is rendered in blocks: the LFO is calculated for the whole  */
+/* block first, then each channel over the whole block, so the state of */
+/* a channel stays in registers and silent channels are skipped.        */
+#define OPL_BLOCK_SIZE 256
+
 void YM3812UpdateOne(FM_OPL *OPL, int16 *buffer, int length) {
 	int i;
 	int data;
@@ -1025,6 +1110,9 @@ void YM3812UpdateOne(FM_OPL *OPL, int16 *buffer, int length) {
 	uint vibCnt = OPL->vibCnt;
 	uint8 rythm = OPL->rythm & 0x20;
 	OPL_CH *CH, *R_CH;
+	int outBuf[OPL_BLOCK_SIZE];
+	int amsBuf[OPL_BLOCK_SIZE];
+	int vibBuf[OPL_BLOCK_SIZE];
 
 
 	if ((void *)OPL != cur_chip) {
@@ -1044,22 +1132,37 @@ void YM3812UpdateOne(FM_OPL *OPL, int16 *buffer, int length) {
 		vib_table = OPL->vib_table;
 	}
 	R_CH = rythm ? &S_CH[6] : E_CH;
-	for (i = 0; i < length; i++) {
-		/*            channel A         channel B         channel C      */
+	while (length > 0) {
+		int blockLength = MIN(length, OPL_BLOCK_SIZE);
+
 		/* LFO */
-		ams = ams_table[(amsCnt += amsIncr) >> AMS_SHIFT];
-		vib = vib_table[(vibCnt += vibIncr) >> VIB_SHIFT];
-		outd[0] = 0;
+		for (i = 0; i < blockLength; i++) {
+			amsBuf[i] = ams_table[(amsCnt += amsIncr) >> AMS_SHIFT];
+			vibBuf[i] = vib_table[(vibCnt += vibIncr) >> VIB_SHIFT];
+			outBuf[i] = 0;
+		}
 		/* FM part */
 		for (CH = S_CH; CH < R_CH; CH++)
-			OPL_CALC_CH(CH);
+			OPL_CALC_CH_BLOCK(CH, outBuf, amsBuf, vibBuf, blockLength);
 		/* Rythn part */
-		if (rythm)
-			OPL_CALC_RH(OPL, S_CH);
-		/* limit check */
-		data = CLIP(outd[0], OPL_MINOUT, OPL_MAXOUT);
-		/* store to sound buffer */
-		buf[i] = data >> OPL_OUTSB;
+		if (rythm) {
+			for (i = 0; i < blockLength; i++) {
+				ams = amsBuf[i];
+				vib = vibBuf[i];
+				outd[0] = 0;
+				OPL_CALC_RH(OPL, S_CH);
+				outBuf[i] += outd[0];
+			}
+		}
+		for (i = 0; i < blockLength; i++) {
+			/* limit check */
+			data = CLIP(outBuf[i], OPL_MINOUT, OPL_MAXOUT);
+			/* store to sound buffer */
+			buf[i] = data >> OPL_OUTSB;
+		}
+
+		buf += blockLength;
+		length -= blockLength;
 	}
 
 	OPL->amsCnt = amsCnt;
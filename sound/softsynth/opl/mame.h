@@ -179,9 +179,13 @@ FM_OPL *makeAdLibOPL(int rate);
 // OPL API implementation
 class OPL : public ::OPL::OPL {
 private:
-	FM_OPL *_opl;
+	Config::OplType _type;
+	/** The emulated chips, the second one is only used for dual OPL2 */
+	FM_OPL *_opl[2];
+
+	void free();
 public:
-	OPL() : _opl(0) {}
+	OPL(Config::OplType type = Config::kOpl2);
 	~OPL();
 
 	bool init(int rate);
@@ -193,7 +197,7 @@ public:
 	void writeReg(int r, int v);
 
 	void readBuffer(int16 *buffer, int length);
-	bool isStereo() const { return false; }
+	bool isStereo() const { return _type != Config::kOpl2; }
 };
 
 } // End of namespace MAME
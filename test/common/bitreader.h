@@ -0,0 +1,111 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitreader.h"
+
+class BitReaderTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) & 0x7fff;
+	}
+
+	// Appends a value to a bit stream in the given bit order
+	static void putBits(byte *buffer, uint32 &bit, uint32 value, uint n, bool msb) {
+		for (uint i = 0; i < n; i++, bit++) {
+			const uint32 b = msb ? (value >> (n - 1 - i)) & 1 : (value >> i) & 1;
+			if (b)
+				buffer[bit >> 3] |= msb ? (0x80 >> (bit & 7)) : (1 << (bit & 7));
+		}
+	}
+
+	template<bool MSB>
+	void checkRoundTrip() {
+		byte buffer[1024];
+		uint32 values[500];
+		uint widths[500];
+
+		for (int run = 0; run < 20; run++) {
+			memset(buffer, 0, sizeof(buffer));
+
+			uint32 bit = 0;
+			int count = 0;
+			while (count < 500 && bit + 24 <= 8 * 1000) {
+				widths[count] = nextRandom() % 25;
+				values[count] = ((nextRandom() << 15) | nextRandom()) & ((1 << widths[count]) - 1);
+				putBits(buffer, bit, values[count], widths[count], MSB);
+				count++;
+			}
+
+			// Try different ends of the buffer for the byte-wise refill
+			const uint32 size = (bit + 7) / 8;
+			Common::BitReader<MSB> bits(buffer, size);
+			for (int i = 0; i < count; i++) {
+				if (widths[i] <= 16)
+					TS_ASSERT_EQUALS(bits.peekBits(widths[i]), values[i]);
+				TS_ASSERT_EQUALS(bits.getBits(widths[i]), values[i]);
+			}
+
+			TS_ASSERT_EQUALS(bits.pos(), bit);
+			TS_ASSERT(!bits.eos());
+		}
+	}
+
+public:
+	void test_msb() {
+		_seed = 1;
+		checkRoundTrip<true>();
+	}
+
+	void test_lsb() {
+		_seed = 2;
+		checkRoundTrip<false>();
+	}
+
+	void test_bit_order() {
+		const byte data[] = { 0xA5, 0x0F, 0x81 };
+
+		Common::BitReaderMSB msb(data, sizeof(data));
+		TS_ASSERT_EQUALS(msb.getBit(), 1u);
+		TS_ASSERT_EQUALS(msb.getBits(3), 2u);
+		TS_ASSERT_EQUALS(msb.getBits(8), 0x50u);
+		TS_ASSERT_EQUALS(msb.getBits(12), 0xF81u);
+
+		Common::BitReaderLSB lsb(data, sizeof(data));
+		TS_ASSERT_EQUALS(lsb.getBit(), 1u);
+		TS_ASSERT_EQUALS(lsb.getBits(3), 2u);
+		TS_ASSERT_EQUALS(lsb.getBits(8), 0xFAu);
+		TS_ASSERT_EQUALS(lsb.getBits(12), 0x810u);
+	}
+
+	void test_skip_and_align() {
+		const byte data[] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC };
+
+		Common::BitReaderMSB bits(data, sizeof(data));
+		bits.skipBits(4);
+		TS_ASSERT_EQUALS(bits.getBits(8), 0x23u);
+		bits.alignToByte();
+		TS_ASSERT_EQUALS(bits.pos(), 16u);
+		TS_ASSERT_EQUALS(bits.getByte(), 0x56);
+		bits.alignToByte();
+		TS_ASSERT_EQUALS(bits.pos(), 24u);
+		bits.skipBits(20);
+		TS_ASSERT_EQUALS(bits.getBits(4), 0xCu);
+	}
+
+	void test_end_of_buffer() {
+		const byte data[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+		Common::BitReaderLSB bits(data, sizeof(data));
+		TS_ASSERT_EQUALS(bits.getBits(24), 0xFFFFFFu);
+		TS_ASSERT_EQUALS(bits.getBits(12), 0xFFFu);
+		TS_ASSERT(!bits.eos());
+
+		// Past the end, the buffer reads as zero bits
+		TS_ASSERT_EQUALS(bits.getBits(8), 0x0Fu);
+		TS_ASSERT(bits.eos());
+		TS_ASSERT_EQUALS(bits.getBits(24), 0u);
+	}
+};
@@ -0,0 +1,45 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dcl.h"
+#include "common/memstream.h"
+
+class DCLTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_binary() {
+		// Binary mode with a 1 KB dictionary, from the description of the
+		// format in blast.c of zlib
+		const byte packed[] = { 0x00, 0x04, 0x82, 0x24, 0x25, 0x8f, 0x80, 0x7f };
+		byte unpacked[13];
+
+		TS_ASSERT(Common::decompressDCL(packed, unpacked, sizeof(packed), sizeof(unpacked)));
+		TS_ASSERT(!memcmp(unpacked, "AIAIAIAIAIAIA", 13));
+
+		Common::MemoryReadStream stream(packed, sizeof(packed));
+		memset(unpacked, 0, sizeof(unpacked));
+		TS_ASSERT(Common::decompressDCL(&stream, unpacked, sizeof(packed), sizeof(unpacked)));
+		TS_ASSERT(!memcmp(unpacked, "AIAIAIAIAIAIA", 13));
+	}
+
+	void test_ascii() {
+		// ASCII mode: "e" (code 11011), "a" (11100) and a copy of 3 bytes
+		// from 2 bytes back (length code 11, distance code 11, low bits 0001)
+		const byte packed[] = { 0x01, 0x04, 0xB6, 0xF3, 0x03 };
+		byte unpacked[5];
+
+		TS_ASSERT(Common::decompressDCL(packed, unpacked, sizeof(packed), sizeof(unpacked)));
+		TS_ASSERT(!memcmp(unpacked, "eaeae", 5));
+	}
+
+	void test_errors() {
+		byte unpacked[16];
+
+		// Unknown mode
+		const byte badMode[] = { 0x02, 0x04, 0x00, 0x00 };
+		TS_ASSERT(!Common::decompressDCL(badMode, unpacked, sizeof(badMode), sizeof(unpacked)));
+
+		// Copy from before the start of the data
+		const byte badCopy[] = { 0x00, 0x04, 0xFF, 0xFF, 0xFF };
+		TS_ASSERT(!Common::decompressDCL(badCopy, unpacked, sizeof(badCopy), sizeof(unpacked)));
+	}
+};
@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitreader.h"
+#include "common/huffman.h"
+
+class HuffmanTestSuite : public CxxTest::TestSuite
+{
+private:
+	// Appends a code to a bit stream, most significant bit of the code first
+	static void putCode(byte *buffer, uint32 &bit, uint32 code, uint n, bool msb) {
+		for (uint i = 0; i < n; i++, bit++) {
+			if ((code >> (n - 1 - i)) & 1)
+				buffer[bit >> 3] |= msb ? (0x80 >> (bit & 7)) : (1 << (bit & 7));
+		}
+	}
+
+	template<bool MSB>
+	void checkCodes(uint tableBits) {
+		// A complete code with lengths from 1 to 14 bits
+		uint32 codes[15];
+		uint8 lengths[15];
+		uint32 symbols[15];
+		for (int i = 0; i < 14; i++) {
+			codes[i] = (1 << (i + 1)) - 2;
+			lengths[i] = i + 1;
+			symbols[i] = 1000 + i;
+		}
+		codes[14] = (1 << 14) - 1;
+		lengths[14] = 14;
+		symbols[14] = 2000;
+
+		Common::Huffman huffman(tableBits, 15, codes, lengths, symbols, MSB);
+
+		byte buffer[512];
+		memset(buffer, 0, sizeof(buffer));
+		uint32 bit = 0;
+		const int message[] = { 0, 14, 3, 13, 1, 7, 9, 0, 0, 12, 2, 14, 11, 5 };
+		for (int i = 0; i < ARRAYSIZE(message); i++)
+			putCode(buffer, bit, codes[message[i]], lengths[message[i]], MSB);
+
+		Common::BitReader<MSB> bits(buffer, (bit + 7) / 8);
+		for (int i = 0; i < ARRAYSIZE(message); i++)
+			TS_ASSERT_EQUALS(huffman.getSymbol(bits), symbols[message[i]]);
+		TS_ASSERT_EQUALS(bits.pos(), bit);
+	}
+
+public:
+	void test_msb() {
+		checkCodes<true>(4);
+		checkCodes<true>(9);
+		checkCodes<true>(16);
+	}
+
+	void test_lsb() {
+		checkCodes<false>(4);
+		checkCodes<false>(9);
+		checkCodes<false>(16);
+	}
+
+	void test_invalid_code() {
+		// Only 0 and 10 are codes, 11 isn't
+		const uint32 codes[] = { 0, 2 };
+		const uint8 lengths[] = { 1, 2 };
+		Common::Huffman huffman(8, 2, codes, lengths, 0, true);
+
+		const byte data[] = { 0x2C };
+		Common::BitReaderMSB bits(data, sizeof(data));
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), 0u);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), 0u);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), 1u);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)Common::Huffman::kInvalidSymbol);
+		TS_ASSERT_EQUALS(bits.pos(), 4u);
+	}
+};
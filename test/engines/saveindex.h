@@ -0,0 +1,221 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+
+#include "engines/saveindex.h"
+
+// Keeps the savefiles in memory
+class MemorySaveFileManager : public Common::SaveFileManager {
+	typedef Common::HashMap<Common::String, Common::String> FileMap;
+
+	class OutFile : public Common::WriteStream {
+	public:
+		OutFile(FileMap &files, const Common::String &name) : _files(files), _name(name) {}
+		~OutFile() { _files[_name] = _data; }
+
+		uint32 write(const void *dataPtr, uint32 dataSize) {
+			_data += Common::String((const char *)dataPtr, dataSize);
+			return dataSize;
+		}
+
+	private:
+		FileMap &_files;
+		Common::String _name;
+		Common::String _data;
+	};
+
+	FileMap _files;
+
+public:
+	MemorySaveFileManager() : _loads(0) {}
+
+	/** Number of savefiles opened for loading, except for the index. */
+	int _loads;
+
+	void writeFile(const Common::String &name, uint32 size) {
+		_files[name] = Common::String();
+		for (uint32 i = 0; i < size; ++i)
+			_files[name] += 'x';
+	}
+
+	Common::OutSaveFile *openForSaving(const Common::String &name) {
+		return new OutFile(_files, name);
+	}
+
+	Common::InSaveFile *openForLoading(const Common::String &name) {
+		if (!_files.contains(name))
+			return 0;
+
+		if (name != SaveStateIndex::getIndexName("target"))
+			++_loads;
+
+		const Common::String &data = _files[name];
+		byte *copy = (byte *)malloc(data.size() + 1);
+		memcpy(copy, data.c_str(), data.size());
+		return new Common::MemoryReadStream(copy, data.size(), DisposeAfterUse::YES);
+	}
+
+	bool removeSavefile(const Common::String &name) {
+		if (!_files.contains(name))
+			return false;
+		_files.erase(name);
+		return true;
+	}
+
+	Common::StringArray listSavefiles(const Common::String &pattern) {
+		Common::StringArray list;
+		for (FileMap::const_iterator i = _files.begin(); i != _files.end(); ++i) {
+			if (i->_key.matchString(pattern, true))
+				list.push_back(i->_key);
+		}
+		return list;
+	}
+};
+
+class SaveStateIndexTestSuite : public CxxTest::TestSuite
+{
+private:
+	static void addSave(MemorySaveFileManager &saveFileMan, SaveStateIndex &index, int slot, uint32 size) {
+		const Common::String file = Common::String::format("target.s%02d", slot);
+		saveFileMan.writeFile(file, size);
+		index.setSave(file, SaveStateDescriptor(slot, Common::String::format("Save %d", slot)), true);
+	}
+
+public:
+	void test_sort_order() {
+		MemorySaveFileManager saveFileMan;
+		SaveStateIndex index("target", &saveFileMan);
+		TS_ASSERT(!index.load());
+
+		addSave(saveFileMan, index, 7, 100);
+		addSave(saveFileMan, index, 2, 200);
+		addSave(saveFileMan, index, 11, 300);
+		TS_ASSERT(index.save());
+
+		SaveStateIndex loaded("target", &saveFileMan);
+		TS_ASSERT(loaded.load());
+		TS_ASSERT(loaded.matches(saveFileMan.listSavefiles("target.s??")));
+
+		SaveStateList list = loaded.getSaveList();
+		TS_ASSERT_EQUALS(list.size(), 3u);
+		TS_ASSERT_EQUALS(list[0].save_slot(), "2");
+		TS_ASSERT_EQUALS(list[1].save_slot(), "7");
+		TS_ASSERT_EQUALS(list[2].save_slot(), "11");
+		TS_ASSERT_EQUALS(list[1].description(), "Save 7");
+
+		SaveStateDescriptor desc;
+		TS_ASSERT(loaded.getMetaInfos(11, desc));
+		TS_ASSERT_EQUALS(desc.description(), "Save 11");
+		TS_ASSERT(!loaded.getMetaInfos(3, desc));
+	}
+
+	void test_set_and_remove() {
+		MemorySaveFileManager saveFileMan;
+		SaveStateIndex index("target", &saveFileMan);
+
+		addSave(saveFileMan, index, 1, 100);
+		addSave(saveFileMan, index, 2, 100);
+		TS_ASSERT(index.hasSave("target.s01"));
+
+		// Replacing a savegame keeps a single entry for it
+		addSave(saveFileMan, index, 1, 150);
+		TS_ASSERT_EQUALS(index.getSaveList().size(), 2u);
+
+		index.removeSave("target.s01");
+		saveFileMan.removeSavefile("target.s01");
+		TS_ASSERT(!index.hasSave("target.s01"));
+		TS_ASSERT(index.hasSave("target.s02"));
+		TS_ASSERT(index.save());
+
+		SaveStateIndex loaded("target", &saveFileMan);
+		TS_ASSERT(loaded.load());
+		TS_ASSERT(loaded.matches(saveFileMan.listSavefiles("target.s??")));
+		TS_ASSERT_EQUALS(loaded.getSaveList().size(), 1u);
+		TS_ASSERT_EQUALS(loaded.getSaveList()[0].save_slot(), "2");
+	}
+
+	void test_stale_index() {
+		MemorySaveFileManager saveFileMan;
+		SaveStateIndex index("target", &saveFileMan);
+
+		addSave(saveFileMan, index, 1, 100);
+		addSave(saveFileMan, index, 2, 200);
+		TS_ASSERT(index.save());
+
+		// Add a savegame the index doesn't know of
+		saveFileMan.writeFile("target.s03", 300);
+		Common::StringArray files = saveFileMan.listSavefiles("target.s??");
+
+		SaveStateIndex loaded("target", &saveFileMan);
+		TS_ASSERT(loaded.load());
+		TS_ASSERT(!loaded.matches(files));
+
+		loaded.prune(files);
+		TS_ASSERT(loaded.hasSave("target.s01"));
+		TS_ASSERT(loaded.hasSave("target.s02"));
+		TS_ASSERT(!loaded.hasSave("target.s03"));
+
+		// Removing a savegame is noticed as well
+		saveFileMan.removeSavefile("target.s01");
+		files = saveFileMan.listSavefiles("target.s??");
+		loaded.prune(files);
+		TS_ASSERT(!loaded.hasSave("target.s01"));
+		TS_ASSERT(loaded.hasSave("target.s02"));
+
+		SaveStateDescriptor desc;
+		TS_ASSERT(!loaded.getMetaInfos(1, desc));
+		TS_ASSERT(loaded.getMetaInfos(2, desc));
+	}
+
+	void test_no_savegames_opened() {
+		MemorySaveFileManager saveFileMan;
+		SaveStateIndex index("target", &saveFileMan);
+
+		addSave(saveFileMan, index, 1, 100);
+		addSave(saveFileMan, index, 2, 200);
+		TS_ASSERT(index.save());
+
+		// Checking the index and reading meta infos without thumbnails
+		// must not open the savegames themselves
+		saveFileMan._loads = 0;
+		const Common::StringArray files = saveFileMan.listSavefiles("target.s??");
+
+		SaveStateIndex loaded("target", &saveFileMan);
+		TS_ASSERT(loaded.load());
+		TS_ASSERT(loaded.matches(files));
+		loaded.prune(files);
+
+		SaveStateDescriptor desc;
+		TS_ASSERT(loaded.getMetaInfos(1, desc));
+		TS_ASSERT_EQUALS(desc.description(), "Save 1");
+		TS_ASSERT_EQUALS(saveFileMan._loads, 0);
+	}
+
+	void test_description_only() {
+		MemorySaveFileManager saveFileMan;
+		SaveStateIndex index("target", &saveFileMan);
+
+		saveFileMan.writeFile("target.s04", 100);
+		index.setSave("target.s04", SaveStateDescriptor(4, "Listed"), false);
+		TS_ASSERT(index.save());
+
+		SaveStateIndex loaded("target", &saveFileMan);
+		TS_ASSERT(loaded.load());
+		TS_ASSERT_EQUALS(loaded.getSaveList()[0].description(), "Listed");
+
+		// The meta infos still have to be read from the savegame
+		SaveStateDescriptor desc;
+		TS_ASSERT(!loaded.getMetaInfos(4, desc));
+	}
+
+	void test_corrupt_index() {
+		MemorySaveFileManager saveFileMan;
+		saveFileMan.writeFile(SaveStateIndex::getIndexName("target"), 64);
+
+		SaveStateIndex index("target", &saveFileMan);
+		TS_ASSERT(!index.load());
+		TS_ASSERT_EQUALS(index.getSaveList().size(), 0u);
+	}
+};
@@ -0,0 +1,116 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/stream.h"
+#include "graphics/pixelformat.h"
+#include "graphics/png.h"
+
+// Generated with zlib. The second line of the true color image uses the Sub
+// filter, all other lines are unfiltered.
+
+static const byte kTrueColorPNG[] = {
+	0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+	0x08, 0x02, 0x00, 0x00, 0x00, 0x12, 0x16, 0xF1, 0x4D, 0x00, 0x00, 0x00,
+	0x17, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0xF8, 0xCF, 0xC0, 0xC0,
+	0x00, 0xC6, 0x8C, 0x02, 0x0A, 0x06, 0x40, 0xB0, 0x7F, 0xFD, 0x7C, 0x00,
+	0x36, 0xDB, 0x05, 0xFC, 0xBD, 0x3E, 0x55, 0x35, 0x00, 0x00, 0x00, 0x00,
+	0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+
+static const byte kIndexedPNG[] = {
+	0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+	0x08, 0x03, 0x00, 0x00, 0x00, 0xAA, 0xAA, 0x96, 0x28, 0x00, 0x00, 0x00,
+	0x09, 0x50, 0x4C, 0x54, 0x45, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00,
+	0x00, 0xFF, 0x2D, 0x4A, 0xCD, 0x8A, 0x00, 0x00, 0x00, 0x10, 0x49, 0x44,
+	0x41, 0x54, 0x78, 0x9C, 0x63, 0x60, 0x60, 0x64, 0x62, 0x60, 0x62, 0x64,
+	0x00, 0x00, 0x00, 0x20, 0x00, 0x07, 0x1D, 0x2B, 0x70, 0xA0, 0x00, 0x00,
+	0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+
+static const byte kIndexedNoPalettePNG[] = {
+	0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+	0x08, 0x03, 0x00, 0x00, 0x00, 0xAA, 0xAA, 0x96, 0x28, 0x00, 0x00, 0x00,
+	0x10, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0x60, 0x60, 0x64, 0x62,
+	0x60, 0x62, 0x64, 0x00, 0x00, 0x00, 0x20, 0x00, 0x07, 0x1D, 0x2B, 0x70,
+	0xA0, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60,
+	0x82,
+};
+
+class PNGTestSuite : public CxxTest::TestSuite
+{
+private:
+	static Graphics::PNG *readPNG(const byte *data, uint32 size) {
+		Graphics::PNG *png = new Graphics::PNG();
+		TS_ASSERT(png->read(new Common::MemoryReadStream(data, size)));
+		return png;
+	}
+
+	static uint32 getPixel(const Graphics::Surface *surface, int x, int y) {
+		return *(const uint32 *)surface->getBasePtr(x, y);
+	}
+
+public:
+	void test_truecolor() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::PNG *png = readPNG(kTrueColorPNG, sizeof(kTrueColorPNG));
+		TS_ASSERT_EQUALS(png->getHeader().colorType, Graphics::kTrueColor);
+
+		Graphics::Surface *surface = png->getSurface(format);
+		TS_ASSERT_EQUALS(getPixel(surface, 0, 0), format.ARGBToColor(255, 255, 0, 0));
+		TS_ASSERT_EQUALS(getPixel(surface, 1, 0), format.ARGBToColor(255, 0, 255, 0));
+		TS_ASSERT_EQUALS(getPixel(surface, 2, 0), format.ARGBToColor(255, 0, 0, 255));
+		TS_ASSERT_EQUALS(getPixel(surface, 0, 1), format.ARGBToColor(255, 16, 32, 48));
+		TS_ASSERT_EQUALS(getPixel(surface, 1, 1), format.ARGBToColor(255, 64, 80, 96));
+		TS_ASSERT_EQUALS(getPixel(surface, 2, 1), format.ARGBToColor(255, 255, 255, 255));
+
+		surface->free();
+		delete surface;
+		delete png;
+	}
+
+	void test_indexed() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::PNG *png = readPNG(kIndexedPNG, sizeof(kIndexedPNG));
+
+		byte *palette = 0;
+		byte entries = 0;
+		png->getPalette(palette, entries);
+		TS_ASSERT_EQUALS(entries, 3);
+
+		const Graphics::Surface *indexed = png->getIndexedSurface();
+		TS_ASSERT_EQUALS(*(const byte *)indexed->getBasePtr(0, 0), 0);
+		TS_ASSERT_EQUALS(*(const byte *)indexed->getBasePtr(2, 0), 2);
+		TS_ASSERT_EQUALS(*(const byte *)indexed->getBasePtr(0, 1), 2);
+
+		Graphics::Surface *surface = png->getSurface(format);
+		TS_ASSERT_EQUALS(getPixel(surface, 0, 0), format.ARGBToColor(255, 255, 0, 0));
+		TS_ASSERT_EQUALS(getPixel(surface, 1, 0), format.ARGBToColor(255, 0, 255, 0));
+		TS_ASSERT_EQUALS(getPixel(surface, 2, 1), format.ARGBToColor(255, 255, 0, 0));
+
+		surface->free();
+		delete surface;
+		delete png;
+	}
+
+	void test_indexed_without_palette() {
+		// Without a PLTE chunk, every index maps to black
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::PNG *png = readPNG(kIndexedNoPalettePNG, sizeof(kIndexedNoPalettePNG));
+
+		byte *palette = 0;
+		byte entries = 0xFF;
+		png->getPalette(palette, entries);
+		TS_ASSERT_EQUALS(entries, 0);
+
+		Graphics::Surface *surface = png->getSurface(format);
+		for (int y = 0; y < 2; y++)
+			for (int x = 0; x < 3; x++)
+				TS_ASSERT_EQUALS(getPixel(surface, x, y), 0u);
+
+		surface->free();
+		delete surface;
+		delete png;
+	}
+};
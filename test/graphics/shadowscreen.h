@@ -0,0 +1,246 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/modular-backend.h"
+#include "common/array.h"
+#include "graphics/shadowscreen.h"
+
+// Records the rectangles copied to the screen, and keeps the screen contents.
+// It replaces g_system while it exists.
+class ScreenRecorder : public ModularBackend {
+public:
+	struct Rect {
+		int x, y, w, h;
+	};
+
+	ScreenRecorder(int width, int height, int bytesPerPixel)
+		: _width(width), _height(height), _bytesPerPixel(bytesPerPixel), _oldSystem(g_system) {
+		_screen.resize(width * height * bytesPerPixel);
+		for (uint i = 0; i < _screen.size(); ++i)
+			_screen[i] = 0;
+		g_system = this;
+	}
+
+	~ScreenRecorder() {
+		g_system = _oldSystem;
+	}
+
+	void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {
+		Rect rect = { x, y, w, h };
+		_rects.push_back(rect);
+
+		TS_ASSERT(x >= 0 && y >= 0 && w > 0 && h > 0 && x + w <= _width && y + h <= _height);
+		for (int i = 0; i < h; ++i)
+			memcpy(&_screen[((y + i) * _width + x) * _bytesPerPixel], buf + i * pitch, w * _bytesPerPixel);
+	}
+
+	uint32 getMillis() { return 0; }
+	void delayMillis(uint msecs) {}
+	void getTimeAndDate(TimeDate &t) const {}
+	Common::SeekableReadStream *createConfigReadStream() { return 0; }
+	Common::WriteStream *createConfigWriteStream() { return 0; }
+
+	/** Checks that exactly the given rectangle has been copied, and forgets it. */
+	void checkRect(int x, int y, int w, int h) {
+		TS_ASSERT_EQUALS(_rects.size(), 1U);
+		if (_rects.size() == 1) {
+			TS_ASSERT_EQUALS(_rects[0].x, x);
+			TS_ASSERT_EQUALS(_rects[0].y, y);
+			TS_ASSERT_EQUALS(_rects[0].w, w);
+			TS_ASSERT_EQUALS(_rects[0].h, h);
+		}
+		_rects.clear();
+	}
+
+	/** Checks that the screen shows the given frame. */
+	void checkScreen(const byte *frame) {
+		TS_ASSERT(!memcmp(_screen.begin(), frame, _screen.size()));
+	}
+
+	Common::Array<Rect> _rects;
+
+private:
+	int _width;
+	int _height;
+	int _bytesPerPixel;
+	Common::Array<byte> _screen;
+	OSystem *_oldSystem;
+};
+
+class ShadowScreenTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_first_copy() {
+		ScreenRecorder screen(8, 6, 1);
+		Graphics::ShadowScreen shadow(8, 6);
+		byte frame[8 * 6];
+		for (int i = 0; i < 8 * 6; ++i)
+			frame[i] = i;
+
+		// Nothing is known about the screen yet, so all of it is copied
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen.checkRect(0, 0, 8, 6);
+		screen.checkScreen(frame);
+		TS_ASSERT_EQUALS(shadow.getPixelsCopied(), 48U);
+		TS_ASSERT_EQUALS(shadow.getPixelsSkipped(), 0U);
+
+		// Then nothing changed
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		TS_ASSERT(screen._rects.empty());
+		TS_ASSERT_EQUALS(shadow.getPixelsCopied(), 48U);
+		TS_ASSERT_EQUALS(shadow.getPixelsSkipped(), 48U);
+
+		shadow.resetStats();
+		TS_ASSERT_EQUALS(shadow.getPixelsCopied(), 0U);
+		TS_ASSERT_EQUALS(shadow.getPixelsSkipped(), 0U);
+	}
+
+	void test_partial_first_copy() {
+		ScreenRecorder screen(8, 6, 1);
+		Graphics::ShadowScreen shadow(8, 6);
+		byte frame[8 * 6];
+		memset(frame, 0, sizeof(frame));
+
+		// The copy is only valid once all of the screen has been copied at once
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 3);
+		screen.checkRect(0, 0, 8, 3);
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 3);
+		screen.checkRect(0, 0, 8, 3);
+
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen.checkRect(0, 0, 8, 6);
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 3);
+		TS_ASSERT(screen._rects.empty());
+	}
+
+	void test_invalidate() {
+		ScreenRecorder screen(8, 6, 1);
+		Graphics::ShadowScreen shadow(8, 6);
+		byte frame[8 * 6];
+		memset(frame, 1, sizeof(frame));
+
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen.checkRect(0, 0, 8, 6);
+
+		shadow.invalidate();
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen.checkRect(0, 0, 8, 6);
+
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		TS_ASSERT(screen._rects.empty());
+	}
+
+	void test_runs() {
+		ScreenRecorder screen(8, 6, 1);
+		Graphics::ShadowScreen shadow(8, 6);
+		byte frame[8 * 6];
+		memset(frame, 0, sizeof(frame));
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen._rects.clear();
+
+		// Overlapping changes in consecutive lines are copied as one rectangle
+		frame[1 * 8 + 2] = frame[1 * 8 + 3] = 1;
+		frame[2 * 8 + 3] = frame[2 * 8 + 5] = 2;
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		screen.checkRect(2, 1, 4, 2);
+		screen.checkScreen(frame);
+
+		// Changes which don't overlap, or are separated by an unchanged
+		// line, are not
+		frame[1 * 8 + 0] = 3;
+		frame[2 * 8 + 7] = 4;
+		frame[4 * 8 + 7] = 5;
+		shadow.copyRectToScreen(frame, 8, 0, 0, 8, 6);
+		TS_ASSERT_EQUALS(screen._rects.size(), 3U);
+		if (screen._rects.size() == 3) {
+			TS_ASSERT_EQUALS(screen._rects[0].x, 0);
+			TS_ASSERT_EQUALS(screen._rects[0].y, 1);
+			TS_ASSERT_EQUALS(screen._rects[0].w, 1);
+			TS_ASSERT_EQUALS(screen._rects[0].h, 1);
+			TS_ASSERT_EQUALS(screen._rects[1].x, 7);
+			TS_ASSERT_EQUALS(screen._rects[1].y, 2);
+			TS_ASSERT_EQUALS(screen._rects[1].w, 1);
+			TS_ASSERT_EQUALS(screen._rects[1].h, 1);
+			TS_ASSERT_EQUALS(screen._rects[2].x, 7);
+			TS_ASSERT_EQUALS(screen._rects[2].y, 4);
+			TS_ASSERT_EQUALS(screen._rects[2].w, 1);
+			TS_ASSERT_EQUALS(screen._rects[2].h, 1);
+		}
+		screen._rects.clear();
+		screen.checkScreen(frame);
+		TS_ASSERT_EQUALS(shadow.getPixelsCopied(), 48U + 8 + 3);
+		TS_ASSERT_EQUALS(shadow.getPixelsSkipped(), 48U - 8 + 48 - 3);
+	}
+
+	void test_clipping() {
+		ScreenRecorder screen(8, 6, 1);
+		Graphics::ShadowScreen shadow(8, 6);
+		byte frame[10 * 8];
+		for (int i = 0; i < 10 * 8; ++i)
+			frame[i] = i;
+
+		// The frame is larger than the screen, and placed left of and above it
+		shadow.copyRectToScreen(frame, 10, -2, -1, 10, 8);
+		screen.checkRect(0, 0, 8, 6);
+
+		byte expected[8 * 6];
+		for (int y = 0; y < 6; ++y)
+			memcpy(expected + y * 8, frame + (y + 1) * 10 + 2, 8);
+		screen.checkScreen(expected);
+
+		// Clipped changes
+		frame[2 * 10 + 1] = 0xFF;
+		frame[0 * 10 + 5] = 0xFF;
+		frame[3 * 10 + 4] = 0xFF;
+		expected[2 * 8 + 2] = 0xFF;
+		shadow.copyRectToScreen(frame, 10, -2, -1, 10, 8);
+		screen.checkRect(2, 2, 1, 1);
+		screen.checkScreen(expected);
+
+		// Rectangles outside of the screen
+		shadow.copyRectToScreen(frame, 10, 8, 0, 10, 8);
+		shadow.copyRectToScreen(frame, 10, -10, 0, 10, 8);
+		shadow.copyRectToScreen(frame, 10, 0, 6, 10, 8);
+		TS_ASSERT(screen._rects.empty());
+	}
+
+	void test_16bpp() {
+		// Wide enough for the 16 byte steps when looking for the changes
+		ScreenRecorder screen(40, 4, 2);
+		Graphics::ShadowScreen shadow(40, 4, 2);
+		uint16 frame[40 * 4];
+		for (int i = 0; i < 40 * 4; ++i)
+			frame[i] = i * 0x0101;
+
+		shadow.copyRectToScreen(frame, 80, 0, 0, 40, 4);
+		screen.checkRect(0, 0, 40, 4);
+		screen.checkScreen((const byte *)frame);
+
+		// Changing one byte of a pixel copies the whole pixel
+		((byte *)&frame[1 * 40 + 30])[1] ^= 0xFF;
+		shadow.copyRectToScreen(frame, 80, 0, 0, 40, 4);
+		screen.checkRect(30, 1, 1, 1);
+		screen.checkScreen((const byte *)frame);
+
+		((byte *)&frame[2 * 40 + 3])[0] ^= 0xFF;
+		((byte *)&frame[3 * 40 + 2])[1] ^= 0xFF;
+		((byte *)&frame[3 * 40 + 4])[0] ^= 0xFF;
+		shadow.copyRectToScreen(frame, 80, 0, 0, 40, 4);
+		screen.checkRect(2, 2, 3, 2);
+		screen.checkScreen((const byte *)frame);
+
+		// Clipped on the left, in pixels
+		uint16 wide[42 * 4];
+		for (int y = 0; y < 4; ++y) {
+			wide[y * 42 + 0] = wide[y * 42 + 1] = 0;
+			memcpy(wide + y * 42 + 2, frame + y * 40, 80);
+		}
+		wide[0 * 42 + 1] ^= 0xFFFF;
+		wide[3 * 42 + 7] ^= 0xFFFF;
+		frame[3 * 40 + 5] ^= 0xFFFF;
+		shadow.copyRectToScreen(wide, 84, -2, 0, 42, 4);
+		screen.checkRect(5, 3, 1, 1);
+		screen.checkScreen((const byte *)frame);
+
+		TS_ASSERT_EQUALS(shadow.getPixelsCopied(), 160U + 1 + 6 + 1);
+	}
+};
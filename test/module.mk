@@ -5,8 +5,8 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/sound/*.h
-TEST_LIBS    := sound/libsound.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/engines/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/sound/*.h
+TEST_LIBS    := engines/libengines.a backends/libbackends.a sound/libsound.a graphics/libgraphics.a common/libcommon.a
 
 #
 TEST_FLAGS   := --runner=StdioPrinter
@@ -0,0 +1,169 @@
+#include <cxxtest/TestSuite.h>
+
+#include "sound/fmopl.h"
+#include "sound/softsynth/opl/mame.h"
+
+class MameOPLTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) & 0x7fff;
+	}
+
+	// Sets up a random voice on a random channel and keys it on or off
+	void writeRandomVoice(OPL::MAME::FM_OPL **chips, int numChips, bool rhythm) {
+		static const int operatorOffsets[9] = { 0, 1, 2, 8, 9, 10, 16, 17, 18 };
+
+		const int channel = nextRandom() % 9;
+		const int op = operatorOffsets[channel] + (nextRandom() & 1) * 3;
+		const int regs[8][2] = {
+			{ 0x20 + op, nextRandom() & 0xff },
+			{ 0x40 + op, nextRandom() & 0x3f },
+			{ 0x60 + op, nextRandom() & 0xff },
+			{ 0x80 + op, nextRandom() & 0xff },
+			{ 0xe0 + op, nextRandom() & 0x03 },
+			{ 0xc0 + channel, nextRandom() & 0x0f },
+			{ 0xa0 + channel, nextRandom() & 0xff },
+			{ 0xb0 + channel, nextRandom() & 0x3f }
+		};
+		const int rhythmValue = rhythm ? (0x20 | (nextRandom() & 0xdf)) : (nextRandom() & 0xc0);
+
+		for (int i = 0; i < numChips; ++i) {
+			for (int j = 0; j < 8; ++j)
+				OPL::MAME::OPLWriteReg(chips[i], regs[j][0], regs[j][1]);
+			OPL::MAME::OPLWriteReg(chips[i], 0xbd, rhythmValue);
+		}
+	}
+
+	// FNV-1a hash of the samples, independent of the byte order
+	static uint32 hashSamples(const int16 *buffer, int length) {
+		uint32 hash = 2166136261u;
+		for (int i = 0; i < length; ++i) {
+			hash = (hash ^ ((uint16)buffer[i] & 0xff)) * 16777619u;
+			hash = (hash ^ ((uint16)buffer[i] >> 8)) * 16777619u;
+		}
+		return hash;
+	}
+
+public:
+	void test_reference_output() {
+		// Hashes of the output of the sample by sample emulator, which the
+		// block renderer replaced, for the same random voices
+		static const uint32 reference[50] = {
+			0xA4392133, 0x69A9CB5D, 0x095A9ACF, 0x3B3B91E0, 0xACFCF065, 0x430AEC26,
+			0x3B3DB509, 0x02E4B14F, 0x7187F841, 0xDC0EDA50, 0x105623B5, 0xB62C6762,
+			0xDD0C9482, 0x2297C7CE, 0x8B01672C, 0xBC7E5ACE, 0xC37B454A, 0xFC31F5A2,
+			0x5C7B03A4, 0xFD7C7041, 0xD34026B6, 0xCE9722BE, 0xB7B248F1, 0xEBAD6CB9,
+			0xB526C38F, 0x8FADF7EC, 0x96E5A21F, 0xDBB9BA73, 0xC5148C15, 0xFE39DBD0,
+			0x0BE608CB, 0x45244DE6, 0xFC3866A9, 0xDD6CDCD1, 0xBFD1237F, 0x3C845865,
+			0xF11AB925, 0xE5B519AF, 0xB4752319, 0x3DF65334, 0xC51B9C35, 0xD4BE21D8,
+			0x46A97965, 0xE7F280F5, 0x978B7740, 0xA9D17B15, 0x7FDB4709, 0xFF023842,
+			0xFC0A1A8C, 0x7160060B
+		};
+
+		const int samples = 2000;
+		int16 *buffer = new int16[samples];
+
+		OPL::MAME::FM_OPL *chip = OPL::MAME::makeAdLibOPL(22050);
+		OPL::MAME::OPLWriteReg(chip, 0x01, 0x20);
+
+		_seed = 1;
+		for (int step = 0; step < 50; ++step) {
+			for (int i = 0; i < 4; ++i)
+				writeRandomVoice(&chip, 1, step >= 25);
+
+			const int length = 1 + nextRandom() % samples;
+			OPL::MAME::YM3812UpdateOne(chip, buffer, length);
+			TS_ASSERT_EQUALS(hashSamples(buffer, length), reference[step]);
+		}
+
+		OPL::MAME::OPLDestroy(chip);
+		delete[] buffer;
+	}
+
+	void test_block_rendering() {
+		// The block renderer has to produce exactly the same output as
+		// rendering the chip sample by sample
+		const int samples = 2000;
+		int16 *block = new int16[samples];
+		int16 *single = new int16[samples];
+
+		OPL::MAME::FM_OPL *chips[2];
+		chips[0] = OPL::MAME::makeAdLibOPL(22050);
+		chips[1] = OPL::MAME::makeAdLibOPL(22050);
+		OPL::MAME::OPLWriteReg(chips[0], 0x01, 0x20);
+		OPL::MAME::OPLWriteReg(chips[1], 0x01, 0x20);
+
+		_seed = 1;
+		bool same = true;
+		for (int step = 0; step < 50 && same; ++step) {
+			for (int i = 0; i < 4; ++i)
+				writeRandomVoice(chips, 2, step >= 25);
+
+			const int length = 1 + nextRandom() % samples;
+			OPL::MAME::YM3812UpdateOne(chips[0], block, length);
+			for (int i = 0; i < length; ++i)
+				OPL::MAME::YM3812UpdateOne(chips[1], single + i, 1);
+
+			same = !memcmp(block, single, length * sizeof(int16));
+		}
+		TS_ASSERT(same);
+
+		OPL::MAME::OPLDestroy(chips[0]);
+		OPL::MAME::OPLDestroy(chips[1]);
+		delete[] block;
+		delete[] single;
+	}
+
+	void test_dual_opl2() {
+		const int samples = 1000;
+		int16 *reference = new int16[samples];
+		int16 *stereo = new int16[samples * 2];
+
+		OPL::MAME::FM_OPL *chip = OPL::MAME::makeAdLibOPL(22050);
+		OPL::MAME::OPL dual(OPL::Config::kDualOpl2);
+		TS_ASSERT(dual.init(22050));
+		TS_ASSERT(dual.isStereo());
+
+		// A voice written to both chips plays on both sides
+		static const int voice[][2] = {
+			{ 0x20, 0x01 }, { 0x40, 0x10 }, { 0x60, 0xf0 }, { 0x80, 0x77 },
+			{ 0x23, 0x01 }, { 0x43, 0x00 }, { 0x63, 0xf0 }, { 0x83, 0x77 },
+			{ 0xa0, 0x98 }, { 0xb0, 0x31 }
+		};
+		for (uint i = 0; i < ARRAYSIZE(voice); ++i) {
+			OPL::MAME::OPLWriteReg(chip, voice[i][0], voice[i][1]);
+			dual.writeReg(voice[i][0], voice[i][1]);
+		}
+
+		OPL::MAME::YM3812UpdateOne(chip, reference, samples);
+		dual.readBuffer(stereo, samples * 2);
+
+		bool same = true;
+		for (int i = 0; i < samples; ++i)
+			same = same && stereo[i * 2] == reference[i] && stereo[i * 2 + 1] == reference[i];
+		TS_ASSERT(same);
+
+		// Keying off through the right chip's ports only silences the right side
+		dual.write(0x222, 0xb0);
+		dual.write(0x223, 0x11);
+
+		OPL::MAME::YM3812UpdateOne(chip, reference, samples);
+		dual.readBuffer(stereo, samples * 2);
+
+		bool leftSame = true, rightSame = true;
+		for (int i = 0; i < samples; ++i) {
+			leftSame = leftSame && stereo[i * 2] == reference[i];
+			rightSame = rightSame && stereo[i * 2 + 1] == reference[i];
+		}
+		TS_ASSERT(leftSame);
+		TS_ASSERT(!rightSame);
+
+		OPL::MAME::OPLDestroy(chip);
+		delete[] reference;
+		delete[] stereo;
+	}
+};
@@ -27,24 +27,19 @@
 
 #include "common/system.h"
 
+#include "graphics/yuv_to_rgb.h"
+
 // Code here partially based off of ffmpeg ;)
 
 namespace Video {
 
-// Convert a color from YUV to RGB colorspace, Cinepak style.
-inline static void CPYUV2RGB(byte y, byte u, byte v, byte &r, byte &g, byte &b) {
-	r = CLIP<int>(y + 2 * (v - 128), 0, 255);
-	g = CLIP<int>(y - (u - 128) / 2 - (v - 128), 0, 255);
-	b = CLIP<int>(y + 2 * (u - 128), 0, 255);
-}
-
+// Colors are converted from YUV to RGB Cinepak style, see kYUVFormulaCinepak
 #define PUT_PIXEL(offset, lum, u, v) \
 	if (_pixelFormat.bytesPerPixel != 1) { \
-		CPYUV2RGB(lum, u, v, r, g, b); \
 		if (_pixelFormat.bytesPerPixel == 2) \
-			*((uint16 *)_curFrame.surface->pixels + offset) = _pixelFormat.RGBToColor(r, g, b); \
+			*((uint16 *)_curFrame.surface->pixels + offset) = _yuvLookup->convert(lum, u, v); \
 		else \
-			*((uint32 *)_curFrame.surface->pixels + offset) = _pixelFormat.RGBToColor(r, g, b); \
+			*((uint32 *)_curFrame.surface->pixels + offset) = _yuvLookup->convert(lum, u, v); \
 	} else \
 		*((byte *)_curFrame.surface->pixels + offset) = lum
 
@@ -52,11 +47,14 @@ CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec() {
 	_curFrame.surface = NULL;
 	_curFrame.strips = NULL;
 	_y = 0;
+	_yuvLookup = 0;
 
 	if (bitsPerPixel == 8)
 		_pixelFormat = Graphics::PixelFormat::createFormatCLUT8();
-	else
+	else {
 		_pixelFormat = g_system->getScreenFormat();
+		_yuvLookup = YUVToRGBMan.getLookup(_pixelFormat, Graphics::kYUVFormulaCinepak);
+	}
 }
 
 CinepakDecoder::~CinepakDecoder() {
@@ -201,7 +199,6 @@ void CinepakDecoder::decodeVectors(Common::SeekableReadStream *stream, uint16 st
 	uint32 flag = 0, mask = 0;
 	uint32 iy[4];
 	int32 startPos = stream->pos();
-	byte r = 0, g = 0, b = 0;
 
 	for (uint16 y = _curFrame.strips[strip].rect.top; y < _curFrame.strips[strip].rect.bottom; y += 4) {
 		iy[0] = _curFrame.strips[strip].rect.left + y * _curFrame.width;
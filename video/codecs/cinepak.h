@@ -34,6 +34,10 @@
 
 #include "video/codecs/codec.h"
 
+namespace Graphics {
+class YUVToRGBLookup;
+}
+
 namespace Video {
 
 struct CinepakCodebook {
@@ -71,6 +75,7 @@ private:
 	CinepakFrame _curFrame;
 	int32 _y;
 	Graphics::PixelFormat _pixelFormat;
+	const Graphics::YUVToRGBLookup *_yuvLookup;
 
 	void loadCodebook(Common::SeekableReadStream *stream, uint16 strip, byte codebookType, byte chunkID, uint32 chunkSize);
 	void decodeVectors(Common::SeekableReadStream *stream, uint16 strip, byte chunkID, uint32 chunkSize);
@@ -38,7 +38,7 @@
 #include "common/frac.h"
 #include "common/file.h"
 
-#include "graphics/conversion.h"
+#include "graphics/yuv_to_rgb.h"
 
 #include "video/codecs/indeo3.h"
 
@@ -49,6 +49,7 @@ Indeo3Decoder::Indeo3Decoder(uint16 width, uint16 height) : _ModPred(0), _correc
 	_iv_frame[1].the_buf = 0;
 
 	_pixelFormat = g_system->getScreenFormat();
+	_yuvLookup = YUVToRGBMan.getLookup(_pixelFormat);
 
 	_surface = new Graphics::Surface;
 	_surface->create(width, height, _pixelFormat.bytesPerPixel);
@@ -317,10 +318,7 @@ const Graphics::Surface *Indeo3Decoder::decodeImage(Common::SeekableReadStream *
 					cV = (((uint32) cV) + ((uint32) srcVN[x >> 2])) / 2;
 				}
 
-				byte r = 0, g = 0, b = 0;
-				Graphics::YUV2RGB(cY, cU, cV, r, g, b);
-
-				const uint32 color = _pixelFormat.RGBToColor(r, g, b);
+				const uint32 color = _yuvLookup->convert(cY, cU, cV);
 
 				for (uint32 sW = 0; sW < scaleWidth; sW++, rowDest += _surface->bytesPerPixel) {
 					if      (_surface->bytesPerPixel == 1)
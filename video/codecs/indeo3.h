@@ -39,6 +39,10 @@
 
 #include "video/codecs/codec.h"
 
+namespace Graphics {
+class YUVToRGBLookup;
+}
+
 namespace Video {
 
 class Indeo3Decoder : public Codec {
@@ -55,6 +59,7 @@ private:
 	Graphics::Surface *_surface;
 
 	Graphics::PixelFormat _pixelFormat;
+	const Graphics::YUVToRGBLookup *_yuvLookup;
 
 	static const int _corrector_type_0[24];
 	static const int _corrector_type_2[8];
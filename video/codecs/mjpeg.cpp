@@ -24,7 +24,6 @@
  */
 
 #include "common/system.h"
-#include "graphics/conversion.h" // For YUV2RGB
 
 #include "video/codecs/mjpeg.h"
 
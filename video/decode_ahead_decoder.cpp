@@ -0,0 +1,226 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "video/decode_ahead_decoder.h"
+
+#include "common/system.h"
+
+namespace Video {
+
+DecodeAheadVideoDecoder::DecodeAheadVideoDecoder(VideoDecoder *decoder, uint queueSize, DisposeAfterUse::Flag disposeDecoder) {
+	assert(decoder);
+	assert(queueSize > 0);
+
+	_decoder = decoder;
+	_disposeDecoder = disposeDecoder;
+	_queueSize = queueSize;
+	_curFrameData = 0;
+	_dirtyPalette = false;
+	_nextFrameTime = 0;
+	memset(_palette, 0, sizeof(_palette));
+}
+
+DecodeAheadVideoDecoder::~DecodeAheadVideoDecoder() {
+	close();
+
+	// All frames are back in the free list after close()
+	for (uint i = 0; i < _freeFrames.size(); i++) {
+		_freeFrames[i]->surface.free();
+		delete _freeFrames[i];
+	}
+
+	if (_disposeDecoder == DisposeAfterUse::YES)
+		delete _decoder;
+}
+
+bool DecodeAheadVideoDecoder::load(Common::SeekableReadStream *stream) {
+	close();
+
+	return _decoder->load(stream);
+}
+
+void DecodeAheadVideoDecoder::close() {
+	flushFrames();
+	_decoder->close();
+
+	_dirtyPalette = false;
+	_nextFrameTime = 0;
+	reset();
+}
+
+const Graphics::Surface *DecodeAheadVideoDecoder::decodeNextFrame() {
+	// The previously returned frame is not used anymore
+	if (_curFrameData) {
+		_freeFrames.push_back(_curFrameData);
+		_curFrameData = 0;
+	}
+
+	Frame *frame;
+
+	if (!_queuedFrames.empty()) {
+		frame = _queuedFrames.pop();
+	} else {
+		// Nothing has been decoded ahead, decode the frame right here
+		frame = getFreeFrame();
+		decodeFrame(frame);
+	}
+
+	showFrame(frame);
+
+	return frame->hasSurface ? &frame->surface : 0;
+}
+
+uint32 DecodeAheadVideoDecoder::getTimeToNextFrame() const {
+	if (endOfVideo() || _curFrame < 0)
+		return 0;
+
+	uint32 elapsedTime = getElapsedTime();
+
+	// If the time that the next frame should be shown has past
+	// the frame should be shown ASAP.
+	if (_nextFrameTime <= elapsedTime)
+		return 0;
+
+	return _nextFrameTime - elapsedTime;
+}
+
+bool DecodeAheadVideoDecoder::decodeAhead() {
+	// Until the first frame is shown, decoding would start the clock of the
+	// wrapped decoder too early
+	if (_curFrame < 0 || isPaused())
+		return false;
+
+	if (!_decoder->isVideoLoaded() || _decoder->endOfVideo() || getQueuedFrameCount() >= _queueSize)
+		return false;
+
+	Frame *frame = getFreeFrame();
+	decodeFrame(frame);
+	_queuedFrames.push(frame);
+
+	return true;
+}
+
+void DecodeAheadVideoDecoder::pauseVideoIntern(bool pause) {
+	_decoder->pauseVideo(pause);
+}
+
+void DecodeAheadVideoDecoder::addPauseTime(uint32 ms) {
+	VideoDecoder::addPauseTime(ms);
+
+	// Frames decoded before the pause were timed on the clock as it was
+	// before the pause, shift them like our own start time.
+	for (int i = 0; i < _queuedFrames.size(); i++) {
+		Frame *frame = _queuedFrames.pop();
+		frame->startTime += ms;
+		_queuedFrames.push(frame);
+	}
+}
+
+void DecodeAheadVideoDecoder::resync() {
+	flushFrames();
+
+	uint32 elapsedTime = _decoder->getElapsedTime();
+
+	_curFrame = _decoder->getCurFrame();
+	_startTime = g_system->getMillis() - elapsedTime;
+	_nextFrameTime = elapsedTime + _decoder->getTimeToNextFrame();
+}
+
+DecodeAheadVideoDecoder::Frame *DecodeAheadVideoDecoder::getFreeFrame() {
+	if (!_freeFrames.empty())
+		return _freeFrames.remove_at(_freeFrames.size() - 1);
+
+	Frame *frame = new Frame();
+	frame->hasSurface = false;
+	return frame;
+}
+
+void DecodeAheadVideoDecoder::flushFrames() {
+	while (!_queuedFrames.empty())
+		_freeFrames.push_back(_queuedFrames.pop());
+
+	if (_curFrameData) {
+		_freeFrames.push_back(_curFrameData);
+		_curFrameData = 0;
+	}
+}
+
+void DecodeAheadVideoDecoder::decodeFrame(Frame *frame) {
+	const Graphics::Surface *surface = _decoder->decodeNextFrame();
+
+	frame->hasSurface = (surface != 0);
+
+	if (surface) {
+		// Frame buffers are only reallocated if the frame size changes
+		if (frame->surface.w != surface->w || frame->surface.h != surface->h || frame->surface.bytesPerPixel != surface->bytesPerPixel)
+			frame->surface.create(surface->w, surface->h, surface->bytesPerPixel);
+
+		const byte *src = (const byte *)surface->pixels;
+		byte *dst = (byte *)frame->surface.pixels;
+		for (int y = 0; y < surface->h; y++) {
+			memcpy(dst, src, surface->w * surface->bytesPerPixel);
+			src += surface->pitch;
+			dst += frame->surface.pitch;
+		}
+	}
+
+	frame->dirtyPalette = _decoder->hasDirtyPalette();
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, _decoder->getPalette(), sizeof(frame->palette));
+
+	frame->frameNum = _decoder->getCurFrame();
+
+	uint32 elapsedTime = _decoder->getElapsedTime();
+	frame->nextFrameTime = elapsedTime + _decoder->getTimeToNextFrame();
+	frame->startTime = g_system->getMillis() - elapsedTime;
+}
+
+void DecodeAheadVideoDecoder::showFrame(Frame *frame) {
+	_curFrameData = frame;
+	_curFrame = frame->frameNum;
+	_startTime = frame->startTime;
+	_nextFrameTime = frame->nextFrameTime;
+
+	if (frame->dirtyPalette) {
+		memcpy(_palette, frame->palette, sizeof(_palette));
+		_dirtyPalette = true;
+	}
+}
+
+SeekableDecodeAheadVideoDecoder::SeekableDecodeAheadVideoDecoder(SeekableVideoDecoder *decoder, uint queueSize, DisposeAfterUse::Flag disposeDecoder)
+	: DecodeAheadVideoDecoder(decoder, queueSize, disposeDecoder), _seekableDecoder(decoder) {
+}
+
+void SeekableDecodeAheadVideoDecoder::seekToFrame(uint32 frame) {
+	_seekableDecoder->seekToFrame(frame);
+	resync();
+}
+
+void SeekableDecodeAheadVideoDecoder::seekToTime(VideoTimestamp time) {
+	_seekableDecoder->seekToTime(time);
+	resync();
+}
+
+} // End of namespace Video
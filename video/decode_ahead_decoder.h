@@ -0,0 +1,141 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef VIDEO_DECODE_AHEAD_DECODER_H
+#define VIDEO_DECODE_AHEAD_DECODER_H
+
+#include "common/array.h"
+#include "common/queue.h"
+#include "common/types.h"
+
+#include "video/video_decoder.h"
+
+namespace Video {
+
+/**
+ * A VideoDecoder wrapper which decodes frames ahead of time into a bounded
+ * queue of frame buffers. The player calls decodeAhead() while it waits for
+ * the next frame to be due, so decodeNextFrame() usually only has to pick up
+ * a finished frame. If the queue has run dry, decodeNextFrame() decodes the
+ * frame itself.
+ *
+ * Decoding ahead starts once the first frame has been requested, so that
+ * the timing of the video starts when it is actually shown. Frame buffers
+ * are recycled once the player asks for the next frame, so the surface
+ * returned by decodeNextFrame() stays valid until then.
+ *
+ * The wrapped decoder must not be used directly while wrapped. Use
+ * SeekableDecodeAheadVideoDecoder to wrap a SeekableVideoDecoder.
+ */
+class DecodeAheadVideoDecoder : public virtual VideoDecoder {
+public:
+	DecodeAheadVideoDecoder(VideoDecoder *decoder, uint queueSize = 4, DisposeAfterUse::Flag disposeDecoder = DisposeAfterUse::YES);
+	virtual ~DecodeAheadVideoDecoder();
+
+	uint16 getWidth() const { return _decoder->getWidth(); }
+	uint16 getHeight() const { return _decoder->getHeight(); }
+	uint32 getFrameCount() const { return _decoder->getFrameCount(); }
+	Graphics::PixelFormat getPixelFormat() const { return _decoder->getPixelFormat(); }
+	bool isVideoLoaded() const { return _decoder->isVideoLoaded(); }
+
+	bool load(Common::SeekableReadStream *stream);
+	void close();
+
+	const Graphics::Surface *decodeNextFrame();
+	const byte *getPalette() { _dirtyPalette = false; return _palette; }
+	bool hasDirtyPalette() const { return _dirtyPalette; }
+	uint32 getTimeToNextFrame() const;
+
+	/**
+	 * Decode the next frame into the queue, if there is room left. Players
+	 * call this while they wait for the next frame to be due.
+	 *
+	 * @return true if a frame was decoded
+	 */
+	bool decodeAhead();
+
+	/**
+	 * Returns the number of frames that have been decoded ahead and are
+	 * waiting to be shown.
+	 */
+	uint getQueuedFrameCount() const { return (uint)_queuedFrames.size(); }
+
+protected:
+	void pauseVideoIntern(bool pause);
+	void addPauseTime(uint32 ms);
+
+	/**
+	 * Drop all frames decoded ahead and take over the timing of the wrapped
+	 * decoder. Used after the wrapped decoder was seeked.
+	 */
+	void resync();
+
+private:
+	struct Frame {
+		Graphics::Surface surface;
+		bool hasSurface;	///< false if the decoder returned no surface for this frame
+		bool dirtyPalette;
+		byte palette[256 * 3];
+		int32 frameNum;
+		uint32 nextFrameTime;	///< Time (on the clock of the decoder) the following frame is due
+		int32 startTime;	///< Start time of the video, synchronized to the clock of the decoder
+	};
+
+	Frame *getFreeFrame();
+	void flushFrames();
+	void decodeFrame(Frame *frame);
+	void showFrame(Frame *frame);
+
+	VideoDecoder *_decoder;
+	DisposeAfterUse::Flag _disposeDecoder;
+
+	uint _queueSize;
+	Common::Queue<Frame *> _queuedFrames;
+	Common::Array<Frame *> _freeFrames;
+	Frame *_curFrameData;	///< The frame currently shown
+
+	byte _palette[256 * 3];
+	bool _dirtyPalette;
+	uint32 _nextFrameTime;
+};
+
+/**
+ * A DecodeAheadVideoDecoder for a SeekableVideoDecoder. Seeking drops all
+ * frames decoded ahead.
+ */
+class SeekableDecodeAheadVideoDecoder : public DecodeAheadVideoDecoder, public SeekableVideoDecoder {
+public:
+	SeekableDecodeAheadVideoDecoder(SeekableVideoDecoder *decoder, uint queueSize = 4, DisposeAfterUse::Flag disposeDecoder = DisposeAfterUse::YES);
+
+	void seekToFrame(uint32 frame);
+	void seekToTime(VideoTimestamp time);
+
+private:
+	SeekableVideoDecoder *_seekableDecoder;
+};
+
+} // End of namespace Video
+
+#endif
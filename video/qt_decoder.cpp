@@ -121,18 +121,11 @@ uint32 QuickTimeDecoder::getFrameDuration() {
 	if (_videoStreamIndex < 0)
 		return 0;
 
-	uint32 curFrameIndex = 0;
-	for (int32 i = 0; i < _streams[_videoStreamIndex]->stts_count; i++) {
-		curFrameIndex += _streams[_videoStreamIndex]->stts_data[i].count;
-		if ((uint32)_curFrame < curFrameIndex) {
-			// Ok, now we have what duration this frame has.
-			return _streams[_videoStreamIndex]->stts_data[i].duration;
-		}
-	}
-
 	// This should never occur
-	error ("Cannot find duration for frame %d", _curFrame);
-	return 0;
+	if ((uint32)_curFrame >= _frameIndex.size())
+		error ("Cannot find duration for frame %d", _curFrame);
+
+	return _frameIndex[_curFrame].duration;
 }
 
 Graphics::PixelFormat QuickTimeDecoder::getPixelFormat() const {
@@ -145,14 +138,66 @@ Graphics::PixelFormat QuickTimeDecoder::getPixelFormat() const {
 }
 
 uint32 QuickTimeDecoder::findKeyFrame(uint32 frame) const {
-	for (int i = _streams[_videoStreamIndex]->keyframe_count - 1; i >= 0; i--)
-		if (_streams[_videoStreamIndex]->keyframes[i] <= frame)
-				return _streams[_videoStreamIndex]->keyframes[i];
-	
+	if (frame < _frameIndex.size())
+		return _frameIndex[frame].keyFrame;
+
 	// If none found, we'll assume the requested frame is a key frame
 	return frame;
 }
 
+void QuickTimeDecoder::buildFrameIndex() {
+	MOVStreamContext *st = _streams[_videoStreamIndex];
+
+	_frameIndex.resize(st->nb_frames);
+
+	// Timing, from the time-to-sample table
+	uint32 frame = 0;
+	uint32 startTime = 0;
+	for (int32 i = 0; i < st->stts_count; i++) {
+		for (int32 j = 0; j < st->stts_data[i].count && frame < st->nb_frames; j++, frame++) {
+			_frameIndex[frame].startTime = startTime;
+			_frameIndex[frame].duration = st->stts_data[i].duration;
+			startTime += st->stts_data[i].duration;
+		}
+	}
+
+	// Location, from the sample-to-chunk, chunk offset and sample size tables.
+	// Frames without data get a description id of 0.
+	for (frame = 0; frame < st->nb_frames; frame++)
+		_frameIndex[frame].descId = 0;
+
+	frame = 0;
+	uint32 sampleToChunkIndex = 0;
+	for (uint32 i = 0; i < st->chunk_count && frame < st->nb_frames; i++) {
+		if (!st->sample_to_chunk_sz || i < st->sample_to_chunk[0].first)
+			error("This chunk (%d) is imaginary", i);
+
+		while (sampleToChunkIndex + 1 < st->sample_to_chunk_sz && i >= st->sample_to_chunk[sampleToChunkIndex + 1].first)
+			sampleToChunkIndex++;
+
+		const MOVstsc &sampleToChunk = st->sample_to_chunk[sampleToChunkIndex];
+		uint32 offset = st->chunk_offsets[i];
+
+		for (uint32 j = 0; j < sampleToChunk.count && frame < st->nb_frames; j++, frame++) {
+			FrameIndexEntry &entry = _frameIndex[frame];
+			entry.offset = offset;
+			entry.size = st->sample_size ? st->sample_size : (frame < st->sample_count ? st->sample_sizes[frame] : 0);
+			entry.descId = sampleToChunk.id;
+			offset += entry.size;
+		}
+	}
+
+	// Key frames, from the sync sample table. Without it, every frame is a
+	// key frame.
+	uint32 keyFrameIndex = 0;
+	for (frame = 0; frame < st->nb_frames; frame++) {
+		while (keyFrameIndex < st->keyframe_count && st->keyframes[keyFrameIndex] <= frame)
+			keyFrameIndex++;
+
+		_frameIndex[frame].keyFrame = keyFrameIndex ? st->keyframes[keyFrameIndex - 1] : frame;
+	}
+}
+
 void QuickTimeDecoder::seekToFrame(uint32 frame) {
 	assert(_videoStreamIndex >= 0);
 	assert(frame < _streams[_videoStreamIndex]->nb_frames);
@@ -160,21 +205,19 @@ void QuickTimeDecoder::seekToFrame(uint32 frame) {
 	// Stop all audio (for now)
 	stopAudio();
 
-	// Track down the keyframe
-	_curFrame = findKeyFrame(frame) - 1;
+	// Track down the keyframe. If the current frame lies between the key
+	// frame and the requested frame, the codec already holds everything
+	// needed, so just continue decoding from there. Either way, a seek
+	// decodes at most the frames between a key frame and the next one.
+	int32 keyFrame = findKeyFrame(frame);
+	if (_curFrame < keyFrame - 1 || _curFrame > (int32)frame - 1)
+		_curFrame = keyFrame - 1;
+
 	while (_curFrame < (int32)frame - 1)
 		decodeNextFrame();
 
 	// Map out the starting point
-	_nextFrameStartTime = 0;
-	uint32 curFrame = 0;
-
-	for (int32 i = 0; i < _streams[_videoStreamIndex]->stts_count && curFrame < frame; i++) {
-		for (int32 j = 0; j < _streams[_videoStreamIndex]->stts_data[i].count && curFrame < frame; j++) {
-			curFrame++;
-			_nextFrameStartTime += _streams[_videoStreamIndex]->stts_data[i].duration;
-		}
-	}
+	_nextFrameStartTime = _frameIndex[frame].startTime;
 
 	// Adjust the video starting point
 	_startTime = g_system->getMillis() - Video::VideoTimestamp(_nextFrameStartTime, _streams[_videoStreamIndex]->time_scale).getUnitsInScale(1000);
@@ -249,23 +292,18 @@ void QuickTimeDecoder::seekToTime(VideoTimestamp time) {
 	// Convert to the local time scale
 	uint32 localTime = time.getUnitsInScale(_streams[_videoStreamIndex]->time_scale);
 
-	// Try to find the last frame that should have been decoded
-	uint32 frame = 0;
-	uint32 totalDuration = 0;
-	bool done = false;
-
-	for (int32 i = 0; i < _streams[_videoStreamIndex]->stts_count && !done; i++) {
-		for (int32 j = 0; j < _streams[_videoStreamIndex]->stts_data[i].count; j++) {
-			totalDuration += _streams[_videoStreamIndex]->stts_data[i].duration;
-			if (localTime < totalDuration) {
-				done = true;
-				break;
-			}
-			frame++;
-		}
+	// Try to find the last frame that should have been decoded, i.e. the
+	// first frame ending after the requested time
+	uint32 low = 0, high = _frameIndex.size();
+	while (low < high) {
+		uint32 mid = (low + high) / 2;
+		if (localTime < _frameIndex[mid].startTime + _frameIndex[mid].duration)
+			high = mid;
+		else
+			low = mid + 1;
 	}
 
-	seekToFrame(frame);
+	seekToFrame(low);
 }
 
 Codec *QuickTimeDecoder::createCodec(uint32 codecTag, byte bitsPerPixel) {
@@ -520,6 +558,8 @@ void QuickTimeDecoder::init() {
 
 	// Initialize video, if present
 	if (_videoStreamIndex >= 0) {
+		buildFrameIndex();
+
 		for (uint32 i = 0; i < _streams[_videoStreamIndex]->stsdEntryCount; i++) {
 			STSDEntry *entry = &_streams[_videoStreamIndex]->stsdEntries[i];
 			entry->videoCodec = createCodec(entry->codecTag, entry->bitsPerSample & 0x1F);
@@ -987,7 +1027,7 @@ int QuickTimeDecoder::readSTSD(MOVatom atom) {
 					uint16 colorCount = 1 << colorDepth;
 					int16 colorIndex = 255;
 					byte colorDec = 256 / (colorCount - 1);
-					for (byte j = 0; j < colorCount; j++) {
+					for (uint16 j = 0; j < colorCount; j++) {
 						entry->palette[j * 3] = entry->palette[j * 3 + 1] = entry->palette[j * 3 + 2] = colorIndex;
 						colorIndex -= colorDec;
 						if (colorIndex < 0)
@@ -1243,6 +1283,8 @@ void QuickTimeDecoder::close() {
 	for (uint32 i = 0; i < _numStreams; i++)
 		delete _streams[i];
 
+	_numStreams = 0;
+
 	delete _fd;
 	_fd = 0;
 
@@ -1255,6 +1297,8 @@ void QuickTimeDecoder::close() {
 	// The audio stream is deleted automatically
 	_audStream = NULL;
 
+	_frameIndex.clear();
+
 	VideoDecoder::reset();
 }
 
@@ -1262,54 +1306,17 @@ Common::SeekableReadStream *QuickTimeDecoder::getNextFramePacket(uint32 &descId)
 	if (_videoStreamIndex < 0)
 		return NULL;
 
-	// First, we have to track down which chunk holds the sample and which sample in the chunk contains the frame we are looking for.
-	int32 totalSampleCount = 0;
-	int32 sampleInChunk = 0;
-	int32 actualChunk = -1;
-
-	for (uint32 i = 0; i < _streams[_videoStreamIndex]->chunk_count; i++) {
-		int32 sampleToChunkIndex = -1;
-
-		for (uint32 j = 0; j < _streams[_videoStreamIndex]->sample_to_chunk_sz; j++)
-			if (i >= _streams[_videoStreamIndex]->sample_to_chunk[j].first)
-				sampleToChunkIndex = j;
-
-		if (sampleToChunkIndex < 0)
-			error("This chunk (%d) is imaginary", sampleToChunkIndex);
-
-		totalSampleCount += _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].count;
-
-		if (totalSampleCount > getCurFrame()) {
-			actualChunk = i;
-			descId = _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].id;
-			sampleInChunk = _streams[_videoStreamIndex]->sample_to_chunk[sampleToChunkIndex].count - totalSampleCount + getCurFrame();
-			break;
-		}
-	}
-
-	if (actualChunk < 0) {
+	if ((uint32)getCurFrame() >= _frameIndex.size() || !_frameIndex[getCurFrame()].descId) {
 		warning ("Could not find data for frame %d", getCurFrame());
 		return NULL;
 	}
 
-	// Next seek to that frame
-	_fd->seek(_streams[_videoStreamIndex]->chunk_offsets[actualChunk]);
-
-	// Then, if the chunk holds more than one frame, seek to where the frame we want is located
-	for (int32 i = getCurFrame() - sampleInChunk; i < getCurFrame(); i++) {
-		if (_streams[_videoStreamIndex]->sample_size != 0)
-			_fd->skip(_streams[_videoStreamIndex]->sample_size);
-		else
-			_fd->skip(_streams[_videoStreamIndex]->sample_sizes[i]);
-	}
-
-	// Finally, read in the raw data for the frame
-	//printf ("Frame Data[%d]: Offset = %d, Size = %d\n", getCurFrame(), _fd->pos(), _streams[_videoStreamIndex]->sample_sizes[getCurFrame()]);
-
-	if (_streams[_videoStreamIndex]->sample_size != 0)
-		return _fd->readStream(_streams[_videoStreamIndex]->sample_size);
+	const FrameIndexEntry &entry = _frameIndex[getCurFrame()];
+	descId = entry.descId;
 
-	return _fd->readStream(_streams[_videoStreamIndex]->sample_sizes[getCurFrame()]);
+	// Read in the raw data for the frame
+	_fd->seek(entry.offset);
+	return _fd->readStream(entry.size);
 }
 
 bool QuickTimeDecoder::checkAudioCodecSupport(uint32 tag) {
@@ -35,6 +35,7 @@
 #define VIDEO_QT_DECODER_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/queue.h"
 #include "common/rational.h"
 
@@ -247,6 +248,20 @@ private:
 	int8 _videoStreamIndex;
 	uint32 findKeyFrame(uint32 frame) const;
 
+	// Location, timing and key frame of a video frame, so that neither
+	// playback nor seeking has to walk the sample tables
+	struct FrameIndexEntry {
+		uint32 offset;
+		uint32 size;
+		uint32 descId;
+		uint32 startTime; // in the time scale of the video stream
+		uint32 duration;
+		uint32 keyFrame;  // the last key frame at or before this frame
+	};
+
+	Common::Array<FrameIndexEntry> _frameIndex;
+	void buildFrameIndex();
+
 	Graphics::Surface *_scaledSurface;
 	const Graphics::Surface *scaleSurface(const Graphics::Surface *frame);
 	Common::Rational getScaleFactorX() const;
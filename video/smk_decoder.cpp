@@ -48,79 +48,111 @@ enum SmkBlockTypes {
 	SMK_BLOCK_FILL = 3
 };
 
+// Byte masks selecting the high color for each nibble of a MONO block map
+static const byte s_monoMasks[16][4] = {
+	{ 0x00, 0x00, 0x00, 0x00 }, { 0xFF, 0x00, 0x00, 0x00 },
+	{ 0x00, 0xFF, 0x00, 0x00 }, { 0xFF, 0xFF, 0x00, 0x00 },
+	{ 0x00, 0x00, 0xFF, 0x00 }, { 0xFF, 0x00, 0xFF, 0x00 },
+	{ 0x00, 0xFF, 0xFF, 0x00 }, { 0xFF, 0xFF, 0xFF, 0x00 },
+	{ 0x00, 0x00, 0x00, 0xFF }, { 0xFF, 0x00, 0x00, 0xFF },
+	{ 0x00, 0xFF, 0x00, 0xFF }, { 0xFF, 0xFF, 0x00, 0xFF },
+	{ 0x00, 0x00, 0xFF, 0xFF }, { 0xFF, 0x00, 0xFF, 0xFF },
+	{ 0x00, 0xFF, 0xFF, 0xFF }, { 0xFF, 0xFF, 0xFF, 0xFF }
+};
+
 /*
  * class BitStream
  * Little-endian bit stream provider.
+ *
+ * Bits are buffered in a 32-bit accumulator, so that the Huffman trees
+ * can peek at up to 24 bits at once to index their lookup tables.
  */
 
 class BitStream {
 public:
 	BitStream(byte *buf, uint32 length)
-		: _buf(buf), _end(buf+length), _bitCount(8) {
-		_curByte = *_buf++;
+		: _buf(buf), _end(buf+length), _bitBuf(0), _bitCount(0) {
+		refill();
 	}
 
 	bool getBit();
 	byte getBits8();
 
-	byte peek8() const;
+	uint32 peekBits(int n);
 	void skip(int n);
 
 private:
+	void refill();
+
 	byte *_buf;
 	byte *_end;
-	byte _curByte;
-	byte  _bitCount;
+	uint32 _bitBuf;
+	int _bitCount;
 };
 
-bool BitStream::getBit() {
-	if (_bitCount == 0) {
-		assert(_buf < _end);
-		_curByte = *_buf++;
-		_bitCount = 8;
+void BitStream::refill() {
+	while (_bitCount <= 24 && _buf < _end) {
+		_bitBuf |= (uint32)*_buf++ << _bitCount;
+		_bitCount += 8;
 	}
+}
+
+bool BitStream::getBit() {
+	if (_bitCount == 0)
+		refill();
 
-	bool v = _curByte & 1;
+	assert(_bitCount > 0);
 
-	_curByte >>= 1;
+	bool v = _bitBuf & 1;
+
+	_bitBuf >>= 1;
 	--_bitCount;
 
 	return v;
 }
 
 byte BitStream::getBits8() {
-	assert(_buf < _end);
+	if (_bitCount < 8)
+		refill();
+
+	assert(_bitCount >= 8);
 
-	byte v = (*_buf << _bitCount) | _curByte;
-	_curByte = *_buf++ >> (8 - _bitCount);
+	byte v = _bitBuf & 0xFF;
+
+	_bitBuf >>= 8;
+	_bitCount -= 8;
 
 	return v;
 }
 
-byte BitStream::peek8() const {
-	if (_buf == _end)
-		return _curByte;
+uint32 BitStream::peekBits(int n) {
+	assert(n <= 24);
+
+	// Bits past the end of the buffer are read as zeroes
+	if (_bitCount < n)
+		refill();
 
-	assert(_buf < _end);
-	return (*_buf << _bitCount) | _curByte;
+	return _bitBuf & ((1 << n) - 1);
 }
 
 void BitStream::skip(int n) {
-	assert(n <= 8);
-	_curByte >>= n;
+	if (_bitCount < n)
+		refill();
 
-	if (_bitCount >= n) {
-		_bitCount -= n;
-	} else {
-		assert(_buf < _end);
-		_bitCount = _bitCount + 8 - n;
-		_curByte = *_buf++ >> (8 - _bitCount);
-	}
+	assert(n <= _bitCount);
+
+	_bitBuf >>= n;
+	_bitCount -= n;
 }
 
 /*
  * class SmallHuffmanTree
  * A Huffman-tree to hold 8-bit values.
+ *
+ * Codes of up to kLookupBits bits are resolved with a single table lookup,
+ * longer ones continue with a walk from the node found in the table.
+ * Lookup entries hold the tree index in the upper and the number of bits
+ * consumed in the lower 8 bits.
  */
 
 class SmallHuffmanTree {
@@ -130,7 +162,8 @@ public:
 	uint16 getCode(BitStream &bs);
 private:
 	enum {
-		SMK_NODE = 0x8000
+		SMK_NODE = 0x8000,
+		kLookupBits = 8
 	};
 
 	uint16 decodeTree(uint32 prefix, int length);
@@ -138,8 +171,7 @@ private:
 	uint16 _treeSize;
 	uint16 _tree[511];
 
-	uint16 _prefixtree[256];
-	byte _prefixlength[256];
+	uint32 _lookup[1 << kLookupBits];
 
 	BitStream &_bs;
 };
@@ -149,8 +181,7 @@ SmallHuffmanTree::SmallHuffmanTree(BitStream &bs)
 	uint32 bit = _bs.getBit();
 	assert(bit);
 
-	for (uint16 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
+	memset(_lookup, 0, sizeof(_lookup));
 
 	decodeTree(0, 0);
 
@@ -162,11 +193,9 @@ uint16 SmallHuffmanTree::decodeTree(uint32 prefix, int length) {
 	if (!_bs.getBit()) { // Leaf
 		_tree[_treeSize] = _bs.getBits8();
 
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
-				_prefixtree[prefix | i] = _treeSize;
-				_prefixlength[prefix | i] = length;
-			}
+		if (length <= kLookupBits) {
+			for (int i = 0; i < (1 << kLookupBits); i += (1 << length))
+				_lookup[prefix | i] = (_treeSize << 8) | length;
 		}
 		++_treeSize;
 
@@ -175,10 +204,8 @@ uint16 SmallHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint16 t = _treeSize++;
 
-	if (length == 8) {
-		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
-	}
+	if (length == kLookupBits)
+		_lookup[prefix] = (t << 8) | kLookupBits;
 
 	uint16 r1 = decodeTree(prefix, length + 1);
 
@@ -190,9 +217,9 @@ uint16 SmallHuffmanTree::decodeTree(uint32 prefix, int length) {
 }
 
 uint16 SmallHuffmanTree::getCode(BitStream &bs) {
-	byte peek = bs.peek8();
-	uint16 *p = &_tree[_prefixtree[peek]];
-	bs.skip(_prefixlength[peek]);
+	uint32 entry = _lookup[bs.peekBits(kLookupBits)];
+	uint16 *p = &_tree[entry >> 8];
+	bs.skip(entry & 0xFF);
 
 	while (*p & SMK_NODE) {
 		if (bs.getBit())
@@ -206,6 +233,9 @@ uint16 SmallHuffmanTree::getCode(BitStream &bs) {
 /*
  * class BigHuffmanTree
  * A Huffman-tree to hold 16-bit values.
+ *
+ * Uses the same lookup scheme as SmallHuffmanTree, with a wider table since
+ * the video trees are queried several times for every 4x4 block.
  */
 
 class BigHuffmanTree {
@@ -220,14 +250,17 @@ private:
 		SMK_NODE = 0x80000000
 	};
 
+	enum {
+		kLookupBits = 12
+	};
+
 	uint32 decodeTree(uint32 prefix, int length);
 
 	uint32  _treeSize;
 	uint32 *_tree;
 	uint32  _last[3];
 
-	uint32 _prefixtree[256];
-	byte _prefixlength[256];
+	uint32 _lookup[1 << kLookupBits];
 
 	/* Used during construction */
 	BitStream &_bs;
@@ -238,6 +271,8 @@ private:
 
 BigHuffmanTree::BigHuffmanTree(BitStream &bs, int allocSize)
 	: _bs(bs) {
+	memset(_lookup, 0, sizeof(_lookup));
+
 	uint32 bit = _bs.getBit();
 	if (!bit) {
 		_tree = new uint32[1];
@@ -246,9 +281,6 @@ BigHuffmanTree::BigHuffmanTree(BitStream &bs, int allocSize)
 		return;
 	}
 
-	for (uint32 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
-
 	_loBytes = new SmallHuffmanTree(_bs);
 	_hiBytes = new SmallHuffmanTree(_bs);
 
@@ -298,11 +330,9 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 		_tree[_treeSize] = v;
 
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
-				_prefixtree[prefix | i] = _treeSize;
-				_prefixlength[prefix | i] = length;
-			}
+		if (length <= kLookupBits) {
+			for (int i = 0; i < (1 << kLookupBits); i += (1 << length))
+				_lookup[prefix | i] = (_treeSize << 8) | length;
 		}
 
 		for (int i = 0; i < 3; ++i) {
@@ -318,10 +348,8 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint32 t = _treeSize++;
 
-	if (length == 8) {
-		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
-	}
+	if (length == kLookupBits)
+		_lookup[prefix] = (t << 8) | kLookupBits;
 
 	uint32 r1 = decodeTree(prefix, length + 1);
 
@@ -332,9 +360,9 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 }
 
 uint32 BigHuffmanTree::getCode(BitStream &bs) {
-	byte peek = bs.peek8();
-	uint32 *p = &_tree[_prefixtree[peek]];
-	bs.skip(_prefixlength[peek]);
+	uint32 entry = _lookup[bs.peekBits(kLookupBits)];
+	uint32 *p = &_tree[entry >> 8];
+	bs.skip(entry & 0xFF);
 
 	while (*p & SMK_NODE) {
 		if (bs.getBit())
@@ -580,34 +608,42 @@ const Graphics::Surface *SmackerDecoder::decodeNextFrame() {
 	uint stride = getWidth();
 	uint block = 0, blocks = bw*bh;
 
+	// Blocks are decoded in raster order, so instead of deriving the output
+	// position from the block index we just advance along the block row.
+	uint blockX = 0;
+	uint rowStride = stride * 4 * doubleY;
+	byte *row = (byte *)_surface->pixels;
+
 	byte *out;
 	uint type, run, j, mode;
 	uint32 p1, p2, clr, map;
-	byte hi, lo;
+	uint32 hi, lo, mask;
 
 	while (block < blocks) {
 		type = _TypeTree->getCode(bs);
-		run = getBlockRun((type >> 2) & 0x3f);
+		run = MIN(getBlockRun((type >> 2) & 0x3f), blocks - block);
+		block += run;
 
 		switch (type & 3) {
 		case SMK_BLOCK_MONO:
-			while (run-- && block < blocks) {
+			while (run--) {
 				clr = _MClrTree->getCode(bs);
 				map = _MMapTree->getCode(bs);
-				out = (byte *)_surface->pixels + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
-				hi = clr >> 8;
-				lo = clr & 0xff;
+				out = row + blockX * 4;
+				hi = (clr >> 8) * 0x01010101;
+				lo = (clr & 0xff) * 0x01010101;
 				for (i = 0; i < 4; i++) {
+					mask = READ_UINT32(s_monoMasks[map & 0xf]);
 					for (j = 0; j < doubleY; j++) {
-						out[0] = (map & 1) ? hi : lo;
-						out[1] = (map & 2) ? hi : lo;
-						out[2] = (map & 4) ? hi : lo;
-						out[3] = (map & 8) ? hi : lo;
+						WRITE_UINT32(out, (hi & mask) | (lo & ~mask));
 						out += stride;
 					}
 					map >>= 4;
 				}
-				++block;
+				if (++blockX == bw) {
+					blockX = 0;
+					row += rowStride;
+				}
 			}
 			break;
 		case SMK_BLOCK_FULL:
@@ -626,8 +662,8 @@ const Graphics::Surface *SmackerDecoder::decodeNextFrame() {
 				}
 			}
 
-			while (run-- && block < blocks) {
-				out = (byte *)_surface->pixels + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
+			while (run--) {
+				out = row + blockX * 4;
 				switch (mode) {
 					case 0:
 						for (i = 0; i < 4; ++i) {
@@ -682,24 +718,32 @@ const Graphics::Surface *SmackerDecoder::decodeNextFrame() {
 						}
 						break;
 				}
-				++block;
+				if (++blockX == bw) {
+					blockX = 0;
+					row += rowStride;
+				}
 			}
 			break;
 		case SMK_BLOCK_SKIP:
-			while (run-- && block < blocks)
-				block++;
+			// Skip the whole run at once
+			blockX += run;
+			while (blockX >= bw) {
+				blockX -= bw;
+				row += rowStride;
+			}
 			break;
 		case SMK_BLOCK_FILL:
-			uint32 col;
 			mode = type >> 8;
-			while (run-- && block < blocks) {
-				out = (byte *)_surface->pixels + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
-				col = mode * 0x01010101;
+			while (run--) {
+				out = row + blockX * 4;
 				for (i = 0; i < 4 * doubleY; ++i) {
-					out[0] = out[1] = out[2] = out[3] = col;
+					memset(out, mode, 4);
 					out += stride;
 				}
-				++block;
+				if (++blockX == bw) {
+					blockX = 0;
+					row += rowStride;
+				}
 			}
 			break;
 		}